@@ -21,6 +21,7 @@
 #include "audiomanager.h"
 
 #include <QApplication>
+#include <QTimer>
 
 #include "config/config.h"
 
@@ -80,14 +81,44 @@ void AudioManager::PushToOutput(const QByteArray &samples)
 
 void AudioManager::StartOutput(QIODevice *device, int playback_speed)
 {
+  scrubbing_ = false;
+
   output_manager_.PullFromDevice(device, playback_speed);
 }
 
 void AudioManager::StopOutput()
 {
+  scrubbing_ = false;
+
   output_manager_.ResetToPushMode();
 }
 
+void AudioManager::ScrubTo(const QString &filename, const AudioRenderingParams &params, const rational &time)
+{
+  SetOutputParams(params);
+
+  if (!output_manager_.OutputIsSet()) {
+    return;
+  }
+
+  if (!scrubbing_) {
+    output_manager_.PullFromDevice(&scrub_output_, 1);
+    scrubbing_ = true;
+  }
+
+  scrub_engine_->Scrub(filename, params, time);
+}
+
+void AudioManager::ScrubSourceUpdated(const QString &filename, const TimeRange &range)
+{
+  scrub_engine_->SourceUpdated(filename, range);
+}
+
+qint64 AudioManager::GetOutputPlayedUSecs() const
+{
+  return output_manager_.PlayedUSecs();
+}
+
 void AudioManager::SetOutputDevice(const QAudioDeviceInfo &info)
 {
   qInfo() << "Setting output audio device to" << info.deviceName();
@@ -189,9 +220,17 @@ void AudioManager::ReverseBuffer(char *buffer, int buffer_size, int sample_size)
 AudioManager::AudioManager() :
   input_(nullptr),
   input_file_(nullptr),
-  refresh_thread_(nullptr)
+  refresh_thread_(nullptr),
+  scrubbing_(false)
 {
-  RefreshDevices();
+  // Scrub grains are generated on their own thread so they never wait on the GUI
+  scrub_engine_ = new AudioScrubEngine(&scrub_output_);
+  scrub_engine_->moveToThread(&scrub_thread_);
+  scrub_thread_.start(QThread::HighPriority);
+
+  // Even on another thread, enumerating devices competes with everything else at startup. Nothing plays audio before
+  // the event loop starts, so wait until then.
+  QTimer::singleShot(0, this, &AudioManager::RefreshDevices);
 
   connect(&output_manager_, &AudioOutputManager::SentSamples, this, &AudioManager::SentSamples);
 
@@ -200,10 +239,17 @@ AudioManager::AudioManager() :
 
 AudioManager::~AudioManager()
 {
+  // Make sure the output isn't pulling from scrub_output_ as it's destroyed
+  StopOutput();
+
   if (refresh_thread_) {
     refresh_thread_->quit();
     refresh_thread_->wait();
   }
+
+  scrub_thread_.quit();
+  scrub_thread_.wait();
+  delete scrub_engine_;
 }
 
 void AudioManager::RefreshThreadDone()
@@ -28,6 +28,7 @@
 
 #include "outputmanager.h"
 #include "render/audioparams.h"
+#include "scrubengine.h"
 
 /**
  * @brief A thread for refreshing the total list of devices on the system
@@ -86,6 +87,25 @@ public:
    */
   void StopOutput();
 
+  /**
+   * @brief Microseconds of audio played since StartOutput(), or -1 if audio isn't currently playing
+   *
+   * Used as the playback clock so video stays in sync with what's actually heard.
+   */
+  qint64 GetOutputPlayedUSecs() const;
+
+  /**
+   * @brief Play a short grain of a rendered PCM cache file at `time`, for scrubbing
+   *
+   * Grains are read and crossfaded on the scrubbing thread (see AudioScrubEngine) so this returns immediately.
+   */
+  void ScrubTo(const QString& filename, const AudioRenderingParams& params, const rational& time);
+
+  /**
+   * @brief Let the scrubber know part of a PCM cache file was just rendered
+   */
+  void ScrubSourceUpdated(const QString& filename, const TimeRange& range);
+
   void SetOutputDevice(const QAudioDeviceInfo& info);
 
   void SetOutputParams(const AudioRenderingParams& params);
@@ -124,6 +144,17 @@ private:
 
   QThread* refresh_thread_;
 
+  QThread scrub_thread_;
+
+  AudioScrubEngine* scrub_engine_;
+
+  AudioScrubOutput scrub_output_;
+
+  /**
+   * @brief Whether the output is currently pulling from scrub_output_
+   */
+  bool scrubbing_;
+
 private slots:
   void RefreshThreadDone();
 
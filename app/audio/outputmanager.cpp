@@ -70,6 +70,18 @@ void AudioOutputManager::ResetToPushMode()
   }
 }
 
+qint64 AudioOutputManager::PlayedUSecs() const
+{
+  // Only meaningful while pulling from a device (i.e. during playback)
+  if (!output_ || push_device_ || output_->state() != QAudio::ActiveState) {
+    return -1;
+  }
+
+  qint64 buffered = output_->format().durationForBytes(output_->bufferSize() - output_->bytesFree());
+
+  return qMax(Q_INT64_C(0), output_->processedUSecs() - buffered);
+}
+
 void AudioOutputManager::SetParameters(const AudioRenderingParams &params)
 {
   device_proxy_.SetParameters(params);
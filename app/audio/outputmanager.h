@@ -56,6 +56,13 @@ public:
 
   void ResetToPushMode();
 
+  /**
+   * @brief Microseconds of audio the output device has played since PullFromDevice(), or -1 if it isn't playing
+   *
+   * Excludes whatever is still waiting in the output's buffer so this follows what's actually audible.
+   */
+  qint64 PlayedUSecs() const;
+
   void SetParameters(const AudioRenderingParams& params);
 
 signals:
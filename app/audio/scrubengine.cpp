@@ -0,0 +1,369 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "scrubengine.h"
+
+#include "audiomanager.h"
+
+const int AudioScrubOutput::kCrossfadeMs = 5;
+
+const int AudioScrubEngine::kRingMs = 1000;
+const int AudioScrubEngine::kMinimumGrainMs = 20;
+const int AudioScrubEngine::kMaximumGrainMs = 120;
+const int AudioScrubEngine::kIdleMs = 250;
+const int AudioScrubEngine::kReplayMs = 1000;
+
+AudioScrubOutput::AudioScrubOutput(QObject *parent) :
+  QIODevice(parent),
+  read_index_(0)
+{
+}
+
+bool AudioScrubOutput::isSequential() const
+{
+  return true;
+}
+
+void AudioScrubOutput::QueueGrain(QByteArray grain, const AudioRenderingParams &params)
+{
+  int frame_size = params.samples_to_bytes(1);
+  int grain_frames = grain.size() / frame_size;
+  int fade_frames = qMin(params.sample_rate() * kCrossfadeMs / 1000, grain_frames / 2);
+  int fade_size = params.samples_to_bytes(fade_frames);
+
+  // End in silence in case nothing follows this grain
+  FadeOut(grain.data() + grain.size() - fade_size, fade_frames, params);
+
+  QMutexLocker locker(&lock_);
+
+  // Fade out of whatever the output is about to play instead of cutting it off
+  QByteArray previous;
+
+  if (params == params_ && read_index_ < queue_.size()) {
+    previous = queue_.mid(read_index_, fade_size);
+    previous.append(QByteArray(fade_size - previous.size(), 0));
+  }
+
+  Crossfade(grain.data(), previous.isEmpty() ? nullptr : previous.constData(), fade_frames, params);
+
+  queue_ = grain;
+  read_index_ = 0;
+  params_ = params;
+}
+
+qint64 AudioScrubOutput::readData(char *data, qint64 maxlen)
+{
+  QMutexLocker locker(&lock_);
+
+  if (!params_.is_valid()) {
+    memset(data, 0, static_cast<size_t>(maxlen));
+    return maxlen;
+  }
+
+  // Only hand out whole sample frames so the channels never shift
+  qint64 length = maxlen - maxlen % params_.samples_to_bytes(1);
+  qint64 copy_length = qMin(length, static_cast<qint64>(queue_.size() - read_index_));
+
+  memcpy(data, queue_.constData() + read_index_, static_cast<size_t>(copy_length));
+  read_index_ += static_cast<int>(copy_length);
+
+  // Keep the output running with silence until the next grain
+  char silence = (params_.format() == SampleFormat::SAMPLE_FMT_U8) ? '\x80' : '\0';
+  memset(data + copy_length, silence, static_cast<size_t>(length - copy_length));
+
+  if (read_index_ == queue_.size()) {
+    queue_.clear();
+    read_index_ = 0;
+  }
+
+  return length;
+}
+
+qint64 AudioScrubOutput::writeData(const char *data, qint64 maxSize)
+{
+  Q_UNUSED(data)
+  Q_UNUSED(maxSize)
+
+  return -1;
+}
+
+void AudioScrubOutput::Crossfade(char *in, const char *out, int frames, const AudioRenderingParams &params)
+{
+  switch (params.format()) {
+  case SampleFormat::SAMPLE_FMT_S16:
+    CrossfadeInternal<qint16>(reinterpret_cast<qint16*>(in), reinterpret_cast<const qint16*>(out), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_S32:
+    CrossfadeInternal<qint32>(reinterpret_cast<qint32*>(in), reinterpret_cast<const qint32*>(out), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_S64:
+    CrossfadeInternal<qint64>(reinterpret_cast<qint64*>(in), reinterpret_cast<const qint64*>(out), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_FLT:
+    CrossfadeInternal<float>(reinterpret_cast<float*>(in), reinterpret_cast<const float*>(out), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_DBL:
+    CrossfadeInternal<double>(reinterpret_cast<double*>(in), reinterpret_cast<const double*>(out), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_U8:
+  case SampleFormat::SAMPLE_FMT_INVALID:
+  case SampleFormat::SAMPLE_FMT_COUNT:
+    // Unsigned samples aren't centered on zero, these go unfaded
+    break;
+  }
+}
+
+void AudioScrubOutput::FadeOut(char *data, int frames, const AudioRenderingParams &params)
+{
+  switch (params.format()) {
+  case SampleFormat::SAMPLE_FMT_S16:
+    FadeOutInternal<qint16>(reinterpret_cast<qint16*>(data), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_S32:
+    FadeOutInternal<qint32>(reinterpret_cast<qint32*>(data), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_S64:
+    FadeOutInternal<qint64>(reinterpret_cast<qint64*>(data), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_FLT:
+    FadeOutInternal<float>(reinterpret_cast<float*>(data), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_DBL:
+    FadeOutInternal<double>(reinterpret_cast<double*>(data), frames, params.channel_count());
+    break;
+  case SampleFormat::SAMPLE_FMT_U8:
+  case SampleFormat::SAMPLE_FMT_INVALID:
+  case SampleFormat::SAMPLE_FMT_COUNT:
+    break;
+  }
+}
+
+template<typename T>
+void AudioScrubOutput::CrossfadeInternal(T *in, const T *out, int frames, int channels)
+{
+  for (int i=0;i<frames;i++) {
+    double gain = static_cast<double>(i) / static_cast<double>(frames);
+
+    for (int j=0;j<channels;j++) {
+      int index = i * channels + j;
+
+      double value = in[index] * gain;
+
+      if (out) {
+        value += out[index] * (1.0 - gain);
+      }
+
+      in[index] = static_cast<T>(value);
+    }
+  }
+}
+
+template<typename T>
+void AudioScrubOutput::FadeOutInternal(T *data, int frames, int channels)
+{
+  for (int i=0;i<frames;i++) {
+    double gain = 1.0 - static_cast<double>(i + 1) / static_cast<double>(frames);
+
+    for (int j=0;j<channels;j++) {
+      int index = i * channels + j;
+
+      data[index] = static_cast<T>(data[index] * gain);
+    }
+  }
+}
+
+AudioScrubEngine::AudioScrubEngine(AudioScrubOutput *output) :
+  output_(output),
+  ring_start_(0),
+  last_sample_(-1),
+  grain_start_(-1),
+  grain_length_(0),
+  grain_reverse_(false),
+  request_pending_(false)
+{
+}
+
+void AudioScrubEngine::Scrub(const QString &filename, const AudioRenderingParams &params, const rational &time)
+{
+  QMutexLocker locker(&request_lock_);
+
+  pending_request_ = {filename, params, time};
+
+  if (!request_pending_) {
+    request_pending_ = true;
+
+    QMetaObject::invokeMethod(this, "ProcessScrub", Qt::QueuedConnection);
+  }
+}
+
+void AudioScrubEngine::SourceUpdated(const QString &filename, const TimeRange &range)
+{
+  QMetaObject::invokeMethod(this,
+                            "RefreshRange",
+                            Qt::QueuedConnection,
+                            Q_ARG(QString, filename),
+                            Q_ARG(TimeRange, range));
+}
+
+void AudioScrubEngine::SetSource(const QString &filename, const AudioRenderingParams &params)
+{
+  if (filename == filename_ && params == params_) {
+    return;
+  }
+
+  file_.close();
+  file_.setFileName(filename);
+
+  filename_ = filename;
+  params_ = params;
+
+  ring_.clear();
+  ring_start_ = 0;
+  last_sample_ = -1;
+  grain_start_ = -1;
+}
+
+QByteArray AudioScrubEngine::ReadFromRing(qint64 start, int count)
+{
+  int frame_size = params_.samples_to_bytes(1);
+  qint64 ring_end = ring_start_ + ring_.size() / frame_size;
+
+  if (start < ring_start_ || start + count > ring_end) {
+    // Center a new ring on this grain
+    int ring_length = qMax(count, params_.sample_rate() * kRingMs / 1000);
+
+    ring_start_ = qMax(Q_INT64_C(0), start + count / 2 - ring_length / 2);
+    ring_ = QByteArray(params_.samples_to_bytes(ring_length), 0);
+
+    ReadFromFile(ring_start_, ring_.data(), ring_length);
+  }
+
+  return ring_.mid(static_cast<int>(start - ring_start_) * frame_size, count * frame_size);
+}
+
+void AudioScrubEngine::ReadFromFile(qint64 start, char *data, int count)
+{
+  // Unbuffered since the renderer writes to this file while we have it open
+  if (!file_.isOpen() && !file_.open(QFile::ReadOnly | QFile::Unbuffered)) {
+    // Nothing has been rendered yet
+    return;
+  }
+
+  qint64 offset = start * params_.samples_to_bytes(1);
+
+  if (offset >= file_.size() || !file_.seek(offset)) {
+    return;
+  }
+
+  file_.read(data, params_.samples_to_bytes(count));
+}
+
+void AudioScrubEngine::PlayGrain(qint64 start, int count, bool reverse)
+{
+  grain_start_ = start;
+  grain_length_ = count;
+  grain_reverse_ = reverse;
+
+  QByteArray grain = ReadFromRing(start, count);
+
+  if (reverse) {
+    AudioManager::ReverseBuffer(grain.data(), grain.size(), params_.samples_to_bytes(1));
+  }
+
+  output_->QueueGrain(grain, params_);
+}
+
+void AudioScrubEngine::ProcessScrub()
+{
+  request_lock_.lock();
+  ScrubRequest request = pending_request_;
+  request_pending_ = false;
+  request_lock_.unlock();
+
+  if (!request.params.is_valid()) {
+    return;
+  }
+
+  SetSource(request.filename, request.params);
+
+  qint64 sample = params_.time_to_samples(request.time);
+
+  // Velocity is how many samples of the timeline we've moved through per sample of real time
+  double velocity = 0;
+  bool reverse = false;
+
+  if (last_sample_ >= 0 && since_last_scrub_.isValid() && since_last_scrub_.elapsed() < kIdleMs) {
+    qint64 distance = sample - last_sample_;
+    double elapsed_samples = qMax(1.0, since_last_scrub_.nsecsElapsed() * params_.sample_rate() / 1000000000.0);
+
+    velocity = qAbs(distance) / elapsed_samples;
+    reverse = (distance < 0);
+  }
+
+  since_last_scrub_.start();
+  last_sample_ = sample;
+
+  int grain_ms = qBound(kMinimumGrainMs, qRound(kMaximumGrainMs / (1.0 + velocity)), kMaximumGrainMs);
+  int count = params_.sample_rate() * grain_ms / 1000;
+
+  qint64 start = sample;
+
+  if (reverse) {
+    // Reverse grains end at the playhead
+    start = qMax(Q_INT64_C(0), sample - count);
+    count = static_cast<int>(sample - start);
+  }
+
+  if (count > 0) {
+    PlayGrain(start, count, reverse);
+  }
+}
+
+void AudioScrubEngine::RefreshRange(const QString &filename, const TimeRange &range)
+{
+  if (filename != filename_ || !params_.is_valid() || ring_.isEmpty()) {
+    return;
+  }
+
+  int frame_size = params_.samples_to_bytes(1);
+
+  qint64 start = params_.time_to_samples(range.in());
+  qint64 end = params_.time_to_samples(range.out());
+  qint64 ring_end = ring_start_ + ring_.size() / frame_size;
+
+  qint64 overlap_start = qMax(start, ring_start_);
+  qint64 overlap_end = qMin(end, ring_end);
+
+  if (overlap_start >= overlap_end) {
+    return;
+  }
+
+  ReadFromFile(overlap_start,
+               ring_.data() + (overlap_start - ring_start_) * frame_size,
+               static_cast<int>(overlap_end - overlap_start));
+
+  // If the playhead is still where audio was just rendered, play it again now that there's something to hear
+  if (grain_start_ >= 0
+      && since_last_scrub_.elapsed() < kReplayMs
+      && grain_start_ < end
+      && grain_start_ + grain_length_ > start) {
+    PlayGrain(grain_start_, grain_length_, grain_reverse_);
+  }
+}
@@ -0,0 +1,192 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef AUDIOSCRUBENGINE_H
+#define AUDIOSCRUBENGINE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIODevice>
+#include <QMutex>
+
+#include "common/timerange.h"
+#include "render/audioparams.h"
+
+/**
+ * @brief Device the audio output pulls scrub grains from
+ *
+ * Grains are queued from AudioScrubEngine's thread and read by the audio output. Each new grain is crossfaded with
+ * whatever is left of the previous one and every grain fades out at its end, so neither interrupting a grain nor
+ * running out of them clicks. Silence is returned while there's nothing queued so the output keeps running and the
+ * next grain starts playing immediately.
+ */
+class AudioScrubOutput : public QIODevice
+{
+  Q_OBJECT
+public:
+  AudioScrubOutput(QObject* parent = nullptr);
+
+  virtual bool isSequential() const override;
+
+  /**
+   * @brief Replace whatever's still queued with this grain, crossfading between them
+   *
+   * Thread-safe.
+   */
+  void QueueGrain(QByteArray grain, const AudioRenderingParams& params);
+
+protected:
+  virtual qint64 readData(char *data, qint64 maxlen) override;
+
+  virtual qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+  /**
+   * @brief Fade `in` up from silence over `frames` while fading `out` (if not null) down into it
+   */
+  static void Crossfade(char* in, const char* out, int frames, const AudioRenderingParams& params);
+
+  static void FadeOut(char* data, int frames, const AudioRenderingParams& params);
+
+  template<typename T>
+  static void CrossfadeInternal(T* in, const T* out, int frames, int channels);
+
+  template<typename T>
+  static void FadeOutInternal(T* data, int frames, int channels);
+
+  QByteArray queue_;
+
+  int read_index_;
+
+  AudioRenderingParams params_;
+
+  QMutex lock_;
+
+  static const int kCrossfadeMs;
+
+};
+
+/**
+ * @brief Generates scrub grains from a rendered PCM cache file on its own thread
+ *
+ * Keeps a small ring of audio around the playhead in memory so consecutive grains don't touch the disk. Grain length
+ * follows scrub velocity: fast scrubbing gets short grains so the sound keeps up with the playhead, slow scrubbing gets
+ * longer ones so it stays intelligible. Scrubbing backwards plays grains in reverse.
+ *
+ * The cache file may not have been rendered around the playhead yet, in which case the grain is silent. Once the range
+ * has been rendered (see SourceUpdated()) the ring is refreshed and, if the playhead is still there, the grain is
+ * played again.
+ */
+class AudioScrubEngine : public QObject
+{
+  Q_OBJECT
+public:
+  AudioScrubEngine(AudioScrubOutput* output);
+
+  /**
+   * @brief Play a grain starting at `time` in `filename`
+   *
+   * Thread-safe. Requests that arrive faster than they can be handled are merged, only the latest is played.
+   */
+  void Scrub(const QString& filename, const AudioRenderingParams& params, const rational& time);
+
+  /**
+   * @brief Let the engine know a range of `filename` was just rendered
+   *
+   * Thread-safe.
+   */
+  void SourceUpdated(const QString& filename, const TimeRange& range);
+
+private:
+  void SetSource(const QString& filename, const AudioRenderingParams& params);
+
+  /**
+   * @brief Copy `count` sample frames starting at `start` out of the ring, refilling it if necessary
+   */
+  QByteArray ReadFromRing(qint64 start, int count);
+
+  /**
+   * @brief Read sample frames from the cache file, anything that hasn't been rendered yet is left untouched
+   */
+  void ReadFromFile(qint64 start, char* data, int count);
+
+  void PlayGrain(qint64 start, int count, bool reverse);
+
+  AudioScrubOutput* output_;
+
+  QString filename_;
+
+  AudioRenderingParams params_;
+
+  QFile file_;
+
+  QByteArray ring_;
+
+  qint64 ring_start_;
+
+  qint64 last_sample_;
+
+  QElapsedTimer since_last_scrub_;
+
+  qint64 grain_start_;
+
+  int grain_length_;
+
+  bool grain_reverse_;
+
+  struct ScrubRequest {
+    QString filename;
+    AudioRenderingParams params;
+    rational time;
+  };
+
+  ScrubRequest pending_request_;
+
+  bool request_pending_;
+
+  QMutex request_lock_;
+
+  /**
+   * @brief Length of audio kept around the playhead
+   */
+  static const int kRingMs;
+
+  static const int kMinimumGrainMs;
+
+  static const int kMaximumGrainMs;
+
+  /**
+   * @brief Scrubs further apart than this are treated as starting from standstill
+   */
+  static const int kIdleMs;
+
+  /**
+   * @brief If the last grain's range is rendered within this long of it being scrubbed, the grain is played again
+   */
+  static const int kReplayMs;
+
+private slots:
+  void ProcessScrub();
+
+  void RefreshRange(const QString& filename, const TimeRange& range);
+
+};
+
+#endif // AUDIOSCRUBENGINE_H
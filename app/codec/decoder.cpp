@@ -27,6 +27,7 @@
 #include "codec/ffmpeg/ffmpegcommon.h"
 #include "codec/ffmpeg/ffmpegdecoder.h"
 #include "codec/oiio/oiiodecoder.h"
+#include "codec/probecache.h"
 #include "codec/waveinput.h"
 #include "codec/waveoutput.h"
 #include "render/backend/indexmanager.h"
@@ -66,6 +67,20 @@ FramePtr Decoder::RetrieveVideo(const rational &/*timecode*/, const int &/*divid
   return nullptr;
 }
 
+FramePtr Decoder::RetrieveKeyframe(const rational &timecode, const int &divider)
+{
+  return RetrieveVideo(timecode, divider);
+}
+
+void Decoder::SetPlaybackSpeed(int /*speed*/)
+{
+}
+
+bool Decoder::IsReturningKeyframesOnly() const
+{
+  return false;
+}
+
 FramePtr Decoder::RetrieveAudio(const rational &/*timecode*/, const rational &/*length*/, const AudioRenderingParams &/*params*/)
 {
   return nullptr;
@@ -114,47 +129,59 @@ bool Decoder::ProbeMedia(Footage *f, const QAtomicInt* cancelled)
   // Reset Footage state for probing
   f->Clear();
 
-  // Create list to iterate through
-  QVector<DecoderPtr> decoder_list = ReceiveListOfAllDecoders();
-
-  // Pass Footage through each Decoder's probe function
-  for (int i=0;i<decoder_list.size();i++) {
-
-    if (cancelled && *cancelled) {
-      return false;
-    }
+  // If this exact file has been probed before, we can skip probing entirely
+  bool probed = ProbeCache::Load(f);
 
-    DecoderPtr decoder = decoder_list.at(i);
+  if (!probed) {
+    // Create list to iterate through
+    QVector<DecoderPtr> decoder_list = ReceiveListOfAllDecoders();
 
-    if (decoder->Probe(f, cancelled)) {
+    // Pass Footage through each Decoder's probe function
+    for (int i=0;i<decoder_list.size();i++) {
 
-      // We found a Decoder, so we can set this media as valid
-      f->set_status(Footage::kReady);
+      if (cancelled && *cancelled) {
+        return false;
+      }
 
-      // Attach the successful Decoder to this Footage object
-      f->set_decoder(decoder->id());
+      DecoderPtr decoder = decoder_list.at(i);
 
-      // FIXME: Cache the results so we don't have to probe if this media is added a second time
+      if (decoder->Probe(f, cancelled)) {
+        // Attach the successful Decoder to this Footage object
+        f->set_decoder(decoder->id());
 
-      // Start an index task
-      foreach (StreamPtr stream, f->streams()) {
-        if (stream->type() == Stream::kAudio) {
-          QMetaObject::invokeMethod(IndexManager::instance(),
-                                    "StartIndexingStream",
-                                    Qt::QueuedConnection,
-                                    Q_ARG(StreamPtr, stream));
-        }
+        probed = true;
+        break;
       }
+    }
 
-      return true;
+    // A cancelled probe may have stopped before determining everything (e.g. durations), so don't cache it
+    if (probed && !(cancelled && *cancelled)) {
+      ProbeCache::Save(f);
     }
   }
 
-  // We aren't able to use this Footage
-  f->set_status(Footage::kInvalid);
-  f->set_decoder(QString());
+  if (!probed) {
+    // We aren't able to use this Footage
+    f->set_status(Footage::kInvalid);
+    f->set_decoder(QString());
 
-  return false;
+    return false;
+  }
+
+  // We found a Decoder, so we can set this media as valid
+  f->set_status(Footage::kReady);
+
+  // Start an index task
+  foreach (StreamPtr stream, f->streams()) {
+    if (stream->type() == Stream::kAudio) {
+      QMetaObject::invokeMethod(IndexManager::instance(),
+                                "StartIndexingStream",
+                                Qt::QueuedConnection,
+                                Q_ARG(StreamPtr, stream));
+    }
+  }
+
+  return true;
 }
 
 DecoderPtr Decoder::CreateFromID(const QString &id)
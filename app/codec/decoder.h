@@ -144,6 +144,33 @@ public:
    */
   virtual FramePtr RetrieveVideo(const rational& timecode, const int& divider);
 
+  /**
+   * @brief Retrieve the closest frame that can be decoded without decoding any frames before it
+   *
+   * Intended for previews (e.g. thumbnails) where the exact frame doesn't matter but speed does. Decoders that can
+   * seek to a keyframe should override this and return the first frame they land on instead of decoding forward to
+   * the exact timecode. The default implementation falls back to RetrieveVideo().
+   */
+  virtual FramePtr RetrieveKeyframe(const rational& timecode, const int& divider);
+
+  /**
+   * @brief Hint at how frames are about to be requested
+   *
+   * `speed` is the playback speed as a multiple of real-time, negative when playing in reverse and 0 when frames are
+   * requested in no particular order (e.g. scrubbing). Decoders may use this to decode ahead in the right direction
+   * or to trade accuracy for speed when shuttling. The default implementation does nothing.
+   */
+  virtual void SetPlaybackSpeed(int speed);
+
+  /**
+   * @brief Returns whether RetrieveVideo() currently returns the nearest keyframe instead of the exact frame
+   *
+   * Decoders may do this at the playback speed set with SetPlaybackSpeed(). Anything rendered from such a frame only
+   * approximates what that time looks like and mustn't be cached as if it was exact. The default implementation
+   * returns false.
+   */
+  virtual bool IsReturningKeyframesOnly() const;
+
   /**
    * @brief Retrieve video frame
    *
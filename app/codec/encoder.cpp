@@ -1,6 +1,9 @@
 #include "encoder.h"
 
+#include <QDebug>
+
 #include "ffmpeg/ffmpegencoder.h"
+#include "oiio/oiioencoder.h"
 
 Encoder::Encoder(const EncodingParams &params) :
   params_(params),
@@ -128,16 +131,54 @@ void EncodingParams::SetExportLength(const rational &export_length)
 
 Encoder* Encoder::CreateFromID(const QString &id, const EncodingParams& params)
 {
-  Q_UNUSED(id)
-  
+  if (id == QStringLiteral("oiio")) {
+    return new OIIOEncoder(params);
+  }
+
   return new FFmpegEncoder(params);
 }
 
+const Encoder::PassthroughTarget &Encoder::passthrough_target() const
+{
+  return passthrough_target_;
+}
+
+QList<rational> Encoder::GetPassthroughSplicePoints(const PassthroughTarget &target,
+                                                    const QString &filename,
+                                                    int stream_index,
+                                                    const QAtomicInt *cancelled) const
+{
+  Q_UNUSED(target)
+  Q_UNUSED(filename)
+  Q_UNUSED(stream_index)
+  Q_UNUSED(cancelled)
+
+  // By default, encoders can't pass through packets
+  return QList<rational>();
+}
+
+YUVParams Encoder::GetNativeYUVParams() const
+{
+  // By default, encoders receive RGBA frames
+  return YUVParams();
+}
+
+bool Encoder::AcceptsFramesOutOfOrder() const
+{
+  // By default, encoders write one stream that frames must arrive in order for
+  return false;
+}
+
 bool Encoder::IsOpen() const
 {
   return open_;
 }
 
+void Encoder::SetPassthroughTarget(const PassthroughTarget &target)
+{
+  passthrough_target_ = target;
+}
+
 void Encoder::Open()
 {
   if (!open_) {
@@ -158,6 +199,32 @@ void Encoder::WriteFrame(FramePtr frame)
   }
 }
 
+void Encoder::WritePassthrough(const QString &filename,
+                               int stream_index,
+                               const rational &source_in,
+                               const rational &source_out,
+                               const rational &dest_in)
+{
+  if (open_) {
+    WritePassthroughInternal(filename, stream_index, source_in, source_out, dest_in);
+  }
+}
+
+void Encoder::WritePassthroughInternal(const QString &filename,
+                                       int stream_index,
+                                       const rational &source_in,
+                                       const rational &source_out,
+                                       const rational &dest_in)
+{
+  Q_UNUSED(filename)
+  Q_UNUSED(stream_index)
+  Q_UNUSED(source_in)
+  Q_UNUSED(source_out)
+  Q_UNUSED(dest_in)
+
+  qWarning() << "This encoder doesn't support passthrough";
+}
+
 void Encoder::Close()
 {
   if (open_) {
@@ -2,6 +2,7 @@
 #define ENCODER_H
 
 #include <memory>
+#include <QAtomicInt>
 #include <QString>
 
 #include "codec/frame.h"
@@ -79,9 +80,92 @@ public:
 
   const EncodingParams& params() const;
 
+  /**
+   * @brief What a source stream's packets must match to be copied into the output, captured when the video encoder opens
+   *
+   * A plain copy of the encoder's parameters so that passthrough scans on other threads never touch the codec state,
+   * which the encoder may free and reallocate. Codec and pixel format IDs are the implementation's own (e.g. AVCodecID
+   * and AVPixelFormat for FFmpegEncoder).
+   */
+  struct PassthroughTarget {
+    PassthroughTarget() :
+      codec_id(-1),
+      width(0),
+      height(0),
+      pixel_format(-1)
+    {
+    }
+
+    bool is_valid() const
+    {
+      return codec_id != -1;
+    }
+
+    int codec_id;
+    int width;
+    int height;
+    int pixel_format;
+    rational time_base;
+    QByteArray extradata;
+  };
+
+  /**
+   * @brief Returns the target passthrough scans must match, invalid if this encoder can't pass packets through
+   *
+   * Set while the encoder opens and never changed afterwards, so it can be read from the thread that received
+   * OpenSucceeded().
+   */
+  const PassthroughTarget& passthrough_target() const;
+
+  /**
+   * @brief Check whether packets from a source stream can be copied into the output without re-encoding
+   *
+   * If the stream's packets are compatible with `target`, this returns the points (in seconds from the start of the
+   * stream) that packets can be copied from and to, i.e. its keyframes and its end. If they aren't, an empty list is
+   * returned and the stream must be re-encoded.
+   *
+   * Only intra-only codecs are passed through. Splicing a long-GOP stream would need the partial GOPs around each edit
+   * re-encoded, which isn't done, so such sources are always re-encoded in full.
+   *
+   * This may read the entire source, so it's meant to be called from another thread. Implementations must only use
+   * `target` and never the encoder's own state. Setting `cancelled` aborts the scan early, in which case an empty list
+   * is returned.
+   */
+  virtual QList<rational> GetPassthroughSplicePoints(const PassthroughTarget& target,
+                                                     const QString& filename,
+                                                     int stream_index,
+                                                     const QAtomicInt* cancelled = nullptr) const;
+
+  /**
+   * @brief The planar Y'CbCr layout this encoder consumes natively
+   *
+   * Only valid once the encoder is open. If this is valid, frames can be converted to this layout on the GPU (see
+   * Frame::yuv_params()) and WriteFrame() will copy them straight through instead of converting them itself. Returns
+   * an invalid YUVParams if the encoder doesn't take planar Y'CbCr or needs its frames as RGBA anyway.
+   */
+  virtual YUVParams GetNativeYUVParams() const;
+
+  /**
+   * @brief Whether frames can be written in any order rather than strictly in sequence
+   *
+   * Encoders that write every frame independently (e.g. image sequences) return true, letting the exporter hand them
+   * frames as soon as they're rendered instead of holding them until every earlier frame has been written.
+   */
+  virtual bool AcceptsFramesOutOfOrder() const;
+
 public slots:
   void Open();
   void WriteFrame(FramePtr frame);
+
+  /**
+   * @brief Copy a source stream's packets between two splice points into the output, starting at `dest_in`
+   */
+  void WritePassthrough(const QString& filename,
+                        int stream_index,
+                        const rational& source_in,
+                        const rational& source_out,
+                        const rational& dest_in);
+
   virtual void WriteAudio(const AudioRenderingParams& pcm_info, const QString& pcm_filename) = 0;
   void Close();
 
@@ -91,18 +175,35 @@ signals:
 
   void Closed();
 
+  /**
+   * @brief Emitted before Closed() if some of the frames written couldn't be stored, so the output is incomplete
+   */
+  void WriteFailed(const QString& message);
+
   void AudioComplete();
 
 protected:
   virtual bool OpenInternal() = 0;
   virtual void WriteInternal(FramePtr frame) = 0;
+  virtual void WritePassthroughInternal(const QString& filename,
+                                        int stream_index,
+                                        const rational& source_in,
+                                        const rational& source_out,
+                                        const rational& dest_in);
   virtual void CloseInternal() = 0;
 
   bool IsOpen() const;
 
+  /**
+   * @brief Set the passthrough target, must only be called from OpenInternal()
+   */
+  void SetPassthroughTarget(const PassthroughTarget& target);
+
 private:
   EncodingParams params_;
 
+  PassthroughTarget passthrough_target_;
+
   bool open_;
 };
 
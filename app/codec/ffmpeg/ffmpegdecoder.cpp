@@ -40,8 +40,36 @@ extern "C" {
 #include "common/timecodefunctions.h"
 #include "ffmpegcommon.h"
 #include "render/diskmanager.h"
+#include "render/memorymanager.h"
 #include "render/pixelformat.h"
 
+const int FFmpegDecoder::kKeyframeOnlySpeed = 4;
+const int FFmpegDecoder::kMaximumReverseFrames = 120;
+
+class FFmpegDecoder::ReversePrefetchTask : public QRunnable
+{
+public:
+  ReversePrefetchTask(FFmpegDecoder* decoder, int generation, int64_t stop_ts) :
+    decoder_(decoder),
+    generation_(generation),
+    stop_ts_(stop_ts)
+  {
+  }
+
+  virtual void run() override
+  {
+    decoder_->ReversePrefetch(generation_, stop_ts_);
+  }
+
+private:
+  FFmpegDecoder* decoder_;
+
+  int generation_;
+
+  int64_t stop_ts_;
+
+};
+
 FFmpegDecoder::FFmpegDecoder() :
   fmt_ctx_(nullptr),
   codec_ctx_(nullptr),
@@ -49,8 +77,17 @@ FFmpegDecoder::FFmpegDecoder() :
   scale_divider_(-1),
   cache_at_zero_(false),
   cache_at_eof_(false),
+  last_keyframe_ts_(AV_NOPTS_VALUE),
+  playback_speed_(0),
+  prefetch_at_zero_(false),
+  prefetch_owns_codec_(false),
+  prefetch_pending_(false),
+  prefetch_generation_(0),
   opts_(nullptr)
 {
+  // The prefetch shares our codec context so there's never more than one
+  prefetch_pool_.setMaxThreadCount(1);
+
   // FIXME: Hardcoded, ideally this value is dynamically chosen based on memory restraints
   clear_timer_.setInterval(250);
   clear_timer_.moveToThread(qApp->thread());
@@ -214,47 +251,47 @@ FramePtr FFmpegDecoder::RetrieveVideo(const rational &timecode, const int &divid
 
   int64_t target_ts = Timecode::time_to_timestamp(timecode, avstream_->time_base) + avstream_->start_time;
 
-  Frame* return_frame = nullptr;
-
   if (divider != scale_divider_) {
     ClearFrameCache();
     FreeScaler();
     SetupScaler(divider);
-  }
-
-  // See if our RAM cache already has a frame that matches this timestamp
-  if (!cached_frames_.isEmpty()) {
-
-    if (target_ts < cached_frames_.first()->native_timestamp()) {
-
-      if (cache_at_zero_) {
-        return_frame = cached_frames_.first();
-        cached_frames_.accessedFirst();
-      }
-
-    } else if (target_ts > cached_frames_.last()->native_timestamp()) {
+    last_keyframe_ = nullptr;
 
-      if (cache_at_eof_) {
-        return_frame = cached_frames_.last();
-        cached_frames_.accessedLast();
-      }
-
-    } else {
+    if (!scale_ctx_) {
+      return nullptr;
+    }
+  }
 
-      // We already have this frame in the cache, find it
-      for (int i=0;i<cached_frames_.size();i++) {
-        Frame* this_frame = cached_frames_.at(i);
+  int playback_speed = playback_speed_;
 
-        if (this_frame->native_timestamp() == target_ts // Test for an exact match
-            || (i < cached_frames_.size() - 1 && cached_frames_.at(i+1)->native_timestamp() > target_ts)) { // Or for this frame to be the "closest"
+  // When shuttling this fast there's no time to decode every GOP up to the frame, so keyframes will have to do
+  if (qAbs(playback_speed) >= kKeyframeOnlySpeed) {
+    return RetrieveKeyframeInternal(target_ts);
+  }
 
-          return_frame = this_frame;
-          cached_frames_.accessed(i);
+  bool reverse = (playback_speed < 0);
 
-          break;
+  // See if our RAM cache already has a frame that matches this timestamp
+  Frame* return_frame = FindInFrameCache(target_ts);
 
-        }
-      }
+  if (!return_frame) {
+    // Anything we do from here on moves the decoder, so the prefetch has to get out of the way
+    CancelReversePrefetch();
+
+    if (reverse
+        && !reverse_prefetch_.isEmpty()
+        && !cached_frames_.isEmpty()
+        && target_ts < cached_frames_.first()->native_timestamp()
+        && target_ts >= reverse_prefetch_.first()->native_timestamp()) {
+      // Playback has reached the GOP we've been prefetching. The decoder is still positioned wherever the prefetch got
+      // to, so if it didn't finish we can carry on decoding from there.
+      cached_frames_.clear();
+      std::swap(cached_frames_, reverse_prefetch_);
+      cache_at_zero_ = prefetch_at_zero_;
+      cache_at_eof_ = false;
+      prefetch_owns_codec_ = false;
+
+      return_frame = FindInFrameCache(target_ts);
     }
   }
 
@@ -290,7 +327,8 @@ FramePtr FFmpegDecoder::RetrieveVideo(const rational &timecode, const int &divid
     bool still_seeking = false;
 
     // If the frame wasn't in the frame cache, see if this frame cache is too old to use
-    if (cached_frames_.isEmpty()
+    if (prefetch_owns_codec_
+        || cached_frames_.isEmpty()
         || target_ts < cached_frames_.first()->native_timestamp()
         || target_ts > cached_frames_.last()->native_timestamp() + 2*second_ts_) {
       ClearFrameCache();
@@ -360,27 +398,16 @@ FramePtr FFmpegDecoder::RetrieveVideo(const rational &timecode, const int &divid
         }
 
         // Whatever it is, keep this frame in memory for the time being just in case
-        Frame* working_frame_converted = cached_frames_.append(VideoRenderingParams(avstream_->codecpar->width / divider,
-                                                                                    avstream_->codecpar->height / divider,
-                                                                                    avstream_->time_base,
-                                                                                    native_pix_fmt_,
-                                                                                    RenderMode::kOffline));
-
-        working_frame_converted->set_timestamp(Timecode::timestamp_to_time(target_ts, avstream_->time_base));
-        working_frame_converted->set_sample_aspect_ratio(av_guess_sample_aspect_ratio(fmt_ctx_, avstream_, nullptr));
-        working_frame_converted->set_native_timestamp(working_frame->pts);
-
-        // Convert frame to RGBA for the rest of the pipeline
-        uint8_t* output_data = reinterpret_cast<uint8_t*>(working_frame_converted->data());
-        int output_linesize = working_frame_converted->width() * PixelFormat::ChannelCount(native_pix_fmt_) * PixelFormat::BytesPerChannel(native_pix_fmt_);
-
-        sws_scale(scale_ctx_,
-                  working_frame->data,
-                  working_frame->linesize,
-                  0,
-                  avstream_->codecpar->height,
-                  &output_data,
-                  &output_linesize);
+        Frame* working_frame_converted = AppendToFrameCache(&cached_frames_,
+                                                            working_frame,
+                                                            Timecode::timestamp_to_time(target_ts, avstream_->time_base));
+
+        // Playing in reverse we only need the frames leading up to the target, and a whole long GOP may not fit in
+        // memory
+        if (reverse && cached_frames_.size() > kMaximumReverseFrames && cached_frames_.first() != return_frame) {
+          cached_frames_.remove_first();
+          cache_at_zero_ = false;
+        }
 
         if (working_frame_is_the_one) {
           // We found the frame we want
@@ -399,22 +426,104 @@ FramePtr FFmpegDecoder::RetrieveVideo(const rational &timecode, const int &divid
 
   // We found the frame, we'll return a copy
   if (return_frame) {
-    FramePtr copy = Frame::Create();
-    copy->set_width(return_frame->width());
-    copy->set_height(return_frame->height());
-    copy->set_format(return_frame->format());
-    copy->set_timestamp(return_frame->timestamp());
-    copy->set_sample_aspect_ratio(return_frame->sample_aspect_ratio());
-    copy->allocate();
-
-    memcpy(copy->data(), return_frame->data(), copy->allocated_size());
+    if (reverse) {
+      // Get the GOP before this one ready while the frames we have are played out
+      StartReversePrefetch();
+    }
 
-    return copy;
+    return CopyFrame(return_frame);
   }
 
   return nullptr;
 }
 
+FramePtr FFmpegDecoder::RetrieveKeyframe(const rational &timecode, const int &divider)
+{
+  QMutexLocker locker(&mutex_);
+
+  if (!open_) {
+    qWarning() << "Tried to retrieve video on a decoder that's still closed";
+    return nullptr;
+  }
+
+  if (avstream_->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+    return nullptr;
+  }
+
+  int64_t target_ts = Timecode::time_to_timestamp(timecode, avstream_->time_base) + avstream_->start_time;
+
+  if (divider != scale_divider_) {
+    ClearFrameCache();
+    FreeScaler();
+    SetupScaler(divider);
+    last_keyframe_ = nullptr;
+
+    if (!scale_ctx_) {
+      return nullptr;
+    }
+  }
+
+  return RetrieveKeyframeInternal(target_ts);
+}
+
+FramePtr FFmpegDecoder::RetrieveKeyframeInternal(int64_t target_ts)
+{
+  // Look up which keyframe the seek will land on, if it's the one we decoded last time there's no need to decode it
+  // again (common when shuttling through long GOPs)
+  int keyframe_index = av_index_search_timestamp(avstream_, target_ts, AVSEEK_FLAG_BACKWARD);
+  int64_t keyframe_ts = (keyframe_index >= 0) ? avstream_->index_entries[keyframe_index].timestamp : AV_NOPTS_VALUE;
+
+  if (last_keyframe_ && keyframe_ts != AV_NOPTS_VALUE && keyframe_ts == last_keyframe_ts_) {
+    return CopyFrame(last_keyframe_.get());
+  }
+
+  // Seeking backwards lands on the keyframe before the target, which is the first frame the decoder can output. We
+  // don't decode forward from there so the frame cache no longer matches the decoder's position.
+  ClearFrameCache();
+  Seek(target_ts);
+
+  AVPacket* pkt = av_packet_alloc();
+  AVFrame* working_frame = av_frame_alloc();
+
+  FramePtr frame = nullptr;
+
+  int ret = GetFrame(pkt, working_frame);
+
+  if (ret >= 0) {
+    frame = Frame::Create();
+    frame->set_width(avstream_->codecpar->width / scale_divider_);
+    frame->set_height(avstream_->codecpar->height / scale_divider_);
+    frame->set_format(native_pix_fmt_);
+    frame->set_timestamp(Timecode::timestamp_to_time(working_frame->pts - avstream_->start_time, avstream_->time_base));
+    frame->set_sample_aspect_ratio(av_guess_sample_aspect_ratio(fmt_ctx_, avstream_, nullptr));
+    frame->allocate();
+
+    uint8_t* output_data = reinterpret_cast<uint8_t*>(frame->data());
+    int output_linesize = frame->width() * PixelFormat::ChannelCount(native_pix_fmt_) * PixelFormat::BytesPerChannel(native_pix_fmt_);
+
+    sws_scale(scale_ctx_,
+              working_frame->data,
+              working_frame->linesize,
+              0,
+              avstream_->codecpar->height,
+              &output_data,
+              &output_linesize);
+
+    last_keyframe_ = frame;
+    last_keyframe_ts_ = keyframe_ts;
+
+    // Callers are free to modify what we return, so keep our own copy untouched
+    frame = CopyFrame(last_keyframe_.get());
+  } else if (ret != AVERROR_EOF) {
+    FFmpegError(ret);
+  }
+
+  av_packet_free(&pkt);
+  av_frame_free(&working_frame);
+
+  return frame;
+}
+
 FramePtr FFmpegDecoder::RetrieveAudio(const rational &timecode, const rational &length, const AudioRenderingParams &params)
 {
   QMutexLocker locker(&mutex_);
@@ -454,6 +563,10 @@ FramePtr FFmpegDecoder::RetrieveAudio(const rational &timecode, const rational &
 
 void FFmpegDecoder::Close()
 {
+  // The prefetch needs the mutex to notice it's been cancelled, so wait for it before taking it
+  CancelReversePrefetch();
+  prefetch_pool_.waitForDone();
+
   QMutexLocker locker(&mutex_);
 
   ClearResources();
@@ -923,6 +1036,12 @@ void FFmpegDecoder::ClearFrameCache()
   cached_frames_.clear();
   cache_at_eof_ = false;
   cache_at_zero_ = false;
+
+  // Whatever we're clearing for is about to move the decoder, which invalidates the prefetch too
+  CancelReversePrefetch();
+  reverse_prefetch_.clear();
+  prefetch_at_zero_ = false;
+  prefetch_owns_codec_ = false;
 }
 
 void FFmpegDecoder::ClearResources()
@@ -934,6 +1053,8 @@ void FFmpegDecoder::ClearResources()
 
   ClearFrameCache();
 
+  last_keyframe_ = nullptr;
+
   FreeScaler();
 
   if (codec_ctx_) {
@@ -982,6 +1103,180 @@ void FFmpegDecoder::ClearTimerEvent()
 {
   QMutexLocker locker(&mutex_);
 
+  if (playback_speed_ < 0) {
+    // In reverse the oldest frames are the ones that are about to be shown, the cache is bounded by
+    // kMaximumReverseFrames instead
+    return;
+  }
+
   cache_at_zero_ = false;
   cached_frames_.remove_old_frames(QDateTime::currentMSecsSinceEpoch() - clear_timer_.interval());
+
+  if (MemoryManager::IsOverBudget()) {
+    // Only keep the most recent frame, the rest goes back to the pool where it can be reclaimed
+    while (cached_frames_.size() > 1) {
+      cached_frames_.remove_first();
+    }
+  }
+}
+
+void FFmpegDecoder::SetPlaybackSpeed(int speed)
+{
+  playback_speed_ = speed;
+}
+
+bool FFmpegDecoder::IsReturningKeyframesOnly() const
+{
+  return qAbs(playback_speed_.load()) >= kKeyframeOnlySpeed;
+}
+
+Frame *FFmpegDecoder::FindInFrameCache(int64_t target_ts)
+{
+  if (cached_frames_.isEmpty()) {
+    return nullptr;
+  }
+
+  if (target_ts < cached_frames_.first()->native_timestamp()) {
+
+    if (cache_at_zero_) {
+      cached_frames_.accessedFirst();
+      return cached_frames_.first();
+    }
+
+  } else if (target_ts > cached_frames_.last()->native_timestamp()) {
+
+    if (cache_at_eof_) {
+      cached_frames_.accessedLast();
+      return cached_frames_.last();
+    }
+
+  } else {
+
+    // We already have this frame in the cache, find it
+    for (int i=0;i<cached_frames_.size();i++) {
+      Frame* this_frame = cached_frames_.at(i);
+
+      if (this_frame->native_timestamp() == target_ts // Test for an exact match
+          || (i < cached_frames_.size() - 1 && cached_frames_.at(i+1)->native_timestamp() > target_ts)) { // Or for this frame to be the "closest"
+
+        cached_frames_.accessed(i);
+        return this_frame;
+
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+Frame *FFmpegDecoder::AppendToFrameCache(FFmpegFrameCache::Client *cache, AVFrame *frame, const rational &timestamp)
+{
+  Frame* converted = cache->append(VideoRenderingParams(avstream_->codecpar->width / scale_divider_,
+                                                        avstream_->codecpar->height / scale_divider_,
+                                                        avstream_->time_base,
+                                                        native_pix_fmt_,
+                                                        RenderMode::kOffline));
+
+  converted->set_timestamp(timestamp);
+  converted->set_sample_aspect_ratio(av_guess_sample_aspect_ratio(fmt_ctx_, avstream_, nullptr));
+  converted->set_native_timestamp(frame->pts);
+
+  // Convert frame to RGBA for the rest of the pipeline
+  uint8_t* output_data = reinterpret_cast<uint8_t*>(converted->data());
+  int output_linesize = converted->width() * PixelFormat::ChannelCount(native_pix_fmt_) * PixelFormat::BytesPerChannel(native_pix_fmt_);
+
+  sws_scale(scale_ctx_,
+            frame->data,
+            frame->linesize,
+            0,
+            avstream_->codecpar->height,
+            &output_data,
+            &output_linesize);
+
+  return converted;
+}
+
+FramePtr FFmpegDecoder::CopyFrame(const Frame *frame)
+{
+  FramePtr copy = Frame::Create();
+  copy->set_width(frame->width());
+  copy->set_height(frame->height());
+  copy->set_format(frame->format());
+  copy->set_timestamp(frame->timestamp());
+  copy->set_sample_aspect_ratio(frame->sample_aspect_ratio());
+  copy->allocate();
+
+  memcpy(copy->data(), frame->const_data(), copy->allocated_size());
+
+  return copy;
+}
+
+void FFmpegDecoder::StartReversePrefetch()
+{
+  if (prefetch_pending_
+      || cache_at_zero_
+      || cached_frames_.isEmpty()
+      || !reverse_prefetch_.isEmpty()) {
+    return;
+  }
+
+  prefetch_pending_ = true;
+
+  prefetch_pool_.start(new ReversePrefetchTask(this,
+                                               prefetch_generation_.load(),
+                                               cached_frames_.first()->native_timestamp()));
+}
+
+void FFmpegDecoder::ReversePrefetch(int generation, int64_t stop_ts)
+{
+  AVPacket* pkt = av_packet_alloc();
+  AVFrame* working_frame = av_frame_alloc();
+
+  bool seeked = false;
+
+  forever {
+    // Only hold the lock for one frame at a time so that requests for frames we already have aren't held up
+    QMutexLocker locker(&mutex_);
+
+    if (!open_ || generation != prefetch_generation_.load()) {
+      break;
+    }
+
+    if (!seeked) {
+      // Seeking backwards from the frame before the cache lands on the keyframe of the GOP before it
+      Seek(stop_ts - 1);
+      prefetch_owns_codec_ = true;
+      seeked = true;
+    }
+
+    int ret = GetFrame(pkt, working_frame);
+
+    if (ret < 0 || working_frame->pts >= stop_ts) {
+      break;
+    }
+
+    if (reverse_prefetch_.isEmpty()) {
+      prefetch_at_zero_ = (working_frame->pts <= qMax(static_cast<int64_t>(0), avstream_->start_time));
+    }
+
+    AppendToFrameCache(&reverse_prefetch_,
+                       working_frame,
+                       Timecode::timestamp_to_time(working_frame->pts - avstream_->start_time, avstream_->time_base));
+
+    if (reverse_prefetch_.size() > kMaximumReverseFrames) {
+      reverse_prefetch_.remove_first();
+      prefetch_at_zero_ = false;
+    }
+  }
+
+  av_packet_free(&pkt);
+  av_frame_free(&working_frame);
+
+  QMutexLocker locker(&mutex_);
+  prefetch_pending_ = false;
+}
+
+void FFmpegDecoder::CancelReversePrefetch()
+{
+  prefetch_generation_.ref();
 }
@@ -28,6 +28,7 @@ extern "C" {
 }
 
 #include <QAtomicInt>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVector>
 
@@ -55,9 +56,14 @@ public:
   virtual bool Open() override;
   virtual RetrieveState GetRetrieveState(const rational &time) override;
   virtual FramePtr RetrieveVideo(const rational &timecode, const int& divider) override;
+  virtual FramePtr RetrieveKeyframe(const rational &timecode, const int& divider) override;
   virtual FramePtr RetrieveAudio(const rational &timecode, const rational &length, const AudioRenderingParams& params) override;
   virtual void Close() override;
 
+  virtual void SetPlaybackSpeed(int speed) override;
+
+  virtual bool IsReturningKeyframesOnly() const override;
+
   virtual QString id() override;
 
   virtual bool SupportsVideo() override;
@@ -109,6 +115,45 @@ private:
   void SetupScaler(const int& divider);
   void FreeScaler();
 
+  /**
+   * @brief Returns the cached frame that should be shown at this timestamp, or nullptr if it isn't cached
+   */
+  Frame* FindInFrameCache(int64_t target_ts);
+
+  /**
+   * @brief Convert a decoded frame with the current scaler and append it to a frame cache
+   */
+  Frame* AppendToFrameCache(FFmpegFrameCache::Client* cache, AVFrame* frame, const rational& timestamp);
+
+  static FramePtr CopyFrame(const Frame* frame);
+
+  /**
+   * @brief Decode the keyframe at or before this timestamp without decoding forward to the timestamp itself
+   *
+   * Assumes the mutex is locked and the scaler is set up.
+   */
+  FramePtr RetrieveKeyframeInternal(int64_t target_ts);
+
+  /**
+   * @brief Start decoding the GOP before the frame cache in the background (reverse playback only)
+   *
+   * Frames are decoded into reverse_prefetch_, which RetrieveVideo() takes over as the frame cache once playback
+   * reaches it. The prefetch holds the mutex for one frame at a time so cache hits aren't held up by it.
+   */
+  void StartReversePrefetch();
+
+  /**
+   * @brief Worker side of StartReversePrefetch()
+   */
+  void ReversePrefetch(int generation, int64_t stop_ts);
+
+  /**
+   * @brief Stop a running prefetch, it'll exit next time it takes the mutex
+   */
+  void CancelReversePrefetch();
+
+  class ReversePrefetchTask;
+
   AVFormatContext* fmt_ctx_;
   AVCodecContext* codec_ctx_;
   AVStream* avstream_;
@@ -125,6 +170,29 @@ private:
 
   int64_t second_ts_;
 
+  FramePtr last_keyframe_;
+  int64_t last_keyframe_ts_;
+
+  QAtomicInt playback_speed_;
+
+  FFmpegFrameCache::Client reverse_prefetch_;
+  bool prefetch_at_zero_;
+
+  /// The decoder's position belongs to reverse_prefetch_, so frame cache can't be extended without seeking first
+  bool prefetch_owns_codec_;
+
+  bool prefetch_pending_;
+
+  QAtomicInt prefetch_generation_;
+
+  QThreadPool prefetch_pool_;
+
+  /// Shuttle speed from which only keyframes are decoded
+  static const int kKeyframeOnlySpeed;
+
+  /// Upper bound on frames held per GOP during reverse playback, long-GOP UHD media would exhaust memory otherwise
+  static const int kMaximumReverseFrames;
+
   AVDictionary* opts_;
 
   QTimer clear_timer_;
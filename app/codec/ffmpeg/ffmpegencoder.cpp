@@ -1,22 +1,137 @@
 #include "ffmpegencoder.h"
 
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
 #include <QFile>
+#include <QThread>
+#include <QThreadPool>
 
+#include "common/timecodefunctions.h"
 #include "ffmpegcommon.h"
 #include "render/pixelformat.h"
 
+const int FFmpegEncoder::kMinimumSliceRows = 64;
+const int FFmpegEncoder::kSliceOverlapRows = 8;
+const int FFmpegEncoder::kVideoBufferAlignment = 32;
+
+class FFmpegEncoder::SliceTask : public QRunnable
+{
+public:
+  SliceTask(std::shared_ptr<VideoConversion> conversion) :
+    conversion_(conversion)
+  {
+  }
+
+  virtual void run() override
+  {
+    // If the encoder got through every slice before we started, this returns straight away
+    FFmpegEncoder::ProcessVideoSlices(conversion_.get());
+  }
+
+private:
+  std::shared_ptr<VideoConversion> conversion_;
+
+};
+
 FFmpegEncoder::FFmpegEncoder(const EncodingParams &params) :
   Encoder(params),
   fmt_ctx_(nullptr),
   video_stream_(nullptr),
   video_codec_ctx_(nullptr),
-  video_scale_ctx_(nullptr),
+  video_buffer_pool_(nullptr),
+  video_convert_frame_(nullptr),
+  video_encode_frame_(nullptr),
+  video_conversion_pending_(false),
+  packet_(nullptr),
   audio_stream_(nullptr),
   audio_codec_ctx_(nullptr),
   audio_resample_ctx_(nullptr)
 {
 }
 
+QList<rational> FFmpegEncoder::GetPassthroughSplicePoints(const PassthroughTarget &target,
+                                                          const QString &filename,
+                                                          int stream_index,
+                                                          const QAtomicInt *cancelled) const
+{
+  QList<rational> splice_points;
+
+  if (!target.is_valid()) {
+    return splice_points;
+  }
+
+  AVFormatContext* src_ctx = OpenPassthroughSource(filename, stream_index);
+
+  if (!src_ctx) {
+    return splice_points;
+  }
+
+  AVStream* src_stream = src_ctx->streams[stream_index];
+  AVCodecParameters* src_par = src_stream->codecpar;
+
+  // Codecs that do have global headers must have identical ones, or copied packets would be decoded with the wrong
+  // parameters
+  bool compatible = src_par->codec_type == AVMEDIA_TYPE_VIDEO
+      && src_par->codec_id == target.codec_id
+      && src_par->width == target.width
+      && src_par->height == target.height
+      && src_par->format == target.pixel_format
+      && av_cmp_q(src_stream->avg_frame_rate, av_inv_q(target.time_base.toAVRational())) == 0
+      && (target.extradata.isEmpty()
+          || QByteArray::fromRawData(reinterpret_cast<const char*>(src_par->extradata),
+                                     src_par->extradata_size) == target.extradata);
+
+  // Every packet of an intra-only stream can be cut at. Long-GOP streams would need the partial GOPs at each edit
+  // re-encoded to splice without breaking references or DTS ordering, so they're never passed through.
+  const AVCodecDescriptor* descriptor = avcodec_descriptor_get(src_par->codec_id);
+
+  compatible = compatible && descriptor && (descriptor->props & AV_CODEC_PROP_INTRA_ONLY);
+
+  if (compatible) {
+    int64_t start_time = (src_stream->start_time == AV_NOPTS_VALUE) ? 0 : src_stream->start_time;
+    int64_t end_ts = 0;
+
+    AVPacket* pkt = av_packet_alloc();
+
+    while (av_read_frame(src_ctx, pkt) >= 0) {
+      if (cancelled && *cancelled) {
+        av_packet_unref(pkt);
+        compatible = false;
+        splice_points.clear();
+        break;
+      }
+
+      if (pkt->stream_index == stream_index) {
+        int64_t ts = (pkt->pts == AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+
+        if (pkt->flags & AV_PKT_FLAG_KEY) {
+          splice_points.append(Timecode::timestamp_to_time(ts - start_time, src_stream->time_base));
+        }
+
+        end_ts = qMax(end_ts, ts + pkt->duration);
+      }
+
+      av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+
+    if (compatible) {
+      // The end of the stream is also a valid place to stop copying
+      splice_points.append(Timecode::timestamp_to_time(end_ts - start_time, src_stream->time_base));
+
+      std::sort(splice_points.begin(), splice_points.end());
+    }
+  }
+
+  avformat_close_input(&src_ctx);
+
+  return splice_points;
+}
+
 void FFmpegEncoder::WriteAudio(const AudioRenderingParams &pcm_info, const QString &pcm_filename)
 {
   QFile pcm(pcm_filename);
@@ -110,12 +225,25 @@ bool FFmpegEncoder::OpenInternal()
     return false;
   }
 
+  packet_ = av_packet_alloc();
+
   // Initialize a video stream if it's enabled
   if (params().video_enabled()) {
     if (!InitializeStream(AVMEDIA_TYPE_VIDEO, &video_stream_, &video_codec_ctx_, params().video_codec())) {
       return false;
     }
 
+    // Passthrough scans run on other threads while we may reopen the codec, so they get a copy of what they need
+    PassthroughTarget target;
+    target.codec_id = video_codec_ctx_->codec_id;
+    target.width = video_codec_ctx_->width;
+    target.height = video_codec_ctx_->height;
+    target.pixel_format = video_codec_ctx_->pix_fmt;
+    target.time_base = rational(video_codec_ctx_->time_base);
+    target.extradata = QByteArray(reinterpret_cast<const char*>(video_codec_ctx_->extradata),
+                                  video_codec_ctx_->extradata_size);
+    SetPassthroughTarget(target);
+
     // This is the format we will expect frames received in Write() to be in
     PixelFormat::Format native_pixel_fmt = params().video_params().format();
 
@@ -128,18 +256,21 @@ bool FFmpegEncoder::OpenInternal()
     // This is the pixel format the encoder wants to encode to
     AVPixelFormat encoder_pix_fmt = video_codec_ctx_->pix_fmt;
 
-    // Set up a scaling context - if the native pixel format is not equal to the encoder's, we'll need to convert it
+    // Set up scaling contexts - if the native pixel format is not equal to the encoder's, we'll need to convert it
     // before encoding. Even if we don't, this may be useful for converting between linesizes, etc.
-    video_scale_ctx_ = sws_getContext(params().video_params().width(),
-                                      params().video_params().height(),
-                                      src_pix_fmt,
-                                      params().video_params().width(),
-                                      params().video_params().height(),
-                                      encoder_pix_fmt,
-                                      0,
-                                      nullptr,
-                                      nullptr,
-                                      nullptr);
+    if (!SetupVideoSlices(src_pix_fmt, encoder_pix_fmt)) {
+      return false;
+    }
+
+    // Frames are converted into buffers from this pool, which they return to once the encoder is done with them
+    video_buffer_pool_ = av_buffer_pool_init(av_image_get_buffer_size(encoder_pix_fmt,
+                                                                      video_codec_ctx_->width,
+                                                                      video_codec_ctx_->height,
+                                                                      kVideoBufferAlignment),
+                                             nullptr);
+
+    video_convert_frame_ = av_frame_alloc();
+    video_encode_frame_ = av_frame_alloc();
   }
 
   // Initialize an audio stream if it's enabled
@@ -169,49 +300,377 @@ bool FFmpegEncoder::OpenInternal()
 
 void FFmpegEncoder::WriteInternal(FramePtr frame)
 {
-  AVFrame* encoded_frame = av_frame_alloc();
+  if (frame->width() != video_codec_ctx_->width || frame->height() != video_codec_ctx_->height) {
+    Error(QStringLiteral("Received a frame with different dimensions to the encoder"));
+    return;
+  }
 
-  int error_code;
-  const char* input_data;
-  int input_linesize;
+  // Slices can't be reused until they're done with the last frame
+  if (!WaitForVideoConversion()) {
+    Error(QStringLiteral("Failed to convert frame for %1").arg(params().filename()));
+    return;
+  }
 
-  // Frame must be video
-  encoded_frame->width = frame->width();
-  encoded_frame->height = frame->height();
-  encoded_frame->format = video_codec_ctx_->pix_fmt;
+  bool encode_previous = video_conversion_pending_;
 
-  error_code = av_frame_get_buffer(encoded_frame, 0);
-  if (error_code < 0) {
-    FFmpegError("Failed to create AVFrame buffer", error_code);
-    goto fail;
+  if (encode_previous) {
+    std::swap(video_convert_frame_, video_encode_frame_);
+    video_conversion_pending_ = false;
   }
 
-  // We may need to convert this frame to a frame that swscale will understand
-  if (frame->format() != video_conversion_fmt_) {
-    frame = PixelFormat::ConvertPixelFormat(frame, video_conversion_fmt_);
+  if (!StartVideoConversion(frame)) {
+    return;
   }
 
-  // Use swscale context to convert formats/linesizes
-  input_data = frame->const_data();
-  input_linesize = frame->width() * PixelFormat::BytesPerPixel(video_conversion_fmt_);
-  error_code = sws_scale(video_scale_ctx_,
-                         reinterpret_cast<const uint8_t**>(&input_data),
-                         &input_linesize,
-                         0,
-                         frame->height(),
-                         encoded_frame->data,
-                         encoded_frame->linesize);
-  if (error_code < 0) {
-    FFmpegError("Failed to scale frame", error_code);
-    goto fail;
+  if (encode_previous) {
+    WriteAVFrame(video_encode_frame_, video_codec_ctx_, video_stream_);
+
+    // Drop our reference, the buffer goes back to the pool once the encoder has let go of it too. If encoding failed,
+    // Error() will have already freed the frame.
+    if (video_encode_frame_) {
+      av_frame_unref(video_encode_frame_);
+    }
   }
+}
+
+bool FFmpegEncoder::SetupVideoSlices(AVPixelFormat src_pix_fmt, AVPixelFormat encoder_pix_fmt)
+{
+  int width = params().video_params().width();
+  int height = params().video_params().height();
+
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(encoder_pix_fmt);
+
+  int slice_count;
+
+  if (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM)) {
+    // Rows of these formats can't be written independently
+    slice_count = 1;
+  } else {
+    slice_count = qBound(1, QThread::idealThreadCount(), height / kMinimumSliceRows);
+  }
+
+  // Every band but the last must cover whole chroma rows so that subsampled planes line up
+  int row_alignment = 1 << desc->log2_chroma_h;
+  int rows_per_slice = (height / slice_count + row_alignment - 1) / row_alignment * row_alignment;
 
-  encoded_frame->pts = qRound(frame->timestamp().toDouble() / av_q2d(video_codec_ctx_->time_base));
+  // Vertically subsampled chroma is filtered across rows, so bands overlap to keep seams out of it
+  int overlap = desc->log2_chroma_h ? kSliceOverlapRows : 0;
 
-  WriteAVFrame(encoded_frame, video_codec_ctx_, video_stream_);
+  for (int first_row=0;first_row<height;first_row+=rows_per_slice) {
+    VideoSlice slice;
 
-fail:
-  av_frame_free(&encoded_frame);
+    slice.first_row = first_row;
+    slice.row_count = qMin(rows_per_slice, height - first_row);
+    slice.src_first_row = qMax(0, first_row - overlap);
+    slice.src_row_count = qMin(height, first_row + slice.row_count + overlap) - slice.src_first_row;
+
+    if (slice.src_row_count != slice.row_count) {
+      slice.overlap.resize(av_image_get_buffer_size(encoder_pix_fmt, width, slice.src_row_count, 1));
+    }
+
+    slice.scale_ctx = sws_getContext(width,
+                                     slice.src_row_count,
+                                     src_pix_fmt,
+                                     width,
+                                     slice.src_row_count,
+                                     encoder_pix_fmt,
+                                     0,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr);
+
+    if (!slice.scale_ctx) {
+      Error(QStringLiteral("Failed to create scaling context for %1").arg(params().filename()));
+      return false;
+    }
+
+    video_slices_.append(slice);
+  }
+
+  return true;
+}
+
+bool FFmpegEncoder::GetPooledVideoFrame(AVFrame *dest)
+{
+  dest->buf[0] = av_buffer_pool_get(video_buffer_pool_);
+
+  if (!dest->buf[0]) {
+    return false;
+  }
+
+  dest->width = video_codec_ctx_->width;
+  dest->height = video_codec_ctx_->height;
+  dest->format = video_codec_ctx_->pix_fmt;
+
+  return av_image_fill_arrays(dest->data,
+                              dest->linesize,
+                              dest->buf[0]->data,
+                              video_codec_ctx_->pix_fmt,
+                              dest->width,
+                              dest->height,
+                              kVideoBufferAlignment) >= 0;
+}
+
+bool FFmpegEncoder::StartVideoConversion(FramePtr frame)
+{
+  if (!GetPooledVideoFrame(video_convert_frame_)) {
+    Error(QStringLiteral("Failed to create AVFrame buffer for %1").arg(params().filename()));
+    return false;
+  }
+
+  video_convert_frame_->pts = qRound(frame->timestamp().toDouble() / av_q2d(video_codec_ctx_->time_base));
+
+  if (frame->yuv_params().is_valid()) {
+    // The frame was already converted to our pixel format on the GPU, so this is just a copy
+    if (frame->yuv_params() != GetNativeYUVParams()) {
+      Error(QStringLiteral("Received a planar frame in a layout this encoder doesn't use"));
+      return false;
+    }
+
+    CopyPlanesToAVFrame(frame, video_convert_frame_);
+  } else {
+    // Keep the frame alive until every slice has read from it
+    video_convert_source_ = frame;
+
+    video_conversion_ = std::make_shared<VideoConversion>();
+    video_conversion_->encoder = this;
+    video_conversion_->slice_count = video_slices_.size();
+
+    // We encode the previous frame in the meantime and pick up what's left in WaitForVideoConversion()
+    int helper_count = qMin(video_slices_.size(), QThreadPool::globalInstance()->maxThreadCount());
+
+    for (int i=0;i<helper_count;i++) {
+      QThreadPool::globalInstance()->start(new SliceTask(video_conversion_));
+    }
+  }
+
+  video_conversion_pending_ = true;
+
+  return true;
+}
+
+void FFmpegEncoder::ConvertVideoSlice(int index)
+{
+  VideoSlice& slice = video_slices_[index];
+
+  int width = video_convert_source_->width();
+  PixelFormat::Format src_format = video_convert_source_->format();
+
+  const char* src_data = video_convert_source_->const_data()
+      + slice.src_first_row * width * PixelFormat::BytesPerPixel(src_format);
+
+  // We may need to convert these rows to a format that swscale will understand
+  if (src_format != video_conversion_fmt_) {
+    int scratch_size = PixelFormat::GetBufferSize(video_conversion_fmt_, width, slice.src_row_count);
+
+    if (slice.scratch.size() < scratch_size) {
+      slice.scratch.resize(scratch_size);
+    }
+
+    if (!PixelFormat::ConvertPixels(src_data, src_format,
+                                    slice.scratch.data(), video_conversion_fmt_,
+                                    width, slice.src_row_count)) {
+      video_slice_errors_.ref();
+      return;
+    }
+
+    src_data = slice.scratch.constData();
+  }
+
+  const uint8_t* src_planes[4] = {reinterpret_cast<const uint8_t*>(src_data), nullptr, nullptr, nullptr};
+  int src_linesizes[4] = {width * PixelFormat::BytesPerPixel(video_conversion_fmt_), 0, 0, 0};
+
+  AVPixelFormat dst_format = static_cast<AVPixelFormat>(video_convert_frame_->format);
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(dst_format);
+  uint8_t* dst_planes[4];
+  int overlap_linesizes[4];
+
+  if (slice.overlap.isEmpty()) {
+    // Offset each plane to this band's first row, chroma planes may be vertically subsampled
+    for (int i=0;i<4;i++) {
+      int row_shift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+
+      if (video_convert_frame_->data[i]) {
+        dst_planes[i] = video_convert_frame_->data[i] + (slice.first_row >> row_shift) * video_convert_frame_->linesize[i];
+      } else {
+        dst_planes[i] = nullptr;
+      }
+    }
+  } else if (av_image_fill_arrays(dst_planes,
+                                  overlap_linesizes,
+                                  reinterpret_cast<uint8_t*>(slice.overlap.data()),
+                                  dst_format,
+                                  width,
+                                  slice.src_row_count,
+                                  1) < 0) {
+    video_slice_errors_.ref();
+    return;
+  }
+
+  if (sws_scale(slice.scale_ctx,
+                src_planes,
+                src_linesizes,
+                0,
+                slice.src_row_count,
+                dst_planes,
+                slice.overlap.isEmpty() ? video_convert_frame_->linesize : overlap_linesizes) < 0) {
+    video_slice_errors_.ref();
+    return;
+  }
+
+  if (!slice.overlap.isEmpty()) {
+    // Keep only this band's own rows, the overlap was just there to give the chroma filter context
+    for (int i=0;i<4 && video_convert_frame_->data[i];i++) {
+      int row_shift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+
+      // Round up like the chroma planes do, only the last band can end on a partial chroma row
+      int band_end = AV_CEIL_RSHIFT(slice.first_row + slice.row_count, row_shift);
+      int band_start = slice.first_row >> row_shift;
+      int overlap_start = slice.src_first_row >> row_shift;
+
+      av_image_copy_plane(video_convert_frame_->data[i] + band_start * video_convert_frame_->linesize[i],
+                          video_convert_frame_->linesize[i],
+                          dst_planes[i] + (band_start - overlap_start) * overlap_linesizes[i],
+                          overlap_linesizes[i],
+                          overlap_linesizes[i],
+                          band_end - band_start);
+    }
+  }
+}
+
+void FFmpegEncoder::ProcessVideoSlices(VideoConversion *conversion)
+{
+  forever {
+    int index = conversion->next_slice.fetchAndAddOrdered(1);
+
+    if (index >= conversion->slice_count) {
+      break;
+    }
+
+    // The encoder can't have been destroyed while a slice is unfinished, it waits for all of them
+    conversion->encoder->ConvertVideoSlice(index);
+    conversion->slices_done.release();
+  }
+}
+
+bool FFmpegEncoder::WaitForVideoConversion()
+{
+  if (video_conversion_) {
+    ProcessVideoSlices(video_conversion_.get());
+
+    video_conversion_->slices_done.acquire(video_conversion_->slice_count);
+    video_conversion_ = nullptr;
+  }
+
+  return video_slice_errors_.fetchAndStoreRelaxed(0) == 0;
+}
+
+YUVParams FFmpegEncoder::GetNativeYUVParams() const
+{
+  if (!video_codec_ctx_) {
+    return YUVParams();
+  }
+
+  switch (video_codec_ctx_->pix_fmt) {
+  case AV_PIX_FMT_YUV420P:
+    return YUVParams(YUVParams::kChroma420, 8);
+  case AV_PIX_FMT_YUV422P:
+    return YUVParams(YUVParams::kChroma422, 8);
+  case AV_PIX_FMT_YUV444P:
+    return YUVParams(YUVParams::kChroma444, 8);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  case AV_PIX_FMT_YUV420P10LE:
+    return YUVParams(YUVParams::kChroma420, 10);
+  case AV_PIX_FMT_YUV422P10LE:
+    return YUVParams(YUVParams::kChroma422, 10);
+  case AV_PIX_FMT_YUV444P10LE:
+    return YUVParams(YUVParams::kChroma444, 10);
+#endif
+  default:
+    // Anything else (packed, semi-planar, RGB, etc.) is still converted by swscale
+    return YUVParams();
+  }
+}
+
+void FFmpegEncoder::CopyPlanesToAVFrame(FramePtr frame, AVFrame *dest)
+{
+  const YUVParams& yuv = frame->yuv_params();
+
+  for (int i=0;i<YUVParams::kPlaneCount;i++) {
+    av_image_copy_plane(dest->data[i],
+                        dest->linesize[i],
+                        reinterpret_cast<const uint8_t*>(frame->const_data() + yuv.plane_offset(i, frame->width(), frame->height())),
+                        yuv.plane_linesize(i, frame->width()),
+                        yuv.plane_linesize(i, frame->width()),
+                        yuv.plane_height(i, frame->height()));
+  }
+}
+
+void FFmpegEncoder::WritePassthroughInternal(const QString &filename,
+                                             int stream_index,
+                                             const rational &source_in,
+                                             const rational &source_out,
+                                             const rational &dest_in)
+{
+  AVFormatContext* src_ctx = OpenPassthroughSource(filename, stream_index);
+
+  if (!src_ctx) {
+    Error(QStringLiteral("Failed to open %1 for passthrough").arg(filename));
+    return;
+  }
+
+  // Anything still buffered in the encoder comes before the packets we're about to copy
+  FlushEncoders();
+
+  AVStream* src_stream = src_ctx->streams[stream_index];
+
+  int64_t start_time = (src_stream->start_time == AV_NOPTS_VALUE) ? 0 : src_stream->start_time;
+  int64_t in_ts = Timecode::time_to_timestamp(source_in, src_stream->time_base) + start_time;
+  int64_t out_ts = Timecode::time_to_timestamp(source_out, src_stream->time_base) + start_time;
+  int64_t dest_offset = Timecode::time_to_timestamp(dest_in, video_stream_->time_base);
+
+  av_seek_frame(src_ctx, stream_index, in_ts, AVSEEK_FLAG_BACKWARD);
+
+  AVPacket* pkt = av_packet_alloc();
+
+  while (av_read_frame(src_ctx, pkt) >= 0) {
+    if (pkt->stream_index == stream_index) {
+      int64_t ts = (pkt->pts == AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+
+      // Streams we pass through don't reorder frames, so we can stop as soon as we reach the end
+      if (ts >= out_ts) {
+        av_packet_unref(pkt);
+        break;
+      }
+
+      if (ts >= in_ts) {
+        if (pkt->pts != AV_NOPTS_VALUE) {
+          pkt->pts = av_rescale_q(pkt->pts - in_ts, src_stream->time_base, video_stream_->time_base) + dest_offset;
+        }
+
+        if (pkt->dts != AV_NOPTS_VALUE) {
+          pkt->dts = av_rescale_q(pkt->dts - in_ts, src_stream->time_base, video_stream_->time_base) + dest_offset;
+        }
+
+        pkt->duration = av_rescale_q(pkt->duration, src_stream->time_base, video_stream_->time_base);
+        pkt->stream_index = video_stream_->index;
+        pkt->pos = -1;
+
+        av_interleaved_write_frame(fmt_ctx_, pkt);
+      }
+    }
+
+    av_packet_unref(pkt);
+  }
+
+  av_packet_free(&pkt);
+
+  avformat_close_input(&src_ctx);
+
+  // The encoder was flushed, so it needs to be re-created for any frames that follow
+  if (!ReopenVideoEncoder()) {
+    Error(QStringLiteral("Failed to reopen video encoder after passthrough"));
+  }
 }
 
 void FFmpegEncoder::CloseInternal()
@@ -225,10 +684,24 @@ void FFmpegEncoder::CloseInternal()
     avio_closep(&fmt_ctx_->pb);
   }
 
-  if (video_scale_ctx_) {
-    sws_freeContext(video_scale_ctx_);
-    video_scale_ctx_ = nullptr;
+  // If we're closing because of an error, slices may still be working on a frame
+  WaitForVideoConversion();
+
+  foreach (const VideoSlice& slice, video_slices_) {
+    sws_freeContext(slice.scale_ctx);
   }
+  video_slices_.clear();
+
+  video_convert_source_ = nullptr;
+  video_conversion_pending_ = false;
+
+  av_frame_free(&video_convert_frame_);
+  av_frame_free(&video_encode_frame_);
+
+  // Buffers still referenced elsewhere keep the pool alive until they're released
+  av_buffer_pool_uninit(&video_buffer_pool_);
+
+  av_packet_free(&packet_);
 
   if (video_codec_ctx_) {
     avcodec_free_context(&video_codec_ctx_);
@@ -267,34 +740,29 @@ void FFmpegEncoder::WriteAVFrame(AVFrame *frame, AVCodecContext* codec_ctx, AVSt
     return;
   }
 
-  AVPacket* pkt = av_packet_alloc();
-
   // Retrieve packets from encoder
   while (error_code >= 0) {
-    error_code = avcodec_receive_packet(codec_ctx, pkt);
+    error_code = avcodec_receive_packet(codec_ctx, packet_);
 
     // EAGAIN just means the encoder wants another frame before encoding
     if (error_code == AVERROR(EAGAIN)) {
       break;
     } else if (error_code < 0) {
       FFmpegError("Failed to receive packet from decoder", error_code);
-      goto fail;
+      return;
     }
 
     // Set packet stream index
-    pkt->stream_index = stream->index;
+    packet_->stream_index = stream->index;
 
-    av_packet_rescale_ts(pkt, codec_ctx->time_base, stream->time_base);
+    av_packet_rescale_ts(packet_, codec_ctx->time_base, stream->time_base);
 
     // Write packet to file
-    av_interleaved_write_frame(fmt_ctx_, pkt);
+    av_interleaved_write_frame(fmt_ctx_, packet_);
 
     // Unref packet in case we're getting another
-    av_packet_unref(pkt);
+    av_packet_unref(packet_);
   }
-
-fail:
-  av_packet_free(&pkt);
 }
 
 bool FFmpegEncoder::InitializeStream(AVMediaType type, AVStream** stream_ptr, AVCodecContext** codec_ctx_ptr, const QString& codec)
@@ -330,35 +798,7 @@ bool FFmpegEncoder::InitializeStream(AVMediaType type, AVStream** stream_ptr, AV
   AVStream* stream = *stream_ptr;
 
   if (type == AVMEDIA_TYPE_VIDEO) {
-    codec_ctx->width = params().video_params().width();
-    codec_ctx->height = params().video_params().height();
-    codec_ctx->sample_aspect_ratio = {1, 1};
-    codec_ctx->time_base = params().video_params().time_base().toAVRational();
-
-    // FIXME: Make this customizable again
-    codec_ctx->pix_fmt = encoder->pix_fmts[0];
-
-    // Set custom options
-    {
-      QHash<QString, QString>::const_iterator i;
-
-      for (i=params().video_opts().begin();i!=params().video_opts().end();i++) {
-        av_opt_set(video_codec_ctx_->priv_data, i.key().toUtf8(), i.value().toUtf8(), AV_OPT_SEARCH_CHILDREN);
-      }
-
-      if (params().video_bit_rate() > 0) {
-        video_codec_ctx_->bit_rate = params().video_bit_rate();
-      }
-
-      if (params().video_max_bit_rate() > 0) {
-        video_codec_ctx_->rc_max_rate = params().video_max_bit_rate();
-      }
-
-      if (params().video_buffer_size() > 0) {
-        video_codec_ctx_->rc_buffer_size = params().video_buffer_size();
-      }
-    }
-
+    SetVideoCodecParameters(codec_ctx, encoder);
   } else {
     codec_ctx->sample_rate = params().audio_params().sample_rate();
     codec_ctx->channel_layout = params().audio_params().channel_layout();
@@ -396,6 +836,22 @@ bool FFmpegEncoder::SetupCodecContext(AVStream* stream, AVCodecContext* codec_ct
 {
   int error_code;
 
+  if (!OpenCodecContext(codec_ctx, codec)) {
+    return false;
+  }
+
+  // Copy context settings to codecpar object
+  error_code = avcodec_parameters_from_context(stream->codecpar, codec_ctx);
+  if (error_code < 0) {
+    FFmpegError("Failed to copy codec parameters to stream", error_code);
+    return false;
+  }
+
+  return true;
+}
+
+bool FFmpegEncoder::OpenCodecContext(AVCodecContext *codec_ctx, AVCodec *codec)
+{
   if (fmt_ctx_->oformat->flags & AVFMT_GLOBALHEADER) {
     codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
   }
@@ -404,43 +860,128 @@ bool FFmpegEncoder::SetupCodecContext(AVStream* stream, AVCodecContext* codec_ct
   av_dict_set(&codec_opts, "threads", "auto", 0);
 
   // Try to open encoder
-  error_code = avcodec_open2(codec_ctx, codec, &codec_opts);
+  int error_code = avcodec_open2(codec_ctx, codec, &codec_opts);
+  av_dict_free(&codec_opts);
+
   if (error_code < 0) {
     FFmpegError("Failed to open encoder", error_code);
     return false;
   }
 
-  // Copy context settings to codecpar object
-  error_code = avcodec_parameters_from_context(stream->codecpar, codec_ctx);
-  if (error_code < 0) {
-    FFmpegError("Failed to copy codec parameters to stream", error_code);
+  return true;
+}
+
+void FFmpegEncoder::SetVideoCodecParameters(AVCodecContext *codec_ctx, AVCodec *codec)
+{
+  codec_ctx->width = params().video_params().width();
+  codec_ctx->height = params().video_params().height();
+  codec_ctx->sample_aspect_ratio = {1, 1};
+  codec_ctx->time_base = params().video_params().time_base().toAVRational();
+
+  // FIXME: Make this customizable again
+  codec_ctx->pix_fmt = codec->pix_fmts[0];
+
+  // Set custom options
+  QHash<QString, QString>::const_iterator i;
+
+  for (i=params().video_opts().begin();i!=params().video_opts().end();i++) {
+    av_opt_set(codec_ctx->priv_data, i.key().toUtf8(), i.value().toUtf8(), AV_OPT_SEARCH_CHILDREN);
+  }
+
+  if (params().video_bit_rate() > 0) {
+    codec_ctx->bit_rate = params().video_bit_rate();
+  }
+
+  if (params().video_max_bit_rate() > 0) {
+    codec_ctx->rc_max_rate = params().video_max_bit_rate();
+  }
+
+  if (params().video_buffer_size() > 0) {
+    codec_ctx->rc_buffer_size = params().video_buffer_size();
+  }
+}
+
+AVFormatContext *FFmpegEncoder::OpenPassthroughSource(const QString &filename, int stream_index)
+{
+  AVFormatContext* src_ctx = nullptr;
+
+  QByteArray filename_bytes = filename.toUtf8();
+
+  if (avformat_open_input(&src_ctx, filename_bytes.constData(), nullptr, nullptr) < 0) {
+    return nullptr;
+  }
+
+  if (avformat_find_stream_info(src_ctx, nullptr) < 0
+      || stream_index < 0
+      || stream_index >= static_cast<int>(src_ctx->nb_streams)) {
+    avformat_close_input(&src_ctx);
+    return nullptr;
+  }
+
+  // We only care about one stream, let the demuxer skip the rest
+  for (unsigned int i=0;i<src_ctx->nb_streams;i++) {
+    if (static_cast<int>(i) != stream_index) {
+      src_ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+  }
+
+  return src_ctx;
+}
+
+bool FFmpegEncoder::ReopenVideoEncoder()
+{
+  AVCodec* codec = avcodec_find_encoder_by_name(params().video_codec().toUtf8().constData());
+
+  if (!codec) {
     return false;
   }
 
-  return true;
+  avcodec_free_context(&video_codec_ctx_);
+
+  video_codec_ctx_ = avcodec_alloc_context3(codec);
+
+  if (!video_codec_ctx_) {
+    return false;
+  }
+
+  SetVideoCodecParameters(video_codec_ctx_, codec);
+
+  return OpenCodecContext(video_codec_ctx_, codec);
 }
 
 void FFmpegEncoder::FlushEncoders()
 {
   if (video_codec_ctx_) {
-    avcodec_send_frame(video_codec_ctx_, nullptr);
-    AVPacket* pkt = av_packet_alloc();
+    // Frames are encoded one behind their conversion, so the last one still has to go in before the flush
+    QVector<AVFrame*> frames;
 
-    int error_code;
-    do {
-      error_code = avcodec_receive_packet(video_codec_ctx_, pkt);
+    if (WaitForVideoConversion() && video_conversion_pending_) {
+      frames.append(video_convert_frame_);
+    }
 
-      if (error_code < 0) {
-        break;
-      }
+    frames.append(nullptr);
 
-      pkt->stream_index = video_stream_->index;
-      av_packet_rescale_ts(pkt, video_codec_ctx_->time_base, video_stream_->time_base);
-      av_interleaved_write_frame(fmt_ctx_, pkt);
-      av_packet_unref(pkt);
-    } while (error_code >= 0);
+    foreach (AVFrame* frame, frames) {
+      avcodec_send_frame(video_codec_ctx_, frame);
 
-    av_packet_free(&pkt);
+      int error_code;
+      do {
+        error_code = avcodec_receive_packet(video_codec_ctx_, packet_);
+
+        if (error_code < 0) {
+          break;
+        }
+
+        packet_->stream_index = video_stream_->index;
+        av_packet_rescale_ts(packet_, video_codec_ctx_->time_base, video_stream_->time_base);
+        av_interleaved_write_frame(fmt_ctx_, packet_);
+        av_packet_unref(packet_);
+      } while (error_code >= 0);
+    }
+
+    av_frame_unref(video_convert_frame_);
+    video_convert_source_ = nullptr;
+    video_conversion_pending_ = false;
   }
 }
 
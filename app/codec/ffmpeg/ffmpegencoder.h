@@ -3,11 +3,18 @@
 
 extern "C" {
 #include <libavformat/avformat.h>
+#include <libavutil/buffer.h>
+#include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
 #include <libswresample/swresample.h>
 #include <libavutil/opt.h>
 }
 
+#include <memory>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QVector>
+
 #include "codec/encoder.h"
 
 class FFmpegEncoder : public Encoder
@@ -16,12 +23,24 @@ class FFmpegEncoder : public Encoder
 public:
   FFmpegEncoder(const EncodingParams &params);
 
+  virtual QList<rational> GetPassthroughSplicePoints(const PassthroughTarget& target,
+                                                     const QString& filename,
+                                                     int stream_index,
+                                                     const QAtomicInt* cancelled = nullptr) const override;
+
+  virtual YUVParams GetNativeYUVParams() const override;
+
 public slots:
   virtual void WriteAudio(const AudioRenderingParams& pcm_info, const QString& pcm_filename) override;
 
 protected:
   virtual bool OpenInternal() override;
   virtual void WriteInternal(FramePtr frame) override;
+  virtual void WritePassthroughInternal(const QString& filename,
+                                        int stream_index,
+                                        const rational& source_in,
+                                        const rational& source_out,
+                                        const rational& dest_in) override;
   virtual void CloseInternal() override;
 
 private:
@@ -46,19 +65,130 @@ private:
 
   void WriteAVFrame(AVFrame* frame, AVCodecContext *codec_ctx, AVStream *stream);
 
+  /**
+   * @brief Set up one conversion slice per band of rows so that a frame can be converted on several threads
+   */
+  bool SetupVideoSlices(AVPixelFormat src_pix_fmt, AVPixelFormat encoder_pix_fmt);
+
+  /**
+   * @brief Point an (unreferenced) AVFrame at a buffer from our pool, sized for the video encoder
+   */
+  bool GetPooledVideoFrame(AVFrame* dest);
+
+  /**
+   * @brief Start converting `frame` into video_convert_frame_, returning before the conversion has finished
+   *
+   * Frames are encoded one behind their conversion, so converting a frame overlaps with encoding the one before it.
+   */
+  bool StartVideoConversion(FramePtr frame);
+
+  /**
+   * @brief Convert one band of rows of video_convert_source_ into video_convert_frame_
+   */
+  void ConvertVideoSlice(int index);
+
+  /**
+   * @brief Finish converting the current frame, returning false if any of its slices failed
+   *
+   * The calling thread converts any slices the thread pool hasn't picked up yet itself, so a busy pool doesn't leave
+   * it waiting with nothing to do.
+   */
+  bool WaitForVideoConversion();
+
+  /**
+   * @brief Copy a frame that was already converted to our native planar layout into an AVFrame's planes
+   */
+  static void CopyPlanesToAVFrame(FramePtr frame, AVFrame* dest);
+
   bool InitializeStream(enum AVMediaType type, AVStream** stream, AVCodecContext** codec_ctx, const QString& codec);
   bool InitializeCodecContext(AVStream** stream, AVCodecContext** codec_ctx, AVCodec* codec);
   bool SetupCodecContext(AVStream *stream, AVCodecContext *codec_ctx, AVCodec *codec);
+  bool OpenCodecContext(AVCodecContext *codec_ctx, AVCodec *codec);
+  void SetVideoCodecParameters(AVCodecContext *codec_ctx, AVCodec *codec);
+
+  /**
+   * @brief Open a source file for passthrough, discarding every stream except `stream_index`
+   */
+  static AVFormatContext* OpenPassthroughSource(const QString& filename, int stream_index);
+
+  /**
+   * @brief Re-create the video encoder after it's been flushed so that it can accept frames again
+   */
+  bool ReopenVideoEncoder();
 
   void FlushEncoders();
 
   AVFormatContext* fmt_ctx_;
 
+  class SliceTask;
+
+  struct VideoSlice {
+    SwsContext* scale_ctx;
+    int first_row;
+    int row_count;
+
+    // Rows that are converted for this band, including any overlap with its neighbours
+    int src_first_row;
+    int src_row_count;
+
+    // Holds this slice's rows in video_conversion_fmt_ if the frame arrives in a format swscale doesn't understand
+    QByteArray scratch;
+
+    // Holds the converted overlapping rows before this band's own are copied out of them
+    QByteArray overlap;
+  };
+
+  /**
+   * @brief Slices of the frame being converted that are still to be claimed or finished
+   *
+   * Shared with the slice tasks, which may not start until the caller has already converted every slice itself.
+   */
+  struct VideoConversion {
+    FFmpegEncoder* encoder;
+    int slice_count;
+    QAtomicInt next_slice;
+    QSemaphore slices_done;
+  };
+
+  /**
+   * @brief Claim and convert slices until there are none left, called from both the thread pool and the encoder
+   */
+  static void ProcessVideoSlices(VideoConversion* conversion);
+
   AVStream* video_stream_;
   AVCodecContext* video_codec_ctx_;
-  SwsContext* video_scale_ctx_;
   PixelFormat::Format video_conversion_fmt_;
 
+  QVector<VideoSlice> video_slices_;
+  std::shared_ptr<VideoConversion> video_conversion_;
+  QAtomicInt video_slice_errors_;
+
+  AVBufferPool* video_buffer_pool_;
+  AVFrame* video_convert_frame_;
+  AVFrame* video_encode_frame_;
+  FramePtr video_convert_source_;
+  bool video_conversion_pending_;
+
+  /**
+   * @brief Packet reused for everything we receive from the encoders
+   */
+  AVPacket* packet_;
+
+  /**
+   * @brief Bands of rows are at least this tall, smaller ones cost more in overhead than they save
+   */
+  static const int kMinimumSliceRows;
+
+  /**
+   * @brief Rows each band converts beyond its edges when the output's chroma is vertically subsampled
+   *
+   * Gives swscale's vertical chroma filter the same context at band edges as it has everywhere else. Must be a
+   * multiple of every format's chroma row alignment.
+   */
+  static const int kSliceOverlapRows;
+
+  static const int kVideoBufferAlignment;
+
   AVStream* audio_stream_;
   AVCodecContext* audio_codec_ctx_;
   SwrContext* audio_resample_ctx_;
@@ -3,8 +3,11 @@
 #include <QDateTime>
 #include <QDebug>
 
+#include "render/memorymanager.h"
+
 QMutex FFmpegFrameCache::pool_lock_;
 QList<Frame*> FFmpegFrameCache::frame_pool_;
+int FFmpegFrameCache::memory_consumer_ = -1;
 
 Frame *FFmpegFrameCache::Client::append(const VideoRenderingParams& params)
 {
@@ -23,6 +26,11 @@ void FFmpegFrameCache::Client::clear()
   frames_.clear();
 }
 
+void FFmpegFrameCache::Client::remove_first()
+{
+  FFmpegFrameCache::Release(frames_.takeFirst().frame);
+}
+
 bool FFmpegFrameCache::Client::isEmpty() const
 {
   return frames_.isEmpty();
@@ -95,6 +103,15 @@ Frame* FFmpegFrameCache::Get(const VideoRenderingParams &params)
   f->set_format(params.format());
   f->allocate();
 
+  if (memory_consumer_ == -1) {
+    memory_consumer_ = MemoryManager::AddConsumer(QStringLiteral("FFmpeg frame pool"),
+                                                  MemoryManager::kPriorityPool,
+                                                  &FFmpegFrameCache::ReclaimPool);
+  }
+
+  // Frames are accounted for from creation, whether they're in the pool or in a decoder's cache
+  MemoryManager::Allocated(memory_consumer_, f->allocated_size());
+
   return f;
 }
 
@@ -104,3 +121,23 @@ void FFmpegFrameCache::Release(Frame *f)
 
   frame_pool_.append(f);
 }
+
+qint64 FFmpegFrameCache::ReclaimPool(qint64 bytes)
+{
+  QMutexLocker locker(&pool_lock_);
+
+  qint64 freed = 0;
+
+  // The oldest frames in the pool are the least likely to match what decoders are asking for now
+  while (freed < bytes && !frame_pool_.isEmpty()) {
+    Frame* f = frame_pool_.takeFirst();
+
+    freed += f->allocated_size();
+
+    delete f;
+  }
+
+  MemoryManager::Freed(memory_consumer_, freed);
+
+  return freed;
+}
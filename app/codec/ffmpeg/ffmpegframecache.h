@@ -23,6 +23,7 @@ public:
 
     Frame* append(const VideoRenderingParams &params);
     void clear();
+    void remove_first();
 
     bool isEmpty() const;
     Frame* first() const;
@@ -47,10 +48,17 @@ public:
   };
 
 private:
+  /**
+   * @brief Delete pooled frames until at least `bytes` were freed (see MemoryManager)
+   */
+  static qint64 ReclaimPool(qint64 bytes);
+
   static QMutex pool_lock_;
 
   static QList<Frame*> frame_pool_;
 
+  static int memory_consumer_;
+
 };
 
 #endif // FFMPEGFRAMECACHE_H
@@ -108,6 +108,16 @@ void Frame::set_format(const PixelFormat::Format &format)
   format_ = format;
 }
 
+const YUVParams &Frame::yuv_params() const
+{
+  return yuv_params_;
+}
+
+void Frame::set_yuv_params(const YUVParams &params)
+{
+  yuv_params_ = params;
+}
+
 QByteArray Frame::ToByteArray() const
 {
   return data_;
@@ -136,7 +146,9 @@ const char *Frame::const_data() const
 void Frame::allocate()
 {
   // Assume this frame is intended to be a video frame
-  if (width_ > 0 && height_ > 0) {
+  if (width_ > 0 && height_ > 0 && yuv_params_.is_valid()) {
+    data_.resize(yuv_params_.GetBufferSize(width_, height_));
+  } else if (width_ > 0 && height_ > 0) {
     data_.resize(PixelFormat::GetBufferSize(static_cast<PixelFormat::Format>(format_), width_, height_));
   } else if (sample_count_ > 0) {
     data_.resize(audio_params_.samples_to_bytes(sample_count_));
@@ -27,6 +27,7 @@
 #include "common/rational.h"
 #include "render/audioparams.h"
 #include "render/pixelformat.h"
+#include "render/yuvparams.h"
 
 class Frame;
 using FramePtr = std::shared_ptr<Frame>;
@@ -83,6 +84,15 @@ public:
   const PixelFormat::Format& format() const;
   void set_format(const PixelFormat::Format& format);
 
+  /**
+   * @brief Get the planar Y'CbCr layout of this frame's data
+   *
+   * Invalid (the default) for regular RGBA frames. If valid, the data is laid out as described by YUVParams and
+   * format() is ignored.
+   */
+  const YUVParams& yuv_params() const;
+  void set_yuv_params(const YUVParams& params);
+
   /**
    * @brief Returns a copy of the data in this frame as a QByteArray
    *
@@ -103,7 +113,7 @@ public:
   /**
    * @brief Allocate memory buffer to store data based on parameters
    *
-   * For video frames, the width(), height(), and format() must be set for this function to work.
+   * For video frames, the width(), height(), and format() (or yuv_params()) must be set for this function to work.
    *
    * If a memory buffer has been previously allocated without destroying, this function will destroy it.
    */
@@ -133,6 +143,8 @@ private:
 
   PixelFormat::Format format_;
 
+  YUVParams yuv_params_;
+
   AudioRenderingParams audio_params_;
 
   int sample_count_;
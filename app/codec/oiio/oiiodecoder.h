@@ -46,6 +46,16 @@ public:
 
   virtual QString GetIndexFilename() override;
 
+  /**
+   * @brief Returns how many digits the end of a filename's base name has, which is how image sequences are detected
+   */
+  static int GetImageSequenceDigitCount(const QString& filename);
+
+  /**
+   * @brief Replace the number at the end of an image sequence filename's base name with `number`
+   */
+  static QString TransformImageSequenceFileName(const QString& filename, const int64_t& number);
+
 private:
 #if OIIO_VERSION < 10903
   OIIO::ImageInput* image_;
@@ -54,10 +64,6 @@ private:
 #endif
   static bool FileTypeIsSupported(const QString& fn);
 
-  static int GetImageSequenceDigitCount(const QString& filename);
-
-  static QString TransformImageSequenceFileName(const QString& filename, const int64_t& number);
-
   bool OpenImageHandler(const QString& fn);
 
   void CloseImageHandle();
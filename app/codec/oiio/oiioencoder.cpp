@@ -0,0 +1,257 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "oiioencoder.h"
+
+#include <QtGlobal>
+
+#if defined(Q_OS_WINDOWS)
+#include <Windows.h>
+#else
+#include <cstdio>
+#endif
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "common/define.h"
+#include "common/timecodefunctions.h"
+#include "oiiodecoder.h"
+#include "render/pixelformat.h"
+
+const int OIIOEncoder::kMinimumDigitCount = 4;
+const int OIIOEncoder::kFramesInFlightPerThread = 2;
+
+class OIIOEncoder::WriteTask : public QRunnable
+{
+public:
+  WriteTask(OIIOEncoder* encoder, FramePtr frame, const QString& filename) :
+    encoder_(encoder),
+    frame_(frame),
+    filename_(filename)
+  {
+  }
+
+  virtual void run() override
+  {
+    if (!encoder_->WriteImage(frame_, filename_)) {
+      encoder_->write_errors_.ref();
+    }
+
+    // Let go of the frame before allowing another one in
+    frame_ = nullptr;
+
+    encoder_->in_flight_.release();
+  }
+
+private:
+  OIIOEncoder* encoder_;
+
+  FramePtr frame_;
+
+  QString filename_;
+
+};
+
+OIIOEncoder::OIIOEncoder(const EncodingParams &params) :
+  Encoder(params),
+  start_number_(0),
+  resume_(false)
+{
+}
+
+bool OIIOEncoder::AcceptsFramesOutOfOrder() const
+{
+  return true;
+}
+
+void OIIOEncoder::WriteAudio(const AudioRenderingParams &pcm_info, const QString &pcm_filename)
+{
+  Q_UNUSED(pcm_info)
+  Q_UNUSED(pcm_filename)
+
+  qWarning() << "Image sequences can't contain audio, it won't be exported";
+
+  emit AudioComplete();
+}
+
+bool OIIOEncoder::OpenInternal()
+{
+  if (!params().video_enabled()) {
+    qWarning() << "Image sequence export requires video";
+    return false;
+  }
+
+  const VideoRenderingParams& video_params = params().video_params();
+
+  filename_template_ = params().filename();
+
+  QFileInfo file_info(filename_template_);
+  QString basename = file_info.baseName();
+
+  int digit_count = OIIODecoder::GetImageSequenceDigitCount(filename_template_);
+
+  if (digit_count > 0) {
+    // Number frames from the one in the filename
+    start_number_ = basename.right(digit_count).toLongLong();
+  } else {
+    // Append enough digits for the last frame so that the files sort correctly
+    int64_t last_number = Timecode::time_to_timestamp(params().GetExportLength(), video_params.time_base());
+    int padding = qMax(kMinimumDigitCount, QString::number(last_number).size());
+
+    start_number_ = 0;
+    filename_template_ = file_info.dir().filePath(QStringLiteral("%1_%2%3").arg(basename,
+                                                                                QString(padding, '0'),
+                                                                                file_info.fileName().mid(basename.size())));
+  }
+
+  // Each format is written at the depth it's usually exchanged in
+  const QString& codec = params().video_codec();
+  OIIO::TypeDesc type;
+
+  if (codec == QStringLiteral("exr")) {
+    type = OIIO::TypeDesc::HALF;
+  } else if (codec == QStringLiteral("png")) {
+    type = OIIO::TypeDesc::UINT8;
+  } else {
+    type = OIIO::TypeDesc::UINT16;
+  }
+
+  spec_ = OIIO::ImageSpec(video_params.width(), video_params.height(), kRGBAChannels, type);
+  spec_.alpha_channel = kRGBChannels;
+
+  // The exporter hands us frames with unassociated alpha
+  spec_.attribute("oiio:UnassociatedAlpha", 1);
+
+  if (codec == QStringLiteral("dpx")) {
+    spec_.attribute("oiio:BitsPerSample", 10);
+  }
+
+  resume_ = false;
+
+  QHash<QString, QString>::const_iterator i;
+
+  for (i=params().video_opts().begin();i!=params().video_opts().end();i++) {
+    if (i.key() == QStringLiteral("resume")) {
+      resume_ = (i.value() == QStringLiteral("1"));
+    } else {
+      spec_.attribute(i.key().toStdString(), i.value().toStdString());
+    }
+  }
+
+  write_errors_ = 0;
+  in_flight_.release(pool_.maxThreadCount() * kFramesInFlightPerThread);
+
+  return true;
+}
+
+void OIIOEncoder::WriteInternal(FramePtr frame)
+{
+  if (write_errors_.load() > 0) {
+    // The export has already failed, it's reported once we're closed
+    return;
+  }
+
+  if (frame->width() != spec_.width
+      || frame->height() != spec_.height
+      || PixelFormat::ChannelCount(frame->format()) != spec_.nchannels) {
+    qWarning() << "Received a frame that doesn't match the image sequence's parameters";
+    write_errors_.ref();
+    return;
+  }
+
+  int64_t number = start_number_ + Timecode::time_to_timestamp(frame->timestamp(), params().video_params().time_base());
+  QString filename = OIIODecoder::TransformImageSequenceFileName(filename_template_, number);
+
+  // Frames only get their final name once they're complete, so an existing one is a frame we've already written
+  if (resume_ && QFileInfo::exists(filename)) {
+    return;
+  }
+
+  // Block while too many frames are waiting to be written so they don't pile up in memory
+  in_flight_.acquire();
+
+  pool_.start(new WriteTask(this, frame, filename));
+}
+
+void OIIOEncoder::CloseInternal()
+{
+  pool_.waitForDone();
+
+  // Every frame has been written, so every slot is free again
+  in_flight_.acquire(in_flight_.available());
+
+  if (write_errors_.load() > 0) {
+    emit WriteFailed(tr("%n frame(s) of %1 failed to write", nullptr, write_errors_.load()).arg(params().filename()));
+  }
+}
+
+bool OIIOEncoder::WriteImage(FramePtr frame, const QString &filename) const
+{
+  QString partial_filename = filename;
+  partial_filename.append(QStringLiteral(".partial"));
+
+  // The writer is chosen from the final filename, since the partial one's extension means nothing to OIIO
+  auto out = OIIO::ImageOutput::create(filename.toStdString());
+
+  if (!out) {
+    qWarning() << "Failed to create image writer for" << filename;
+    return false;
+  }
+
+  bool success = out->open(partial_filename.toStdString(), spec_)
+      && out->write_image(PixelFormat::GetOIIOTypeDesc(frame->format()), frame->const_data())
+      && out->close();
+
+  if (!success) {
+    qWarning() << "Failed to write" << filename << QString::fromStdString(out->geterror());
+  }
+
+#if OIIO_VERSION < 10903
+  OIIO::ImageOutput::destroy(out);
+#endif
+
+  if (!success) {
+    QFile::remove(partial_filename);
+    return false;
+  }
+
+  // Replace any frame left by a previous export
+  if (!ReplaceFile(partial_filename, filename)) {
+    qWarning() << "Failed to rename" << partial_filename << "to" << filename;
+    QFile::remove(partial_filename);
+    return false;
+  }
+
+  return true;
+}
+
+bool OIIOEncoder::ReplaceFile(const QString &source, const QString &filename)
+{
+  // QFile::rename() won't overwrite, and removing the old file first would leave a moment where neither exists
+#if defined(Q_OS_WINDOWS)
+  return MoveFileExW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(source).utf16()),
+                     reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(filename).utf16()),
+                     MOVEFILE_REPLACE_EXISTING);
+#else
+  return std::rename(QFile::encodeName(source).constData(), QFile::encodeName(filename).constData()) == 0;
+#endif
+}
@@ -0,0 +1,99 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#ifndef OIIOENCODER_H
+#define OIIOENCODER_H
+
+#include <OpenImageIO/imageio.h>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "codec/encoder.h"
+
+/**
+ * @brief Writes video as a sequence of still images (EXR, DPX, TIFF, PNG, etc.) through OpenImageIO
+ *
+ * Every frame is its own file, so frames are accepted in any order and compressed and written concurrently on a
+ * thread pool. Only a limited number of frames are held at once, further writes block until one has finished.
+ *
+ * Each image is written under a temporary name and renamed over the final one once it's complete, so a file with a
+ * frame's name is always a whole frame. If any frame fails to write, WriteFailed() is emitted when closing. With the "resume" option set, frames that already have a file are skipped, which lets an interrupted
+ * export pick up where it left off. Any other options are passed to OIIO as attributes of the image, e.g.
+ * "compression" for EXR.
+ *
+ * Frames are numbered the way OIIODecoder detects sequences. If the filename already ends in a number, it's used as
+ * the first frame's number, otherwise one is appended.
+ */
+class OIIOEncoder : public Encoder
+{
+  Q_OBJECT
+public:
+  OIIOEncoder(const EncodingParams& params);
+
+  virtual bool AcceptsFramesOutOfOrder() const override;
+
+public slots:
+  virtual void WriteAudio(const AudioRenderingParams& pcm_info, const QString& pcm_filename) override;
+
+protected:
+  virtual bool OpenInternal() override;
+  virtual void WriteInternal(FramePtr frame) override;
+  virtual void CloseInternal() override;
+
+private:
+  class WriteTask;
+
+  /**
+   * @brief Compress and write one frame, called from the thread pool
+   */
+  bool WriteImage(FramePtr frame, const QString& filename) const;
+
+  /**
+   * @brief Move a file to `filename` in one step, replacing whatever was there
+   */
+  static bool ReplaceFile(const QString& source, const QString& filename);
+
+  QString filename_template_;
+
+  int64_t start_number_;
+
+  OIIO::ImageSpec spec_;
+
+  bool resume_;
+
+  QThreadPool pool_;
+
+  QSemaphore in_flight_;
+
+  QAtomicInt write_errors_;
+
+  /**
+   * @brief Frame numbers are padded to at least this many digits
+   */
+  static const int kMinimumDigitCount;
+
+  /**
+   * @brief How many frames may be queued or being written per thread
+   */
+  static const int kFramesInFlightPerThread;
+
+};
+
+#endif // OIIOENCODER_H
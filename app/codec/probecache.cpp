@@ -0,0 +1,256 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "probecache.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <OpenImageIO/oiioversion.h>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "common/filefunctions.h"
+#include "project/item/footage/audiostream.h"
+#include "project/item/footage/videostream.h"
+
+const quint32 ProbeCache::kVersion = 1;
+
+bool ProbeCache::Load(Footage *f)
+{
+  QString cache_filename = GetCacheFilename(f->filename());
+
+  if (cache_filename.isEmpty()) {
+    return false;
+  }
+
+  QFile cache_file(cache_filename);
+
+  if (!cache_file.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream ds(&cache_file);
+
+  QString decoder;
+  int stream_count;
+
+  ds >> decoder >> stream_count;
+
+  QList<StreamPtr> streams;
+
+  for (int i=0;i<stream_count && ds.status() == QDataStream::Ok;i++) {
+    streams.append(ReadStream(ds));
+  }
+
+  if (ds.status() != QDataStream::Ok || decoder.isEmpty()) {
+    qWarning() << "Ignoring invalid probe cache entry" << cache_filename;
+    return false;
+  }
+
+  foreach (StreamPtr s, streams) {
+    f->add_stream(s);
+  }
+
+  f->set_decoder(decoder);
+
+  return true;
+}
+
+void ProbeCache::Save(const Footage *f)
+{
+  QString cache_filename = GetCacheFilename(f->filename());
+
+  if (cache_filename.isEmpty()) {
+    return;
+  }
+
+  // Write to a temporary file first so a concurrent Load() never sees a partial entry
+  QSaveFile cache_file(cache_filename);
+
+  if (!cache_file.open(QFile::WriteOnly)) {
+    qWarning() << "Failed to write probe cache entry" << cache_filename;
+    return;
+  }
+
+  QDataStream ds(&cache_file);
+
+  ds << f->decoder() << f->stream_count();
+
+  foreach (StreamPtr s, f->streams()) {
+    WriteStream(ds, s);
+  }
+
+  if (!cache_file.commit()) {
+    qWarning() << "Failed to write probe cache entry" << cache_filename;
+  }
+}
+
+QString ProbeCache::GetCacheFilename(const QString &filename)
+{
+  QFileInfo info(filename);
+
+  if (!info.exists()) {
+    return QString();
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  hash.addData(info.absoluteFilePath().toUtf8());
+  hash.addData(QString::number(info.size()).toUtf8());
+  hash.addData(QString::number(info.lastModified().toMSecsSinceEpoch()).toUtf8());
+
+  // A different version of either library may probe the same file differently
+  hash.addData(QString::number(kVersion).toUtf8());
+  hash.addData(QString::number(LIBAVFORMAT_VERSION_INT).toUtf8());
+  hash.addData(QString::number(OIIO_VERSION).toUtf8());
+
+  QDir probe_dir(QDir(GetMediaIndexLocation()).filePath(QStringLiteral("probe")));
+
+  probe_dir.mkpath(QStringLiteral("."));
+
+  return probe_dir.filePath(QString(hash.result().toHex()));
+}
+
+void ProbeCache::WriteStream(QDataStream &ds, const StreamPtr &stream)
+{
+  ds << static_cast<int>(stream->type())
+     << stream->index()
+     << stream->timebase().toString()
+     << static_cast<qint64>(stream->duration());
+
+  switch (stream->type()) {
+  case Stream::kVideo:
+  case Stream::kImage:
+  {
+    ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(stream);
+
+    ds << image_stream->width()
+       << image_stream->height()
+       << image_stream->premultiplied_alpha();
+
+    if (stream->type() == Stream::kVideo) {
+      VideoStreamPtr video_stream = std::static_pointer_cast<VideoStream>(stream);
+
+      ds << video_stream->frame_rate().toString()
+         << static_cast<qint64>(video_stream->start_time());
+    }
+    break;
+  }
+  case Stream::kAudio:
+  {
+    AudioStreamPtr audio_stream = std::static_pointer_cast<AudioStream>(stream);
+
+    ds << audio_stream->channels()
+       << static_cast<quint64>(audio_stream->channel_layout())
+       << audio_stream->sample_rate();
+    break;
+  }
+  case Stream::kUnknown:
+  case Stream::kData:
+  case Stream::kSubtitle:
+  case Stream::kAttachment:
+    break;
+  }
+}
+
+StreamPtr ProbeCache::ReadStream(QDataStream &ds)
+{
+  int type, index;
+  QString timebase;
+  qint64 duration;
+
+  ds >> type >> index >> timebase >> duration;
+
+  StreamPtr stream;
+
+  switch (static_cast<Stream::Type>(type)) {
+  case Stream::kVideo:
+  case Stream::kImage:
+  {
+    int width, height;
+    bool premultiplied_alpha;
+
+    ds >> width >> height >> premultiplied_alpha;
+
+    ImageStreamPtr image_stream;
+
+    if (type == Stream::kVideo) {
+      QString frame_rate;
+      qint64 start_time;
+
+      ds >> frame_rate >> start_time;
+
+      VideoStreamPtr video_stream = std::make_shared<VideoStream>();
+      video_stream->set_frame_rate(rational::fromString(frame_rate));
+      video_stream->set_start_time(start_time);
+
+      image_stream = video_stream;
+    } else {
+      image_stream = std::make_shared<ImageStream>();
+    }
+
+    image_stream->set_width(width);
+    image_stream->set_height(height);
+    image_stream->set_premultiplied_alpha(premultiplied_alpha);
+
+    stream = image_stream;
+    break;
+  }
+  case Stream::kAudio:
+  {
+    int channels, sample_rate;
+    quint64 channel_layout;
+
+    ds >> channels >> channel_layout >> sample_rate;
+
+    AudioStreamPtr audio_stream = std::make_shared<AudioStream>();
+    audio_stream->set_channels(channels);
+    audio_stream->set_channel_layout(channel_layout);
+    audio_stream->set_sample_rate(sample_rate);
+
+    stream = audio_stream;
+    break;
+  }
+  case Stream::kUnknown:
+  case Stream::kData:
+  case Stream::kSubtitle:
+  case Stream::kAttachment:
+    stream = std::make_shared<Stream>();
+    stream->set_type(static_cast<Stream::Type>(type));
+    break;
+  default:
+    // Not a type we've ever written, the entry must be corrupt
+    ds.setStatus(QDataStream::ReadCorruptData);
+    return nullptr;
+  }
+
+  stream->set_index(index);
+  stream->set_timebase(rational::fromString(timebase));
+  stream->set_duration(duration);
+
+  return stream;
+}
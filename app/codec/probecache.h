@@ -0,0 +1,70 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <QDataStream>
+
+#include "project/item/footage/footage.h"
+
+/**
+ * @brief On-disk cache of Decoder::ProbeMedia() results
+ *
+ * Probing can open the container, read stream info and even scan the whole file for its duration. The streams a
+ * probe produced are stored here along with the decoder that produced them, keyed by the file's absolute path, size
+ * and modification time and by the version of the probing code and libraries. Importing the same file again (e.g. into
+ * another project, or reopening a project) then restores the streams without touching the file.
+ *
+ * All functions are thread-safe, each file gets its own cache entry.
+ */
+class ProbeCache
+{
+public:
+  /**
+   * @brief Restore a previous probe's streams into `f`
+   *
+   * Returns false if there's no valid cache entry for this file, in which case `f` is left untouched.
+   */
+  static bool Load(Footage* f);
+
+  /**
+   * @brief Store the streams and decoder of a successfully probed Footage
+   */
+  static void Save(const Footage* f);
+
+private:
+  /**
+   * @brief Returns the cache entry filename for a media file, or an empty string if the file doesn't exist
+   */
+  static QString GetCacheFilename(const QString& filename);
+
+  static void WriteStream(QDataStream& ds, const StreamPtr& stream);
+
+  static StreamPtr ReadStream(QDataStream& ds);
+
+  /**
+   * @brief Increment whenever Probe() functions start setting up streams differently
+   */
+  static const quint32 kVersion;
+
+};
+
+#endif // PROBECACHE_H
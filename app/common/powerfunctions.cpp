@@ -0,0 +1,81 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "powerfunctions.h"
+
+#include <QtGlobal>
+
+#if defined(Q_OS_LINUX)
+#include <QDir>
+#include <QFile>
+#elif defined(Q_OS_WINDOWS)
+#include <Windows.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+static QByteArray ReadPowerSupplyAttribute(const QDir& supply, const QString& attribute)
+{
+  QFile f(supply.filePath(attribute));
+
+  if (f.open(QFile::ReadOnly)) {
+    return f.readAll().trimmed();
+  }
+
+  return QByteArray();
+}
+#endif
+
+bool IsRunningOnBattery()
+{
+#if defined(Q_OS_LINUX)
+  QDir supplies(QStringLiteral("/sys/class/power_supply"));
+
+  bool has_battery = false;
+
+  foreach (const QString& name, supplies.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+    QDir supply(supplies.filePath(name));
+    QByteArray type = ReadPowerSupplyAttribute(supply, QStringLiteral("type"));
+
+    if (type == "Mains" || type == "USB") {
+      // Any online external supply means we're not draining the battery
+      if (ReadPowerSupplyAttribute(supply, QStringLiteral("online")) == "1") {
+        return false;
+      }
+    } else if (type == "Battery"
+               && ReadPowerSupplyAttribute(supply, QStringLiteral("scope")) != "Device") {
+      // Peripherals like wireless mice report their own batteries with a "Device" scope
+      has_battery = true;
+    }
+  }
+
+  // Desktops have no battery and often don't report a mains supply either
+  return has_battery;
+#elif defined(Q_OS_WINDOWS)
+  SYSTEM_POWER_STATUS status;
+
+  if (GetSystemPowerStatus(&status)) {
+    return status.ACLineStatus == 0;
+  }
+
+  return false;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,32 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef POWERFUNCTIONS_H
+#define POWERFUNCTIONS_H
+
+/**
+ * @brief Returns whether this machine is currently running off a battery
+ *
+ * Only implemented on Linux (through sysfs) and Windows. Everywhere else, and whenever the power source can't be
+ * determined, the machine is assumed to be on mains power.
+ */
+bool IsRunningOnBattery();
+
+#endif // POWERFUNCTIONS_H
@@ -56,6 +56,7 @@ void Config::SetDefaults()
   config_map_["DefaultStillLength"] = QVariant::fromValue(rational(2));
   config_map_["HoverFocus"] = false;
   config_map_["AudioScrubbing"] = true;
+  config_map_["PlaybackLateFramePolicy"] = 0;
   config_map_["AutorecoveryInterval"] = 1;
   config_map_["Language"] = "en_US";
   config_map_["ScrollZooms"] = false;
@@ -82,6 +83,10 @@ void Config::SetDefaults()
   config_map_["DiskCacheBehind"] = QVariant::fromValue(rational(2));
   config_map_["DiskCacheAhead"] = QVariant::fromValue(rational(10));
   config_map_["ClearDiskCacheOnClose"] = false;
+  config_map_["MemoryBudget"] = 0.0;
+  config_map_["BackgroundRender"] = false;
+  config_map_["BackgroundRenderIdleDelay"] = 1000;
+  config_map_["BackgroundRenderPauseOnBattery"] = true;
 
   config_map_["DefaultSequenceWidth"] = 1920;
   config_map_["DefaultSequenceHeight"] = 1080;
@@ -96,6 +101,10 @@ void Config::SetDefaults()
   config_map_["OfflineSampleFormat"] = SampleFormat::SAMPLE_FMT_FLT;
   config_map_["OnlineOCIOMethod"] = ColorManager::kOCIOAccurate;
   config_map_["OfflineOCIOMethod"] = ColorManager::kOCIOFast;
+
+  // Export render workers (0 renders in-process)
+  config_map_["RenderWorkerProcesses"] = 0;
+  config_map_["RenderWorkerPinNuma"] = false;
 }
 
 void Config::Load()
@@ -20,6 +20,7 @@
 
 #include "core.h"
 
+#include <csignal>
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDebug>
@@ -46,9 +47,13 @@
 #include "project/projectsavemanager.h"
 #include "render/backend/indexmanager.h"
 #include "render/backend/opengl/opengltexturecache.h"
+#include "render/backend/process/renderprocessserver.h"
 #include "render/colormanager.h"
 #include "render/diskmanager.h"
+#include "render/filmstripcache.h"
+#include "render/memorymanager.h"
 #include "render/pixelformat.h"
+#include "render/thumbnailcache.h"
 #include "task/taskmanager.h"
 #include "ui/style/style.h"
 #include "undo/undostack.h"
@@ -60,9 +65,11 @@ Core Core::instance_;
 
 Core::Core() :
   main_window_(nullptr),
+  render_worker_(nullptr),
   tool_(Tool::kPointer),
   snapping_(true),
-  queue_autorecovery_(false)
+  queue_autorecovery_(false),
+  startup_stage_start_(0)
 {
 }
 
@@ -73,6 +80,8 @@ Core *Core::instance()
 
 void Core::Start()
 {
+  startup_timer_.start();
+
   //
   // Parse command line arguments
   //
@@ -92,6 +101,13 @@ void Core::Start()
   QCommandLineOption fullscreen_option({"f", "fullscreen"}, tr("Start in full screen mode"));
   parser.addOption(fullscreen_option);
 
+  // Internal option used by RenderProcessPool to start headless render workers
+  QCommandLineOption render_worker_option(RenderProcessProtocol::kWorkerOption, tr("Run as a render worker process"));
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
+  render_worker_option.setFlags(QCommandLineOption::HiddenFromHelp);
+#endif
+  parser.addOption(render_worker_option);
+
   // Parse options
   parser.process(*app);
 
@@ -105,7 +121,11 @@ void Core::Start()
   // Declare custom types for Qt signal/slot syste
   DeclareTypesForQt();
 
-  // Set up node factory/library
+  // Start anything that doesn't depend on the rest of startup on the thread pool first, so it can run while we
+  // continue here
+  ColorManager::PreloadDefaultConfig();
+
+  // Set up node factory/library (reads external node metadata in the background)
   NodeFactory::Initialize();
 
   // Set up the index manager for renderers
@@ -114,6 +134,15 @@ void Core::Start()
   // Load application config
   Config::Load();
 
+  // Governs cache memory for both editors and render workers, so it needs the Config
+  MemoryManager::CreateInstance();
+
+  TraceStartup("Core services");
+
+  if (parser.isSet(render_worker_option)) {
+    StartRenderWorker();
+    return;
+  }
 
   //
   // Start GUI (FIXME CLI mode)
@@ -130,6 +159,26 @@ void Core::Start()
   }
 }
 
+void Core::StartRenderWorker()
+{
+  // A crashing worker is handled by the editor that started it, don't pop up the crash dialog
+  signal(SIGSEGV, SIG_DFL);
+  signal(SIGABRT, SIG_DFL);
+
+  // Workers deliberately don't start the DiskManager, the disk cache index belongs to the editor
+  TaskManager::CreateInstance();
+
+  PixelFormat::CreateInstance();
+
+  // Snapshots can't be loaded without the complete node library
+  NodeFactory::FinishInitialization();
+
+  render_worker_ = new RenderProcessServer();
+  render_worker_->Start();
+
+  TraceStartup("Render worker");
+}
+
 void Core::Stop()
 {
   // Save Config
@@ -143,14 +192,22 @@ void Core::Stop()
 
   AudioManager::DestroyInstance();
 
+  ThumbnailCache::DestroyInstance();
+
+  FilmstripCache::DestroyInstance();
+
   DiskManager::DestroyInstance();
 
   PixelFormat::DestroyInstance();
 
+  MemoryManager::DestroyInstance();
+
   NodeFactory::Destroy();
 
   IndexManager::DestroyInstance();
 
+  delete render_worker_;
+
   delete main_window_;
 }
 
@@ -384,24 +441,37 @@ void Core::StartGUI(bool full_screen)
   qApp->setStyle(QStyleFactory::create("Fusion"));
   StyleManager::SetStyle(StyleManager::DefaultStyle());
 
+  TraceStartup("Style");
+
   // Set up shared menus
   MenuShared::CreateInstance();
 
   // Since we're starting GUI mode, create a PanelFocusManager (auto-deletes with QObject)
   PanelManager::CreateInstance();
 
-  // Initialize audio service
+  // Initialize audio service (devices are enumerated once the event loop is running)
   AudioManager::CreateInstance();
 
-  // Initialize disk service
+  // Initialize disk service (the index is validated in the background)
   DiskManager::CreateInstance();
 
+  // Initialize thumbnail services
+  ThumbnailCache::CreateInstance();
+  FilmstripCache::CreateInstance();
+
   // Initialize task manager
   TaskManager::CreateInstance();
 
   // Initialize pixel service
   PixelFormat::CreateInstance();
 
+  TraceStartup("GUI services");
+
+  // Panels create node menus and nodes, so the library needs to be complete by now
+  NodeFactory::FinishInitialization();
+
+  TraceStartup("Node library");
+
   // Connect the PanelFocusManager to the application's focus change signal
   connect(qApp,
           &QApplication::focusChanged,
@@ -416,6 +486,13 @@ void Core::StartGUI(bool full_screen)
     main_window_->showMaximized();
   }
 
+  TraceStartup("Main window");
+
+  // Anything deferred to the event loop (e.g. audio device enumeration) starts after this
+  QTimer::singleShot(0, this, [this]{
+    TraceStartup("First event loop iteration");
+  });
+
   // When a new project is opened, update the mainwindow
   connect(this, &Core::ProjectOpened, main_window_, &MainWindow::ProjectOpen);
 
@@ -435,6 +512,15 @@ void Core::SaveProjectInternal(Project *project)
   task_dialog->open();
 }
 
+void Core::TraceStartup(const char *stage)
+{
+  qint64 elapsed = startup_timer_.elapsed();
+
+  qDebug() << "Startup:" << stage << "took" << (elapsed - startup_stage_start_) << "ms," << elapsed << "ms total";
+
+  startup_stage_start_ = elapsed;
+}
+
 void Core::SaveAutorecovery()
 {
   if (queue_autorecovery_) {
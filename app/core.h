@@ -21,6 +21,7 @@
 #ifndef CORE_H
 #define CORE_H
 
+#include <QElapsedTimer>
 #include <QFileInfoList>
 #include <QList>
 #include <QTimer>
@@ -35,6 +36,7 @@
 #include "undo/undostack.h"
 
 class MainWindow;
+class RenderProcessServer;
 
 /**
  * @brief The main central Olive application instance
@@ -296,16 +298,34 @@ private:
    */
   void StartGUI(bool full_screen);
 
+  /**
+   * @brief Start Olive as a headless render worker (see RenderProcessPool)
+   *
+   * Only the services needed for rendering are started. The worker receives its project and frames to render from the
+   * process that launched it.
+   */
+  void StartRenderWorker();
+
   /**
    * @brief Internal function for saving a project to a file
    */
   void SaveProjectInternal(Project* project);
 
+  /**
+   * @brief Log how long a stage of startup took and how long we've been starting up in total
+   */
+  void TraceStartup(const char* stage);
+
   /**
    * @brief Internal main window object
    */
   MainWindow* main_window_;
 
+  /**
+   * @brief Render worker server, only valid if we were started with `--render-worker`
+   */
+  RenderProcessServer* render_worker_;
+
   /**
    * @brief Internal startup project object
    *
@@ -347,6 +367,13 @@ private:
    */
   UndoStack undo_stack_;
 
+  /**
+   * @brief Startup timing, see TraceStartup()
+   */
+  QElapsedTimer startup_timer_;
+
+  qint64 startup_stage_start_;
+
   /**
    * @brief Static singleton core instance
    */
@@ -15,9 +15,25 @@ ImageSection::ImageSection(QWidget* parent) :
 
   image_sequence_checkbox_ = new QCheckBox();
   layout->addWidget(new QCheckBox(), row, 1);
+
+  row++;
+
+  layout->addWidget(new QLabel(tr("Skip Existing Frames:")), row, 0);
+
+  skip_existing_checkbox_ = new QCheckBox();
+  skip_existing_checkbox_->setToolTip(tr("Only write frames that don't have a file yet, e.g. to resume an interrupted "
+                                         "export"));
+  layout->addWidget(skip_existing_checkbox_, row, 1);
 }
 
 QCheckBox *ImageSection::image_sequence_checkbox() const
 {
   return image_sequence_checkbox_;
 }
+
+void ImageSection::AddOpts(EncodingParams *params)
+{
+  if (skip_existing_checkbox_->isChecked()) {
+    params->SetVideoOption(QStringLiteral("resume"), QStringLiteral("1"));
+  }
+}
@@ -12,9 +12,13 @@ public:
 
   QCheckBox* image_sequence_checkbox() const;
 
+  virtual void AddOpts(EncodingParams* params) override;
+
 private:
   QCheckBox* image_sequence_checkbox_;
 
+  QCheckBox* skip_existing_checkbox_;
+
 };
 
 #endif // IMAGESECTION_H
@@ -99,6 +99,14 @@ ExportDialog::ExportDialog(ViewerOutput *viewer_node, QWidget *parent) :
   audio_enabled_->setChecked(true);
   av_enabled_layout->addWidget(audio_enabled_);
 
+  smart_render_enabled_ = new QCheckBox(tr("Copy Untouched Intra-Frame Footage"));
+  smart_render_enabled_->setToolTip(tr("Clips without effects whose footage already matches the export's codec, "
+                                       "resolution, pixel format and frame rate are copied without re-encoding.\n\n"
+                                       "Only intra-frame codecs (e.g. ProRes, DNxHD or MJPEG) qualify. Long-GOP "
+                                       "footage such as H.264 or HEVC is always re-encoded."));
+  smart_render_enabled_->setChecked(true);
+  av_enabled_layout->addWidget(smart_render_enabled_);
+
   preferences_layout->addLayout(av_enabled_layout, row, 0, 1, 4);
 
   row++;
@@ -255,12 +263,29 @@ void ExportDialog::accept()
                                 audio_codec.id());
   }
 
-  Encoder* encoder = Encoder::CreateFromID("ffmpeg", encoding_params);
+  Encoder* encoder = Encoder::CreateFromID(formats_.at(format_combobox_->currentIndex()).encoder(), encoding_params);
 
   exporter_ = new Exporter(viewer_node_, encoder);
 
   if (video_enabled_->isChecked()) {
     exporter_->EnableVideo(video_render_params, transform, color_processor);
+
+    // Untouched footage can only be copied as-is if no look is applied on top of the display transform
+    if (smart_render_enabled_->isChecked() && video_tab_->CurrentOCIOLook().isEmpty()) {
+      QString display = video_tab_->CurrentOCIODisplay();
+      QString view = video_tab_->CurrentOCIOView();
+
+      if (display.isEmpty()) {
+        display = color_manager_->GetDefaultDisplay();
+      }
+
+      if (view.isEmpty()) {
+        view = color_manager_->GetDefaultView(display);
+      }
+
+      exporter_->EnableSmartRender(color_manager_->GetConfig()->getDisplayColorSpaceName(display.toUtf8(),
+                                                                                          view.toUtf8()));
+    }
   }
 
   if (audio_enabled_->isChecked()) {
@@ -375,6 +400,9 @@ void ExportDialog::SetUpFormats()
     case kCodecDNxHD:
       codecs_.append(ExportCodec(tr("DNxHD"), "dnxhd"));
       break;
+    case kCodecDPX:
+      codecs_.append(ExportCodec(tr("DPX"), "dpx", ExportCodec::kStillImage));
+      break;
     case kCodecH264:
       codecs_.append(ExportCodec(tr("H.264"), "libx264"));
       break;
@@ -416,6 +444,9 @@ void ExportDialog::SetUpFormats()
     case kFormatDNxHD:
       formats_.append(ExportFormat(tr("DNxHD"), "mxf", "ffmpeg", {kCodecDNxHD}, {kCodecPCM}));
       break;
+    case kFormatDPX:
+      formats_.append(ExportFormat(tr("DPX"), "dpx", "oiio", {kCodecDPX}, {}));
+      break;
     case kFormatMatroska:
       formats_.append(ExportFormat(tr("Matroska Video"), "mkv", "ffmpeg", {kCodecH264, kCodecH265}, {kCodecAAC, kCodecMP2, kCodecMP3, kCodecPCM}));
       break;
@@ -42,6 +42,7 @@ private:
 
   QCheckBox* video_enabled_;
   QCheckBox* audio_enabled_;
+  QCheckBox* smart_render_enabled_;
 
   QList<ExportCodec> codecs_;
 
@@ -68,6 +69,7 @@ private:
 
   enum Format {
     kFormatDNxHD,
+    kFormatDPX,
     kFormatMatroska,
     kFormatMPEG4,
     kFormatOpenEXR,
@@ -80,6 +82,7 @@ private:
 
   enum Codec {
     kCodecDNxHD,
+    kCodecDPX,
     kCodecH264,
     kCodecH265,
     kCodecOpenEXR,
@@ -9,6 +9,7 @@
 #include "common/autoscroll.h"
 #include "dialog/sequence/sequence.h"
 #include "project/item/sequence/sequence.h"
+#include "widget/viewer/viewer.h"
 
 PreferencesGeneralTab::PreferencesGeneralTab()
 {
@@ -74,6 +75,18 @@ PreferencesGeneralTab::PreferencesGeneralTab()
 
   row++;
 
+  general_layout->addWidget(new QLabel(tr("Late Frames During Playback:")), row, 0);
+
+  // ComboBox indices match enum indicies
+  late_frame_policy_ = new QComboBox();
+  late_frame_policy_->addItem(tr("Drop Frames"), ViewerWidget::kLateFrameDrop);
+  late_frame_policy_->addItem(tr("Wait For Frames"), ViewerWidget::kLateFrameHold);
+  late_frame_policy_->addItem(tr("Lower Resolution"), ViewerWidget::kLateFrameDegrade);
+  late_frame_policy_->setCurrentIndex(Config::Current()["PlaybackLateFramePolicy"].toInt());
+  general_layout->addWidget(late_frame_policy_, row, 1);
+
+  row++;
+
   general_layout->addWidget(new QLabel(tr("Default Still Image Length:")), row, 0);
 
   default_still_length_ = new FloatSlider();
@@ -103,6 +116,8 @@ void PreferencesGeneralTab::Accept()
 
   Config::Current()["Autoscroll"] = autoscroll_method_->currentData();
 
+  Config::Current()["PlaybackLateFramePolicy"] = late_frame_policy_->currentData();
+
   Config::Current()["DefaultStillLength"] = QVariant::fromValue(rational::fromDouble(default_still_length_->GetValue()));
 }
 
@@ -27,6 +27,8 @@ private:
 
   QComboBox* autoscroll_method_;
 
+  QComboBox* late_frame_policy_;
+
   FloatSlider* default_still_length_;
 
   /**
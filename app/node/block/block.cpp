@@ -22,11 +22,14 @@
 
 #include <QDebug>
 
+#include "node/output/track/track.h"
 #include "transition/transition.h"
 
 Block::Block() :
   previous_(nullptr),
-  next_(nullptr)
+  next_(nullptr),
+  track_(nullptr),
+  track_index_(-1)
 {
   name_input_ = new NodeInput("name_in", NodeParam::kString);
   name_input_->SetConnectable(false);
@@ -36,6 +39,7 @@ Block::Block() :
   length_input_ = new NodeInput("length_in", NodeParam::kRational);
   length_input_->SetConnectable(false);
   length_input_->set_is_keyframable(false);
+  length_input_->set_is_structural(true);
   AddInput(length_input_);
   connect(length_input_, SIGNAL(ValueChanged(const rational&, const rational&)), this, SLOT(LengthInputChanged()));
 
@@ -59,13 +63,21 @@ QString Block::Category() const
   return tr("Block");
 }
 
-const rational &Block::in() const
+rational Block::in() const
 {
+  if (track_) {
+    return track_->InPointOfIndex(track_index_);
+  }
+
   return in_point_;
 }
 
-const rational &Block::out() const
+rational Block::out() const
 {
+  if (track_) {
+    return track_->OutPointOfIndex(track_index_);
+  }
+
   return out_point_;
 }
 
@@ -79,6 +91,17 @@ void Block::set_out(const rational &out)
   out_point_ = out;
 }
 
+void Block::set_track_position(TrackOutput *track, int index)
+{
+  track_ = track;
+  track_index_ = index;
+}
+
+int Block::track_index() const
+{
+  return track_index_;
+}
+
 rational Block::length() const
 {
   return length_input_->get_standard_value().value<rational>();
@@ -23,6 +23,8 @@
 
 #include "node/node.h"
 
+class TrackOutput;
+
 /**
  * @brief A Node that represents a block of time, also displayable on a Timeline
  *
@@ -49,11 +51,24 @@ public:
 
   virtual QString Category() const override;
 
-  const rational& in() const;
-  const rational& out() const;
+  /**
+   * @brief Where this Block starts and ends on its track
+   *
+   * Derived from the track's position index while the Block is on one (see set_track_position()), otherwise these
+   * return what was last set with set_in() and set_out().
+   */
+  rational in() const;
+  rational out() const;
   void set_in(const rational& in);
   void set_out(const rational& out);
 
+  /**
+   * @brief Used by TrackOutput to tell a Block which track and which index on it it's currently connected to
+   */
+  void set_track_position(TrackOutput* track, int index);
+
+  int track_index() const;
+
   rational length() const;
   void set_length_and_media_out(const rational &length);
   void set_length_and_media_in(const rational &length);
@@ -120,6 +135,9 @@ private:
   rational in_point_;
   rational out_point_;
 
+  TrackOutput* track_;
+  int track_index_;
+
   QVector<Block*> linked_clips_;
 
 private slots:
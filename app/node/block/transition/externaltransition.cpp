@@ -1,41 +1,53 @@
 #include "externaltransition.h"
 
 ExternalTransition::ExternalTransition(const QString &xml_meta_filename) :
-  meta_(xml_meta_filename)
+  ExternalTransition(std::make_shared<NodeMetaReader>(xml_meta_filename))
 {
-  foreach (NodeInput* input, meta_.inputs()) {
+}
+
+ExternalTransition::ExternalTransition(NodeMetaReaderPtr meta) :
+  meta_(meta),
+  iteration_input_(nullptr)
+{
+  meta_inputs_ = meta_->CreateInputs();
+
+  foreach (NodeInput* input, meta_inputs_) {
     AddInput(input);
+
+    if (input->id() == meta_->iteration_input_id()) {
+      iteration_input_ = input;
+    }
   }
 }
 
 Node *ExternalTransition::copy() const
 {
-  return new ExternalTransition(meta_.filename());
+  return new ExternalTransition(meta_);
 }
 
 QString ExternalTransition::Name() const
 {
-  return meta_.Name();
+  return meta_->Name();
 }
 
 QString ExternalTransition::id() const
 {
-  return meta_.id();
+  return meta_->id();
 }
 
 QString ExternalTransition::Category() const
 {
-  return meta_.Category();
+  return meta_->Category();
 }
 
 QString ExternalTransition::Description() const
 {
-  return meta_.Description();
+  return meta_->Description();
 }
 
 void ExternalTransition::Retranslate()
 {
-  meta_.Retranslate();
+  meta_->Retranslate(meta_inputs_);
 }
 
 bool ExternalTransition::IsAccelerated() const
@@ -45,20 +57,20 @@ bool ExternalTransition::IsAccelerated() const
 
 QString ExternalTransition::AcceleratedCodeVertex() const
 {
-  return meta_.vert_code();
+  return meta_->vert_code();
 }
 
 QString ExternalTransition::AcceleratedCodeFragment() const
 {
-  return meta_.frag_code();
+  return meta_->frag_code();
 }
 
 int ExternalTransition::AcceleratedCodeIterations() const
 {
-  return meta_.iterations();
+  return meta_->iterations();
 }
 
 NodeInput *ExternalTransition::AcceleratedCodeIterativeInput() const
 {
-  return meta_.iteration_input();
+  return iteration_input_;
 }
@@ -10,6 +10,11 @@ class ExternalTransition : public TransitionBlock
 public:
   ExternalTransition(const QString& xml_meta_filename);
 
+  /**
+   * @brief Create from metadata that's already been read, used by copy() and NodeFactory to avoid reading it again
+   */
+  ExternalTransition(NodeMetaReaderPtr meta);
+
   virtual Node* copy() const override;
 
   virtual QString Name() const override;
@@ -26,7 +31,11 @@ public:
   virtual NodeInput* AcceleratedCodeIterativeInput() const override;
 
 private:
-  NodeMetaReader meta_;
+  NodeMetaReaderPtr meta_;
+
+  QList<NodeInput*> meta_inputs_;
+
+  NodeInput* iteration_input_;
 };
 
 #endif // EXTERNALTRANSITION_H
@@ -108,6 +108,27 @@ NodeValueTable TransformDistort::Value(const NodeValueDatabase &value) const
   return output;
 }
 
+bool TransformDistort::IsIdentity() const
+{
+  QList<NodeInput*> inputs = {position_input_, rotation_input_, scale_input_, anchor_input_};
+
+  foreach (NodeInput* input, inputs) {
+    if (input->IsConnected() || input->is_keyframing()) {
+      return false;
+    }
+  }
+
+  QVector2D scale = scale_input_->get_standard_value().value<QVector2D>();
+  if (uniform_scale_input_->get_standard_value().toBool()) {
+    scale.setY(scale.x());
+  }
+
+  return position_input_->get_standard_value().value<QVector2D>().isNull()
+      && qIsNull(rotation_input_->get_standard_value().toFloat())
+      && scale == QVector2D(1.0f, 1.0f)
+      && anchor_input_->get_standard_value().value<QVector2D>().isNull();
+}
+
 void TransformDistort::UniformScaleChanged()
 {
   scale_input_->set_property("disabley", uniform_scale_input_->get_standard_value().toBool());
@@ -40,6 +40,13 @@ public:
 
   virtual NodeValueTable Value(const NodeValueDatabase& value) const override;
 
+  /**
+   * @brief Returns true if this node's matrix is an identity matrix for its entire length
+   *
+   * i.e. all parameters are at their defaults, and none are keyframed or connected to other nodes.
+   */
+  bool IsIdentity() const;
+
 private:
   NodeInput* position_input_;
 
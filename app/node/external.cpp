@@ -3,41 +3,53 @@
 #include <QFile>
 
 ExternalNode::ExternalNode(const QString &xml_meta_filename) :
-  meta_(xml_meta_filename)
+  ExternalNode(std::make_shared<NodeMetaReader>(xml_meta_filename))
 {
-  foreach (NodeInput* input, meta_.inputs()) {
+}
+
+ExternalNode::ExternalNode(NodeMetaReaderPtr meta) :
+  meta_(meta),
+  iteration_input_(nullptr)
+{
+  meta_inputs_ = meta_->CreateInputs();
+
+  foreach (NodeInput* input, meta_inputs_) {
     AddInput(input);
+
+    if (input->id() == meta_->iteration_input_id()) {
+      iteration_input_ = input;
+    }
   }
 }
 
 Node *ExternalNode::copy() const
 {
-  return new ExternalNode(meta_.filename());
+  return new ExternalNode(meta_);
 }
 
 QString ExternalNode::Name() const
 {
-  return meta_.Name();
+  return meta_->Name();
 }
 
 QString ExternalNode::id() const
 {
-  return meta_.id();
+  return meta_->id();
 }
 
 QString ExternalNode::Category() const
 {
-  return meta_.Category();
+  return meta_->Category();
 }
 
 QString ExternalNode::Description() const
 {
-  return meta_.Description();
+  return meta_->Description();
 }
 
 void ExternalNode::Retranslate()
 {
-  meta_.Retranslate();
+  meta_->Retranslate(meta_inputs_);
 }
 
 bool ExternalNode::IsAccelerated() const
@@ -47,20 +59,20 @@ bool ExternalNode::IsAccelerated() const
 
 QString ExternalNode::AcceleratedCodeVertex() const
 {
-  return meta_.vert_code();
+  return meta_->vert_code();
 }
 
 QString ExternalNode::AcceleratedCodeFragment() const
 {
-  return meta_.frag_code();
+  return meta_->frag_code();
 }
 
 int ExternalNode::AcceleratedCodeIterations() const
 {
-  return meta_.iterations();
+  return meta_->iterations();
 }
 
 NodeInput *ExternalNode::AcceleratedCodeIterativeInput() const
 {
-  return meta_.iteration_input();
+  return iteration_input_;
 }
@@ -14,6 +14,11 @@ class ExternalNode : public Node
 public:
   ExternalNode(const QString& xml_meta_filename);
 
+  /**
+   * @brief Create from metadata that's already been read, used by copy() and NodeFactory to avoid reading it again
+   */
+  ExternalNode(NodeMetaReaderPtr meta);
+
   virtual Node* copy() const override;
 
   virtual QString Name() const override;
@@ -30,7 +35,11 @@ public:
   virtual NodeInput* AcceleratedCodeIterativeInput() const override;
 
 private:
-  NodeMetaReader meta_;
+  NodeMetaReaderPtr meta_;
+
+  QList<NodeInput*> meta_inputs_;
+
+  NodeInput* iteration_input_;
 };
 
 #endif // EXTERNALNODE_H
@@ -1,5 +1,7 @@
 #include "factory.h"
 
+#include <QThreadPool>
+
 #include "audio/pan/pan.h"
 #include "audio/volume/volume.h"
 #include "block/clip/clip.h"
@@ -13,29 +15,44 @@
 #include "external.h"
 
 QList<Node*> NodeFactory::library_;
+QVector<NodeFactory::ExternalMeta> NodeFactory::external_meta_;
+QSemaphore NodeFactory::external_meta_read_;
 
 void NodeFactory::Initialize()
 {
   Destroy();
 
+  external_meta_ = {
+    {":/shaders/gaussianblur.xml", false, nullptr},
+    {":/shaders/boxblur.xml", false, nullptr},
+    {":/shaders/opacity.xml", false, nullptr},
+    {":/shaders/solid.xml", false, nullptr},
+    {":/shaders/stroke.xml", false, nullptr},
+    {":/shaders/alphaover.xml", false, nullptr},
+    {":/shaders/dropshadow.xml", false, nullptr},
+    {":/shaders/crossdissolve.xml", true, nullptr},
+    {":/shaders/diptoblack.xml", true, nullptr}
+  };
+
+  // The metadata files don't depend on each other so they can all be read at once. external_meta_ isn't resized
+  // again until FinishInitialization() so the tasks can write straight into it.
+  for (int i=0;i<external_meta_.size();i++) {
+    ExternalMeta& m = external_meta_[i];
+
+    QThreadPool::globalInstance()->start(new MetaReadTask(m.filename, &m.meta));
+  }
+
   // Add internal types
   for (int i=0;i<kInternalNodeCount;i++) {
     library_.append(CreateInternal(static_cast<InternalID>(i)));
   }
-
-  library_.append(new ExternalNode(":/shaders/gaussianblur.xml"));
-  library_.append(new ExternalNode(":/shaders/boxblur.xml"));
-  library_.append(new ExternalNode(":/shaders/opacity.xml"));
-  library_.append(new ExternalNode(":/shaders/solid.xml"));
-  library_.append(new ExternalNode(":/shaders/stroke.xml"));
-  library_.append(new ExternalNode(":/shaders/alphaover.xml"));
-  library_.append(new ExternalNode(":/shaders/dropshadow.xml"));
-  library_.append(new ExternalTransition(":/shaders/crossdissolve.xml"));
-  library_.append(new ExternalTransition(":/shaders/diptoblack.xml"));
 }
 
 void NodeFactory::Destroy()
 {
+  // Don't pull the metadata out from under tasks that are still reading it
+  FinishInitialization();
+
   foreach (Node* n, library_) {
     delete n;
   }
@@ -143,3 +160,36 @@ Node *NodeFactory::CreateInternal(const NodeFactory::InternalID &id)
   // We should never get here
   abort();
 }
+
+void NodeFactory::FinishInitialization()
+{
+  if (external_meta_.isEmpty()) {
+    return;
+  }
+
+  external_meta_read_.acquire(external_meta_.size());
+
+  // Append in a fixed order, menu actions refer to nodes by their library index
+  foreach (const ExternalMeta& m, external_meta_) {
+    if (m.transition) {
+      library_.append(new ExternalTransition(m.meta));
+    } else {
+      library_.append(new ExternalNode(m.meta));
+    }
+  }
+
+  external_meta_.clear();
+}
+
+NodeFactory::MetaReadTask::MetaReadTask(const QString &filename, NodeMetaReaderPtr *destination) :
+  filename_(filename),
+  destination_(destination)
+{
+}
+
+void NodeFactory::MetaReadTask::run()
+{
+  *destination_ = std::make_shared<NodeMetaReader>(filename_);
+
+  NodeFactory::external_meta_read_.release();
+}
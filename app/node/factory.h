@@ -2,7 +2,11 @@
 #define NODEFACTORY_H
 
 #include <QList>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
 
+#include "metareader.h"
 #include "node.h"
 #include "widget/menu/menu.h"
 
@@ -26,8 +30,21 @@ public:
 
   NodeFactory() = default;
 
+  /**
+   * @brief Create the node library
+   *
+   * External node metadata is read on the global thread pool so startup can continue while it's parsed.
+   * FinishInitialization() must be called before the library is used.
+   */
   static void Initialize();
 
+  /**
+   * @brief Wait for any metadata still being read and add its nodes to the library
+   *
+   * Nodes are QObjects so this should be called from the main thread.
+   */
+  static void FinishInitialization();
+
   static void Destroy();
 
   static Menu* CreateMenu();
@@ -37,9 +54,37 @@ public:
   static Node* CreateFromID(const QString& id);
 
 private:
+  /**
+   * @brief Reads one external node's metadata file off the main thread
+   */
+  class MetaReadTask : public QRunnable
+  {
+  public:
+    MetaReadTask(const QString& filename, NodeMetaReaderPtr* destination);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    QString filename_;
+
+    NodeMetaReaderPtr* destination_;
+
+  };
+
+  struct ExternalMeta {
+    QString filename;
+    bool transition;
+    NodeMetaReaderPtr meta;
+  };
+
   static Node* CreateInternal(const InternalID& id);
 
   static QList<Node*> library_;
+
+  static QVector<ExternalMeta> external_meta_;
+
+  static QSemaphore external_meta_read_;
 };
 
 #endif // NODEFACTORY_H
@@ -36,7 +36,9 @@ NodeInput::NodeInput(const QString& id, const DataType &type, const QVariant &de
   NodeParam(id),
   data_type_(type),
   keyframable_(true),
-  keyframing_(false)
+  keyframing_(false),
+  value_version_(0),
+  structural_(false)
 {
   int track_size;
 
@@ -122,6 +124,8 @@ void NodeInput::Load(QXmlStreamReader *reader, QHash<quintptr, NodeOutput*>& par
               standard_value_.replace(val_index, StringToValue(value_text, footage_connections));
             }
 
+            increment_value_version();
+
             val_index++;
           }
         }
@@ -175,6 +179,7 @@ void NodeInput::Load(QXmlStreamReader *reader, QHash<quintptr, NodeOutput*>& par
                 key->set_bezier_control_out(key_out_handle);
                 key->set_parent(this);
                 keyframe_tracks_[track].append(key);
+                increment_value_version();
               }
             }
 
@@ -344,11 +349,18 @@ QVector<QVariant> NodeInput::get_split_values_at_time(const rational &time) cons
 {
   QVector<QVariant> vals;
 
+  // Hold a reference for the whole evaluation so every track reads from the same snapshot
+  ValueSnapshotPtr snapshot = value_snapshot();
+
   for (int i=0;i<get_number_of_keyframe_tracks();i++) {
-    if (is_using_standard_value(i)) {
-      vals.append(standard_value_.at(i));
+    if (snapshot) {
+      vals.append(value_at_time_for_track(snapshot->standard_value,
+                                          snapshot->keyframe_tracks,
+                                          snapshot->keyframing,
+                                          time,
+                                          i));
     } else {
-      vals.append(get_value_at_time_for_track(time, i));
+      vals.append(value_at_time_for_track(standard_value_, keyframe_tracks_, keyframing_, time, i));
     }
   }
 
@@ -357,8 +369,27 @@ QVector<QVariant> NodeInput::get_split_values_at_time(const rational &time) cons
 
 QVariant NodeInput::get_value_at_time_for_track(const rational& time, int track) const
 {
-  if (!is_using_standard_value(track)) {
-    const KeyframeTrack& key_track = keyframe_tracks_.at(track);
+  ValueSnapshotPtr snapshot = value_snapshot();
+
+  if (snapshot) {
+    return value_at_time_for_track(snapshot->standard_value,
+                                   snapshot->keyframe_tracks,
+                                   snapshot->keyframing,
+                                   time,
+                                   track);
+  }
+
+  return value_at_time_for_track(standard_value_, keyframe_tracks_, keyframing_, time, track);
+}
+
+QVariant NodeInput::value_at_time_for_track(const QVector<QVariant> &standard_value,
+                                            const QVector<KeyframeTrack> &keyframe_tracks,
+                                            bool keyframing,
+                                            const rational &time,
+                                            int track) const
+{
+  if (keyframing && !keyframe_tracks.at(track).isEmpty()) {
+    const KeyframeTrack& key_track = keyframe_tracks.at(track);
 
     if (key_track.first()->time() >= time) {
       // This time precedes any keyframe, so we just return the first value
@@ -442,18 +473,25 @@ QVariant NodeInput::get_value_at_time_for_track(const rational& time, int track)
     }
   }
 
-  return standard_value_.at(track);
+  return standard_value.at(track);
 }
 
 QList<NodeKeyframePtr> NodeInput::get_keyframe_at_time(const rational &time) const
 {
   QList<NodeKeyframePtr> keys;
 
-  for (int i=0;i<keyframe_tracks_.size();i++) {
-    NodeKeyframePtr key_at_time = get_keyframe_at_time_on_track(time, i);
+  ValueSnapshotPtr snapshot;
+  bool keyframing;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot, &keyframing);
 
-    if (key_at_time) {
-      keys.append(key_at_time);
+  if (keyframing) {
+    foreach (const KeyframeTrack& track, tracks) {
+      foreach (NodeKeyframePtr key, track) {
+        if (key->time() == time) {
+          keys.append(key);
+          break;
+        }
+      }
     }
   }
 
@@ -462,8 +500,12 @@ QList<NodeKeyframePtr> NodeInput::get_keyframe_at_time(const rational &time) con
 
 NodeKeyframePtr NodeInput::get_keyframe_at_time_on_track(const rational &time, int track) const
 {
-  if (!is_using_standard_value(track)) {
-    foreach (NodeKeyframePtr key, keyframe_tracks_.at(track)) {
+  ValueSnapshotPtr snapshot;
+  bool keyframing;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot, &keyframing);
+
+  if (keyframing) {
+    foreach (NodeKeyframePtr key, tracks.at(track)) {
       if (key->time() == time) {
         return key;
       }
@@ -475,11 +517,15 @@ NodeKeyframePtr NodeInput::get_keyframe_at_time_on_track(const rational &time, i
 
 NodeKeyframePtr NodeInput::get_closest_keyframe_to_time_on_track(const rational &time, int track) const
 {
-  if (is_using_standard_value(track)) {
+  ValueSnapshotPtr snapshot;
+  bool keyframing;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot, &keyframing);
+
+  if (!keyframing || tracks.at(track).isEmpty()) {
     return nullptr;
   }
 
-  const KeyframeTrack& key_track = keyframe_tracks_.at(track);
+  const KeyframeTrack& key_track = tracks.at(track);
 
   if (time <= key_track.first()->time()) {
     return key_track.first();
@@ -513,7 +559,10 @@ NodeKeyframePtr NodeInput::get_closest_keyframe_before_time(const rational &time
 {
   NodeKeyframePtr key = nullptr;
 
-  foreach (const KeyframeTrack& track, keyframe_tracks_) {
+  ValueSnapshotPtr snapshot;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot);
+
+  foreach (const KeyframeTrack& track, tracks) {
     foreach (NodeKeyframePtr k, track) {
       if (k->time() >= time) {
         break;
@@ -530,7 +579,10 @@ NodeKeyframePtr NodeInput::get_closest_keyframe_after_time(const rational &time)
 {
   NodeKeyframePtr key = nullptr;
 
-  foreach (const KeyframeTrack& track, keyframe_tracks_) {
+  ValueSnapshotPtr snapshot;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot);
+
+  foreach (const KeyframeTrack& track, tracks) {
     for (int i=track.size()-1;i>=0;i--) {
       NodeKeyframePtr k = track.at(i);
 
@@ -558,14 +610,19 @@ NodeKeyframe::Type NodeInput::get_best_keyframe_type_for_time(const rational &ti
 
 int NodeInput::get_number_of_keyframe_tracks() const
 {
-  return keyframe_tracks_.size();
+  ValueSnapshotPtr snapshot;
+
+  return current_keyframe_tracks(&snapshot).size();
 }
 
 NodeKeyframePtr NodeInput::get_earliest_keyframe() const
 {
   NodeKeyframePtr earliest = nullptr;
 
-  foreach (const KeyframeTrack& track, keyframe_tracks_) {
+  ValueSnapshotPtr snapshot;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot);
+
+  foreach (const KeyframeTrack& track, tracks) {
     if (!track.isEmpty()) {
       NodeKeyframePtr earliest_in_track = track.first();
 
@@ -583,7 +640,10 @@ NodeKeyframePtr NodeInput::get_latest_keyframe() const
 {
   NodeKeyframePtr latest = nullptr;
 
-  foreach (const KeyframeTrack& track, keyframe_tracks_) {
+  ValueSnapshotPtr snapshot;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot);
+
+  foreach (const KeyframeTrack& track, tracks) {
     if (!track.isEmpty()) {
       NodeKeyframePtr latest_in_track = track.last();
 
@@ -602,6 +662,7 @@ void NodeInput::insert_keyframe(NodeKeyframePtr key)
   Q_ASSERT(is_keyframable());
 
   insert_keyframe_internal(key);
+  increment_value_version();
 
   connect(key.get(), &NodeKeyframe::TimeChanged, this, &NodeInput::KeyframeTimeChanged);
   connect(key.get(), &NodeKeyframe::ValueChanged, this, &NodeInput::KeyframeValueChanged);
@@ -628,6 +689,7 @@ void NodeInput::remove_keyframe(NodeKeyframePtr key)
 
   keyframe_tracks_[key->track()].removeOne(key);
   key->set_parent(nullptr);
+  increment_value_version();
 
   emit KeyframeRemoved(key);
   emit_time_range(time_affected);
@@ -640,6 +702,8 @@ void NodeInput::KeyframeTimeChanged()
 
   Q_ASSERT(keyframe_index > -1);
 
+  increment_value_version();
+
   TimeRange original_range = get_range_around_index(keyframe_index, key->track());
 
   if (!(original_range.in() < key->time() && original_range.out() > key->time())) {
@@ -662,6 +726,8 @@ void NodeInput::KeyframeTimeChanged()
 
 void NodeInput::KeyframeValueChanged()
 {
+  increment_value_version();
+
   emit_range_affected_by_keyframe(static_cast<NodeKeyframe*>(sender()));
 }
 
@@ -670,6 +736,8 @@ void NodeInput::KeyframeTypeChanged()
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
   int keyframe_index = FindIndexOfKeyframeFromRawPtr(key);
 
+  increment_value_version();
+
   if (keyframe_tracks_.at(key->track()).size() == 1) {
     // If there are no other frames, the interpolation won't do anything
     return;
@@ -687,6 +755,8 @@ void NodeInput::KeyframeBezierInChanged()
   rational start = RATIONAL_MIN;
   rational end = key->time();
 
+  increment_value_version();
+
   if (keyframe_index > 0) {
     start = keyframe_tracks_.at(key->track()).at(keyframe_index - 1)->time();
   }
@@ -702,6 +772,8 @@ void NodeInput::KeyframeBezierOutChanged()
   rational start = key->time();
   rational end = RATIONAL_MAX;
 
+  increment_value_version();
+
   if (keyframe_index < keyframe_tracks_.at(key->track()).size() - 1) {
     end = keyframe_tracks_.at(key->track()).at(keyframe_index + 1)->time();
   }
@@ -745,7 +817,11 @@ void NodeInput::insert_keyframe_internal(NodeKeyframePtr key)
 
 bool NodeInput::is_using_standard_value(int track) const
 {
-  return (!is_keyframing() || keyframe_tracks_.at(track).isEmpty());
+  ValueSnapshotPtr snapshot;
+  bool keyframing;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot, &keyframing);
+
+  return (!keyframing || tracks.at(track).isEmpty());
 }
 
 TimeRange NodeInput::get_range_affected_by_keyframe(NodeKeyframe *key) const
@@ -787,6 +863,13 @@ TimeRange NodeInput::get_range_around_index(int index, int track) const
   return TimeRange(range_begin, range_end);
 }
 
+void NodeInput::increment_value_version()
+{
+  value_version_++;
+
+  emit ValueVersionChanged();
+}
+
 void NodeInput::emit_time_range(const TimeRange &range)
 {
   emit ValueChanged(range.in(), range.out());
@@ -799,12 +882,16 @@ void NodeInput::emit_range_affected_by_keyframe(NodeKeyframe *key)
 
 bool NodeInput::has_keyframe_at_time(const rational &time) const
 {
-  if (!is_keyframing()) {
+  ValueSnapshotPtr snapshot;
+  bool keyframing;
+  const QVector<KeyframeTrack>& tracks = current_keyframe_tracks(&snapshot, &keyframing);
+
+  if (!keyframing) {
     return false;
   }
 
   // Loop through keyframes to see if any match
-  foreach (const KeyframeTrack& track, keyframe_tracks_) {
+  foreach (const KeyframeTrack& track, tracks) {
     foreach (NodeKeyframePtr key, track) {
       if (key->time() == time) {
         return true;
@@ -818,12 +905,15 @@ bool NodeInput::has_keyframe_at_time(const rational &time) const
 
 bool NodeInput::is_keyframing() const
 {
-  return keyframing_;
+  ValueSnapshotPtr snapshot = value_snapshot();
+
+  return snapshot ? snapshot->keyframing : keyframing_;
 }
 
 void NodeInput::set_is_keyframing(bool k)
 {
   keyframing_ = k;
+  increment_value_version();
 
   emit KeyframeEnableChanged(keyframing_);
 }
@@ -835,17 +925,20 @@ bool NodeInput::is_keyframable() const
 
 QVariant NodeInput::get_standard_value() const
 {
-  return combine_track_values_into_normal_value(standard_value_);
+  return combine_track_values_into_normal_value(get_split_standard_value());
 }
 
-const QVector<QVariant> &NodeInput::get_split_standard_value() const
+QVector<QVariant> NodeInput::get_split_standard_value() const
 {
-  return standard_value_;
+  ValueSnapshotPtr snapshot = value_snapshot();
+
+  return snapshot ? snapshot->standard_value : standard_value_;
 }
 
 void NodeInput::set_standard_value(const QVariant &value, int track)
 {
   standard_value_.replace(track, value);
+  increment_value_version();
 
   if (is_using_standard_value(track)) {
     // If this standard value is being used, we need to send a value changed signal
@@ -853,9 +946,11 @@ void NodeInput::set_standard_value(const QVariant &value, int track)
   }
 }
 
-const QVector<NodeInput::KeyframeTrack> &NodeInput::keyframe_tracks() const
+QVector<NodeInput::KeyframeTrack> NodeInput::keyframe_tracks() const
 {
-  return keyframe_tracks_;
+  ValueSnapshotPtr snapshot = value_snapshot();
+
+  return snapshot ? snapshot->keyframe_tracks : keyframe_tracks_;
 }
 
 void NodeInput::set_is_keyframable(bool k)
@@ -879,7 +974,11 @@ void NodeInput::CopyValues(NodeInput *source, NodeInput *dest, bool include_conn
   }
 
   // Copy keyframing state
-  dest->set_is_keyframing(source->is_keyframing());
+  dest->set_is_keyframing(source->keyframing_);
+
+  // Destination now holds these values itself and is as up to date as the source
+  std::atomic_store(&dest->value_snapshot_, ValueSnapshotPtr());
+  dest->value_version_ = source->value_version_;
 
   // Copy connections
   if (include_connections && source->get_connected_output() != nullptr) {
@@ -901,6 +1000,82 @@ void NodeInput::CopyValues(NodeInput *source, NodeInput *dest, bool include_conn
   emit dest->ValueChanged(RATIONAL_MIN, RATIONAL_MAX);
 }
 
+quint64 NodeInput::value_version() const
+{
+  return value_version_;
+}
+
+const QVector<NodeInput::KeyframeTrack> &NodeInput::current_keyframe_tracks(ValueSnapshotPtr *snapshot,
+                                                                            bool *keyframing) const
+{
+  *snapshot = value_snapshot();
+
+  if (*snapshot) {
+    if (keyframing) {
+      *keyframing = (*snapshot)->keyframing;
+    }
+
+    return (*snapshot)->keyframe_tracks;
+  }
+
+  if (keyframing) {
+    *keyframing = keyframing_;
+  }
+
+  return keyframe_tracks_;
+}
+
+NodeInput::ValueSnapshotPtr NodeInput::CreateValueSnapshot() const
+{
+  std::shared_ptr<ValueSnapshot> snapshot = std::make_shared<ValueSnapshot>();
+
+  snapshot->standard_value = standard_value_;
+  snapshot->keyframing = keyframing_;
+  snapshot->version = value_version_;
+
+  // Keyframes are QObjects that the UI can keep modifying, so the snapshot gets its own copies
+  snapshot->keyframe_tracks.resize(keyframe_tracks_.size());
+
+  for (int i=0;i<keyframe_tracks_.size();i++) {
+    foreach (NodeKeyframePtr key, keyframe_tracks_.at(i)) {
+      NodeKeyframe* copy = new NodeKeyframe(key->time(), key->value(), key->type(), key->track());
+      copy->set_bezier_control_in(key->bezier_control_in());
+      copy->set_bezier_control_out(key->bezier_control_out());
+
+      // The last reference to a snapshot is often dropped by a render thread, but the copies belong to this thread so
+      // they must be destroyed by it
+      snapshot->keyframe_tracks[i].append(NodeKeyframePtr(copy, [](NodeKeyframe* k){ k->deleteLater(); }));
+    }
+  }
+
+  return snapshot;
+}
+
+void NodeInput::SetValueSnapshot(NodeInput::ValueSnapshotPtr snapshot, bool notify)
+{
+  std::atomic_store(&value_snapshot_, snapshot);
+  value_version_ = snapshot->version;
+
+  if (notify) {
+    emit ValueChanged(RATIONAL_MIN, RATIONAL_MAX);
+  }
+}
+
+bool NodeInput::is_structural() const
+{
+  return structural_;
+}
+
+void NodeInput::set_is_structural(bool e)
+{
+  structural_ = e;
+}
+
+NodeInput::ValueSnapshotPtr NodeInput::value_snapshot() const
+{
+  return std::atomic_load(&value_snapshot_);
+}
+
 void NodeInput::set_property(const QString &key, const QVariant &value)
 {
   properties_.insert(key, value);
@@ -21,6 +21,8 @@
 #ifndef NODEINPUT_H
 #define NODEINPUT_H
 
+#include <memory>
+
 #include "common/timerange.h"
 #include "keyframe.h"
 #include "param.h"
@@ -34,6 +36,22 @@ class NodeInput : public NodeParam
 public:
   using KeyframeTrack = QList<NodeKeyframePtr>;
 
+  /**
+   * @brief An immutable copy of an input's values, keyframes and keyframing state
+   *
+   * Render backends keep the inputs of their copy of the graph up to date by handing them snapshots of the inputs
+   * that changed (see SetValueSnapshot()). Render threads can carry on reading the previous snapshot while it's being
+   * replaced, so the backend doesn't have to wait for them to finish first.
+   */
+  struct ValueSnapshot {
+    QVector<QVariant> standard_value;
+    QVector<KeyframeTrack> keyframe_tracks;
+    bool keyframing;
+    quint64 version;
+  };
+
+  using ValueSnapshotPtr = std::shared_ptr<const ValueSnapshot>;
+
   /**
    * @brief NodeInput Constructor
    *
@@ -199,7 +217,7 @@ public:
   /**
    * @brief Get non-keyframed value split into components (the way it's stored)
    */
-  const QVector<QVariant>& get_split_standard_value() const;
+  QVector<QVariant> get_split_standard_value() const;
 
   /**
    * @brief Set non-keyframed value
@@ -209,7 +227,7 @@ public:
   /**
    * @brief Return list of keyframes in this parameter
    */
-  const QVector<KeyframeTrack> &keyframe_tracks() const;
+  QVector<KeyframeTrack> keyframe_tracks() const;
 
   /**
    * @brief Set whether this input can be keyframed or not
@@ -221,6 +239,43 @@ public:
    */
   static void CopyValues(NodeInput* source, NodeInput* dest, bool include_connections = true);
 
+  /**
+   * @brief Changes every time this input's values, keyframes or keyframing state change
+   *
+   * An input that was copied with CopyValues() or given a snapshot takes on the version of what it copied, so
+   * comparing versions tells whether a copy is out of date.
+   */
+  quint64 value_version() const;
+
+  /**
+   * @brief Create a snapshot of this input's current values (deep copying its keyframes)
+   */
+  ValueSnapshotPtr CreateValueSnapshot() const;
+
+  /**
+   * @brief Read values from a snapshot from now on instead of this input's own values
+   *
+   * Safe to call while other threads are reading values from this input, they'll either see the previous snapshot or
+   * this one. If `notify` is true, ValueChanged() is emitted, which is only safe if no other thread is using this
+   * input's Node (see is_structural()).
+   *
+   * Every getter reads from the snapshot, including the keyframe queries, which return the snapshot's copies of the
+   * keyframes. Editing functions such as insert_keyframe() and remove_keyframe() only change this input's own values,
+   * which the snapshot hides, so they mustn't be used on an input that has one.
+   */
+  void SetValueSnapshot(ValueSnapshotPtr snapshot, bool notify);
+
+  /**
+   * @brief Return whether the Node derives any state from this input's changes
+   *
+   * Nodes that connect to their own input's ValueChanged() to update something (e.g. a Block's length or a
+   * MediaInput's footage) set this, so render backends know to wait until the copied graph is idle before updating the
+   * input and to emit ValueChanged() when they do.
+   */
+  bool is_structural() const;
+
+  void set_is_structural(bool e);
+
   /**
    * @brief Set an arbitrary property on this input to influence a UI representation's behavior
    *
@@ -269,6 +324,14 @@ signals:
 
   void PropertyChanged(const QString& s, const QVariant& v);
 
+  /**
+   * @brief Emitted whenever value_version() changes because of an edit to this input
+   *
+   * Unlike ValueChanged(), this is emitted for every change, including ones that don't affect the output (e.g. the
+   * standard value of a keyframed input).
+   */
+  void ValueVersionChanged();
+
 protected:
   virtual void LoadInternal(QXmlStreamReader* reader, QHash<quintptr, NodeOutput*>& param_ptrs, QList<SerializedConnection> &input_connections, QList<FootageConnection>& footage_connections, const QAtomicInt* cancelled);
 
@@ -302,6 +365,27 @@ private:
    */
   bool is_using_standard_value(int track) const;
 
+  /**
+   * @brief Returns the snapshot set with SetValueSnapshot() or nullptr if this input uses its own values
+   */
+  ValueSnapshotPtr value_snapshot() const;
+
+  /**
+   * @brief The keyframe tracks (and keyframing state) to read from, either the snapshot's or this input's own
+   *
+   * `snapshot` is set to the snapshot being read from, which must be held for as long as the tracks are used.
+   */
+  const QVector<KeyframeTrack>& current_keyframe_tracks(ValueSnapshotPtr* snapshot, bool* keyframing = nullptr) const;
+
+  /**
+   * @brief get_value_at_time_for_track() on either this input's own values or a snapshot's
+   */
+  QVariant value_at_time_for_track(const QVector<QVariant>& standard_value,
+                                   const QVector<KeyframeTrack>& keyframe_tracks,
+                                   bool keyframing,
+                                   const rational& time,
+                                   int track) const;
+
   /**
    * @brief Intelligently determine how what time range is affected by a keyframe
    */
@@ -312,6 +396,11 @@ private:
    */
   TimeRange get_range_around_index(int index, int track) const;
 
+  /**
+   * @brief Mark this input's values as changed, see value_version()
+   */
+  void increment_value_version();
+
   /**
    * @brief Convenience function - equivalent to calling `emit ValueChanged(range.in(), range.out())`
    */
@@ -351,6 +440,12 @@ private:
    */
   bool keyframing_;
 
+  quint64 value_version_;
+
+  ValueSnapshotPtr value_snapshot_;
+
+  bool structural_;
+
   /**
    * @brief Internal properties variable
    */
@@ -28,6 +28,7 @@ MediaInput::MediaInput() :
   footage_input_ = new NodeInput("footage_in", NodeInput::kFootage);
   footage_input_->SetConnectable(false);
   footage_input_->set_is_keyframable(false);
+  footage_input_->set_is_structural(true);
   connect(footage_input_, SIGNAL(ValueChanged(const rational&, const rational&)), this, SLOT(FootageChanged()));
   AddInput(footage_input_);
 }
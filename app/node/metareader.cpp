@@ -7,8 +7,7 @@
 
 NodeMetaReader::NodeMetaReader(const QString &xml_meta_filename) :
   xml_filename_(xml_meta_filename),
-  iterations_(1),
-  iteration_input_(nullptr)
+  iterations_(1)
 {
   QFile metadata_file(xml_filename_);
 
@@ -69,24 +68,39 @@ const int &NodeMetaReader::iterations() const
   return iterations_;
 }
 
-NodeInput *NodeMetaReader::iteration_input() const
+const QString &NodeMetaReader::iteration_input_id() const
 {
-  return iteration_input_;
+  return iteration_input_id_;
 }
 
-const QList<NodeInput *> &NodeMetaReader::inputs() const
+QList<NodeInput *> NodeMetaReader::CreateInputs() const
 {
-  return inputs_;
+  QList<NodeInput*> inputs;
+
+  foreach (const ParamDescriptor& param, params_) {
+    NodeInput* input = new NodeInput(param.id, param.type, param.default_value);
+
+    QHash<QString, QVariant>::const_iterator iterator;
+
+    for (iterator=param.properties.begin();iterator!=param.properties.end();iterator++) {
+      input->set_property(iterator.key(), iterator.value());
+    }
+
+    inputs.append(input);
+  }
+
+  return inputs;
 }
 
-void NodeMetaReader::Retranslate()
+void NodeMetaReader::Retranslate(const QList<NodeInput *> &inputs) const
 {
-  QMap<QString, QMap<QString, QString> >::const_iterator iterator;
+  // Find each input's language table, if we have one
+  foreach (NodeInput* input, inputs) {
+    QMap<QString, QMap<QString, QString> >::const_iterator names = param_names_.constFind(input->id());
 
-  // Iterate through parameter language tables that we have
-  for (iterator=param_names_.begin();iterator!=param_names_.end();iterator++) {
-    NodeInput* this_input = GetInputWithID(iterator.key());
-    this_input->set_name(GetStringForCurrentLanguage(&iterator.value()));
+    if (names != param_names_.constEnd()) {
+      input->set_name(GetStringForCurrentLanguage(&names.value()));
+    }
   }
 }
 
@@ -221,19 +235,11 @@ void NodeMetaReader::XMLReadParam(QXmlStreamReader *reader)
     }
   }
 
-  NodeInput* input = new NodeInput(param_id, param_type, default_val);
-
-  QHash<QString, QVariant>::const_iterator iterator;
-
-  for (iterator=properties.begin();iterator!=properties.end();iterator++) {
-    input->set_property(iterator.key(), iterator.value());
-  }
-
   if (is_iterative) {
-    iteration_input_ = input;
+    iteration_input_id_ = param_id;
   }
 
-  inputs_.append(input);
+  params_.append({param_id, param_type, default_val, properties});
 }
 
 void NodeMetaReader::XMLReadShader(QXmlStreamReader *reader, QString &destination)
@@ -293,13 +299,3 @@ QString NodeMetaReader::GetStringForCurrentLanguage(const QMap<QString, QString>
   // (assume a string in the wrong language is better than no string at all)
   return language_map->first();
 }
-
-NodeInput *NodeMetaReader::GetInputWithID(const QString &id) const
-{
-  foreach (NodeInput* input, inputs_) {
-    if (input->id() == id) {
-      return input;
-    }
-  }
-  return nullptr;
-}
@@ -1,12 +1,23 @@
 #ifndef NODEMETAREADER_H
 #define NODEMETAREADER_H
 
+#include <memory>
 #include <QMap>
 #include <QString>
 #include <QXmlStreamReader>
 
 #include "input.h"
 
+class NodeMetaReader;
+using NodeMetaReaderPtr = std::shared_ptr<const NodeMetaReader>;
+
+/**
+ * @brief Effect metadata read from an XML file (and the shader code it refers to)
+ *
+ * This never changes once it's been read, so every node created from the same file shares one instance through a
+ * NodeMetaReaderPtr instead of parsing the XML and reading its shaders again. Nodes own their inputs, so rather than
+ * holding inputs itself, this describes them and creates a new set for each node with CreateInputs().
+ */
 class NodeMetaReader
 {
 public:
@@ -23,13 +34,26 @@ public:
   const QString& vert_code() const;
 
   const int& iterations() const;
-  NodeInput* iteration_input() const;
+  const QString& iteration_input_id() const;
 
-  const QList<NodeInput*>& inputs() const;
+  /**
+   * @brief Create the inputs this metadata describes, ownership is passed to the caller
+   */
+  QList<NodeInput*> CreateInputs() const;
 
-  void Retranslate();
+  /**
+   * @brief Name inputs created by CreateInputs() in the current language
+   */
+  void Retranslate(const QList<NodeInput*>& inputs) const;
 
 private:
+  struct ParamDescriptor {
+    QString id;
+    NodeParam::DataType type;
+    QVariant default_value;
+    QHash<QString, QVariant> properties;
+  };
+
   void XMLReadLanguageString(QXmlStreamReader* reader, QMap<QString, QString>* map);
   void XMLReadEffect(QXmlStreamReader *reader);
   void XMLReadIterations(QXmlStreamReader* reader);
@@ -38,8 +62,6 @@ private:
 
   static QString GetStringForCurrentLanguage(const QMap<QString, QString> *language_map);
 
-  NodeInput* GetInputWithID(const QString& id) const;
-
   QString xml_filename_;
 
   QMap<QString, QString> names_;
@@ -53,9 +75,9 @@ private:
   QString vert_code_;
 
   int iterations_;
-  NodeInput* iteration_input_;
+  QString iteration_input_id_;
 
-  QList<NodeInput*> inputs_;
+  QList<ParamDescriptor> params_;
 };
 
 #endif // NODEMETAREADER_H
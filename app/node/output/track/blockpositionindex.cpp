@@ -0,0 +1,112 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "blockpositionindex.h"
+
+int BlockPositionIndex::size() const
+{
+  return lengths_.size();
+}
+
+void BlockPositionIndex::Resize(int size)
+{
+  if (size < lengths_.size()) {
+    // Nodes only ever cover lengths before them, so the remaining nodes are still correct
+    lengths_.resize(size);
+    tree_.resize(size + 1);
+    return;
+  }
+
+  if (tree_.isEmpty()) {
+    tree_.append(rational());
+  }
+
+  while (lengths_.size() < size) {
+    int i = lengths_.size() + 1;
+
+    // A new (zero-length) node covers the range (i - LowestBit(i), i], which is everything before it in that range
+    tree_.append(PositionOf(i - 1) - PositionOf(i - LowestBit(i)));
+    lengths_.append(rational());
+  }
+}
+
+const rational &BlockPositionIndex::LengthAt(int index) const
+{
+  return lengths_.at(index);
+}
+
+void BlockPositionIndex::SetLengthAt(int index, const rational &length)
+{
+  rational delta = length - lengths_.at(index);
+
+  if (delta == 0) {
+    return;
+  }
+
+  lengths_.replace(index, length);
+
+  for (int i=index+1;i<tree_.size();i+=LowestBit(i)) {
+    tree_[i] += delta;
+  }
+}
+
+rational BlockPositionIndex::PositionOf(int index) const
+{
+  rational sum;
+
+  for (int i=index;i>0;i-=LowestBit(i)) {
+    sum += tree_.at(i);
+  }
+
+  return sum;
+}
+
+rational BlockPositionIndex::Total() const
+{
+  return PositionOf(lengths_.size());
+}
+
+int BlockPositionIndex::IndexOfFirstEndingAfter(const rational &time) const
+{
+  int step = 1;
+
+  while (step * 2 <= lengths_.size()) {
+    step *= 2;
+  }
+
+  // Walk down the tree, skipping every range that ends at or before `time`
+  int index = 0;
+  rational remaining = time;
+
+  for (;step>0;step/=2) {
+    int next = index + step;
+
+    if (next <= lengths_.size() && tree_.at(next) <= remaining) {
+      index = next;
+      remaining -= tree_.at(next);
+    }
+  }
+
+  return index;
+}
+
+int BlockPositionIndex::LowestBit(int i)
+{
+  return i & -i;
+}
@@ -0,0 +1,73 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#ifndef BLOCKPOSITIONINDEX_H
+#define BLOCKPOSITIONINDEX_H
+
+#include <QVector>
+
+#include "common/rational.h"
+
+/**
+ * @brief Fenwick tree of block lengths that a TrackOutput derives its block positions from
+ *
+ * Changing a length, appending or removing from the end and looking up the time at which an index starts are all
+ * O(log n), so trimming a block in the middle of a long track no longer means recalculating every block after it.
+ */
+class BlockPositionIndex
+{
+public:
+  BlockPositionIndex() = default;
+
+  int size() const;
+
+  /**
+   * @brief Grow (with zero lengths) or shrink the index
+   */
+  void Resize(int size);
+
+  const rational& LengthAt(int index) const;
+
+  void SetLengthAt(int index, const rational& length);
+
+  /**
+   * @brief Returns the sum of the lengths before `index`, i.e. the time the block at `index` starts
+   */
+  rational PositionOf(int index) const;
+
+  rational Total() const;
+
+  /**
+   * @brief Returns the first index whose block ends after `time`, or size() if there is none
+   */
+  int IndexOfFirstEndingAfter(const rational& time) const;
+
+private:
+  static int LowestBit(int i);
+
+  /**
+   * @brief Fenwick tree, one-based so tree_.at(0) is unused
+   */
+  QVector<rational> tree_;
+
+  QVector<rational> lengths_;
+
+};
+
+#endif // BLOCKPOSITIONINDEX_H
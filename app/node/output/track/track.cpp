@@ -27,7 +27,12 @@
 #include "node/block/gap/gap.h"
 #include "node/graph.h"
 
+int TrackOutput::edit_transaction_depth_ = 0;
+QVector<TrackOutput*> TrackOutput::edited_tracks_;
+
 TrackOutput::TrackOutput() :
+  pending_blocks_moved_(false),
+  pending_length_changed_(false),
   track_type_(Timeline::kTrackTypeNone),
   block_invalidate_cache_stack_(0),
   index_(-1),
@@ -48,6 +53,20 @@ TrackOutput::TrackOutput() :
   track_height_ = GetDefaultTrackHeight();
 }
 
+TrackOutput::~TrackOutput()
+{
+  edited_tracks_.removeOne(this);
+
+  // Blocks still referring to our position index keep their current positions instead
+  foreach (Block* block, block_cache_) {
+    if (block) {
+      block->set_in(block->in());
+      block->set_out(block->out());
+      block->set_track_position(nullptr, -1);
+    }
+  }
+}
+
 void TrackOutput::set_track_type(const Timeline::TrackType &track_type)
 {
   track_type_ = track_type;
@@ -127,12 +146,10 @@ void TrackOutput::SetIndex(const int &index)
 
 Block *TrackOutput::BlockContainingTime(const rational &time) const
 {
-  foreach (Block* block, block_cache_) {
-    if (block->in() < time && block->out() > time) {
-      return block;
-    } else if (block->out() == time) {
-      break;
-    }
+  int index = IndexOfFirstBlockEndingAfter(time);
+
+  if (index < block_cache_.size() && InPointOfIndex(index) < time) {
+    return block_cache_.at(index);
   }
 
   return nullptr;
@@ -140,50 +157,43 @@ Block *TrackOutput::BlockContainingTime(const rational &time) const
 
 Block *TrackOutput::NearestBlockBefore(const rational &time) const
 {
-  foreach (Block* block, block_cache_) {
-    // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
-    if (block->out() >= time) {
-      return block;
+  int index = IndexOfFirstBlockEndingAfter(time);
+
+  // A block that ends precisely at this time comes first
+  for (int i=index-1;i>=0 && OutPointOfIndex(i)==time;i--) {
+    if (block_cache_.at(i)) {
+      index = i;
     }
   }
 
-  return nullptr;
+  return (index < block_cache_.size()) ? block_cache_.at(index) : nullptr;
 }
 
 Block *TrackOutput::NearestBlockBeforeOrAt(const rational &time) const
 {
-  foreach (Block* block, block_cache_) {
-    // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
-    if (block->out() > time) {
-      return block;
-    }
-  }
+  int index = IndexOfFirstBlockEndingAfter(time);
 
-  return nullptr;
+  return (index < block_cache_.size()) ? block_cache_.at(index) : nullptr;
 }
 
 Block *TrackOutput::NearestBlockAfterOrAt(const rational &time) const
 {
-  foreach (Block* block, block_cache_) {
-    // Blocks are sorted by time, so the first Block after this time is the correct Block
-    if (block->in() >= time) {
-      return block;
-    }
+  int index = IndexOfFirstBlockEndingAfter(time);
+
+  if (index < block_cache_.size() && InPointOfIndex(index) < time) {
+    // This block started before the time, so the correct Block is the one after it
+    index = IndexOfNextBlock(index + 1);
   }
 
-  return nullptr;
+  return (index < block_cache_.size()) ? block_cache_.at(index) : nullptr;
 }
 
 Block *TrackOutput::NearestBlockAfter(const rational &time) const
 {
-  foreach (Block* block, block_cache_) {
-    // Blocks are sorted by time, so the first Block after this time is the correct Block
-    if (block->in() > time) {
-      return block;
-    }
-  }
+  // The first Block that ends after this time starts at or before it, so the correct Block is the one after it
+  int index = IndexOfNextBlock(IndexOfFirstBlockEndingAfter(time) + 1);
 
-  return nullptr;
+  return (index < block_cache_.size()) ? block_cache_.at(index) : nullptr;
 }
 
 Block *TrackOutput::BlockAtTime(const rational &time) const
@@ -192,17 +202,31 @@ Block *TrackOutput::BlockAtTime(const rational &time) const
     return nullptr;
   }
 
-  foreach (Block* block, block_cache_) {
-    if (block
-        && block->in() <= time
-        && block->out() > time) {
-      return block;
-    }
+  int index = IndexOfFirstBlockEndingAfter(time);
+
+  if (index < block_cache_.size() && InPointOfIndex(index) <= time) {
+    return block_cache_.at(index);
   }
 
   return nullptr;
 }
 
+int TrackOutput::IndexOfFirstBlockEndingAfter(const rational &time) const
+{
+  // Empty slots have no length, so this always lands on a Block
+  return block_positions_.IndexOfFirstEndingAfter(time);
+}
+
+rational TrackOutput::InPointOfIndex(int index) const
+{
+  return block_positions_.PositionOf(index);
+}
+
+rational TrackOutput::OutPointOfIndex(int index) const
+{
+  return block_positions_.PositionOf(index) + block_positions_.LengthAt(index);
+}
+
 QList<Block *> TrackOutput::BlocksAtTimeRange(const TimeRange &range) const
 {
   QList<Block*> list;
@@ -211,10 +235,14 @@ QList<Block *> TrackOutput::BlocksAtTimeRange(const TimeRange &range) const
     return list;
   }
 
-  foreach (Block* block, block_cache_) {
-    if (block
-        && block->out() > range.in()
-        && block->in() < range.out()) {
+  for (int i=IndexOfFirstBlockEndingAfter(range.in());i<block_cache_.size();i++) {
+    Block* block = block_cache_.at(i);
+
+    if (block) {
+      if (block->in() >= range.out()) {
+        break;
+      }
+
       list.append(block);
     }
   }
@@ -230,7 +258,12 @@ const QVector<Block *> &TrackOutput::Blocks() const
 void TrackOutput::InvalidateCache(const rational &start_range, const rational &end_range, NodeInput *from)
 {
   if (block_invalidate_cache_stack_ == 0) {
-    Node::InvalidateCache(qMax(start_range, rational(0)), qMin(end_range, track_length()), from);
+    if (edit_transaction_depth_ > 0) {
+      pending_invalidation_.InsertTimeRange(TimeRange(qMax(start_range, rational(0)), qMin(end_range, track_length())));
+      MarkEdited();
+    } else {
+      Node::InvalidateCache(qMax(start_range, rational(0)), qMin(end_range, track_length()), from);
+    }
   }
 }
 
@@ -414,43 +447,97 @@ void TrackOutput::SetLocked(bool e)
   locked_ = e;
 }
 
-void TrackOutput::UpdateInOutFrom(int index)
+void TrackOutput::UpdateLengthAtIndex(int index)
 {
   Q_ASSERT(index >= 0);
   Q_ASSERT(index < block_cache_.size());
 
-  rational new_track_length;
+  Block* b = block_cache_.at(index);
 
-  // Find block just before this one to find the last out point
-  for (int i=index-1;i>=0;i--) {
-    Block* b = block_cache_.at(i);
-
-    if (b) {
-      new_track_length = b->out();
-      break;
-    }
-  }
+  // Every Block's position is derived from the index, so this is all that needs to change
+  block_positions_.SetLengthAt(index, b ? b->length() : rational());
 
-  for (int i=index;i<block_cache_.size();i++) {
-    Block* b = block_cache_.at(i);
+  bool deferred = (edit_transaction_depth_ > 0);
 
+  if (deferred) {
+    pending_blocks_moved_ = true;
+    MarkEdited();
+  } else {
     if (b) {
-      // Set in
-      b->set_in(new_track_length);
-
-      // Set out
-      new_track_length += b->length();
-      b->set_out(new_track_length);
-
       emit b->Refreshed();
     }
+
+    emit BlocksMoved();
   }
 
   // Update track length
+  rational new_track_length = block_positions_.Total();
+
   if (new_track_length != track_length_) {
     track_length_ = new_track_length;
+
+    if (deferred) {
+      pending_length_changed_ = true;
+    } else {
+      emit TrackLengthChanged();
+    }
+  }
+}
+
+int TrackOutput::IndexOfNextBlock(int index) const
+{
+  while (index < block_cache_.size() && !block_cache_.at(index)) {
+    index++;
+  }
+
+  return index;
+}
+
+void TrackOutput::MarkEdited()
+{
+  if (!edited_tracks_.contains(this)) {
+    edited_tracks_.append(this);
+  }
+}
+
+void TrackOutput::CommitEdit()
+{
+  if (pending_blocks_moved_) {
+    pending_blocks_moved_ = false;
+    emit BlocksMoved();
+  }
+
+  if (pending_length_changed_) {
+    pending_length_changed_ = false;
     emit TrackLengthChanged();
   }
+
+  TimeRangeList invalidated = pending_invalidation_;
+  pending_invalidation_.clear();
+
+  foreach (const TimeRange& range, invalidated) {
+    Node::InvalidateCache(range.in(), range.out());
+  }
+}
+
+TrackOutput::EditTransaction::EditTransaction()
+{
+  edit_transaction_depth_++;
+}
+
+TrackOutput::EditTransaction::~EditTransaction()
+{
+  edit_transaction_depth_--;
+
+  if (edit_transaction_depth_ == 0) {
+    // Committing may cause further edits (and therefore further commits), so take the list first
+    QVector<TrackOutput*> tracks = edited_tracks_;
+    edited_tracks_.clear();
+
+    foreach (TrackOutput* track, tracks) {
+      track->CommitEdit();
+    }
+  }
 }
 
 void TrackOutput::UpdatePreviousAndNextOfIndex(int index)
@@ -508,7 +595,12 @@ void TrackOutput::BlockConnected(NodeEdgePtr edge)
   Block* connected_block = connected_node->IsBlock() ? static_cast<Block*>(connected_node) : nullptr;
   block_cache_.replace(block_index, connected_block);
   UpdatePreviousAndNextOfIndex(block_index);
-  UpdateInOutFrom(block_index);
+
+  if (connected_block) {
+    connected_block->set_track_position(this, block_index);
+  }
+
+  UpdateLengthAtIndex(block_index);
 
   if (connected_block) {
     connect(connected_block, SIGNAL(LengthChanged(const rational&)), this, SLOT(BlockLengthChanged()));
@@ -523,12 +615,20 @@ void TrackOutput::BlockDisconnected(NodeEdgePtr edge)
 
   Q_ASSERT(block_index >= 0);
 
+  Node* connected_node = edge->output()->parentNode();
+  Block* connected_block = connected_node->IsBlock() ? static_cast<Block*>(connected_node) : nullptr;
+
+  if (connected_block) {
+    // Let the Block remember where it was, e.g. for undo commands that still refer to it
+    connected_block->set_in(connected_block->in());
+    connected_block->set_out(connected_block->out());
+    connected_block->set_track_position(nullptr, -1);
+  }
+
   block_cache_.replace(block_index, nullptr);
   UpdatePreviousAndNextOfIndex(block_index);
-  UpdateInOutFrom(block_index);
+  UpdateLengthAtIndex(block_index);
 
-  Node* connected_node = edge->output()->parentNode();
-  Block* connected_block = connected_node->IsBlock() ? static_cast<Block*>(connected_node) : nullptr;
   if (connected_block) {
     disconnect(connected_block, SIGNAL(LengthChanged(const rational&)), this, SLOT(BlockLengthChanged()));
 
@@ -547,6 +647,8 @@ void TrackOutput::BlockListSizeChanged(int size)
   for (int i=old_size;i<size;i++) {
     block_cache_.replace(i, nullptr);
   }
+
+  block_positions_.Resize(size);
 }
 
 void TrackOutput::BlockLengthChanged()
@@ -554,9 +656,9 @@ void TrackOutput::BlockLengthChanged()
   // Assumes sender is a Block
   Block* b = static_cast<Block*>(sender());
 
-  int index = block_cache_.indexOf(b);
+  int index = b->track_index();
 
-  Q_ASSERT(index >= 0);
+  Q_ASSERT(index >= 0 && block_cache_.at(index) == b);
 
-  UpdateInOutFrom(index);
+  UpdateLengthAtIndex(index);
 }
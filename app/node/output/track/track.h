@@ -21,7 +21,10 @@
 #ifndef TRACKOUTPUT_H
 #define TRACKOUTPUT_H
 
+#include "common/constructors.h"
 #include "common/timelinecommon.h"
+#include "common/timerange.h"
+#include "blockpositionindex.h"
 #include "node/block/block.h"
 
 /**
@@ -33,6 +36,28 @@ class TrackOutput : public Block
 public:
   TrackOutput();
 
+  virtual ~TrackOutput() override;
+
+  /**
+   * @brief Groups edits to any number of tracks so they notify everything else only once
+   *
+   * While at least one transaction exists, tracks keep their block positions up to date (edits often depend on the
+   * result of a previous one) but hold back BlocksMoved(), TrackLengthChanged() and cache invalidation. When the
+   * outermost transaction ends, each edited track emits BlocksMoved() and TrackLengthChanged() once if necessary, and
+   * invalidates the coalesced set of ranges that were touched.
+   *
+   * Transactions may be nested and must only be used from the main thread.
+   */
+  class EditTransaction
+  {
+  public:
+    EditTransaction();
+
+    ~EditTransaction();
+
+    DISABLE_COPY_MOVE(EditTransaction)
+  };
+
   const Timeline::TrackType& track_type();
   void set_track_type(const Timeline::TrackType& track_type);
 
@@ -78,6 +103,24 @@ public:
   Block* NearestBlockAfter(const rational& time) const;
 
   Block* BlockAtTime(const rational& time) const;
+
+  /**
+   * @brief Returns the index in Blocks() of the first block that ends AFTER a given time
+   *
+   * Blocks are sorted by time so this is a binary search, use it instead of iterating Blocks() from the start when only
+   * a window of time is needed. Returns the size of Blocks() if no block ends after the given time.
+   */
+  int IndexOfFirstBlockEndingAfter(const rational& time) const;
+
+  /**
+   * @brief Returns the time at which the slot at `index` in Blocks() starts
+   *
+   * Blocks derive their in() and out() from these, both are O(log n).
+   */
+  rational InPointOfIndex(int index) const;
+
+  rational OutPointOfIndex(int index) const;
+
   QList<Block*> BlocksAtTimeRange(const TimeRange& range) const;
 
   const QVector<Block*>& Blocks() const;
@@ -171,6 +214,14 @@ signals:
    */
   void TrackLengthChanged();
 
+  /**
+   * @brief Signal emitted when a Block's length changed, which moves every Block after it
+   *
+   * Blocks after the changed one aren't sent Block::Refreshed() individually, UI widgets that show them should update
+   * whatever is visible when they receive this.
+   */
+  void BlocksMoved();
+
   /**
    * @brief Signal emitted when the height of the track has changed
    */
@@ -179,12 +230,42 @@ signals:
 protected:
 
 private:
-  void UpdateInOutFrom(int index);
+  /**
+   * @brief Bring the position index up to date with the Block (or empty slot) at `index`
+   */
+  void UpdateLengthAtIndex(int index);
+
+  /**
+   * @brief Returns the first index at or after `index` that holds a Block, or the size of Blocks() if there is none
+   */
+  int IndexOfNextBlock(int index) const;
+
+  /**
+   * @brief Add this track to the tracks that will be notified when the current EditTransaction ends
+   */
+  void MarkEdited();
+
+  /**
+   * @brief Send everything that was held back while an EditTransaction was active
+   */
+  void CommitEdit();
+
+  static int edit_transaction_depth_;
+
+  static QVector<TrackOutput*> edited_tracks_;
+
+  bool pending_blocks_moved_;
+
+  bool pending_length_changed_;
+
+  TimeRangeList pending_invalidation_;
 
   void UpdatePreviousAndNextOfIndex(int index);
 
   QVector<Block*> block_cache_;
 
+  BlockPositionIndex block_positions_;
+
   NodeInputArray* block_input_;
 
   NodeInput* muted_input_;
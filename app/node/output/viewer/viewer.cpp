@@ -165,6 +165,11 @@ const QUuid &ViewerOutput::uuid() const
   return uuid_;
 }
 
+void ViewerOutput::set_uuid(const QUuid &uuid)
+{
+  uuid_ = uuid;
+}
+
 void ViewerOutput::DependentEdgeChanged(NodeInput *from)
 {
   if (from == texture_input_) {
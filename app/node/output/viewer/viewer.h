@@ -67,6 +67,11 @@ public:
 
   const QUuid& uuid() const;
 
+  /**
+   * @brief Restore a UUID from a saved project so that caches keyed by it carry over between sessions
+   */
+  void set_uuid(const QUuid& uuid);
+
   const QVector<TrackOutput *> &Tracks() const;
 
   NodeInput* track_input(Timeline::TrackType type) const;
@@ -20,6 +20,8 @@
 
 #include "viewer.h"
 
+#include "config/config.h"
+
 ViewerPanel::ViewerPanel(QWidget *parent) :
   ViewerPanelBase(parent)
 {
@@ -29,6 +31,8 @@ ViewerPanel::ViewerPanel(QWidget *parent) :
   // Set ViewerWidget as the central widget
   SetTimeBasedWidget(new ViewerWidget());
 
+  SetBackgroundRenderEnabled(Config::Current()["BackgroundRender"].toBool());
+
   // Set strings
   Retranslate();
 }
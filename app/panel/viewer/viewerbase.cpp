@@ -37,3 +37,8 @@ VideoRenderBackend *ViewerPanelBase::video_renderer() const
 {
   return static_cast<ViewerWidget*>(GetTimeBasedWidget())->video_renderer();
 }
+
+void ViewerPanelBase::SetBackgroundRenderEnabled(bool enabled)
+{
+  static_cast<ViewerWidget*>(GetTimeBasedWidget())->SetBackgroundRenderEnabled(enabled);
+}
@@ -22,6 +22,8 @@ public:
 
   VideoRenderBackend* video_renderer() const;
 
+  void SetBackgroundRenderEnabled(bool enabled);
+
 };
 
 #endif // VIEWERPANELBASE_H
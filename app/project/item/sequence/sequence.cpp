@@ -51,8 +51,12 @@ void Sequence::Load(QXmlStreamReader *reader, QHash<quintptr, StreamPtr> &, QLis
 
     if (attr.name() == "name") {
       set_name(attr.value().toString());
+    } else if (attr.name() == "uuid") {
+      QUuid uuid(attr.value().toString());
 
-      // Currently the only thing we care about
+      if (!uuid.isNull()) {
+        viewer_output_->set_uuid(uuid);
+      }
     }
   }
 
@@ -164,6 +168,8 @@ void Sequence::Save(QXmlStreamWriter *writer) const
 
   writer->writeAttribute("name", name());
 
+  writer->writeAttribute("uuid", viewer_output_->uuid().toString());
+
   writer->writeStartElement("video");
 
   writer->writeTextElement("width", QString::number(video_params().width()));
@@ -25,6 +25,7 @@
 #include <QUrl>
 
 #include "core.h"
+#include "render/thumbnailcache.h"
 
 ProjectViewModel::ProjectViewModel(QObject *parent) :
   QAbstractItemModel(parent),
@@ -34,6 +35,10 @@ ProjectViewModel::ProjectViewModel(QObject *parent) :
   columns_.append(kName);
   columns_.append(kDuration);
   columns_.append(kRate);
+
+  if (ThumbnailCache::instance()) {
+    connect(ThumbnailCache::instance(), &ThumbnailCache::ThumbnailReady, this, &ProjectViewModel::ThumbnailReady);
+  }
 }
 
 Project *ProjectViewModel::project()
@@ -47,6 +52,8 @@ void ProjectViewModel::set_project(Project *p)
 
   project_ = p;
 
+  thumbnail_requests_.clear();
+
   endResetModel();
 }
 
@@ -139,6 +146,23 @@ QVariant ProjectViewModel::data(const QModelIndex &index, int role) const
   case Qt::DecorationRole:
     // If this is the first column, return the Item's icon
     if (column_type == kName) {
+      if (internal_item->type() == Item::kFootage && ThumbnailCache::instance()) {
+        Footage* footage = static_cast<Footage*>(internal_item);
+
+        // Never blocks, if the thumbnail isn't ready we show the regular icon until ThumbnailReady() tells us it is
+        QPixmap thumbnail = ThumbnailCache::instance()->Get(footage);
+
+        if (!thumbnail.isNull()) {
+          return QIcon(thumbnail);
+        }
+
+        QString key = ThumbnailCache::GetKey(footage);
+
+        if (!key.isEmpty() && !thumbnail_requests_.contains(key, index)) {
+          thumbnail_requests_.insert(key, index);
+        }
+      }
+
       return internal_item->icon();
     }
     break;
@@ -149,6 +173,18 @@ QVariant ProjectViewModel::data(const QModelIndex &index, int role) const
   return QVariant();
 }
 
+void ProjectViewModel::ThumbnailReady(const QString &key)
+{
+  // Persistent indexes are invalidated if the item was removed in the meantime
+  foreach (const QPersistentModelIndex& index, thumbnail_requests_.values(key)) {
+    if (index.isValid()) {
+      emit dataChanged(index, index, {Qt::DecorationRole});
+    }
+  }
+
+  thumbnail_requests_.remove(key);
+}
+
 QVariant ProjectViewModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
   // Check if we need text data (DisplayRole) and orientation is horizontal
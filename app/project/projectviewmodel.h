@@ -22,6 +22,8 @@
 #define VIEWMODEL_H
 
 #include <QAbstractItemModel>
+#include <QMultiHash>
+#include <QPersistentModelIndex>
 
 #include "project.h"
 #include "undo/undocommand.h"
@@ -214,9 +216,17 @@ private:
    */
   void MoveItemInternal(Item* item, Item* destination);
 
+  /**
+   * @brief Updates any views showing a placeholder for a thumbnail that ThumbnailCache just finished
+   */
+  void ThumbnailReady(const QString& key);
+
   Project* project_;
 
   QVector<ColumnType> columns_;
+
+  /// Indexes that are showing a placeholder icon until their thumbnail is ready
+  mutable QMultiHash<QString, QPersistentModelIndex> thumbnail_requests_;
 };
 
 #endif // VIEWMODEL_H
@@ -0,0 +1,190 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "asyncimagecache.h"
+
+#include <algorithm>
+#include <QThread>
+
+#include "common/filefunctions.h"
+
+AsyncImageCache::AsyncImageCache(int memory_cache_size, int maximum_queue_size, int maximum_batch_size) :
+  memory_cache_(memory_cache_size),
+  maximum_queue_size_(maximum_queue_size),
+  maximum_batch_size_(maximum_batch_size)
+{
+  // Leave the rest of the system's threads to rendering and playback
+  pool_.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 4));
+}
+
+AsyncImageCache::~AsyncImageCache()
+{
+  Stop();
+}
+
+QPixmap *AsyncImageCache::Cached(const QString &key)
+{
+  return memory_cache_.object(key);
+}
+
+void AsyncImageCache::Queue(const AsyncImageCache::Request &request)
+{
+  if (pending_.contains(request.key) || failed_.contains(request.key)) {
+    return;
+  }
+
+  pending_.insert(request.key);
+
+  {
+    QMutexLocker locker(&queue_lock_);
+
+    queue_.prepend(request);
+
+    // Forget the oldest requests, if they're still visible they'll be requested again
+    while (queue_.size() > maximum_queue_size_) {
+      pending_.remove(queue_.takeLast().key);
+    }
+  }
+
+  pool_.start(new ImageTask(this));
+}
+
+void AsyncImageCache::Stop()
+{
+  {
+    QMutexLocker locker(&queue_lock_);
+    queue_.clear();
+  }
+
+  pool_.waitForDone();
+}
+
+QDir AsyncImageCache::GetDiskCacheDirectory(const QString &name)
+{
+  QDir dir(QDir(GetMediaCacheLocation()).filePath(name));
+
+  dir.mkpath(QStringLiteral("."));
+
+  return dir;
+}
+
+void AsyncImageCache::ImageGenerated(const QString &key, const QImage &image)
+{
+  QMetaObject::invokeMethod(this,
+                            "StoreImage",
+                            Qt::QueuedConnection,
+                            Q_ARG(QString, key),
+                            Q_ARG(QImage, image));
+}
+
+QList<AsyncImageCache::Request> AsyncImageCache::TakeBatch()
+{
+  QMutexLocker locker(&queue_lock_);
+
+  QList<Request> batch;
+
+  if (queue_.isEmpty()) {
+    return batch;
+  }
+
+  StreamPtr stream = queue_.first().stream;
+
+  for (int i=0;i<queue_.size() && batch.size()<maximum_batch_size_;) {
+    if (queue_.at(i).stream == stream) {
+      batch.append(queue_.takeAt(i));
+    } else {
+      i++;
+    }
+  }
+
+  std::sort(batch.begin(), batch.end(), [](const Request& a, const Request& b) {
+    return a.position < b.position;
+  });
+
+  return batch;
+}
+
+QImage AsyncImageCache::FrameToImage(FramePtr frame)
+{
+  int channels = PixelFormat::ChannelCount(frame->format());
+  int bytes_per_channel = PixelFormat::BytesPerChannel(frame->format());
+
+  QImage::Format image_format = (channels == 4) ? QImage::Format_RGBA8888 : QImage::Format_RGB888;
+
+  if (bytes_per_channel == 1) {
+    return QImage(reinterpret_cast<const uchar*>(frame->const_data()),
+                  frame->width(),
+                  frame->height(),
+                  frame->width() * channels,
+                  image_format).copy();
+  } else if (bytes_per_channel == 2
+             && (frame->format() == PixelFormat::PIX_FMT_RGB16U || frame->format() == PixelFormat::PIX_FMT_RGBA16U)) {
+    // Keep the most significant byte of each channel
+    QImage image(frame->width(), frame->height(), image_format);
+
+    const quint16* src = reinterpret_cast<const quint16*>(frame->const_data());
+    int row_values = frame->width() * channels;
+
+    for (int y=0;y<frame->height();y++) {
+      uchar* dst = image.scanLine(y);
+      const quint16* src_row = src + y * row_values;
+
+      for (int x=0;x<row_values;x++) {
+        dst[x] = static_cast<uchar>(src_row[x] >> 8);
+      }
+    }
+
+    return image;
+  }
+
+  // Float formats would need color management to look right, callers fall back to an icon for these
+  return QImage();
+}
+
+void AsyncImageCache::StoreImage(const QString &key, const QImage &image)
+{
+  pending_.remove(key);
+
+  if (image.isNull()) {
+    failed_.insert(key);
+    return;
+  }
+
+  QPixmap* pixmap = new QPixmap(QPixmap::fromImage(image));
+
+  memory_cache_.insert(key, pixmap, qMax(1, pixmap->width() * pixmap->height() * 4 / 1024));
+
+  ImageReady(key);
+}
+
+AsyncImageCache::ImageTask::ImageTask(AsyncImageCache *cache) :
+  cache_(cache)
+{
+}
+
+void AsyncImageCache::ImageTask::run()
+{
+  // The requests this task was started for may have been taken by another batch already
+  QList<Request> batch = cache_->TakeBatch();
+
+  if (!batch.isEmpty()) {
+    cache_->ProcessBatch(batch);
+  }
+}
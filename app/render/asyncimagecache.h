@@ -0,0 +1,174 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef ASYNCIMAGECACHE_H
+#define ASYNCIMAGECACHE_H
+
+#include <QCache>
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QPixmap>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+
+#include "codec/frame.h"
+#include "project/item/footage/stream.h"
+
+/**
+ * @brief Base class for caches of small images that are generated from footage in the background
+ *
+ * Subclasses look images up in memory with Cached() and queue anything missing with Queue(), so neither ever blocks
+ * the main thread. Requests are serviced newest first on a small thread pool of the cache's own, in batches of
+ * requests for the same stream sorted by position so the decoder can continue from its last frame rather than seek.
+ * The queue is bounded, so scrolling quickly through a view doesn't leave the pool working on items that have long
+ * since scrolled out of it.
+ *
+ * Each generated image is passed to ImageGenerated() and ends up in the memory cache, after which ImageReady() is
+ * called on the main thread. Keys whose image couldn't be generated aren't requested again this session.
+ */
+class AsyncImageCache : public QObject
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief Convert an 8 or 16-bit integer frame to an 8-bit QImage, or a null QImage if the format isn't supported
+   */
+  static QImage FrameToImage(FramePtr frame);
+
+protected:
+  /**
+   * @brief AsyncImageCache constructor
+   *
+   * @param memory_cache_size
+   *
+   * Memory cache size in kilobytes.
+   *
+   * @param maximum_queue_size
+   *
+   * Number of requests to keep queued before the oldest are dropped.
+   *
+   * @param maximum_batch_size
+   *
+   * Number of requests a single task will process.
+   */
+  AsyncImageCache(int memory_cache_size, int maximum_queue_size, int maximum_batch_size);
+
+  virtual ~AsyncImageCache() override;
+
+  struct Request {
+    QString key;
+    QString filename;
+    QString decoder;
+    StreamPtr stream;
+
+    /// Where in the stream the image comes from, its meaning is up to the subclass
+    qint64 position;
+  };
+
+  /**
+   * @brief Retrieve the image for `key` from memory, or nullptr if it isn't cached
+   *
+   * Must only be called from the main thread.
+   */
+  QPixmap* Cached(const QString& key);
+
+  /**
+   * @brief Queue a request unless its key is already queued or previously failed
+   *
+   * Must only be called from the main thread.
+   */
+  void Queue(const Request& request);
+
+  /**
+   * @brief Drop all queued requests and wait for the running ones to finish
+   *
+   * Subclasses must call this in their destructor since the pool calls back into them.
+   */
+  void Stop();
+
+  /**
+   * @brief Retrieve (and create if necessary) a directory in the media cache to store images on disk
+   */
+  static QDir GetDiskCacheDirectory(const QString& name);
+
+  /**
+   * @brief Load or generate the images for a batch of requests
+   *
+   * Called from the worker pool. Each request's image must be passed to ImageGenerated(), a null image marks the
+   * key as failed.
+   */
+  virtual void ProcessBatch(const QList<Request>& batch) = 0;
+
+  /**
+   * @brief Store a generated image, thread-safe
+   */
+  void ImageGenerated(const QString& key, const QImage& image);
+
+  /**
+   * @brief Called on the main thread once the image for `key` can be retrieved with Cached()
+   */
+  virtual void ImageReady(const QString& key) = 0;
+
+private:
+  /**
+   * @brief Takes the newest request and any other queued requests for the same stream, in position order
+   *
+   * Thread-safe, called from the worker pool.
+   */
+  QList<Request> TakeBatch();
+
+  class ImageTask : public QRunnable
+  {
+  public:
+    ImageTask(AsyncImageCache* cache);
+
+    virtual void run() override;
+
+  private:
+    AsyncImageCache* cache_;
+
+  };
+
+  QCache<QString, QPixmap> memory_cache_;
+
+  /// Keys that have been queued or are being generated
+  QSet<QString> pending_;
+
+  /// Keys that couldn't be generated
+  QSet<QString> failed_;
+
+  QList<Request> queue_;
+
+  QMutex queue_lock_;
+
+  QThreadPool pool_;
+
+  int maximum_queue_size_;
+
+  int maximum_batch_size_;
+
+private slots:
+  void StoreImage(const QString& key, const QImage& image);
+
+};
+
+#endif // ASYNCIMAGECACHE_H
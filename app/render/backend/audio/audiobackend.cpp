@@ -91,6 +91,8 @@ void AudioBackend::ThreadCompletedCache(NodeDependency dep, NodeValueTable data,
       }
 
       f.close();
+
+      emit CachedRangeReady(dep.range());
     } else {
       qWarning() << "Failed to write to cached PCM file";
     }
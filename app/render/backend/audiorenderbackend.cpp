@@ -7,8 +7,12 @@
 #include "common/filefunctions.h"
 #include "render/backend/indexmanager.h"
 
+const rational AudioRenderBackend::kMaximumJobLength(2);
+const rational AudioRenderBackend::kPriorityWindow(1, 2);
+
 AudioRenderBackend::AudioRenderBackend(QObject *parent) :
-  RenderBackend(parent)
+  RenderBackend(parent),
+  priority_time_(-1)
 {
   connect(IndexManager::instance(), &IndexManager::StreamConformAppended, this, &AudioRenderBackend::ConformUpdated);
 }
@@ -86,6 +90,16 @@ QString AudioRenderBackend::CachePathName()
   return QDir(GetMediaCacheLocation()).filePath(cache_fn);
 }
 
+void AudioRenderBackend::SetPriorityTime(const rational &time)
+{
+  priority_time_ = time;
+
+  // Start any idle workers on the priority range right away
+  if (!cache_queue_.isEmpty()) {
+    CacheNext();
+  }
+}
+
 bool AudioRenderBackend::CanRender()
 {
   return params_.is_valid();
@@ -98,6 +112,28 @@ void AudioRenderBackend::ConnectWorkerToThis(RenderWorker *worker)
   connect(arw, &AudioRenderWorker::ConformUnavailable, this, &AudioRenderBackend::ConformUnavailable, Qt::QueuedConnection);
 }
 
+TimeRange AudioRenderBackend::PopNextFrameFromQueue()
+{
+  TimeRange range = cache_queue_.first();
+
+  if (priority_time_ >= 0) {
+    TimeRangeList priority_ranges = cache_queue_.Intersects(TimeRange(priority_time_ - kPriorityWindow,
+                                                                      priority_time_ + kPriorityWindow));
+
+    if (!priority_ranges.isEmpty()) {
+      range = priority_ranges.first();
+    }
+  }
+
+  if (range.length() > kMaximumJobLength) {
+    range = TimeRange(range.in(), range.in() + kMaximumJobLength);
+  }
+
+  cache_queue_.RemoveTimeRange(range);
+
+  return range;
+}
+
 void AudioRenderBackend::ConformUnavailable(StreamPtr stream, const TimeRange &range, const rational &stream_time, const AudioRenderingParams& params)
 {
   ConformWaitInfo info = {stream, params, range, stream_time};
@@ -24,6 +24,19 @@ public:
 
   QString CachePathName();
 
+  /**
+   * @brief Render anything queued around this time before the rest of the queue
+   *
+   * Used while scrubbing so that unrendered audio near the playhead becomes audible as soon as possible.
+   */
+  void SetPriorityTime(const rational& time);
+
+signals:
+  /**
+   * @brief Emitted when a range has been rendered and written to the PCM cache file
+   */
+  void CachedRangeReady(const TimeRange& range);
+
 protected:
   virtual void ConnectViewer(ViewerOutput* node) override;
 
@@ -44,6 +57,8 @@ protected:
 
   virtual void ConnectWorkerToThis(RenderWorker* worker) override;
 
+  virtual TimeRange PopNextFrameFromQueue() override;
+
   QHash<Node*, Node*> copy_map_;
 
 private:
@@ -60,6 +75,18 @@ private:
 
   AudioRenderingParams params_;
 
+  rational priority_time_;
+
+  /**
+   * @brief Longest range rendered in one job, so long invalidations don't hold up priority ranges for long
+   */
+  static const rational kMaximumJobLength;
+
+  /**
+   * @brief How far either side of the priority time is rendered first
+   */
+  static const rational kPriorityWindow;
+
 private slots:
   void ConformUnavailable(StreamPtr stream, const TimeRange& range, const rational& stream_time, const AudioRenderingParams &params);
 
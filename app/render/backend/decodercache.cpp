@@ -0,0 +1,64 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "decodercache.h"
+
+#include <QDebug>
+
+#include "project/item/footage/footage.h"
+
+DecoderCache::DecoderCache() :
+  playback_speed_(0)
+{
+}
+
+DecoderPtr DecoderCache::GetOrOpen(StreamPtr stream)
+{
+  QMutexLocker locker(&lock_);
+
+  DecoderPtr decoder = Get(stream.get());
+
+  if (!decoder && stream) {
+    // Create a new Decoder here
+    decoder = Decoder::CreateFromID(stream->footage()->decoder());
+    decoder->set_stream(stream);
+
+    if (decoder->Open()) {
+      decoder->SetPlaybackSpeed(playback_speed_);
+      Add(stream.get(), decoder);
+    } else {
+      decoder = nullptr;
+      qWarning() << "Failed to open decoder for" << stream->footage()->filename() << "::" << stream->index();
+    }
+  }
+
+  return decoder;
+}
+
+void DecoderCache::SetPlaybackSpeed(int speed)
+{
+  QMutexLocker locker(&lock_);
+
+  playback_speed_ = speed;
+
+  foreach (DecoderPtr decoder, Values()) {
+    decoder->SetPlaybackSpeed(speed);
+  }
+}
@@ -8,13 +8,27 @@
 class DecoderCache : public RenderCache<Stream*, DecoderPtr>
 {
 public:
-  DecoderCache() = default;
+  DecoderCache();
 
   QMutex* lock() {return &lock_;}
 
+  /**
+   * @brief Get the decoder for this stream, opening and adding one if we don't have it yet
+   *
+   * Thread-safe. Returns nullptr if the decoder failed to open.
+   */
+  DecoderPtr GetOrOpen(StreamPtr stream);
+
+  /**
+   * @brief Pass a playback speed hint to every decoder, including ones opened later (see Decoder::SetPlaybackSpeed())
+   */
+  void SetPlaybackSpeed(int speed);
+
 private:
   QMutex lock_;
 
+  int playback_speed_;
+
 };
 
 #endif // DECODERCACHE_H
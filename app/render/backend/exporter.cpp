@@ -1,9 +1,20 @@
 #include "exporter.h"
 
+#include <algorithm>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+
+#include "common/timecodefunctions.h"
+#include "node/distort/transform/transform.h"
+#include "node/input/media/video/video.h"
+#include "project/item/footage/footage.h"
 #include "render/backend/audio/audiobackend.h"
 #include "render/backend/opengl/openglbackend.h"
 #include "render/colormanager.h"
+#include "render/memorymanager.h"
 #include "render/pixelformat.h"
+#include "render/pixelpipeline.h"
 
 Exporter::Exporter(ViewerOutput* viewer,
                    Encoder *encoder,
@@ -16,12 +27,39 @@ Exporter::Exporter(ViewerOutput* viewer,
   audio_done_(true),
   encoder_(encoder),
   export_status_(false),
-  export_msg_(tr("Export hasn't started yet"))
+  export_msg_(tr("Export hasn't started yet")),
+  encoder_failed_(false),
+  process_pool_(nullptr),
+  splice_scan_running_(false),
+  splice_scan_cancelled_(0)
 {
   debug_timer_.setInterval(5000);
   connect(&debug_timer_, &QTimer::timeout, this, &Exporter::DebugTimerMessage);
 
   connect(this, &Exporter::ExportEnded, this, &Exporter::deleteLater);
+
+  // Frames waiting to be encoded can't be freed, but we can stop rendering more of them ahead
+  memory_consumer_ = MemoryManager::AddConsumer(QStringLiteral("Export frame buffer"),
+                                                MemoryManager::kPriorityWorking,
+                                                [this](qint64 bytes) {
+    Q_UNUSED(bytes)
+
+    QMetaObject::invokeMethod(this, "UpdateRenderLimit", Qt::QueuedConnection);
+
+    return 0;
+  });
+}
+
+Exporter::~Exporter()
+{
+  // Make sure a splice scan isn't still using us
+  if (splice_scan_running_) {
+    splice_scan_cancelled_ = 1;
+    splice_scan_done_.acquire();
+  }
+
+  // Also releases the usage of any frames still waiting in cached_frames_
+  MemoryManager::RemoveConsumer(memory_consumer_);
 }
 
 void Exporter::EnableVideo(const VideoRenderingParams &video_params, const QMatrix4x4 &transform, ColorProcessorPtr color_processor)
@@ -40,6 +78,11 @@ void Exporter::EnableAudio(const AudioRenderingParams &audio_params)
   audio_done_ = false;
 }
 
+void Exporter::EnableSmartRender(const QString &output_colorspace)
+{
+  smart_render_colorspace_ = output_colorspace;
+}
+
 bool Exporter::GetExportStatus() const
 {
   return export_status_;
@@ -52,6 +95,13 @@ const QString &Exporter::GetExportError() const
 
 void Exporter::Cancel()
 {
+  splice_scan_cancelled_ = 1;
+
+  if (process_pool_) {
+    process_pool_->deleteLater();
+    process_pool_ = nullptr;
+  }
+
   if (video_backend_) {
     video_backend_->CancelQueue();
     video_backend_->deleteLater();
@@ -72,6 +122,7 @@ void Exporter::StartExporting()
 {
   // Default to error state until ExportEnd is called
   export_status_ = false;
+  encoder_failed_ = false;
 
   // Create renderers
   if (!video_done_) {
@@ -99,6 +150,7 @@ void Exporter::StartExporting()
   connect(encoder_, &Encoder::OpenSucceeded, this, &Exporter::EncoderOpenedSuccessfully, Qt::QueuedConnection);
   connect(encoder_, &Encoder::OpenFailed, this, &Exporter::EncoderOpenFailed, Qt::QueuedConnection);
   connect(encoder_, &Encoder::AudioComplete, this, &Exporter::AudioEncodeComplete, Qt::QueuedConnection);
+  connect(encoder_, &Encoder::WriteFailed, this, &Exporter::EncoderWriteFailed, Qt::QueuedConnection);
   connect(encoder_, &Encoder::Closed, encoder_, &Encoder::deleteLater, Qt::QueuedConnection);
 
   QMetaObject::invokeMethod(encoder_,
@@ -117,6 +169,11 @@ void Exporter::ExportSucceeded()
     return;
   }
 
+  if (process_pool_) {
+    process_pool_->deleteLater();
+    process_pool_ = nullptr;
+  }
+
   if (video_backend_) {
     video_backend_->deleteLater();
     video_backend_ = nullptr;
@@ -139,37 +196,107 @@ void Exporter::ExportStopped()
 
 void Exporter::EncodeFrame()
 {
-  while (cached_frames_.contains(waiting_for_frame_)) {
-    FramePtr frame = cached_frames_.take(waiting_for_frame_);
-
-    // OCIO conversion requires a frame in 32F format
-    if (frame->format() != PixelFormat::PIX_FMT_RGBA32F) {
-      frame = PixelFormat::ConvertPixelFormat(frame, PixelFormat::PIX_FMT_RGBA32F);
+  forever {
+    if (!passthrough_segments_.isEmpty() && passthrough_segments_.first().range.in() == waiting_for_frame_) {
+      // Copy this segment straight from the source file
+      PassthroughSegment segment = passthrough_segments_.takeFirst();
+
+      QMetaObject::invokeMethod(encoder_,
+                                "WritePassthrough",
+                                Qt::QueuedConnection,
+                                Q_ARG(const QString&, segment.filename),
+                                Q_ARG(int, segment.stream_index),
+                                Q_ARG(const rational&, segment.source_in),
+                                Q_ARG(const rational&, segment.source_in + segment.range.length()),
+                                Q_ARG(const rational&, segment.range.in()));
+
+      waiting_for_frame_ = segment.range.out();
+    } else if (cached_frames_.contains(waiting_for_frame_)) {
+      FramePtr frame = TakeCachedFrame(waiting_for_frame_);
+
+      // Frames were already converted in FrameRendered() and are shared between every time with the same hash, so
+      // this time gets its own (implicitly shared) copy to stamp
+      SendFrameToEncoder(std::make_shared<Frame>(*frame), waiting_for_frame_);
+
+      waiting_for_frame_ += video_params_.time_base();
+    } else {
+      break;
     }
 
-    // Color conversion must be done with unassociated alpha, and the pipeline is always associated
-    ColorManager::DisassociateAlpha(frame);
+    // Calculate progress
+    int progress = qRound(100.0 * (waiting_for_frame_.toDouble() / viewer_node_->Length().toDouble()));
+    emit ProgressChanged(progress);
+  }
+
+  if (waiting_for_frame_ >= viewer_node_->Length()) {
+    video_done_ = true;
+    debug_timer_.stop();
+
+    ExportSucceeded();
+  } else {
+    UpdateRenderLimit();
+  }
+}
+
+void Exporter::SendFrameToEncoder(FramePtr frame, const rational &time)
+{
+  // Set frame timestamp
+  frame->set_timestamp(time);
 
-    // Convert color space
-    color_processor_->ConvertFrame(frame);
+  QMetaObject::invokeMethod(encoder_,
+                            "WriteFrame",
+                            Qt::QueuedConnection,
+                            Q_ARG(FramePtr, frame));
+}
 
-    // Set frame timestamp
-    frame->set_timestamp(waiting_for_frame_);
+void Exporter::CacheFrame(const rational &time, FramePtr frame)
+{
+  cached_frames_.insert(time, frame);
 
-    // Encode (may require re-associating alpha?)
-    QMetaObject::invokeMethod(encoder_,
-                              "WriteFrame",
-                              Qt::QueuedConnection,
-                              Q_ARG(FramePtr, frame));
+  int& refs = cached_frame_refs_[frame.get()];
 
-    waiting_for_frame_ += video_params_.time_base();
+  if (refs == 0) {
+    MemoryManager::Allocated(memory_consumer_, frame->allocated_size());
+  }
 
-    // Calculate progress
-    int progress = qRound(100.0 * (waiting_for_frame_.toDouble() / viewer_node_->Length().toDouble()));
-    emit ProgressChanged(progress);
+  refs++;
+}
+
+FramePtr Exporter::TakeCachedFrame(const rational &time)
+{
+  FramePtr frame = cached_frames_.take(time);
+
+  QHash<const Frame*, int>::iterator i = cached_frame_refs_.find(frame.get());
+
+  (*i)--;
+
+  if (*i == 0) {
+    cached_frame_refs_.erase(i);
+
+    MemoryManager::Freed(memory_consumer_, frame->allocated_size());
   }
 
-  if (waiting_for_frame_ >= viewer_node_->Length()) {
+  return frame;
+}
+
+void Exporter::EncodeFrameOutOfOrder(FramePtr frame, const QList<rational> &times)
+{
+  foreach (const rational& t, times) {
+    if (IsInPassthroughSegment(t) || encoded_times_.contains(t)) {
+      continue;
+    }
+
+    // Each time gets its own (implicitly shared) copy to stamp
+    SendFrameToEncoder(std::make_shared<Frame>(*frame), t);
+
+    encoded_times_.insert(t);
+  }
+
+  int total_frames = video_backend_->frame_cache()->time_hash_map().size();
+
+  emit ProgressChanged(qRound(100.0 * static_cast<double>(encoded_times_.size()) / static_cast<double>(total_frames)));
+
+  if (encoded_times_.size() >= total_frames) {
     video_done_ = true;
     debug_timer_.stop();
 
@@ -189,10 +316,40 @@ void Exporter::FrameRendered(const rational &time, FramePtr value)
 
   QList<rational> matching_times = time_hash_map.keys(this_hash);
 
+  // Convert once here, every time that shares this hash shares this frame. Frames the GPU already converted to the
+  // encoder's Y'CbCr format have had the color transform applied too.
+  if (!value->yuv_params().is_valid()) {
+    // OCIO conversion requires a frame in 32F format, and must be done with unassociated alpha while the pipeline
+    // is always associated
+    value = PixelPipeline::Process(value,
+                                   PixelFormat::PIX_FMT_RGBA32F,
+                                   PixelPipeline::kAlphaDisassociate,
+                                   color_processor_.get(),
+                                   PixelPipeline::kAlphaNone);
+  }
+
+  if (encoder_->AcceptsFramesOutOfOrder()) {
+    // No need to hold onto anything, every time that uses this frame can be written now
+    EncodeFrameOutOfOrder(value, matching_times);
+
+    if (!video_done_) {
+      debug_timer_.start();
+    }
+
+    return;
+  }
+
   foreach (const rational& t, matching_times) {
+    // Frames in passthrough segments won't be encoded
+    if (IsInPassthroughSegment(t)) {
+      continue;
+    }
+
     qDebug() << "  Matches" << t.toDouble();
 
-    cached_frames_.insert(t, value);
+    if (!cached_frames_.contains(t)) {
+      CacheFrame(t, value);
+    }
   }
 
   qDebug() << "    Waiting for" << waiting_for_frame_.toDouble();
@@ -228,12 +385,8 @@ void Exporter::AudioEncodeComplete()
 void Exporter::EncoderOpenedSuccessfully()
 {
   // Invalidate caches
-  if (!video_done_) {
-    // First we generate the hashes so we know exactly how many frames we need
-    video_backend_->SetOperatingMode(VideoRenderWorker::kHashOnly);
-    connect(video_backend_, &VideoRenderBackend::QueueComplete, this, &Exporter::VideoHashesComplete);
-
-    video_backend_->InvalidateCache(TimeRange(0, viewer_node_->Length()));
+  if (!video_done_ && !StartSmartRenderAnalysis()) {
+    StartVideo();
   }
 
   if (!audio_done_) {
@@ -244,6 +397,31 @@ void Exporter::EncoderOpenedSuccessfully()
   }
 }
 
+void Exporter::StartVideo()
+{
+  TimeRangeList ranges = GetRangesToRender();
+
+  if (ranges.isEmpty()) {
+    // The entire sequence is passed through so there's nothing to hash
+    VideoHashesComplete();
+  } else {
+    // First we generate the hashes so we know exactly how many frames we need
+    connect(video_backend_, &VideoRenderBackend::HashesGenerated, this, &Exporter::VideoHashesComplete);
+
+    if (!video_backend_->GenerateHashes(ranges)) {
+      // Fall back to hashing through the render workers
+      disconnect(video_backend_, &VideoRenderBackend::HashesGenerated, this, &Exporter::VideoHashesComplete);
+
+      video_backend_->SetOperatingMode(VideoRenderWorker::kHashOnly);
+      connect(video_backend_, &VideoRenderBackend::QueueComplete, this, &Exporter::VideoHashesComplete);
+
+      foreach (const TimeRange& range, ranges) {
+        video_backend_->InvalidateCache(range);
+      }
+    }
+  }
+}
+
 void Exporter::EncoderOpenFailed()
 {
   SetExportMessage(tr("Failed to open encoder"));
@@ -252,21 +430,44 @@ void Exporter::EncoderOpenFailed()
 
 void Exporter::EncoderClosed()
 {
+  if (encoder_failed_) {
+    // Everything was sent to the encoder, but not all of it made it into the output
+    export_status_ = false;
+  }
+
   emit ProgressChanged(100);
   ExportStopped();
 }
 
+void Exporter::EncoderWriteFailed(const QString &message)
+{
+  // Emitted before Closed(), so this is always seen before EncoderClosed()
+  encoder_failed_ = true;
+
+  SetExportMessage(message);
+}
+
 void Exporter::VideoHashesComplete()
 {
   // We've got our hashes, time to kick off actual rendering
+  disconnect(video_backend_, &VideoRenderBackend::HashesGenerated, this, &Exporter::VideoHashesComplete);
   disconnect(video_backend_, &VideoRenderBackend::QueueComplete, this, &Exporter::VideoHashesComplete);
 
-  // Determine what frames will be hashed
-  TimeRangeList ranges;
-  ranges.append(TimeRange(0, viewer_node_->Length()));
+  if (!RenderProcessPool::IsEnabled() || !RenderVideoInWorkerProcesses()) {
+    RenderVideoInProcess(GetRangesToRender());
+  }
 
+  // Write any passthrough segments we don't need to wait for
+  EncodeFrame();
+}
+
+void Exporter::RenderVideoInProcess(const TimeRangeList &ranges)
+{
   // Set video backend to render mode but NOT hash or download
   video_backend_->SetOperatingMode(VideoRenderWorker::kRenderOnly);
+
+  // If the encoder takes planar Y'CbCr, do the color transform and conversion on the GPU and only read back the planes
+  video_backend_->SetOutputConversion(color_processor_, encoder_->GetNativeYUVParams());
   video_backend_->SetOnlySignalLastFrameRequested(false);
 
   // FIXME: Exporting is now broken because of this
@@ -277,7 +478,353 @@ void Exporter::VideoHashesComplete()
   }
 }
 
+bool Exporter::RenderVideoInWorkerProcesses()
+{
+  process_pool_ = new RenderProcessPool(this);
+
+  if (!process_pool_->Start(viewer_node_, video_backend_->params())) {
+    qWarning() << "Failed to start render worker processes, rendering in-process instead";
+
+    delete process_pool_;
+    process_pool_ = nullptr;
+
+    return false;
+  }
+
+  connect(process_pool_, &RenderProcessPool::FrameRendered, this, &Exporter::FrameRendered);
+  connect(process_pool_, &RenderProcessPool::Failed, this, &Exporter::WorkerProcessesFailed);
+
+  // Only render one frame per unique hash, FrameRendered() distributes it to every time that shares it
+  const QMap<rational, QByteArray>& time_hash_map = video_backend_->frame_cache()->time_hash_map();
+
+  QList<rational> frames_to_render;
+  QSet<QByteArray> queued_hashes;
+
+  for (QMap<rational, QByteArray>::const_iterator i=time_hash_map.constBegin();i!=time_hash_map.constEnd();i++) {
+    if (!queued_hashes.contains(i.value())) {
+      queued_hashes.insert(i.value());
+      frames_to_render.append(i.key());
+    }
+  }
+
+  process_pool_->Render(frames_to_render);
+
+  return true;
+}
+
+void Exporter::WorkerProcessesFailed(const QList<rational> &unrendered_frames)
+{
+  qWarning() << "All render worker processes failed, rendering remaining frames in-process";
+
+  process_pool_->deleteLater();
+  process_pool_ = nullptr;
+
+  TimeRangeList ranges;
+
+  foreach (const rational& time, unrendered_frames) {
+    ranges.InsertTimeRange(TimeRange(time, time + video_backend_->params().time_base()));
+  }
+
+  RenderVideoInProcess(ranges);
+}
+
+bool Exporter::StartSmartRenderAnalysis()
+{
+  passthrough_segments_.clear();
+  passthrough_candidates_.clear();
+  splice_scans_.clear();
+
+  // The sequence must map 1:1 onto the export and the graph between the tracks and the viewer mustn't modify anything
+  if (smart_render_colorspace_.isEmpty()
+      || !transform_.isIdentity()
+      || video_params_.width() != viewer_node_->video_params().width()
+      || video_params_.height() != viewer_node_->video_params().height()
+      || video_params_.time_base() != viewer_node_->video_params().time_base()
+      || !VideoGraphIsPassthroughCompatible(viewer_node_->texture_input())) {
+    return false;
+  }
+
+  // Set by the encoder before it reported it was open and never changed afterwards
+  passthrough_target_ = encoder_->passthrough_target();
+
+  if (!passthrough_target_.is_valid()) {
+    return false;
+  }
+
+  const QVector<TrackOutput*>& tracks = viewer_node_->track_list(Timeline::kTrackTypeVideo)->Tracks();
+  rational sequence_length = viewer_node_->Length();
+
+  // Scanning a source for keyframes reads the whole file, so only do it once per stream
+  QHash<QString, int> scan_indexes;
+
+  foreach (TrackOutput* track, tracks) {
+    if (!track || track->IsMuted()) {
+      continue;
+    }
+
+    foreach (Block* block, track->Blocks()) {
+      if (block->type() != Block::kClip) {
+        continue;
+      }
+
+      VideoStreamPtr stream = GetPassthroughStream(static_cast<ClipBlock*>(block));
+
+      if (!stream) {
+        continue;
+      }
+
+      TimeRange clip_range(block->in(), qMin(block->out(), sequence_length));
+
+      // Nothing else can be visible while this clip is
+      bool overlaps_other_content = false;
+
+      foreach (TrackOutput* other_track, tracks) {
+        if (!other_track || other_track == track || other_track->IsMuted()) {
+          continue;
+        }
+
+        foreach (Block* other_block, other_track->BlocksAtTimeRange(clip_range)) {
+          if (other_block->type() != Block::kGap
+              && TimeRange(other_block->in(), other_block->out()).OverlapsWith(clip_range, false, false)) {
+            overlaps_other_content = true;
+            break;
+          }
+        }
+
+        if (overlaps_other_content) {
+          break;
+        }
+      }
+
+      if (overlaps_other_content) {
+        continue;
+      }
+
+      QString filename = stream->footage()->filename();
+      QString cache_key = QStringLiteral("%1:%2").arg(filename, QString::number(stream->index()));
+
+      if (!scan_indexes.contains(cache_key)) {
+        SpliceScan scan;
+        scan.filename = filename;
+        scan.stream_index = stream->index();
+
+        scan_indexes.insert(cache_key, splice_scans_.size());
+        splice_scans_.append(scan);
+      }
+
+      PassthroughCandidate candidate;
+      candidate.clip_range = clip_range;
+
+      // Speed is 1.0 so sequence and media time only differ by an offset
+      candidate.media_offset = block->media_in() - block->in();
+      candidate.scan_index = scan_indexes.value(cache_key);
+
+      passthrough_candidates_.append(candidate);
+    }
+  }
+
+  if (passthrough_candidates_.isEmpty()) {
+    return false;
+  }
+
+  splice_scan_running_ = true;
+
+  QThreadPool::globalInstance()->start(new SpliceScanTask(this));
+
+  return true;
+}
+
+void Exporter::SpliceScanFinished()
+{
+  splice_scan_done_.acquire();
+  splice_scan_running_ = false;
+
+  if (splice_scan_cancelled_) {
+    return;
+  }
+
+  const rational& timebase = video_params_.time_base();
+
+  foreach (const PassthroughCandidate& candidate, passthrough_candidates_) {
+    const SpliceScan& scan = splice_scans_.at(candidate.scan_index);
+
+    rational source_in = candidate.clip_range.in() + candidate.media_offset;
+    rational source_out = candidate.clip_range.out() + candidate.media_offset;
+
+    // Copy from the first splice point inside the clip to the last, frames outside of that are re-encoded
+    bool found_splice_point = false;
+    rational copy_in, copy_out;
+
+    foreach (const rational& point, scan.splice_points) {
+      if (point >= source_in && point <= source_out) {
+        if (!found_splice_point) {
+          copy_in = point;
+          found_splice_point = true;
+        }
+
+        copy_out = point;
+      }
+    }
+
+    if (!found_splice_point || copy_in >= copy_out) {
+      continue;
+    }
+
+    TimeRange copy_range(copy_in - candidate.media_offset, copy_out - candidate.media_offset);
+
+    // Packets can only be copied to frame boundaries
+    if (Timecode::snap_time_to_timebase(copy_range.in(), timebase) != copy_range.in()
+        || Timecode::snap_time_to_timebase(copy_range.out(), timebase) != copy_range.out()) {
+      continue;
+    }
+
+    PassthroughSegment segment;
+    segment.range = copy_range;
+    segment.filename = scan.filename;
+    segment.stream_index = scan.stream_index;
+    segment.source_in = copy_in;
+    passthrough_segments_.append(segment);
+  }
+
+  passthrough_candidates_.clear();
+  splice_scans_.clear();
+
+  std::sort(passthrough_segments_.begin(),
+            passthrough_segments_.end(),
+            [](const PassthroughSegment& a, const PassthroughSegment& b) {
+    return a.range.in() < b.range.in();
+  });
+
+  StartVideo();
+}
+
+bool Exporter::VideoGraphIsPassthroughCompatible(NodeInput *input)
+{
+  Node* connected = input->get_connected_node();
+
+  if (!connected || connected->IsTrack()) {
+    return true;
+  }
+
+  // TrackList composites tracks with alpha over nodes, which leave a clip untouched if there's nothing under it
+  if (connected->id() != QStringLiteral("org.olivevideoeditor.Olive.alphaoverblend")) {
+    return false;
+  }
+
+  foreach (NodeParam* param, connected->parameters()) {
+    if (param->type() == NodeParam::kInput
+        && !VideoGraphIsPassthroughCompatible(static_cast<NodeInput*>(param))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+VideoStreamPtr Exporter::GetPassthroughStream(ClipBlock *clip) const
+{
+  if (clip->speed() != rational(1)) {
+    return nullptr;
+  }
+
+  // The clip must be connected directly to its media with no effects in between
+  VideoInput* video_input = dynamic_cast<VideoInput*>(clip->texture_input()->get_connected_node());
+
+  if (!video_input || !video_input->footage() || video_input->footage()->type() != Stream::kVideo) {
+    return nullptr;
+  }
+
+  if (video_input->matrix_input()->IsConnected()) {
+    TransformDistort* transform = dynamic_cast<TransformDistort*>(video_input->matrix_input()->get_connected_node());
+
+    if (!transform || !transform->IsIdentity()) {
+      return nullptr;
+    }
+  }
+
+  VideoStreamPtr stream = std::static_pointer_cast<VideoStream>(video_input->footage());
+
+  if (stream->width() != video_params_.width()
+      || stream->height() != video_params_.height()
+      || stream->colorspace() != smart_render_colorspace_) {
+    return nullptr;
+  }
+
+  return stream;
+}
+
+TimeRangeList Exporter::GetRangesToRender() const
+{
+  TimeRangeList ranges;
+
+  ranges.append(TimeRange(0, viewer_node_->Length()));
+
+  foreach (const PassthroughSegment& segment, passthrough_segments_) {
+    ranges.RemoveTimeRange(segment.range);
+  }
+
+  return ranges;
+}
+
+bool Exporter::IsInPassthroughSegment(const rational &time) const
+{
+  foreach (const PassthroughSegment& segment, passthrough_segments_) {
+    if (time >= segment.range.in() && time < segment.range.out()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+Exporter::SpliceScanTask::SpliceScanTask(Exporter *exporter) :
+  exporter_(exporter)
+{
+}
+
+void Exporter::SpliceScanTask::run()
+{
+  for (int i=0;i<exporter_->splice_scans_.size();i++) {
+    if (exporter_->splice_scan_cancelled_) {
+      break;
+    }
+
+    SpliceScan& scan = exporter_->splice_scans_[i];
+
+    scan.splice_points = exporter_->encoder_->GetPassthroughSplicePoints(exporter_->passthrough_target_,
+                                                                         scan.filename,
+                                                                         scan.stream_index,
+                                                                         &exporter_->splice_scan_cancelled_);
+  }
+
+  QMetaObject::invokeMethod(exporter_, "SpliceScanFinished", Qt::QueuedConnection);
+
+  exporter_->splice_scan_done_.release();
+}
+
 void Exporter::DebugTimerMessage()
 {
   qDebug() << "Still waiting for" << waiting_for_frame_.toDouble();
 }
+
+void Exporter::UpdateRenderLimit()
+{
+  // Encoders that take frames out of order never leave anything waiting, so there's nothing to limit
+  if (video_done_ || encoder_->AcceptsFramesOutOfOrder()) {
+    return;
+  }
+
+  rational limit = RATIONAL_MAX;
+
+  if (MemoryManager::IsOverBudget()) {
+    // Render no further ahead than every thread could have in flight. The frame we're waiting for is always within
+    // the limit, so the export keeps moving and frees frames as it goes.
+    limit = waiting_for_frame_ + video_params_.time_base() * rational(QThread::idealThreadCount());
+  }
+
+  if (process_pool_) {
+    process_pool_->SetRenderLimit(limit);
+  } else if (video_backend_) {
+    video_backend_->SetRenderLimit(limit);
+  }
+}
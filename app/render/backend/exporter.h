@@ -2,14 +2,20 @@
 #define EXPORTER_H
 
 #include <QMatrix4x4>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSet>
 #include <QString>
 #include <QTimer>
 #include <QObject>
 
 #include "codec/encoder.h"
+#include "node/block/clip/clip.h"
 #include "node/output/viewer/viewer.h"
 #include "render/backend/audiorenderbackend.h"
+#include "render/backend/process/renderprocesspool.h"
 #include "render/backend/videorenderbackend.h"
+#include "project/item/footage/videostream.h"
 #include "render/colorprocessor.h"
 
 class Exporter : public QObject
@@ -20,9 +26,20 @@ public:
            Encoder* encoder,
            QObject* parent = nullptr);
 
+  virtual ~Exporter() override;
+
   void EnableVideo(const VideoRenderingParams& video_params, const QMatrix4x4& transform, ColorProcessorPtr color_processor);
   void EnableAudio(const AudioRenderingParams& audio_params);
 
+  /**
+   * @brief Allow untouched source segments to be copied into the output rather than re-encoded
+   *
+   * A segment qualifies if it's a single clip with no effects, an identity transform and a footage stream whose
+   * intra-only codec and parameters match the export (see Encoder::GetPassthroughSplicePoints()). Since its pixels would otherwise go through the color pipeline, the
+   * footage must also be in `output_colorspace`, the color space the export is converted to.
+   */
+  void EnableSmartRender(const QString& output_colorspace);
+
   bool GetExportStatus() const;
   const QString& GetExportError() const;
 
@@ -64,6 +81,90 @@ private:
 
   void EncodeFrame();
 
+  /**
+   * @brief Hand a frame that's ready to be encoded to the encoder as the frame at `time`
+   */
+  void SendFrameToEncoder(FramePtr frame, const rational& time);
+
+  /**
+   * @brief Hold a frame in cached_frames_ until the encoder is ready for `time`
+   */
+  void CacheFrame(const rational& time, FramePtr frame);
+
+  FramePtr TakeCachedFrame(const rational& time);
+
+  /**
+   * @brief Write a rendered frame to every time that uses it straight away, for encoders that take frames in any order
+   */
+  void EncodeFrameOutOfOrder(FramePtr frame, const QList<rational>& times);
+
+  void RenderVideoInProcess(const TimeRangeList& ranges);
+
+  bool RenderVideoInWorkerProcesses();
+
+  /**
+   * @brief Start hashing and rendering everything that isn't passed through
+   */
+  void StartVideo();
+
+  /**
+   * @brief Start looking for segments of the sequence that can be copied straight from their source
+   *
+   * See EnableSmartRender(). Finding where a source can be spliced means reading all of its packets, so this happens
+   * on another thread and the analysis finishes in SpliceScanFinished(). Returns false if there was nothing to scan, in
+   * which case there are no passthrough segments.
+   */
+  bool StartSmartRenderAnalysis();
+
+  /**
+   * @brief Reads the splice points of every source in splice_scans_
+   */
+  class SpliceScanTask : public QRunnable
+  {
+  public:
+    SpliceScanTask(Exporter* exporter);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    Exporter* exporter_;
+
+  };
+
+  static bool VideoGraphIsPassthroughCompatible(NodeInput* input);
+
+  VideoStreamPtr GetPassthroughStream(ClipBlock* clip) const;
+
+  /**
+   * @brief Returns the ranges of the sequence that must be rendered, i.e. everything but passthrough segments
+   */
+  TimeRangeList GetRangesToRender() const;
+
+  bool IsInPassthroughSegment(const rational& time) const;
+
+  struct PassthroughSegment {
+    TimeRange range;
+    QString filename;
+    int stream_index;
+    rational source_in;
+  };
+
+  struct SpliceScan {
+    QString filename;
+    int stream_index;
+    QList<rational> splice_points;
+  };
+
+  /**
+   * @brief A clip that can be passed through if its source has splice points within it
+   */
+  struct PassthroughCandidate {
+    TimeRange clip_range;
+    rational media_offset;
+    int scan_index;
+  };
+
   ColorProcessorPtr color_processor_;
 
   Encoder* encoder_;
@@ -72,10 +173,57 @@ private:
 
   QString export_msg_;
 
+  /**
+   * @brief Set if the encoder reported frames it couldn't write, see Encoder::WriteFailed()
+   */
+  bool encoder_failed_;
+
   rational waiting_for_frame_;
 
   QHash<rational, FramePtr> cached_frames_;
 
+  /**
+   * @brief How many times in cached_frames_ share each frame, so a frame's memory is only counted once
+   */
+  QHash<const Frame*, int> cached_frame_refs_;
+
+  /**
+   * @brief Accounts for frames waiting in cached_frames_
+   *
+   * These can't be freed without stalling the export, so when memory runs short, rendering ahead is limited instead
+   * (see UpdateRenderLimit()).
+   */
+  int memory_consumer_;
+
+  /**
+   * @brief Times already sent to an encoder that accepts frames out of order
+   */
+  QSet<rational> encoded_times_;
+
+  RenderProcessPool* process_pool_;
+
+  QString smart_render_colorspace_;
+
+  QList<PassthroughSegment> passthrough_segments_;
+
+  QList<PassthroughCandidate> passthrough_candidates_;
+
+  /**
+   * @brief Copy of the encoder's stream parameters for SpliceScanTask, which can't touch the encoder itself
+   */
+  Encoder::PassthroughTarget passthrough_target_;
+
+  /**
+   * @brief One entry per source stream, only touched by SpliceScanTask while a scan is running
+   */
+  QVector<SpliceScan> splice_scans_;
+
+  bool splice_scan_running_;
+
+  QAtomicInt splice_scan_cancelled_;
+
+  QSemaphore splice_scan_done_;
+
   QTimer debug_timer_;
 
 private slots:
@@ -91,10 +239,21 @@ private slots:
 
   void EncoderClosed();
 
+  void EncoderWriteFailed(const QString& message);
+
   void VideoHashesComplete();
 
+  void SpliceScanFinished();
+
+  void WorkerProcessesFailed(const QList<rational>& unrendered_frames);
+
   void DebugTimerMessage();
 
+  /**
+   * @brief Keep rendering close to the frame the encoder is waiting for while memory is over budget
+   */
+  void UpdateRenderLimit();
+
 };
 
 #endif // EXPORTER_H
@@ -24,6 +24,7 @@ bool OpenGLBackend::InitInternal()
 
   proxy_ = new OpenGLProxy();
   proxy_->SetParameters(params());
+  proxy_->SetOutputConversion(output_color_processor(), output_yuv_params());
   QThread* proxy_thread = new QThread();
   proxy_thread->start(QThread::IdlePriority);
   proxy_->moveToThread(proxy_thread);
@@ -47,6 +48,7 @@ bool OpenGLBackend::InitInternal()
 
     connect(processor, &OpenGLWorker::RequestFrameToValue, proxy_, &OpenGLProxy::FrameToValue, Qt::BlockingQueuedConnection);
     connect(processor, &OpenGLWorker::RequestTextureToBuffer, proxy_, &OpenGLProxy::TextureToBuffer, Qt::BlockingQueuedConnection);
+    connect(processor, &OpenGLWorker::RequestTextureToPlanes, proxy_, &OpenGLProxy::TextureToPlanes, Qt::BlockingQueuedConnection);
     connect(processor, &OpenGLWorker::RequestRunNodeAccelerated, proxy_, &OpenGLProxy::RunNodeAccelerated, Qt::BlockingQueuedConnection);
   }
 
@@ -83,3 +85,10 @@ void OpenGLBackend::ParamsChangedEvent()
     proxy_->SetParameters(params());
   }
 }
+
+void OpenGLBackend::OutputConversionChangedEvent()
+{
+  if (IsInitiated()) {
+    proxy_->SetOutputConversion(output_color_processor(), output_yuv_params());
+  }
+}
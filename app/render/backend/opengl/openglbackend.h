@@ -27,6 +27,8 @@ protected:
 
   virtual void ParamsChangedEvent() override;
 
+  virtual void OutputConversionChangedEvent() override;
+
 private:
   OpenGLProxy* proxy_;
 
@@ -1,6 +1,8 @@
 #include "openglproxy.h"
 
 #include <QThread>
+#include <QVector2D>
+#include <QVector3D>
 
 #include "common/clamp.h"
 #include "core.h"
@@ -9,18 +11,28 @@
 #include "openglcolorprocessor.h"
 #include "openglrenderfunctions.h"
 #include "render/colormanager.h"
+#include "render/memorymanager.h"
 #include "render/pixelformat.h"
+#include "render/pixelpipeline.h"
 
 OpenGLProxy::OpenGLProxy(QObject *parent) :
   QObject(parent),
   ctx_(nullptr),
-  functions_(nullptr)
+  functions_(nullptr),
+  output_conversion_changed_(false),
+  output_ocio_lut_(0)
 {
   surface_.create();
+
+  still_image_memory_consumer_ = MemoryManager::AddConsumer(QStringLiteral("Still image cache"),
+                                                            MemoryManager::kPriorityCache,
+                                                            [this](qint64 bytes){return RequestStillImageCacheClear(bytes);});
 }
 
 OpenGLProxy::~OpenGLProxy()
 {
+  MemoryManager::RemoveConsumer(still_image_memory_consumer_);
+
   Close();
 
   surface_.destroy();
@@ -45,6 +57,16 @@ bool OpenGLProxy::Init()
   return true;
 }
 
+qint64 OpenGLProxy::RequestStillImageCacheClear(qint64 bytes)
+{
+  Q_UNUSED(bytes)
+
+  clear_still_image_cache_ = 1;
+
+  // Released stills return their textures to the texture cache, which accounts for them and frees them if necessary
+  return 0;
+}
+
 void OpenGLProxy::FrameToValue(DecoderPtr decoder, StreamPtr stream, const TimeRange &range, NodeValueTable* table)
 {
   // Ensure stream is video or image type
@@ -59,6 +81,10 @@ void OpenGLProxy::FrameToValue(DecoderPtr decoder, StreamPtr stream, const TimeR
 
   OpenGLTextureCache::ReferencePtr footage_tex_ref = nullptr;
 
+  if (clear_still_image_cache_.testAndSetRelaxed(1, 0)) {
+    still_image_cache_.Clear();
+  }
+
   if (stream->type() == Stream::kImage && still_image_cache_.Has(stream.get())) {
     CachedStill cs = still_image_cache_.Get(stream.get());
 
@@ -94,25 +120,29 @@ void OpenGLProxy::FrameToValue(DecoderPtr decoder, StreamPtr stream, const TimeR
     if (ocio_method == ColorManager::kOCIOAccurate) {
       bool has_alpha = PixelFormat::FormatHasAlphaChannel(frame->format());
 
-      // If alpha is associated, disassociate for the color transform
-      if (has_alpha && video_stream->premultiplied_alpha()) {
-        ColorManager::DisassociateAlpha(frame);
-      }
-
-      // Convert frame to float for OCIO
-      frame = PixelFormat::ConvertPixelFormat(frame, has_alpha ? PixelFormat::PIX_FMT_RGBA32F : PixelFormat::PIX_FMT_RGB32F);
+      PixelPipeline::AlphaOperation before_transform = PixelPipeline::kAlphaNone;
+      PixelPipeline::AlphaOperation after_transform = PixelPipeline::kAlphaNone;
 
-      // Perform color transform
-      color_processor->ConvertFrame(frame);
-
-      // Associate alpha
       if (has_alpha) {
         if (video_stream->premultiplied_alpha()) {
-          ColorManager::ReassociateAlpha(frame);
+          // Alpha is associated, disassociate for the color transform and reassociate afterwards
+          before_transform = PixelPipeline::kAlphaDisassociate;
+          after_transform = PixelPipeline::kAlphaReassociate;
         } else {
-          ColorManager::AssociateAlpha(frame);
+          after_transform = PixelPipeline::kAlphaAssociate;
         }
       }
+
+      // Convert frame to float and perform the color transform in one pass
+      frame = PixelPipeline::Process(frame,
+                                     has_alpha ? PixelFormat::PIX_FMT_RGBA32F : PixelFormat::PIX_FMT_RGB32F,
+                                     before_transform,
+                                     color_processor.get(),
+                                     after_transform);
+
+      if (!frame) {
+        return;
+      }
     }
 
     VideoRenderingParams footage_params(frame->width(), frame->height(), stream->timebase(), frame->format(), video_params_.mode());
@@ -176,6 +206,8 @@ void OpenGLProxy::FrameToValue(DecoderPtr decoder, StreamPtr stream, const TimeR
 
 void OpenGLProxy::Close()
 {
+  ClearOutputConversion();
+  yuv_shader_ = nullptr;
   shader_cache_.Clear();
   buffer_.Destroy();
   functions_ = nullptr;
@@ -413,6 +445,147 @@ void OpenGLProxy::TextureToBuffer(const QVariant &tex_in, void *buffer)
   buffer_.Detach();
 }
 
+void OpenGLProxy::TextureToPlanes(const QVariant &tex_in, void *buffer)
+{
+  OpenGLTextureCache::ReferencePtr texture = tex_in.value<OpenGLTextureCache::ReferencePtr>();
+
+  int width = video_params_.effective_width();
+  int height = video_params_.effective_height();
+
+  if (output_conversion_changed_) {
+    ClearOutputConversion();
+
+    if (output_color_processor_) {
+      // Rendered textures are always associated
+      output_ocio_shader_ = OpenGLShader::CreateOCIO(ctx_,
+                                                     output_ocio_lut_,
+                                                     output_color_processor_->GetProcessor(),
+                                                     true);
+    }
+
+    output_conversion_changed_ = false;
+  }
+
+  if (!yuv_shader_) {
+    yuv_shader_ = OpenGLShader::CreateYUVPlane();
+  }
+
+  if (output_ocio_shader_) {
+    // Blit through the output transform into a texture of the same format so we don't lose any precision
+    OpenGLTextureCache::ReferencePtr transformed_tex_ref = texture_cache_.Get(ctx_, video_params_);
+
+    buffer_.Attach(transformed_tex_ref->texture(), true);
+    buffer_.Bind();
+    texture->texture()->Bind();
+
+    functions_->glViewport(0, 0, width, height);
+
+    OpenGLRenderFunctions::OCIOBlit(output_ocio_shader_, output_ocio_lut_);
+
+    texture->texture()->Release();
+    buffer_.Release();
+    buffer_.Detach();
+
+    texture = transformed_tex_ref;
+  }
+
+  // Sample values are scaled to the bit depth, then normalized to what we read back (8 or 16-bit)
+  float depth_scale = static_cast<float>(1 << (output_yuv_params_.bit_depth() - 8));
+  float storage_max = (output_yuv_params_.bytes_per_sample() == 1) ? 255.0f : 65535.0f;
+  float code_max = static_cast<float>((1 << output_yuv_params_.bit_depth()) - 1);
+  GLenum read_type = (output_yuv_params_.bytes_per_sample() == 1) ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+
+  // Plane sizes generally aren't multiples of 4
+  functions_->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+  for (int i=0;i<YUVParams::kPlaneCount;i++) {
+    int plane_width = output_yuv_params_.plane_width(i, width);
+    int plane_height = output_yuv_params_.plane_height(i, height);
+
+    OpenGLTextureCache::ReferencePtr plane_tex_ref = texture_cache_.Get(ctx_,
+                                                                        VideoRenderingParams(plane_width,
+                                                                                             plane_height,
+                                                                                             video_params_.time_base(),
+                                                                                             PixelFormat::PIX_FMT_RGBA16U,
+                                                                                             video_params_.mode()));
+
+    buffer_.Attach(plane_tex_ref->texture(), true);
+    buffer_.Bind();
+    texture->texture()->Bind();
+
+    functions_->glViewport(0, 0, plane_width, plane_height);
+
+    // BT.601 coefficients, luma is 16-235 and chroma is 16-240 centered on 128 (at 8-bit)
+    QVector3D coefficients;
+    float offset, range;
+
+    if (i == 0) {
+      coefficients = QVector3D(0.299f, 0.587f, 0.114f);
+      offset = 16.0f;
+      range = 219.0f;
+    } else if (i == 1) {
+      coefficients = QVector3D(-0.168736f, -0.331264f, 0.5f);
+      offset = 128.0f;
+      range = 224.0f;
+    } else {
+      coefficients = QVector3D(0.5f, -0.418688f, -0.081312f);
+      offset = 128.0f;
+      range = 224.0f;
+    }
+
+    QVector2D subsampling(1.0f, 1.0f);
+
+    if (i > 0) {
+      subsampling = QVector2D(output_yuv_params_.horizontal_subsampling(), output_yuv_params_.vertical_subsampling());
+    }
+
+    yuv_shader_->bind();
+    yuv_shader_->setUniformValue("yuv_texel_size", QVector2D(1.0f / width, 1.0f / height));
+    yuv_shader_->setUniformValue("yuv_subsampling", subsampling);
+    yuv_shader_->setUniformValue("yuv_coefficients", coefficients);
+    yuv_shader_->setUniformValue("yuv_offset", offset * depth_scale / storage_max);
+    yuv_shader_->setUniformValue("yuv_scale", range * depth_scale / storage_max);
+    yuv_shader_->setUniformValue("yuv_maximum", code_max / storage_max);
+
+    OpenGLRenderFunctions::Blit(yuv_shader_);
+
+    yuv_shader_->release();
+
+    texture->texture()->Release();
+
+    functions_->glReadPixels(0,
+                             0,
+                             plane_width,
+                             plane_height,
+                             GL_RED,
+                             read_type,
+                             static_cast<char*>(buffer) + output_yuv_params_.plane_offset(i, width, height));
+
+    buffer_.Release();
+    buffer_.Detach();
+  }
+
+  functions_->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  functions_->glViewport(0, 0, width, height);
+}
+
+void OpenGLProxy::SetOutputConversion(ColorProcessorPtr color_processor, const YUVParams &yuv_params)
+{
+  output_color_processor_ = color_processor;
+  output_yuv_params_ = yuv_params;
+  output_conversion_changed_ = true;
+}
+
+void OpenGLProxy::ClearOutputConversion()
+{
+  if (output_ocio_lut_ && functions_) {
+    functions_->glDeleteTextures(1, &output_ocio_lut_);
+  }
+
+  output_ocio_lut_ = 0;
+  output_ocio_shader_ = nullptr;
+}
+
 void OpenGLProxy::SetParameters(const VideoRenderingParams &params)
 {
   video_params_ = params;
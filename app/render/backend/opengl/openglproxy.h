@@ -47,8 +47,24 @@ public:
 
   void TextureToBuffer(const QVariant& texture, void *buffer);
 
+  /**
+   * @brief Apply the output color transform to a texture, convert it to Y'CbCr and download each plane into a buffer
+   *
+   * The buffer is laid out as described by the YUVParams set in SetOutputConversion(). Y'CbCr is BT.601 limited range,
+   * which is what swscale produced when it did this conversion on the CPU.
+   */
+  void TextureToPlanes(const QVariant& texture, void *buffer);
+
   void SetParameters(const VideoRenderingParams& params);
 
+  /**
+   * @brief Set the color transform and Y'CbCr layout used by TextureToPlanes()
+   *
+   * Like SetParameters(), this must not be called while any worker is using this proxy. The OpenGL resources are
+   * (re)created in this object's thread the next time they're needed.
+   */
+  void SetOutputConversion(ColorProcessorPtr color_processor, const YUVParams& yuv_params);
+
 private:
   QOpenGLContext* ctx_;
   QOffscreenSurface surface_;
@@ -65,6 +81,20 @@ private:
 
   OpenGLTextureCache texture_cache_;
 
+  void ClearOutputConversion();
+
+  ColorProcessorPtr output_color_processor_;
+
+  YUVParams output_yuv_params_;
+
+  bool output_conversion_changed_;
+
+  GLuint output_ocio_lut_;
+
+  OpenGLShaderPtr output_ocio_shader_;
+
+  OpenGLShaderPtr yuv_shader_;
+
   struct CachedStill {
     OpenGLTextureCache::ReferencePtr texture;
     QString colorspace;
@@ -74,6 +104,18 @@ private:
 
   RenderCache<Stream*, CachedStill> still_image_cache_;
 
+  /**
+   * @brief MemoryManager reclaim function for the still image cache
+   */
+  qint64 RequestStillImageCacheClear(qint64 bytes);
+
+  int still_image_memory_consumer_;
+
+  /**
+   * @brief Set by the MemoryManager, the still image cache is cleared in our thread next time it's used
+   */
+  QAtomicInt clear_still_image_cache_;
+
 private slots:
   void FinishInit();
 
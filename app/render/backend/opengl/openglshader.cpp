@@ -129,6 +129,17 @@ OpenGLShaderPtr OpenGLShader::CreateOCIO(QOpenGLContext* ctx,
   return shader;
 }
 
+OpenGLShaderPtr OpenGLShader::CreateYUVPlane()
+{
+  OpenGLShaderPtr program = std::make_shared<OpenGLShader>();
+
+  program->addShaderFromSourceCode(QOpenGLShader::Vertex, CodeDefaultVertex());
+  program->addShaderFromSourceCode(QOpenGLShader::Fragment, CodeYUVPlaneFragment());
+  program->link();
+
+  return program;
+}
+
 QString OpenGLShader::CodeDefaultFragment(const QString &function_name, const QString &shader_code)
 {
   QString frag_code = QStringLiteral("#version 110\n"
@@ -204,6 +215,59 @@ QString OpenGLShader::CodeDefaultVertex()
                         "}\n");
 }
 
+QString OpenGLShader::CodeYUVPlaneFragment()
+{
+  QString frag_code = QStringLiteral("#version 110\n"
+                                     "\n"
+                                     "#ifdef GL_ES\n"
+                                     "precision highp int;\n"
+                                     "precision highp float;\n"
+                                     "#endif\n"
+                                     "\n"
+                                     "uniform sampler2D ove_maintex;\n"
+                                     "\n"
+                                     "// Size of one source pixel in texture coordinates\n"
+                                     "uniform vec2 yuv_texel_size;\n"
+                                     "\n"
+                                     "// How many source pixels each output sample covers\n"
+                                     "uniform vec2 yuv_subsampling;\n"
+                                     "\n"
+                                     "// output = offset + scale * dot(rgb, coefficients), clamped to maximum\n"
+                                     "uniform vec3 yuv_coefficients;\n"
+                                     "uniform float yuv_offset;\n"
+                                     "uniform float yuv_scale;\n"
+                                     "uniform float yuv_maximum;\n"
+                                     "\n"
+                                     "varying vec2 ove_texcoord;\n"
+                                     "\n");
+
+  frag_code.append(CodeAlphaDisassociate(QStringLiteral("disassoc")));
+
+  frag_code.append(QStringLiteral("\n"
+                                  "vec3 yuv_sample(vec2 coord) {\n"
+                                  "  // Bias down to the base level, mipmaps would blur in pixels outside of this block\n"
+                                  "  vec4 col = disassoc(texture2D(ove_maintex, coord, -16.0));\n"
+                                  "  return clamp(col.rgb, 0.0, 1.0);\n"
+                                  "}\n"
+                                  "\n"
+                                  "void main() {\n"
+                                  "  vec2 origin = floor(gl_FragCoord.xy) * yuv_subsampling * yuv_texel_size;\n"
+                                  "  vec2 first = 0.5 * yuv_texel_size;\n"
+                                  "  vec2 last = (yuv_subsampling - vec2(0.5)) * yuv_texel_size;\n"
+                                  "\n"
+                                  "  vec3 rgb = (yuv_sample(origin + first)\n"
+                                  "              + yuv_sample(origin + vec2(last.x, first.y))\n"
+                                  "              + yuv_sample(origin + vec2(first.x, last.y))\n"
+                                  "              + yuv_sample(origin + last)) * 0.25;\n"
+                                  "\n"
+                                  "  float value = yuv_offset + yuv_scale * dot(rgb, yuv_coefficients);\n"
+                                  "\n"
+                                  "  gl_FragColor = vec4(clamp(value, 0.0, yuv_maximum), 0.0, 0.0, 1.0);\n"
+                                  "}\n"));
+
+  return frag_code;
+}
+
 QString OpenGLShader::CodeAlphaDisassociate(const QString &function_name)
 {
   return QStringLiteral("vec4 %1(vec4 col) {\n"
@@ -25,9 +25,18 @@ public:
                                     OCIO::ConstProcessorRcPtr processor,
                                     bool alpha_is_associated);
 
+  /**
+   * @brief Create a shader that converts an RGBA texture into one plane of a Y'CbCr image
+   *
+   * Renders into the red channel at the plane's resolution. Each output sample averages the block of source pixels it
+   * covers according to `yuv_subsampling`, which must be set along with the other `yuv_` uniforms before drawing.
+   */
+  static OpenGLShaderPtr CreateYUVPlane();
+
   static QString CodeDefaultFragment(const QString &function_name = QString(),
                                      const QString &shader_code = QString());
   static QString CodeDefaultVertex();
+  static QString CodeYUVPlaneFragment();
   static QString CodeAlphaDisassociate(const QString& function_name);
   static QString CodeAlphaReassociate(const QString& function_name);
   static QString CodeAlphaAssociate(const QString& function_name);
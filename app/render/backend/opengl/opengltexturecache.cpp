@@ -1,7 +1,20 @@
 #include "opengltexturecache.h"
 
+#include "render/memorymanager.h"
+
+OpenGLTextureCache::OpenGLTextureCache() :
+  reclaim_requested_(0)
+{
+  memory_consumer_ = MemoryManager::AddConsumer(QStringLiteral("OpenGL texture pool"),
+                                                MemoryManager::kPriorityPool,
+                                                [this](qint64 bytes){return RequestReclaim(bytes);});
+}
+
 OpenGLTextureCache::~OpenGLTextureCache()
 {
+  // Unregister before anything else so a reclaim can't reach us while we're being destroyed
+  MemoryManager::RemoveConsumer(memory_consumer_);
+
   foreach (Reference* ref, existing_references_) {
     ref->ParentKilled();
   }
@@ -13,6 +26,10 @@ OpenGLTextureCache::ReferencePtr OpenGLTextureCache::Get(QOpenGLContext* ctx, co
 
   lock_.lock();
 
+  if (reclaim_requested_ > 0) {
+    ReclaimAvailableTextures();
+  }
+
   // Iterate through textures and see if we have one that matches these parameters
   for (int i=0;i<available_textures_.size();i++) {
     OpenGLTexturePtr test = available_textures_.at(i);
@@ -30,6 +47,8 @@ OpenGLTextureCache::ReferencePtr OpenGLTextureCache::Get(QOpenGLContext* ctx, co
   if (!texture) {
     texture = std::make_shared<OpenGLTexture>();
     texture->Create(ctx, params.effective_width(), params.effective_height(), params.format());
+
+    MemoryManager::Allocated(memory_consumer_, TextureSize(texture));
   }
 
   ReferencePtr ref = std::make_shared<Reference>(this, texture);
@@ -44,6 +63,41 @@ OpenGLTextureCache::ReferencePtr OpenGLTextureCache::Get(QOpenGLContext* ctx, co
   return ref;
 }
 
+qint64 OpenGLTextureCache::RequestReclaim(qint64 bytes)
+{
+  QMutexLocker locker(&lock_);
+
+  qint64 available = 0;
+
+  foreach (OpenGLTexturePtr texture, available_textures_) {
+    available += TextureSize(texture);
+  }
+
+  // Anything over what's available can't be freed by us
+  reclaim_requested_ = qMin(bytes, available);
+
+  return reclaim_requested_;
+}
+
+void OpenGLTextureCache::ReclaimAvailableTextures()
+{
+  qint64 freed = 0;
+
+  // Textures are appended as they're relinquished, so the ones at the start have been unused the longest
+  while (freed < reclaim_requested_ && !available_textures_.isEmpty()) {
+    freed += TextureSize(available_textures_.takeFirst());
+  }
+
+  reclaim_requested_ = 0;
+
+  MemoryManager::Freed(memory_consumer_, freed);
+}
+
+qint64 OpenGLTextureCache::TextureSize(OpenGLTexturePtr texture)
+{
+  return PixelFormat::GetBufferSize(texture->format(), texture->width(), texture->height());
+}
+
 void OpenGLTextureCache::Relinquish(OpenGLTextureCache::Reference *ref)
 {
   OpenGLTexturePtr tex = ref->texture();
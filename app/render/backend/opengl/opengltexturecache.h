@@ -29,7 +29,7 @@ public:
 
   using ReferencePtr = std::shared_ptr<Reference>;
 
-  OpenGLTextureCache() = default;
+  OpenGLTextureCache();
 
   ~OpenGLTextureCache();
 
@@ -40,8 +40,24 @@ public:
 private:
   void Relinquish(Reference* ref);
 
+  /**
+   * @brief MemoryManager reclaim function, textures can only be destroyed in our thread so this only requests it
+   */
+  qint64 RequestReclaim(qint64 bytes);
+
+  /**
+   * @brief Destroy available textures as requested by RequestReclaim(), assumes the lock is held
+   */
+  void ReclaimAvailableTextures();
+
+  static qint64 TextureSize(OpenGLTexturePtr texture);
+
   QMutex lock_;
 
+  int memory_consumer_;
+
+  qint64 reclaim_requested_;
+
   QList<OpenGLTexturePtr> available_textures_;
 
   QList<Reference*> existing_references_;
@@ -28,3 +28,8 @@ void OpenGLWorker::TextureToBuffer(const QVariant &tex_in, void *buffer)
 {
   emit RequestTextureToBuffer(tex_in, buffer);
 }
+
+void OpenGLWorker::TextureToPlanes(const QVariant &tex_in, void *buffer)
+{
+  emit RequestTextureToPlanes(tex_in, buffer);
+}
@@ -22,6 +22,8 @@ signals:
 
   void RequestTextureToBuffer(const QVariant& texture, void *buffer);
 
+  void RequestTextureToPlanes(const QVariant& texture, void *buffer);
+
 protected:
   virtual void FrameToValue(DecoderPtr decoder, StreamPtr stream, const TimeRange &range, NodeValueTable* table) override;
 
@@ -29,6 +31,8 @@ protected:
 
   virtual void TextureToBuffer(const QVariant& texture, void *buffer) override;
 
+  virtual void TextureToPlanes(const QVariant& texture, void *buffer) override;
+
 };
 
 #endif // OPENGLPROCESSOR_H
@@ -0,0 +1,290 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "renderprocess.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+
+RenderProcess::RenderProcess(int index, int slot_count, QObject *parent) :
+  QObject(parent),
+  index_(index),
+  ready_(false),
+  stopping_(false)
+{
+  slot_times_.resize(slot_count);
+  slot_busy_.resize(slot_count);
+  slot_busy_.fill(false);
+
+  shared_memory_.setKey(QStringLiteral("olive-render-%1-%2").arg(QString::number(QCoreApplication::applicationPid()),
+                                                                 QString::number(index_)));
+
+  // Let the worker's log output through to our own
+  process_.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+  connect(&process_, &QProcess::started, this, &RenderProcess::ProcessStarted);
+  connect(&process_, &QProcess::readyReadStandardOutput, this, &RenderProcess::ReadOutput);
+  connect(&process_, &QProcess::errorOccurred, this, &RenderProcess::ProcessError);
+  connect(&process_,
+          static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+          this,
+          &RenderProcess::ProcessFinished);
+
+  kill_timer_.setSingleShot(true);
+  kill_timer_.setInterval(kStopTimeout);
+  connect(&kill_timer_, &QTimer::timeout, &process_, &QProcess::kill);
+}
+
+RenderProcess::~RenderProcess()
+{
+  // We're normally only destroyed once the worker has exited (see Stopped()). If it hasn't, QProcess's destructor
+  // kills it, and we don't want to hear about that.
+  disconnect(&process_, nullptr, this, nullptr);
+}
+
+bool RenderProcess::Start(const QByteArray &project_xml, int sequence_index, const VideoRenderingParams &params, int numa_node)
+{
+  if (process_.state() != QProcess::NotRunning) {
+    qWarning() << "Attempted to start render worker" << index_ << "while it's still running";
+    return false;
+  }
+
+  params_ = params;
+  stopping_ = false;
+  read_buffer_.clear();
+  slot_busy_.fill(false);
+
+  int segment_size = frame_size() * slot_times_.size();
+
+  if (shared_memory_.isAttached() && shared_memory_.size() < segment_size) {
+    shared_memory_.detach();
+  }
+
+  if (!shared_memory_.isAttached() && !shared_memory_.create(segment_size)) {
+    if (shared_memory_.error() == QSharedMemory::AlreadyExists) {
+      // A previous session may have left this segment behind, attaching and detaching will clean it up on platforms
+      // that require it
+      if (shared_memory_.attach()) {
+        shared_memory_.detach();
+      }
+    }
+
+    if (!shared_memory_.create(segment_size)) {
+      qWarning() << "Failed to create shared memory for render worker" << index_ << shared_memory_.errorString();
+      return false;
+    }
+  }
+
+  snapshot_.clear();
+
+  QDataStream ds(&snapshot_, QIODevice::WriteOnly);
+
+  ds << project_xml
+     << sequence_index
+     << params_.width()
+     << params_.height()
+     << params_.time_base().toString()
+     << static_cast<int>(params_.format())
+     << static_cast<int>(params_.mode())
+     << shared_memory_.key()
+     << slot_times_.size()
+     << numa_node;
+
+  // The snapshot is sent from ProcessStarted()
+  process_.start(QCoreApplication::applicationFilePath(),
+                 {QStringLiteral("--%1").arg(RenderProcessProtocol::kWorkerOption)});
+
+  return true;
+}
+
+void RenderProcess::Stop()
+{
+  ready_ = false;
+
+  if (process_.state() == QProcess::NotRunning) {
+    emit Stopped();
+    return;
+  }
+
+  if (stopping_) {
+    return;
+  }
+
+  stopping_ = true;
+
+  // Closing the worker's input makes it exit cleanly, if it doesn't we kill it
+  process_.closeWriteChannel();
+
+  kill_timer_.start();
+}
+
+bool RenderProcess::IsReady() const
+{
+  return ready_;
+}
+
+bool RenderProcess::HasFreeSlot() const
+{
+  return ready_ && slot_busy_.contains(false);
+}
+
+void RenderProcess::Render(const rational &time)
+{
+  int slot = slot_busy_.indexOf(false);
+
+  if (!ready_ || slot == -1) {
+    qCritical() << "Attempted to queue a frame on a render worker that can't take it";
+    return;
+  }
+
+  slot_times_.replace(slot, time);
+  slot_busy_.replace(slot, true);
+
+  QByteArray payload;
+  QDataStream ds(&payload, QIODevice::WriteOnly);
+  ds << slot << time.toString();
+
+  RenderProcessProtocol::WriteMessage(&process_, RenderProcessProtocol::kRender, payload);
+}
+
+int RenderProcess::frame_size() const
+{
+  return PixelFormat::GetBufferSize(params_.format(), params_.effective_width(), params_.effective_height());
+}
+
+QList<rational> RenderProcess::TakeBusySlots()
+{
+  QList<rational> busy_frames;
+
+  for (int i=0;i<slot_busy_.size();i++) {
+    if (slot_busy_.at(i)) {
+      busy_frames.append(slot_times_.at(i));
+    }
+  }
+
+  slot_busy_.fill(false);
+
+  return busy_frames;
+}
+
+void RenderProcess::ProcessStarted()
+{
+  if (stopping_) {
+    // Stopped before it even got going, closing the write channel will see it out
+    return;
+  }
+
+  RenderProcessProtocol::WriteMessage(&process_, RenderProcessProtocol::kSnapshot, snapshot_);
+  snapshot_.clear();
+}
+
+void RenderProcess::ReadOutput()
+{
+  read_buffer_.append(process_.readAllStandardOutput());
+
+  RenderProcessProtocol::MessageType type;
+  QByteArray payload;
+
+  while (RenderProcessProtocol::TakeMessage(&read_buffer_, &type, &payload)) {
+    switch (type) {
+    case RenderProcessProtocol::kReady:
+      ready_ = true;
+      emit Ready();
+      break;
+    case RenderProcessProtocol::kFailed:
+      qWarning() << "Render worker" << index_ << "failed to load its snapshot";
+      process_.kill();
+      break;
+    case RenderProcessProtocol::kFrameReady:
+    {
+      QDataStream ds(payload);
+
+      int slot, width, height, format;
+      ds >> slot >> width >> height >> format;
+
+      if (slot < 0 || slot >= slot_busy_.size() || !slot_busy_.at(slot)) {
+        qWarning() << "Render worker" << index_ << "returned an invalid slot" << slot;
+        break;
+      }
+
+      FramePtr frame = Frame::Create();
+      frame->set_width(width);
+      frame->set_height(height);
+      frame->set_format(static_cast<PixelFormat::Format>(format));
+      frame->allocate();
+
+      shared_memory_.lock();
+      memcpy(frame->data(),
+             static_cast<const char*>(shared_memory_.constData()) + slot * frame_size(),
+             static_cast<size_t>(qMin(frame->allocated_size(), frame_size())));
+      shared_memory_.unlock();
+
+      slot_busy_.replace(slot, false);
+
+      emit FrameReady(slot_times_.at(slot), frame);
+      break;
+    }
+    case RenderProcessProtocol::kSnapshot:
+    case RenderProcessProtocol::kRender:
+      // These are never sent to us
+      break;
+    }
+  }
+}
+
+void RenderProcess::ProcessError(QProcess::ProcessError error)
+{
+  // Any other error is either followed by finished() or doesn't stop the worker
+  if (error != QProcess::FailedToStart) {
+    return;
+  }
+
+  ready_ = false;
+  kill_timer_.stop();
+
+  QList<rational> lost_frames = TakeBusySlots();
+
+  if (stopping_) {
+    emit Stopped();
+    return;
+  }
+
+  qWarning() << "Failed to start render worker" << index_ << process_.errorString();
+
+  emit Crashed(lost_frames);
+}
+
+void RenderProcess::ProcessFinished(int exit_code, QProcess::ExitStatus status)
+{
+  ready_ = false;
+  kill_timer_.stop();
+
+  QList<rational> lost_frames = TakeBusySlots();
+
+  if (stopping_) {
+    emit Stopped();
+    return;
+  }
+
+  qWarning() << "Render worker" << index_ << "exited unexpectedly with code" << exit_code << "status" << status;
+
+  emit Crashed(lost_frames);
+}
@@ -0,0 +1,136 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef RENDERPROCESS_H
+#define RENDERPROCESS_H
+
+#include <QProcess>
+#include <QSharedMemory>
+#include <QTimer>
+#include <QVector>
+
+#include "codec/frame.h"
+#include "render/videoparams.h"
+#include "renderprocessprotocol.h"
+
+/**
+ * @brief Editor-side handle to a single out-of-process render worker
+ *
+ * Launches Olive as a headless worker (see RenderProcessServer), sends it a graph snapshot and then frame jobs. Each
+ * job is assigned a slot in a shared memory segment that the worker writes the finished frame into, so frames never
+ * travel through the pipe. If the worker dies for any reason, Crashed() is emitted with the frames that were still in
+ * flight so they can be reassigned.
+ *
+ * Starting and stopping never wait on the worker, so they're safe to call from a thread with other work to do.
+ */
+class RenderProcess : public QObject
+{
+  Q_OBJECT
+public:
+  RenderProcess(int index, int slot_count, QObject* parent = nullptr);
+
+  virtual ~RenderProcess() override;
+
+  /**
+   * @brief Start the worker process and send it a snapshot once it's running
+   *
+   * Returns false if the worker couldn't be set up. If the process itself fails to launch, that's reported later
+   * through Crashed().
+   *
+   * @param project_xml
+   *
+   * The serialized project containing the sequence to render.
+   *
+   * @param sequence_index
+   *
+   * Index of the sequence to render in a depth-first traversal of the project.
+   *
+   * @param numa_node
+   *
+   * NUMA node to pin this worker to, or -1 to let the OS schedule it.
+   */
+  bool Start(const QByteArray& project_xml, int sequence_index, const VideoRenderingParams& params, int numa_node);
+
+  /**
+   * @brief Ask the worker to exit, Stopped() is emitted once it has
+   *
+   * Workers that haven't exited within kStopTimeout are killed.
+   */
+  void Stop();
+
+  bool IsReady() const;
+
+  bool HasFreeSlot() const;
+
+  void Render(const rational& time);
+
+signals:
+  void Ready();
+
+  void FrameReady(const rational& time, FramePtr frame);
+
+  void Crashed(const QList<rational>& lost_frames);
+
+  void Stopped();
+
+private:
+  int frame_size() const;
+
+  /**
+   * @brief Free every slot and return the frames that were still assigned to them
+   */
+  QList<rational> TakeBusySlots();
+
+  int index_;
+
+  QProcess process_;
+
+  QSharedMemory shared_memory_;
+
+  QByteArray read_buffer_;
+
+  QByteArray snapshot_;
+
+  QTimer kill_timer_;
+
+  VideoRenderingParams params_;
+
+  QVector<rational> slot_times_;
+
+  QVector<bool> slot_busy_;
+
+  bool ready_;
+
+  bool stopping_;
+
+  static const int kStopTimeout = 3000;
+
+private slots:
+  void ProcessStarted();
+
+  void ReadOutput();
+
+  void ProcessError(QProcess::ProcessError error);
+
+  void ProcessFinished(int exit_code, QProcess::ExitStatus status);
+
+};
+
+#endif // RENDERPROCESS_H
@@ -0,0 +1,281 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "renderprocesspool.h"
+
+#include <QDir>
+#include <QThread>
+#include <QXmlStreamWriter>
+
+#include "config/config.h"
+#include "project/item/sequence/sequence.h"
+#include "project/project.h"
+
+RenderProcessPool::RenderProcessPool(QObject *parent) :
+  QObject(parent),
+  sequence_index_(-1),
+  render_limit_(RATIONAL_MAX),
+  numa_node_count_(0)
+{
+}
+
+RenderProcessPool::~RenderProcessPool()
+{
+  Stop();
+}
+
+bool RenderProcessPool::IsEnabled()
+{
+  return Config::Current()["RenderWorkerProcesses"].toInt() > 0;
+}
+
+bool RenderProcessPool::Start(ViewerOutput *viewer, const VideoRenderingParams &params)
+{
+  Stop();
+
+  int process_count = Config::Current()["RenderWorkerProcesses"].toInt();
+
+  if (process_count <= 0) {
+    return false;
+  }
+
+  // The viewer's parent graph is the sequence it belongs to
+  Sequence* sequence = dynamic_cast<Sequence*>(viewer->parent());
+
+  if (!sequence || !sequence->project()) {
+    qWarning() << "Failed to find project for out-of-process rendering";
+    return false;
+  }
+
+  Project* project = sequence->project();
+
+  sequence_index_ = IndexOfSequence(project->root(), viewer);
+
+  if (sequence_index_ == -1) {
+    qWarning() << "Failed to find sequence for out-of-process rendering";
+    return false;
+  }
+
+  // Snapshot the project as it is right now, the workers will render from this regardless of what the user does
+  // in the meantime
+  project_xml_.clear();
+
+  QXmlStreamWriter writer(&project_xml_);
+  writer.writeStartDocument();
+  project->Save(&writer);
+  writer.writeEndDocument();
+
+  params_ = params;
+
+  // Spread our threads over the processes, each slot is one frame that can be in flight at a time
+  int slot_count = qMax(1, QThread::idealThreadCount() / process_count);
+
+  numa_node_count_ = Config::Current()["RenderWorkerPinNuma"].toBool() ? NumaNodeCount() : 0;
+
+  for (int i=0;i<process_count;i++) {
+    RenderProcess* process = new RenderProcess(i, slot_count, this);
+
+    connect(process, &RenderProcess::Ready, this, &RenderProcessPool::DispatchNext);
+    connect(process, &RenderProcess::FrameReady, this, &RenderProcessPool::ProcessFrameReady);
+
+    // Queued so that the process is restarted outside of QProcess's own signal handling
+    connect(process, &RenderProcess::Crashed, this, &RenderProcessPool::ProcessCrashed, Qt::QueuedConnection);
+
+    if (StartProcess(process)) {
+      processes_.append(process);
+      restart_counts_.append(0);
+    } else {
+      delete process;
+    }
+  }
+
+  return !processes_.isEmpty();
+}
+
+void RenderProcessPool::Stop()
+{
+  foreach (RenderProcess* process, processes_) {
+    // Let each worker exit in its own time rather than waiting on it, it cleans itself up once it has. It's no longer
+    // ours, so it outlives us if it has to.
+    disconnect(process, nullptr, this, nullptr);
+    process->setParent(nullptr);
+    connect(process, &RenderProcess::Stopped, process, &RenderProcess::deleteLater);
+
+    process->Stop();
+  }
+
+  processes_.clear();
+  restart_counts_.clear();
+
+  queue_.clear();
+}
+
+void RenderProcessPool::Render(const QList<rational> &times)
+{
+  queue_.append(times);
+
+  DispatchNext();
+}
+
+void RenderProcessPool::SetRenderLimit(const rational &time)
+{
+  bool raised = (time > render_limit_);
+
+  render_limit_ = time;
+
+  if (raised) {
+    DispatchNext();
+  }
+}
+
+int RenderProcessPool::IndexOfSequence(const Item *folder, const ViewerOutput *viewer)
+{
+  int counter = 0;
+
+  return IndexOfSequenceInternal(folder, viewer, &counter);
+}
+
+ViewerOutput *RenderProcessPool::SequenceAtIndex(const Item *folder, int index)
+{
+  int counter = 0;
+
+  return SequenceAtIndexInternal(folder, index, &counter);
+}
+
+int RenderProcessPool::NumaNodeCount()
+{
+#ifdef Q_OS_LINUX
+  QStringList nodes = QDir(QStringLiteral("/sys/devices/system/node")).entryList({QStringLiteral("node*")},
+                                                                                 QDir::Dirs);
+
+  return qMax(1, nodes.size());
+#else
+  return 1;
+#endif
+}
+
+int RenderProcessPool::IndexOfSequenceInternal(const Item *folder, const ViewerOutput *viewer, int *counter)
+{
+  foreach (ItemPtr child, folder->children()) {
+    if (child->type() == Item::kSequence) {
+      if (static_cast<Sequence*>(child.get())->viewer_output() == viewer) {
+        return *counter;
+      }
+
+      (*counter)++;
+    } else if (child->CanHaveChildren()) {
+      int index = IndexOfSequenceInternal(child.get(), viewer, counter);
+
+      if (index > -1) {
+        return index;
+      }
+    }
+  }
+
+  return -1;
+}
+
+ViewerOutput *RenderProcessPool::SequenceAtIndexInternal(const Item *folder, int index, int *counter)
+{
+  foreach (ItemPtr child, folder->children()) {
+    if (child->type() == Item::kSequence) {
+      if (*counter == index) {
+        return static_cast<Sequence*>(child.get())->viewer_output();
+      }
+
+      (*counter)++;
+    } else if (child->CanHaveChildren()) {
+      ViewerOutput* viewer = SequenceAtIndexInternal(child.get(), index, counter);
+
+      if (viewer) {
+        return viewer;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+bool RenderProcessPool::StartProcess(RenderProcess *process)
+{
+  int numa_node = -1;
+
+  if (numa_node_count_ > 1) {
+    // Round-robin workers over the NUMA nodes
+    numa_node = processes_.contains(process) ? processes_.indexOf(process) : processes_.size();
+    numa_node %= numa_node_count_;
+  }
+
+  return process->Start(project_xml_, sequence_index_, params_, numa_node);
+}
+
+void RenderProcessPool::DispatchNext()
+{
+  foreach (RenderProcess* process, processes_) {
+    // The queue is in time order, so everything after a frame past the limit is too
+    while (!queue_.isEmpty() && queue_.first() <= render_limit_ && process->HasFreeSlot()) {
+      process->Render(queue_.takeFirst());
+    }
+  }
+}
+
+void RenderProcessPool::ProcessFrameReady(const rational &time, FramePtr frame)
+{
+  emit FrameRendered(time, frame);
+
+  DispatchNext();
+}
+
+void RenderProcessPool::ProcessCrashed(const QList<rational> &lost_frames)
+{
+  RenderProcess* process = static_cast<RenderProcess*>(sender());
+  int index = processes_.indexOf(process);
+
+  // Put the lost frames back at the front of the queue
+  for (int i=lost_frames.size()-1;i>=0;i--) {
+    queue_.prepend(lost_frames.at(i));
+  }
+
+  if (index == -1) {
+    return;
+  }
+
+  restart_counts_[index]++;
+
+  if (restart_counts_.at(index) <= kMaximumRestarts && StartProcess(process)) {
+    // Process will call DispatchNext() again once it's ready
+    return;
+  }
+
+  qWarning() << "Removing render worker" << index << "from pool after too many failures";
+
+  processes_.removeAt(index);
+  restart_counts_.removeAt(index);
+  process->deleteLater();
+
+  if (processes_.isEmpty()) {
+    QList<rational> unrendered = queue_;
+    queue_.clear();
+
+    emit Failed(unrendered);
+  } else {
+    DispatchNext();
+  }
+}
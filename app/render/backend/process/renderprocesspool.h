@@ -0,0 +1,116 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef RENDERPROCESSPOOL_H
+#define RENDERPROCESSPOOL_H
+
+#include "node/output/viewer/viewer.h"
+#include "project/item/item.h"
+#include "renderprocess.h"
+
+/**
+ * @brief Distributes frames over a set of out-of-process render workers
+ *
+ * Used instead of in-process RenderWorker threads when "RenderWorkerProcesses" is set in the Config. A crashing worker
+ * (driver fault, decoder crash, OOM) only takes down its own process. Its frames are requeued and the worker is
+ * restarted from the same snapshot, up to a limit, after which it's dropped from the pool. If every worker has been
+ * dropped, Failed() is emitted with the frames that couldn't be rendered so the caller can fall back to in-process
+ * rendering.
+ */
+class RenderProcessPool : public QObject
+{
+  Q_OBJECT
+public:
+  RenderProcessPool(QObject* parent = nullptr);
+
+  virtual ~RenderProcessPool() override;
+
+  /**
+   * @brief Returns whether the user has enabled out-of-process rendering
+   */
+  static bool IsEnabled();
+
+  /**
+   * @brief Snapshot the project that `viewer` belongs to and start the worker processes
+   */
+  bool Start(ViewerOutput* viewer, const VideoRenderingParams& params);
+
+  void Stop();
+
+  void Render(const QList<rational>& times);
+
+  /**
+   * @brief Don't send any frame after `time` to a worker until the limit is raised again, see
+   * VideoRenderBackend::SetRenderLimit()
+   */
+  void SetRenderLimit(const rational& time);
+
+  /**
+   * @brief Find a sequence's index in a depth-first traversal of the project, or -1 if it couldn't be found
+   */
+  static int IndexOfSequence(const Item* folder, const ViewerOutput* viewer);
+
+  /**
+   * @brief Retrieve the sequence's viewer at a certain index (see IndexOfSequence())
+   */
+  static ViewerOutput* SequenceAtIndex(const Item* folder, int index);
+
+signals:
+  void FrameRendered(const rational& time, FramePtr frame);
+
+  void Failed(const QList<rational>& unrendered_frames);
+
+private:
+  static int NumaNodeCount();
+
+  static int IndexOfSequenceInternal(const Item* folder, const ViewerOutput* viewer, int* counter);
+
+  static ViewerOutput* SequenceAtIndexInternal(const Item* folder, int index, int* counter);
+
+  bool StartProcess(RenderProcess* process);
+
+  void DispatchNext();
+
+  QVector<RenderProcess*> processes_;
+
+  QVector<int> restart_counts_;
+
+  QList<rational> queue_;
+
+  rational render_limit_;
+
+  QByteArray project_xml_;
+
+  int sequence_index_;
+
+  VideoRenderingParams params_;
+
+  int numa_node_count_;
+
+  static const int kMaximumRestarts = 3;
+
+private slots:
+  void ProcessFrameReady(const rational& time, FramePtr frame);
+
+  void ProcessCrashed(const QList<rational>& lost_frames);
+
+};
+
+#endif // RENDERPROCESSPOOL_H
@@ -0,0 +1,59 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "renderprocessprotocol.h"
+
+#include <QtEndian>
+
+const char* RenderProcessProtocol::kWorkerOption = "render-worker";
+
+void RenderProcessProtocol::WriteMessage(QIODevice *device, RenderProcessProtocol::MessageType type, const QByteArray &payload)
+{
+  uchar header[kHeaderSize];
+
+  qToBigEndian<quint32>(static_cast<quint32>(type), header);
+  qToBigEndian<quint32>(static_cast<quint32>(payload.size()), header + 4);
+
+  device->write(reinterpret_cast<const char*>(header), kHeaderSize);
+  device->write(payload);
+}
+
+bool RenderProcessProtocol::TakeMessage(QByteArray *buffer, RenderProcessProtocol::MessageType *type, QByteArray *payload)
+{
+  if (buffer->size() < kHeaderSize) {
+    return false;
+  }
+
+  const uchar* header = reinterpret_cast<const uchar*>(buffer->constData());
+
+  quint32 payload_size = qFromBigEndian<quint32>(header + 4);
+
+  if (static_cast<quint32>(buffer->size() - kHeaderSize) < payload_size) {
+    // Rest of the payload hasn't arrived yet
+    return false;
+  }
+
+  *type = static_cast<MessageType>(qFromBigEndian<quint32>(header));
+  *payload = buffer->mid(kHeaderSize, static_cast<int>(payload_size));
+
+  buffer->remove(0, kHeaderSize + static_cast<int>(payload_size));
+
+  return true;
+}
@@ -0,0 +1,74 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef RENDERPROCESSPROTOCOL_H
+#define RENDERPROCESSPROTOCOL_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+/**
+ * @brief Message framing shared by RenderProcess (editor side) and RenderProcessServer (worker side)
+ *
+ * Messages are sent over the worker's standard input/output pipes. Each message is an 8-byte header (big-endian
+ * message type and payload length) followed by the payload, which is usually a QDataStream. Pixel data never goes
+ * through the pipe, it's written into a QSharedMemory segment that both processes have attached to.
+ */
+class RenderProcessProtocol {
+public:
+  enum MessageType {
+    /// Editor -> worker: serialized project, sequence to render and rendering parameters
+    kSnapshot,
+
+    /// Editor -> worker: render a frame into a shared memory slot
+    kRender,
+
+    /// Worker -> editor: the snapshot was loaded and the worker is ready for jobs
+    kReady,
+
+    /// Worker -> editor: a frame has been written into its shared memory slot
+    kFrameReady,
+
+    /// Worker -> editor: the snapshot could not be loaded
+    kFailed
+  };
+
+  /**
+   * @brief Command line option that starts Olive as a headless render worker
+   */
+  static const char* kWorkerOption;
+
+  static void WriteMessage(QIODevice* device, MessageType type, const QByteArray& payload = QByteArray());
+
+  /**
+   * @brief Take one complete message from the front of `buffer`
+   *
+   * @return TRUE if a message was taken, FALSE if the buffer doesn't contain a full message yet
+   */
+  static bool TakeMessage(QByteArray* buffer, MessageType* type, QByteArray* payload);
+
+  /**
+   * @brief Size of the header that precedes each message payload
+   */
+  static const int kHeaderSize = 8;
+
+};
+
+#endif // RENDERPROCESSPROTOCOL_H
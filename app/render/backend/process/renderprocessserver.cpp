@@ -0,0 +1,278 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "renderprocessserver.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QtEndian>
+#include <QXmlStreamReader>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+#include "renderprocesspool.h"
+
+RenderProcessInput::RenderProcessInput(QObject *parent) :
+  QThread(parent)
+{
+}
+
+void RenderProcessInput::run()
+{
+  QFile input;
+
+  if (input.open(stdin, QFile::ReadOnly | QFile::Unbuffered)) {
+    forever {
+      // Unbuffered reads on a pipe block until the requested size has arrived or the pipe was closed
+      QByteArray message = input.read(RenderProcessProtocol::kHeaderSize);
+
+      if (message.size() < RenderProcessProtocol::kHeaderSize) {
+        break;
+      }
+
+      int payload_size = static_cast<int>(qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(message.constData()) + 4));
+
+      if (payload_size > 0) {
+        QByteArray payload = input.read(payload_size);
+
+        if (payload.size() < payload_size) {
+          break;
+        }
+
+        message.append(payload);
+      }
+
+      RenderProcessProtocol::MessageType type;
+      QByteArray payload;
+
+      if (RenderProcessProtocol::TakeMessage(&message, &type, &payload)) {
+        emit MessageReceived(type, payload);
+      }
+    }
+  }
+
+  emit Closed();
+}
+
+RenderProcessServer::RenderProcessServer(QObject *parent) :
+  QObject(parent),
+  backend_(nullptr),
+  frame_size_(0)
+{
+}
+
+RenderProcessServer::~RenderProcessServer()
+{
+  delete backend_;
+
+  if (!input_.wait(1000)) {
+    // Still blocking on a read, at this point we don't care
+    input_.terminate();
+    input_.wait();
+  }
+}
+
+void RenderProcessServer::Start()
+{
+  // Our standard output is reserved for protocol messages, any logging goes through standard error
+  output_.open(stdout, QFile::WriteOnly | QFile::Unbuffered);
+
+  connect(&input_, &RenderProcessInput::MessageReceived, this, &RenderProcessServer::MessageReceived, Qt::QueuedConnection);
+  connect(&input_, &RenderProcessInput::Closed, qApp, &QCoreApplication::quit, Qt::QueuedConnection);
+
+  input_.start();
+}
+
+bool RenderProcessServer::LoadSnapshot(const QByteArray &payload)
+{
+  QDataStream ds(payload);
+
+  QByteArray project_xml;
+  int sequence_index, width, height, format, mode, slot_count, numa_node;
+  QString time_base, shared_key;
+
+  ds >> project_xml
+     >> sequence_index
+     >> width
+     >> height
+     >> time_base
+     >> format
+     >> mode
+     >> shared_key
+     >> slot_count
+     >> numa_node;
+
+  // Pin before the backend creates any threads so that they inherit our affinity
+  if (numa_node >= 0) {
+    PinToNumaNode(numa_node);
+  }
+
+  project_ = std::make_shared<Project>();
+
+  QXmlStreamReader reader(project_xml);
+
+  while (!reader.atEnd()) {
+    reader.readNext();
+
+    if (reader.isStartElement() && reader.name() == "project") {
+      project_->Load(&reader, nullptr);
+    }
+  }
+
+  if (reader.hasError()) {
+    qWarning() << "Render worker failed to parse snapshot:" << reader.errorString();
+    return false;
+  }
+
+  ViewerOutput* viewer = RenderProcessPool::SequenceAtIndex(project_->root(), sequence_index);
+
+  if (!viewer) {
+    qWarning() << "Render worker failed to find sequence" << sequence_index;
+    return false;
+  }
+
+  VideoRenderingParams params(width,
+                              height,
+                              rational::fromString(time_base),
+                              static_cast<PixelFormat::Format>(format),
+                              static_cast<RenderMode::Mode>(mode));
+
+  time_base_ = params.time_base();
+  frame_size_ = PixelFormat::GetBufferSize(params.format(), params.effective_width(), params.effective_height());
+
+  shared_memory_.setKey(shared_key);
+
+  if (!shared_memory_.attach() || shared_memory_.size() < frame_size_ * slot_count) {
+    qWarning() << "Render worker failed to attach to shared memory:" << shared_memory_.errorString();
+    return false;
+  }
+
+  backend_ = new OpenGLBackend();
+
+  backend_->SetLimitCaching(false);
+  backend_->SetViewerNode(viewer);
+  backend_->SetParameters(params);
+  backend_->SetOperatingMode(VideoRenderWorker::kRenderOnly);
+  backend_->SetOnlySignalLastFrameRequested(false);
+
+  connect(backend_, &VideoRenderBackend::GeneratedFrame, this, &RenderProcessServer::FrameGenerated);
+
+  return true;
+}
+
+void RenderProcessServer::Send(RenderProcessProtocol::MessageType type, const QByteArray &payload)
+{
+  RenderProcessProtocol::WriteMessage(&output_, type, payload);
+}
+
+void RenderProcessServer::PinToNumaNode(int node)
+{
+#ifdef Q_OS_LINUX
+  QFile cpu_list_file(QStringLiteral("/sys/devices/system/node/node%1/cpulist").arg(node));
+
+  if (!cpu_list_file.open(QFile::ReadOnly)) {
+    qWarning() << "Failed to read CPU list for NUMA node" << node;
+    return;
+  }
+
+  // CPU lists are formatted like "0-7,16-23"
+  QString cpu_list = QString::fromLatin1(cpu_list_file.readAll()).trimmed();
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+
+  foreach (const QString& range, cpu_list.split(',', QString::SkipEmptyParts)) {
+    QStringList bounds = range.split('-');
+
+    int first = bounds.first().toInt();
+    int last = bounds.last().toInt();
+
+    for (int cpu=first;cpu<=last;cpu++) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpu_set) != 0) {
+    qWarning() << "Failed to pin render worker to NUMA node" << node;
+  }
+#else
+  Q_UNUSED(node)
+#endif
+}
+
+void RenderProcessServer::MessageReceived(int type, const QByteArray &payload)
+{
+  switch (static_cast<RenderProcessProtocol::MessageType>(type)) {
+  case RenderProcessProtocol::kSnapshot:
+    if (!backend_ && LoadSnapshot(payload)) {
+      Send(RenderProcessProtocol::kReady);
+    } else {
+      Send(RenderProcessProtocol::kFailed);
+    }
+    break;
+  case RenderProcessProtocol::kRender:
+  {
+    if (!backend_) {
+      break;
+    }
+
+    QDataStream ds(payload);
+
+    int slot;
+    QString time_string;
+    ds >> slot >> time_string;
+
+    rational time = rational::fromString(time_string);
+
+    pending_slots_.insert(time, slot);
+
+    backend_->InvalidateCache(TimeRange(time, time + time_base_));
+    break;
+  }
+  case RenderProcessProtocol::kReady:
+  case RenderProcessProtocol::kFrameReady:
+  case RenderProcessProtocol::kFailed:
+    // These are never sent to us
+    break;
+  }
+}
+
+void RenderProcessServer::FrameGenerated(const rational &time, FramePtr frame)
+{
+  if (!pending_slots_.contains(time)) {
+    return;
+  }
+
+  int slot = pending_slots_.take(time);
+
+  shared_memory_.lock();
+  memcpy(static_cast<char*>(shared_memory_.data()) + slot * frame_size_,
+         frame->const_data(),
+         static_cast<size_t>(qMin(frame->allocated_size(), frame_size_)));
+  shared_memory_.unlock();
+
+  QByteArray payload;
+  QDataStream ds(&payload, QIODevice::WriteOnly);
+  ds << slot << frame->width() << frame->height() << static_cast<int>(frame->format());
+
+  Send(RenderProcessProtocol::kFrameReady, payload);
+}
@@ -0,0 +1,104 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef RENDERPROCESSSERVER_H
+#define RENDERPROCESSSERVER_H
+
+#include <QFile>
+#include <QSharedMemory>
+#include <QThread>
+
+#include "project/project.h"
+#include "render/backend/opengl/openglbackend.h"
+#include "renderprocessprotocol.h"
+
+/**
+ * @brief Thread that blocks on the worker's standard input and relays complete messages
+ */
+class RenderProcessInput : public QThread
+{
+  Q_OBJECT
+public:
+  RenderProcessInput(QObject* parent = nullptr);
+
+protected:
+  virtual void run() override;
+
+signals:
+  void MessageReceived(int type, const QByteArray& payload);
+
+  /**
+   * @brief Emitted when the editor closed our input (or died), at which point the worker should exit
+   */
+  void Closed();
+
+};
+
+/**
+ * @brief Worker side of out-of-process rendering (see RenderProcess)
+ *
+ * Runs inside an Olive instance started with `--render-worker`. It loads the snapshot it receives into its own Project,
+ * renders requested frames with a regular OpenGLBackend and writes them into the shared memory slot the editor assigned
+ * to each job.
+ */
+class RenderProcessServer : public QObject
+{
+  Q_OBJECT
+public:
+  RenderProcessServer(QObject* parent = nullptr);
+
+  virtual ~RenderProcessServer() override;
+
+  void Start();
+
+private:
+  bool LoadSnapshot(const QByteArray& payload);
+
+  void Send(RenderProcessProtocol::MessageType type, const QByteArray& payload = QByteArray());
+
+  /**
+   * @brief Restrict this process (and any threads it creates afterwards) to the CPUs of a NUMA node
+   */
+  static void PinToNumaNode(int node);
+
+  RenderProcessInput input_;
+
+  QFile output_;
+
+  ProjectPtr project_;
+
+  OpenGLBackend* backend_;
+
+  QSharedMemory shared_memory_;
+
+  int frame_size_;
+
+  rational time_base_;
+
+  QHash<rational, int> pending_slots_;
+
+private slots:
+  void MessageReceived(int type, const QByteArray& payload);
+
+  void FrameGenerated(const rational& time, FramePtr frame);
+
+};
+
+#endif // RENDERPROCESSSERVER_H
@@ -14,7 +14,8 @@ RenderBackend::RenderBackend(QObject *parent) :
   viewer_node_(nullptr),
   copied_viewer_node_(nullptr),
   recompile_queued_(false),
-  input_update_queued_(false)
+  input_update_queued_(false),
+  graph_generation_(0)
 {
   // FIXME: Don't create in CLI mode
   cancel_dialog_ = new RenderCancelDialog(Core::instance()->main_window());
@@ -137,6 +138,19 @@ bool RenderBackend::Compile()
 
   // We just copied the inputs, so if an input update is queued, it's unnecessary
   input_update_queued_ = false;
+  changed_inputs_.clear();
+  resized_arrays_.clear();
+
+  for (int i=0;i<source_node_list_.size();i++) {
+    const QList<NodeParam*>& src_params = source_node_list_.at(i)->parameters();
+    const QList<NodeParam*>& dst_params = copied_graph_.nodes().at(i)->parameters();
+
+    for (int j=0;j<src_params.size();j++) {
+      if (src_params.at(j)->type() == NodeParam::kInput) {
+        TrackInput(static_cast<NodeInput*>(src_params.at(j)), static_cast<NodeInput*>(dst_params.at(j)));
+      }
+    }
+  }
 
   // We know that the first node will be the viewer node since we appended that first in the copy
   copied_viewer_node_ = static_cast<ViewerOutput*>(copied_graph_.nodes().first());
@@ -161,6 +175,17 @@ void RenderBackend::Decompile()
 
   DecompileInternal();
 
+  // Connections to inputs that have since been deleted are already gone, disconnecting them is harmless
+  foreach (const QMetaObject::Connection& c, input_connections_) {
+    disconnect(c);
+  }
+
+  input_connections_.clear();
+  input_copies_.clear();
+  array_elements_.clear();
+  changed_inputs_.clear();
+  resized_arrays_.clear();
+
   copied_graph_.Clear();
   copied_viewer_node_ = nullptr;
   source_node_list_.clear();
@@ -205,6 +230,11 @@ TimeRange RenderBackend::PopNextFrameFromQueue()
   return cache_queue_.takeFirst();
 }
 
+bool RenderBackend::NextFrameIsHeld()
+{
+  return false;
+}
+
 rational RenderBackend::GetSequenceLength()
 {
   if (viewer_node_ == nullptr) {
@@ -239,36 +269,10 @@ void RenderBackend::CacheNext()
     return;
   }
 
-  if (!Init()
-      || !ViewerIsConnected()
-      || !CanRender()) {
-    return;
-  }
-
-  if ((input_update_queued_ || recompile_queued_) && !AllProcessorsAreAvailable()) {
-    return;
-  }
-
-  if (recompile_queued_) {
-    Decompile();
-    recompile_queued_ = false;
-  }
-
-  if (!compiled_ && !Compile()) {
+  if (!PrepareGraph()) {
     return;
   }
 
-  if (input_update_queued_) {
-    for (int i=0;i<source_node_list_.size();i++) {
-      Node* src = source_node_list_.at(i);
-      Node* dst = copied_graph_.nodes().at(i);
-
-      Node::CopyInputs(src, dst, false);
-    }
-
-    input_update_queued_ = false;
-  }
-
   Node* node_connected_to_viewer = GetDependentInput()->get_connected_node();
 
   if (!node_connected_to_viewer) {
@@ -276,7 +280,7 @@ void RenderBackend::CacheNext()
   }
 
   foreach (RenderWorker* worker, processors_) {
-    if (cache_queue_.isEmpty()) {
+    if (cache_queue_.isEmpty() || NextFrameIsHeld()) {
       break;
     }
 
@@ -312,6 +316,163 @@ void RenderBackend::CacheNext()
   }
 }
 
+bool RenderBackend::PrepareGraph()
+{
+  if (!Init()
+      || !ViewerIsConnected()
+      || !CanRender()) {
+    return false;
+  }
+
+  if (recompile_queued_ && !AllProcessorsAreAvailable()) {
+    return false;
+  }
+
+  if (recompile_queued_) {
+    Decompile();
+    recompile_queued_ = false;
+  }
+
+  if (!compiled_ && !Compile()) {
+    return false;
+  }
+
+  if (input_update_queued_ && !UpdateInputSnapshots()) {
+    return false;
+  }
+
+  return true;
+}
+
+bool RenderBackend::UpdateInputSnapshots()
+{
+  QList<QPair<NodeInput*, NodeInput*> > changed_inputs;
+
+  // Resizing creates and destroys inputs, so arrays that were resized get copied whole while idle
+  bool needs_idle = !resized_arrays_.isEmpty();
+
+  foreach (NodeInput* src, changed_inputs_) {
+    NodeInput* dst = input_copies_.value(src);
+
+    // Elements of resized arrays aren't tracked until the array has been copied
+    if (!dst || src->value_version() == dst->value_version()) {
+      continue;
+    }
+
+    changed_inputs.append({src, dst});
+
+    if (src->is_structural()) {
+      needs_idle = true;
+    }
+  }
+
+  if (needs_idle && !AllProcessorsAreAvailable()) {
+    // Try again once the workers are done with the current graph
+    return false;
+  }
+
+  if (changed_inputs.isEmpty() && resized_arrays_.isEmpty()) {
+    changed_inputs_.clear();
+    input_update_queued_ = false;
+    return true;
+  }
+
+  // The generation is odd while inputs are being swapped, so a worker that looks at it before and after a job can tell
+  // whether everything it read came from the same version of the graph
+  graph_generation_.fetchAndAddOrdered(1);
+
+  foreach (NodeInputArray* src_array, resized_arrays_) {
+    NodeInputArray* dst_array = static_cast<NodeInputArray*>(input_copies_.value(src_array));
+
+    NodeInput::CopyValues(src_array, dst_array, false);
+
+    // Pick up the array's new elements
+    TrackInput(src_array, dst_array);
+  }
+
+  for (int i=0;i<changed_inputs.size();i++) {
+    NodeInput* src = changed_inputs.at(i).first;
+    NodeInput* dst = changed_inputs.at(i).second;
+
+    // Structural inputs are only changed while idle, so it's safe to let their nodes react to them
+    dst->SetValueSnapshot(src->CreateValueSnapshot(), src->is_structural());
+  }
+
+  graph_generation_.fetchAndAddOrdered(1);
+
+  changed_inputs_.clear();
+  resized_arrays_.clear();
+  input_update_queued_ = false;
+
+  return true;
+}
+
+void RenderBackend::TrackInput(NodeInput *src, NodeInput *dst)
+{
+  input_copies_.insert(src, dst);
+
+  // Inputs that survive an array resize are tracked again, so don't connect them twice
+  QMetaObject::Connection c = connect(src,
+                                      &NodeInput::ValueVersionChanged,
+                                      this,
+                                      &RenderBackend::InputValueVersionChanged,
+                                      Qt::UniqueConnection);
+
+  if (c) {
+    input_connections_.append(c);
+  }
+
+  if (src->IsArray()) {
+    NodeInputArray* src_array = static_cast<NodeInputArray*>(src);
+    NodeInputArray* dst_array = static_cast<NodeInputArray*>(dst);
+
+    c = connect(src_array,
+                &NodeInputArray::SizeChanged,
+                this,
+                &RenderBackend::InputArraySizeChanged,
+                Qt::UniqueConnection);
+
+    if (c) {
+      input_connections_.append(c);
+    }
+
+    QVector<NodeInput*>& elements = array_elements_[src_array];
+    elements.clear();
+
+    for (int i=0;i<src_array->GetSize();i++) {
+      elements.append(src_array->At(i));
+
+      TrackInput(src_array->At(i), dst_array->At(i));
+    }
+  }
+}
+
+void RenderBackend::UntrackArrayElements(NodeInputArray *array)
+{
+  // Only used as keys, since some of these may have been deleted
+  foreach (NodeInput* element, array_elements_.take(array)) {
+    input_copies_.remove(element);
+    changed_inputs_.remove(element);
+  }
+}
+
+void RenderBackend::InputValueVersionChanged()
+{
+  changed_inputs_.insert(static_cast<NodeInput*>(sender()));
+
+  input_update_queued_ = true;
+}
+
+void RenderBackend::InputArraySizeChanged()
+{
+  NodeInputArray* array = static_cast<NodeInputArray*>(sender());
+
+  UntrackArrayElements(array);
+  resized_arrays_.insert(array);
+
+  input_update_queued_ = true;
+}
+
 ViewerOutput *RenderBackend::viewer_node() const
 {
   return copied_viewer_node_;
@@ -360,6 +521,11 @@ bool RenderBackend::ViewerIsConnected() const
   return viewer_node_ != nullptr;
 }
 
+ViewerOutput *RenderBackend::source_viewer_node() const
+{
+  return viewer_node_;
+}
+
 const QString &RenderBackend::cache_id() const
 {
   return cache_id_;
@@ -420,6 +586,8 @@ void RenderBackend::InitWorkers()
     RenderWorker* processor = processors_.at(i);
     QThread* thread = threads().at(i);
 
+    processor->SetGraphGeneration(&graph_generation_);
+
     // Connect to it
     ConnectWorkerToThis(processor);
 
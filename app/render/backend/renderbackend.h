@@ -2,11 +2,13 @@
 #define RENDERBACKEND_H
 
 #include <QLinkedList>
+#include <QSet>
 
 #include "common/constructors.h"
 #include "dialog/rendercancel/rendercancel.h"
 #include "decodercache.h"
 #include "node/graph.h"
+#include "node/inputarray.h"
 #include "node/output/viewer/viewer.h"
 #include "renderworker.h"
 
@@ -55,6 +57,11 @@ protected:
 
   virtual TimeRange PopNextFrameFromQueue();
 
+  /**
+   * @brief Return true to leave idle workers idle even though frames are queued
+   */
+  virtual bool NextFrameIsHeld();
+
   rational GetSequenceLength();
 
   const QVector<QThread*>& threads();
@@ -80,6 +87,33 @@ protected:
    */
   void CacheNext();
 
+  /**
+   * @brief Bring our copy of the node graph up to date with the source, compiling it if necessary
+   *
+   * Returns false if the graph can't be used right now, e.g. because workers are still busy with the old one.
+   */
+  bool PrepareGraph();
+
+  /**
+   * @brief Give the inputs of our copied graph snapshots of the source inputs that changed since the last update
+   *
+   * Only inputs that reported a change since the last update are looked at (see TrackInput()), so the cost scales
+   * with what was edited rather than with the size of the graph. Workers keep rendering while this happens. A job that read values from both sides of an update can't trust its
+   * result, workers use the graph generation to detect this (see RenderWorker::GraphChangedSince()). Changes that alter the structure of the graph (see NodeInput::is_structural() and array
+   * sizes) still wait for every worker to be idle, in which case this returns false and the update stays queued.
+   */
+  bool UpdateInputSnapshots();
+
+  /**
+   * @brief Start recording changes to a source input (and an array's elements) so UpdateInputSnapshots() can find them
+   */
+  void TrackInput(NodeInput* src, NodeInput* dst);
+
+  /**
+   * @brief Forget the elements of an array that was resized, which may already have been deleted
+   */
+  void UntrackArrayElements(NodeInputArray* array);
+
   void InitWorkers();
 
   virtual NodeInput* GetDependentInput() = 0;
@@ -88,6 +122,11 @@ protected:
 
   bool ViewerIsConnected() const;
 
+  /**
+   * @brief The viewer node set with SetViewerNode(), as opposed to viewer_node() which returns our compiled copy
+   */
+  ViewerOutput* source_viewer_node() const;
+
   const QString& cache_id() const;
 
   void QueueValueUpdate();
@@ -115,6 +154,11 @@ protected:
 protected slots:
   void QueueRecompile();
 
+private slots:
+  void InputValueVersionChanged();
+
+  void InputArraySizeChanged();
+
 private:
   /**
    * @brief Internal list of RenderProcessThreads
@@ -146,6 +190,33 @@ private:
   bool recompile_queued_;
   bool input_update_queued_;
 
+  /**
+   * @brief Every tracked source input and its copy in copied_graph_
+   */
+  QHash<NodeInput*, NodeInput*> input_copies_;
+
+  /**
+   * @brief The elements of each tracked array as they were when it was tracked
+   */
+  QHash<NodeInputArray*, QVector<NodeInput*> > array_elements_;
+
+  QList<QMetaObject::Connection> input_connections_;
+
+  /**
+   * @brief Source inputs edited since the last UpdateInputSnapshots()
+   */
+  QSet<NodeInput*> changed_inputs_;
+
+  /**
+   * @brief Source arrays resized since the last UpdateInputSnapshots(), these are copied whole
+   */
+  QSet<NodeInputArray*> resized_arrays_;
+
+  /**
+   * @brief Incremented before and after UpdateInputSnapshots() changes any input of the copied graph
+   */
+  QAtomicInt graph_generation_;
+
   QVector<bool> processor_busy_state_;
 
   RenderCancelDialog* cancel_dialog_;
@@ -20,6 +20,8 @@ public:
 
   void Remove(K key) {values_.remove(key);}
 
+  QList<V> Values() const {return values_.values();}
+
 private:
   QHash<K, V> values_;
 
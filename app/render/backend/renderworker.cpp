@@ -7,7 +7,9 @@
 RenderWorker::RenderWorker(DecoderCache *decoder_cache, QObject *parent) :
   QObject(parent),
   started_(false),
-  decoder_cache_(decoder_cache)
+  decoder_cache_(decoder_cache),
+  graph_generation_(nullptr),
+  footage_approximated_(false)
 {
 }
 
@@ -34,6 +36,7 @@ void RenderWorker::Close()
 void RenderWorker::Render(NodeDependency path, qint64 job_time)
 {
   path_ = path;
+  footage_approximated_ = false;
 
   emit CompletedCache(path, RenderInternal(path, job_time), job_time);
 }
@@ -60,26 +63,33 @@ StreamPtr RenderWorker::ResolveStreamFromInput(NodeInput *input)
 
 DecoderPtr RenderWorker::ResolveDecoderFromInput(StreamPtr stream)
 {
-  QMutexLocker locker(decoder_cache_->lock());
+  return decoder_cache_->GetOrOpen(stream);
+}
 
-  // Access a map of Node inputs and decoder instances and retrieve a frame!
+DecoderCache *RenderWorker::decoder_cache() const
+{
+  return decoder_cache_;
+}
 
-  DecoderPtr decoder = decoder_cache_->Get(stream.get());
+void RenderWorker::SetGraphGeneration(const QAtomicInt *generation)
+{
+  graph_generation_ = generation;
+}
 
-  if (!decoder && stream) {
-    // Create a new Decoder here
-    decoder = Decoder::CreateFromID(stream->footage()->decoder());
-    decoder->set_stream(stream);
+int RenderWorker::GraphGeneration() const
+{
+  return graph_generation_ ? graph_generation_->loadAcquire() : 0;
+}
 
-    if (decoder->Open()) {
-      decoder_cache_->Add(stream.get(), decoder);
-    } else {
-      decoder = nullptr;
-      qWarning() << "Failed to open decoder for" << stream->footage()->filename() << "::" << stream->index();
-    }
-  }
+bool RenderWorker::GraphChangedSince(int generation) const
+{
+  // An odd generation means an update was already in progress when it was taken
+  return (generation & 1) || GraphGeneration() != generation;
+}
 
-  return decoder;
+bool RenderWorker::FootageWasApproximated() const
+{
+  return footage_approximated_;
 }
 
 bool RenderWorker::IsStarted()
@@ -165,7 +175,14 @@ NodeValueDatabase RenderWorker::GenerateDatabase(const Node* node, const TimeRan
             Decoder::RetrieveState state = decoder->GetRetrieveState(input_time.out());
 
             if (state == Decoder::kReady) {
+              // The playback speed can change while we're retrieving, so check on both sides
+              bool approximated = decoder->IsReturningKeyframesOnly();
+
               FrameToValue(decoder, stream, input_time, &table);
+
+              if (approximated || decoder->IsReturningKeyframesOnly()) {
+                footage_approximated_ = true;
+              }
             } else {
               ReportUnavailableFootage(stream, state, input_time.out());
             }
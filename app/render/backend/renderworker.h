@@ -1,6 +1,7 @@
 #ifndef RENDERWORKER_H
 #define RENDERWORKER_H
 
+#include <QAtomicInt>
 #include <QObject>
 
 #include "common/cancelableobject.h"
@@ -19,6 +20,11 @@ public:
 
   bool IsStarted();
 
+  /**
+   * @brief Set the counter the backend increments whenever it updates the values of the graph we render
+   */
+  void SetGraphGeneration(const QAtomicInt* generation);
+
 public slots:
   void Close();
 
@@ -53,6 +59,27 @@ protected:
 
   const NodeDependency& CurrentPath() const;
 
+  DecoderCache* decoder_cache() const;
+
+  /**
+   * @brief Returns the current graph generation, take this before reading any values for a job
+   */
+  int GraphGeneration() const;
+
+  /**
+   * @brief Returns true if the graph's values may have changed since GraphGeneration() returned `generation`
+   *
+   * If this returns false, every value read in between came from the same version of the graph.
+   */
+  bool GraphChangedSince(int generation) const;
+
+  /**
+   * @brief Returns whether any footage in the current job came from a decoder that was returning keyframes only
+   *
+   * See Decoder::IsReturningKeyframesOnly().
+   */
+  bool FootageWasApproximated() const;
+
 private:
   NodeValueDatabase GenerateDatabase(const Node *node, const TimeRange &range);
 
@@ -60,6 +87,10 @@ private:
 
   DecoderCache* decoder_cache_;
 
+  const QAtomicInt* graph_generation_;
+
+  bool footage_approximated_;
+
   NodeDependency path_;
 
 };
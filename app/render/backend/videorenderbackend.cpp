@@ -23,24 +23,65 @@
 #include <OpenImageIO/imageio.h>
 #include <QApplication>
 #include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QtMath>
 
+#include "common/powerfunctions.h"
 #include "common/timecodefunctions.h"
 #include "config/config.h"
-#include "render/diskmanager.h"
+#include "node/inputarray.h"
+#include "project/item/footage/footage.h"
+#include "project/item/footage/imagestream.h"
+#include "project/project.h"
 #include "render/diskmanager.h"
 #include "render/pixelformat.h"
+#include "videorenderhasher.h"
 #include "videorenderworker.h"
 
+const double VideoRenderBackend::kRenderCostWeight = 0.2;
+const double VideoRenderBackend::kMaximumLookAheadScale = 4.0;
+const double VideoRenderBackend::kLateFrameScore = 1e9;
+
 VideoRenderBackend::VideoRenderBackend(QObject *parent) :
   RenderBackend(parent),
   operating_mode_(VideoRenderWorker::kHashRenderCache),
   only_signal_last_frame_requested_(true),
-  limit_caching_(true)
+  limit_caching_(true),
+  hash_tasks_remaining_(0),
+  hash_batch_(0),
+  validating_(false),
+  validating_batch_(0),
+  playback_speed_(0),
+  render_limit_(RATIONAL_MAX),
+  render_cost_(0),
+  background_idle_(false),
+  background_paused_(false),
+  background_progress_(-1),
+  background_progress_paused_(false)
+{
+  // Headless render workers don't run a DiskManager
+  if (DiskManager::instance()) {
+    connect(DiskManager::instance(), &DiskManager::DeletedFrame, this, &VideoRenderBackend::FrameRemovedFromDiskCache);
+  }
+
+  background_idle_timer_.setSingleShot(true);
+  connect(&background_idle_timer_, &QTimer::timeout, this, &VideoRenderBackend::BackgroundIdleTimeout);
+
+  power_check_timer_.setInterval(kPowerCheckInterval);
+  connect(&power_check_timer_, &QTimer::timeout, this, &VideoRenderBackend::CheckPowerSource);
+
+  connect(this, &VideoRenderBackend::CachedTimeReady, this, &VideoRenderBackend::UpdateBackgroundRenderProgress);
+}
+
+VideoRenderBackend::~VideoRenderBackend()
 {
-  connect(DiskManager::instance(), &DiskManager::DeletedFrame, this, &VideoRenderBackend::FrameRemovedFromDiskCache);
+  CancelHashing();
+
+  // A restored map may still be being validated
+  hash_pool_.waitForDone();
 }
 
 void VideoRenderBackend::ConnectViewer(ViewerOutput *node)
@@ -56,7 +97,15 @@ void VideoRenderBackend::DisconnectViewer(ViewerOutput *node)
   disconnect(node, &ViewerOutput::VideoGraphChanged, this, &VideoRenderBackend::QueueRecompile);
   disconnect(node, &ViewerOutput::LengthChanged, this, &VideoRenderBackend::TruncateFrameCacheLength);
 
+  CancelHashing();
+
+  SaveFrameCacheMap();
+
   frame_cache_.Clear();
+  restored_map_.clear();
+
+  // Discard any restored map that's still being validated
+  validating_batch_++;
 }
 
 const VideoRenderingParams &VideoRenderBackend::params() const
@@ -64,6 +113,16 @@ const VideoRenderingParams &VideoRenderBackend::params() const
   return params_;
 }
 
+ColorProcessorPtr VideoRenderBackend::output_color_processor() const
+{
+  return output_color_processor_;
+}
+
+const YUVParams &VideoRenderBackend::output_yuv_params() const
+{
+  return output_yuv_params_;
+}
+
 void VideoRenderBackend::SetParameters(const VideoRenderingParams& params)
 {
   CancelQueue();
@@ -97,6 +156,23 @@ void VideoRenderBackend::SetOperatingMode(const VideoRenderWorker::OperatingMode
   }
 }
 
+void VideoRenderBackend::SetOutputConversion(ColorProcessorPtr color_processor, const YUVParams &yuv_params)
+{
+  if (!AllProcessorsAreAvailable()) {
+    qCritical() << "Attempted to set output conversion on a backend whose workers are still busy";
+    return;
+  }
+
+  output_color_processor_ = color_processor;
+  output_yuv_params_ = yuv_params;
+
+  OutputConversionChangedEvent();
+
+  foreach (RenderWorker* worker, processors_) {
+    static_cast<VideoRenderWorker*>(worker)->SetOutputYUVParams(output_yuv_params_);
+  }
+}
+
 void VideoRenderBackend::SetOnlySignalLastFrameRequested(bool enabled)
 {
   only_signal_last_frame_requested_ = enabled;
@@ -114,6 +190,32 @@ void VideoRenderBackend::SetLimitCaching(bool limit)
   limit_caching_ = limit;
 }
 
+void VideoRenderBackend::SetBackgroundRenderRange(const TimeRange &range)
+{
+  if (background_range_ == range) {
+    return;
+  }
+
+  background_range_ = range;
+  background_progress_ = -1;
+
+  if (background_range_.length() > 0) {
+    CheckPowerSource();
+    power_check_timer_.start();
+
+    // Wait for the user to be idle before starting
+    background_idle_ = false;
+    background_idle_timer_.start(Config::Current()["BackgroundRenderIdleDelay"].toInt());
+  } else {
+    power_check_timer_.stop();
+    background_idle_timer_.stop();
+    background_idle_ = false;
+    background_paused_ = false;
+  }
+
+  Requeue();
+}
+
 bool VideoRenderBackend::GenerateCacheIDInternal(QCryptographicHash& hash)
 {
   if (!params_.is_valid()) {
@@ -131,7 +233,16 @@ bool VideoRenderBackend::GenerateCacheIDInternal(QCryptographicHash& hash)
 
 void VideoRenderBackend::CacheIDChangedEvent(const QString &id)
 {
+  // Keep what we have for the old ID in case we come back to it
+  SaveFrameCacheMap();
+
   frame_cache_.SetCacheID(id);
+
+  // Validation is deferred to the next requeue since the graph may still be changing at this point
+  restored_graph_hash_ = frame_cache_.LoadMap(&restored_map_);
+
+  // Anything still being validated belongs to the old ID
+  validating_batch_++;
 }
 
 void VideoRenderBackend::ConnectWorkerToThis(RenderWorker *processor)
@@ -139,10 +250,14 @@ void VideoRenderBackend::ConnectWorkerToThis(RenderWorker *processor)
   VideoRenderWorker* video_processor = static_cast<VideoRenderWorker*>(processor);
 
   video_processor->SetOperatingMode(operating_mode_);
+  video_processor->SetOutputYUVParams(output_yuv_params_);
 
   connect(video_processor, &VideoRenderWorker::HashAlreadyBeingCached, this, &VideoRenderBackend::ThreadSkippedFrame, Qt::QueuedConnection);
   connect(video_processor, &VideoRenderWorker::CompletedDownload, this, &VideoRenderBackend::ThreadCompletedDownload, Qt::QueuedConnection);
+  connect(video_processor, &VideoRenderWorker::CompletedApproximateDownload, this, &VideoRenderBackend::ThreadCompletedApproximateDownload, Qt::QueuedConnection);
   connect(video_processor, &VideoRenderWorker::HashAlreadyExists, this, &VideoRenderBackend::ThreadHashAlreadyExists, Qt::QueuedConnection);
+  connect(video_processor, &VideoRenderWorker::ValuesChangedDuringRender, this, &VideoRenderBackend::ThreadValuesChangedDuringRender, Qt::QueuedConnection);
+  connect(video_processor, &VideoRenderWorker::RenderTimeMeasured, this, &VideoRenderBackend::ThreadRenderTimeMeasured, Qt::QueuedConnection);
   connect(video_processor, &VideoRenderWorker::GeneratedFrame, this, &VideoRenderBackend::GeneratedFrame, Qt::QueuedConnection);
   connect(video_processor, &VideoRenderWorker::GeneratedFrame, this, &VideoRenderBackend::ThreadGeneratedFrame, Qt::QueuedConnection);
 }
@@ -163,10 +278,24 @@ VideoRenderFrameCache *VideoRenderBackend::frame_cache()
   return &frame_cache_;
 }
 
+bool VideoRenderBackend::IsFrameCached(const rational &time)
+{
+  QByteArray frame_hash = frame_cache_.TimeToHash(time);
+
+  return !frame_hash.isEmpty() && !frame_cache_.IsCaching(frame_hash);
+}
+
 QString VideoRenderBackend::GetCachedFrame(const rational &time)
 {
   last_time_requested_ = time;
 
+  if (background_range_.length() > 0) {
+    // The user is interacting, drop any background frames from the queue so they yield to this one. Frames already
+    // being rendered will still finish, but that's at most one per worker.
+    background_idle_ = false;
+    background_idle_timer_.start(Config::Current()["BackgroundRenderIdleDelay"].toInt());
+  }
+
   if (viewer_node() == nullptr) {
     // Nothing is connected - nothing to show or render
     return nullptr;
@@ -188,9 +317,11 @@ QString VideoRenderBackend::GetCachedFrame(const rational &time)
   QByteArray frame_hash = frame_cache_.TimeToHash(time);
 
   if (!frame_hash.isEmpty()) {
+    QString frame_path = frame_cache_.CachePathName(frame_hash, params_.format());
+
     DiskManager::instance()->Accessed(frame_hash);
 
-    return frame_cache_.CachePathName(frame_hash, params_.format());
+    return frame_path;
   }
 
   return QString();
@@ -203,21 +334,33 @@ NodeInput *VideoRenderBackend::GetDependentInput()
 
 bool VideoRenderBackend::CanRender()
 {
-  return params_.is_valid();
+  // Hashing threads read the graph so it can't be updated until they're done
+  return params_.is_valid() && hash_tasks_remaining_ == 0;
 }
 
 TimeRange VideoRenderBackend::PopNextFrameFromQueue()
 {
-  // Try to find the frame that's closest to the last time requested (the playhead)
+  // Frames are prioritized by deadline. While paused or scrubbing, that's the frame closest to the playhead. While
+  // playing, it's the first frame in the playback direction that can still be rendered before the playhead reaches
+  // it. Frames that would be late anyway come after all of those.
+  int direction = (playback_speed_ > 0) ? 1 : ((playback_speed_ < 0) ? -1 : 0);
+
+  rational target = last_time_requested_;
 
-  // Set up playhead frame range to see if the queue contains this frame precisely
-  TimeRange test_range(last_time_requested_, last_time_requested_ + params_.time_base());
+  if (direction != 0) {
+    target += rational::fromDouble(playback_speed_ * render_cost_ * 0.001);
+  }
+
+  // Set up target frame range to see if the queue contains this frame precisely
+  rational target_frame = FrameContaining(target);
+  TimeRange test_range(target_frame, target_frame + params_.time_base());
 
-  // Use this variable to find the closest frame in the range
+  // Use these variables to find the closest frame in the range
   rational closest_time = -1;
+  double closest_score = 0;
 
   foreach (const TimeRange& range_here, cache_queue_) {
-    if (range_here.OverlapsWith(test_range, false, false)) {
+    if (range_here.OverlapsWith(test_range, false, false) && target_frame <= render_limit_) {
       closest_time = -1;
       break;
     }
@@ -226,10 +369,7 @@ TimeRange VideoRenderBackend::PopNextFrameFromQueue()
       rational compare;
 
       if (j == 0) {
-        compare = Timecode::snap_time_to_timebase(range_here.in(), params_.time_base());
-        if (compare > range_here.in()) {
-          compare -= params_.time_base();
-        }
+        compare = FrameContaining(range_here.in());
       } else {
         compare = Timecode::snap_time_to_timebase(range_here.out(), params_.time_base());
         if (compare >= range_here.out()) {
@@ -237,9 +377,24 @@ TimeRange VideoRenderBackend::PopNextFrameFromQueue()
         }
       }
 
-      if (closest_time < 0
-          || qAbs(compare - last_time_requested_) < qAbs(closest_time - last_time_requested_)) {
+      if (compare > render_limit_) {
+        continue;
+      }
+
+      double distance = (compare - target).toDouble();
+      double score;
+
+      if (direction == 0) {
+        score = qAbs(distance);
+      } else if (distance * direction >= 0) {
+        score = distance * direction;
+      } else {
+        score = kLateFrameScore - distance * direction;
+      }
+
+      if (closest_time < 0 || score < closest_score) {
         closest_time = compare;
+        closest_score = score;
       }
     }
   }
@@ -262,6 +417,18 @@ TimeRange VideoRenderBackend::PopNextFrameFromQueue()
   return TimeRange(frame_range.in(), frame_range.in());
 }
 
+bool VideoRenderBackend::NextFrameIsHeld()
+{
+  // PopNextFrameFromQueue() only picks frames within the limit, so hold off if there aren't any
+  foreach (const TimeRange& range, cache_queue_) {
+    if (FrameContaining(range.in()) <= render_limit_) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void VideoRenderBackend::ThreadCompletedDownload(NodeDependency dep, qint64 job_time, QByteArray hash, bool texture_existed)
 {
   SetWorkerBusyState(static_cast<RenderWorker*>(sender()), false);
@@ -283,6 +450,18 @@ void VideoRenderBackend::ThreadCompletedDownload(NodeDependency dep, qint64 job_
   CacheNext();
 }
 
+void VideoRenderBackend::ThreadCompletedApproximateDownload(NodeDependency dep, qint64 job_time, QByteArray hash, bool texture_existed)
+{
+  // Remember which frames are approximations so they get rendered exactly once playback slows down again. Check now
+  // since ThreadCompletedDownload() clears the job.
+  if (JobIsCurrent(dep, job_time)) {
+    approximated_.InsertTimeRange(TimeRange(dep.in(), dep.in() + params_.time_base()));
+  }
+
+  // Otherwise it's shown like any other frame
+  ThreadCompletedDownload(dep, job_time, hash, texture_existed);
+}
+
 void VideoRenderBackend::ThreadSkippedFrame(NodeDependency dep, qint64 job_time, QByteArray hash)
 {
   SetWorkerBusyState(static_cast<RenderWorker*>(sender()), false);
@@ -308,6 +487,28 @@ void VideoRenderBackend::ThreadHashAlreadyExists(NodeDependency dep, qint64 job_
   CacheNext();
 }
 
+void VideoRenderBackend::ThreadValuesChangedDuringRender(NodeDependency dep, qint64 job_time)
+{
+  SetWorkerBusyState(static_cast<RenderWorker*>(sender()), false);
+
+  if (JobIsCurrent(dep, job_time)) {
+    // The change didn't invalidate this frame, but we still have nothing for it so it needs to be rendered again
+    render_job_info_.remove(dep.range());
+
+    invalidated_.InsertTimeRange(TimeRange(dep.in(), dep.in() + params_.time_base()));
+
+    Requeue();
+  } else {
+    // Queue up a new frame for this worker
+    CacheNext();
+  }
+}
+
+void VideoRenderBackend::ThreadRenderTimeMeasured(double msecs)
+{
+  render_cost_ = (render_cost_ <= 0) ? msecs : render_cost_ * (1.0 - kRenderCostWeight) + msecs * kRenderCostWeight;
+}
+
 void VideoRenderBackend::ThreadGeneratedFrame()
 {
   SetWorkerBusyState(static_cast<RenderWorker*>(sender()), false);
@@ -321,6 +522,7 @@ void VideoRenderBackend::TruncateFrameCacheLength(const rational &length)
   frame_cache_.Truncate(length);
 
   invalidated_.RemoveTimeRange(TimeRange(length, RATIONAL_MAX));
+  approximated_.RemoveTimeRange(TimeRange(length, RATIONAL_MAX));
 
   // If the playhead is past the length, update the viewer to a null texture because it won't be cached through the
   // queue, but will now be a null texture
@@ -334,6 +536,17 @@ void VideoRenderBackend::TruncateFrameCacheLength(const rational &length)
 
 void VideoRenderBackend::FrameRemovedFromDiskCache(const QByteArray &hash)
 {
+  // Don't let a restored map that's still being validated bring this frame back
+  QMap<rational, QByteArray>::iterator i = validating_map_.begin();
+
+  while (i != validating_map_.end()) {
+    if (i.value() == hash) {
+      i = validating_map_.erase(i);
+    } else {
+      i++;
+    }
+  }
+
   QList<rational> deleted_frames = frame_cache()->TakeFramesWithHash(hash);
 
   foreach (const rational& frame, deleted_frames) {
@@ -343,6 +556,26 @@ void VideoRenderBackend::FrameRemovedFromDiskCache(const QByteArray &hash)
 
     emit RangeInvalidated(invalidated);
   }
+
+  UpdateBackgroundRenderProgress();
+}
+
+void VideoRenderBackend::BackgroundIdleTimeout()
+{
+  background_idle_ = true;
+
+  Requeue();
+}
+
+void VideoRenderBackend::CheckPowerSource()
+{
+  bool paused = Config::Current()["BackgroundRenderPauseOnBattery"].toBool() && IsRunningOnBattery();
+
+  if (background_paused_ != paused) {
+    background_paused_ = paused;
+
+    Requeue();
+  }
 }
 
 bool VideoRenderBackend::TimeIsQueued(const TimeRange &time) const
@@ -369,14 +602,30 @@ bool VideoRenderBackend::SetFrameHash(const NodeDependency &dep, const QByteArra
 
 void VideoRenderBackend::Requeue()
 {
+  ApplyRestoredFrameCacheMap();
+
   if (limit_caching_) {
 
     // Reset queue around the last time requested
-    TimeRange queueable_range(last_time_requested_ - Config::Current()["DiskCacheBehind"].value<rational>(),
-                              last_time_requested_ + Config::Current()["DiskCacheAhead"].value<rational>());
+    rational behind, ahead;
+    GetCacheWindow(&behind, &ahead);
+
+    TimeRange queueable_range;
+
+    if (playback_speed_ < 0) {
+      queueable_range = TimeRange(last_time_requested_ - ahead, last_time_requested_ + behind);
+    } else {
+      queueable_range = TimeRange(last_time_requested_ - behind, last_time_requested_ + ahead);
+    }
 
     cache_queue_ = invalidated_.Intersects(queueable_range);
 
+    if (BackgroundRenderIsActive()) {
+      foreach (const TimeRange& range, invalidated_.Intersects(background_range_)) {
+        cache_queue_.InsertTimeRange(range);
+      }
+    }
+
   } else {
 
     cache_queue_ = invalidated_;
@@ -384,4 +633,457 @@ void VideoRenderBackend::Requeue()
   }
 
   CacheNext();
+
+  UpdateBackgroundRenderProgress();
+}
+
+void VideoRenderBackend::GetCacheWindow(rational *behind, rational *ahead) const
+{
+  double behind_sec = Config::Current()["DiskCacheBehind"].value<rational>().toDouble();
+  double ahead_sec = Config::Current()["DiskCacheAhead"].value<rational>().toDouble();
+
+  if (playback_speed_ != 0) {
+    // Media seconds played and rendered per second
+    double consumption = qAbs(playback_speed_);
+    double throughput = GetRenderThroughput();
+
+    // Nothing behind the playhead will be needed until playback stops
+    behind_sec = 0;
+
+    if (throughput > 0 && throughput < consumption) {
+      // The renderer can't keep up, so anything it would render far ahead will just be passed by the playhead before
+      // the frames in between are done. Keep the window to what it can realistically get to.
+      ahead_sec *= throughput / consumption;
+    } else {
+      // Look further ahead at higher speeds so shuttling doesn't outrun the cache
+      ahead_sec *= qMin(consumption, kMaximumLookAheadScale);
+    }
+  }
+
+  // Don't plan further ahead than the disk cache can hold, otherwise the frames we render last evict the ones the
+  // playhead is about to reach
+  double frame_size = PixelFormat::GetBufferSize(params_.format(), params_.effective_width(), params_.effective_height());
+
+  if (frame_size > 0) {
+    double disk_limit = Config::Current()["DiskCacheSize"].toDouble() * 1073741824;
+    double window_limit = disk_limit * 0.5 / frame_size * params_.time_base().toDouble();
+
+    ahead_sec = qMin(ahead_sec, window_limit);
+    behind_sec = qMin(behind_sec, window_limit - ahead_sec);
+  }
+
+  *behind = rational::fromDouble(qMax(0.0, behind_sec));
+  *ahead = rational::fromDouble(qMax(0.0, ahead_sec));
+}
+
+double VideoRenderBackend::GetRenderThroughput() const
+{
+  if (render_cost_ <= 0 || processors_.isEmpty()) {
+    return 0;
+  }
+
+  // Every worker renders one frame at a time
+  return processors_.size() * 1000.0 / render_cost_ * params_.time_base().toDouble();
+}
+
+rational VideoRenderBackend::FrameContaining(const rational &time) const
+{
+  rational frame = Timecode::snap_time_to_timebase(time, params_.time_base());
+
+  if (frame > time) {
+    frame -= params_.time_base();
+  }
+
+  return frame;
+}
+
+void VideoRenderBackend::SetRenderLimit(const rational &time)
+{
+  if (render_limit_ == time) {
+    return;
+  }
+
+  bool raised = (time > render_limit_);
+
+  render_limit_ = time;
+
+  if (raised) {
+    CacheNext();
+  }
+}
+
+void VideoRenderBackend::SetPlaybackSpeed(int speed)
+{
+  if (playback_speed_ == speed) {
+    return;
+  }
+
+  playback_speed_ = speed;
+
+  decoder_cache()->SetPlaybackSpeed(speed);
+
+  // Frames rendered from keyframes only were good enough for the old speed, replace them with exact ones (or new
+  // approximations if we're still shuttling)
+  foreach (const TimeRange& range, approximated_) {
+    invalidated_.InsertTimeRange(range);
+
+    emit RangeInvalidated(range);
+  }
+
+  approximated_.clear();
+
+  Requeue();
+}
+
+bool VideoRenderBackend::GenerateHashes(const TimeRangeList &ranges)
+{
+  if (hash_tasks_remaining_ > 0) {
+    qWarning() << "Attempted to generate hashes while a previous batch is still running";
+    return false;
+  }
+
+  if (!PrepareGraph()) {
+    return false;
+  }
+
+  const Node* node = GetDependentInput()->get_connected_node();
+
+  if (!node) {
+    return false;
+  }
+
+  hash_times_.clear();
+
+  foreach (const TimeRange& range, ranges) {
+    rational time = Timecode::snap_time_to_timebase(range.in(), params_.time_base());
+
+    if (time > range.in()) {
+      time -= params_.time_base();
+    }
+
+    for (;time<range.out();time+=params_.time_base()) {
+      hash_times_.append(time);
+    }
+  }
+
+  if (hash_times_.isEmpty()) {
+    QMetaObject::invokeMethod(this, "HashesGenerated", Qt::QueuedConnection);
+    return true;
+  }
+
+  hash_results_.resize(hash_times_.size());
+  hash_cancelled_ = 0;
+  hash_batch_++;
+
+  // Split into more slices than threads so threads that get cheaper frames don't sit idle at the end, slices are
+  // still contiguous so each one benefits from its hasher's block and footage caches
+  int slice_count = qMin(hash_times_.size(), qMax(1, hash_pool_.maxThreadCount()) * 4);
+  int slice_size = (hash_times_.size() + slice_count - 1) / slice_count;
+
+  hash_tasks_remaining_ = 0;
+
+  for (int start=0;start<hash_times_.size();start+=slice_size) {
+    hash_pool_.start(new VideoRenderHashTask(this,
+                                             hash_batch_,
+                                             node,
+                                             params_,
+                                             decoder_cache(),
+                                             &hash_times_,
+                                             hash_results_.data(),
+                                             start,
+                                             qMin(start + slice_size, hash_times_.size()),
+                                             &hash_cancelled_));
+
+    hash_tasks_remaining_++;
+  }
+
+  return true;
+}
+
+void VideoRenderBackend::HashTaskFinished(int batch)
+{
+  if (batch != hash_batch_ || hash_tasks_remaining_ == 0) {
+    // Left over from a batch that was cancelled
+    return;
+  }
+
+  hash_tasks_remaining_--;
+
+  if (hash_tasks_remaining_ > 0) {
+    return;
+  }
+
+  for (int i=0;i<hash_times_.size();i++) {
+    frame_cache_.SetHash(hash_times_.at(i), hash_results_.at(i));
+  }
+
+  hash_times_.clear();
+  hash_results_.clear();
+
+  emit HashesGenerated();
+
+  // Continue with anything that was queued while the graph was locked
+  CacheNext();
+}
+
+void VideoRenderBackend::CancelHashing()
+{
+  if (hash_tasks_remaining_ == 0) {
+    return;
+  }
+
+  hash_cancelled_ = 1;
+  hash_pool_.waitForDone();
+
+  hash_tasks_remaining_ = 0;
+  hash_times_.clear();
+  hash_results_.clear();
+}
+
+QByteArray VideoRenderBackend::GenerateGraphHash()
+{
+  // Hash the source graph rather than our copy since the copy may be out of date or not compiled yet
+  Node* connected = source_viewer_node()->texture_input()->get_connected_node();
+
+  if (!connected) {
+    return QByteArray();
+  }
+
+  QList<Node*> nodes;
+  nodes.append(connected);
+  nodes.append(connected->GetDependencies());
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  foreach (Node* n, nodes) {
+    hash.addData(n->id().toUtf8());
+
+    foreach (NodeParam* param, n->parameters()) {
+      if (param->type() == NodeParam::kInput) {
+        HashGraphInput(&hash, static_cast<NodeInput*>(param), nodes);
+      }
+    }
+  }
+
+  return hash.result();
+}
+
+void VideoRenderBackend::HashGraphInput(QCryptographicHash *hash, NodeInput *input, const QList<Node*>& nodes)
+{
+  hash->addData(input->id().toUtf8());
+
+  if (input->IsConnected()) {
+    // Pointers change between sessions so we identify the connected node by its position in the graph instead
+    NodeOutput* output = input->get_connected_output();
+
+    hash->addData(QString::number(nodes.indexOf(output->parentNode())).toUtf8());
+    hash->addData(output->id().toUtf8());
+  }
+
+  hash->addData(QByteArray::number(input->is_keyframing()));
+
+  foreach (const QVariant& v, input->get_split_standard_value()) {
+    HashGraphValue(hash, v);
+  }
+
+  foreach (const NodeInput::KeyframeTrack& track, input->keyframe_tracks()) {
+    foreach (NodeKeyframePtr key, track) {
+      hash->addData(key->time().toString().toUtf8());
+      hash->addData(QByteArray::number(key->type()));
+      hash->addData(QStringLiteral("%1:%2:%3:%4").arg(QString::number(key->bezier_control_in().x()),
+                                                      QString::number(key->bezier_control_in().y()),
+                                                      QString::number(key->bezier_control_out().x()),
+                                                      QString::number(key->bezier_control_out().y())).toUtf8());
+      HashGraphValue(hash, key->value());
+    }
+  }
+
+  if (input->IsArray()) {
+    NodeInputArray* array = static_cast<NodeInputArray*>(input);
+
+    for (int i=0;i<array->GetSize();i++) {
+      HashGraphInput(hash, array->At(i), nodes);
+    }
+  }
+}
+
+void VideoRenderBackend::HashGraphValue(QCryptographicHash *hash, const QVariant &value)
+{
+  if (value.userType() == qMetaTypeId<rational>()) {
+    hash->addData(value.value<rational>().toString().toUtf8());
+  } else if (value.userType() == qMetaTypeId<StreamPtr>()) {
+    StreamPtr stream = value.value<StreamPtr>();
+
+    if (stream) {
+      // Same footage details the render workers use in their frame hashes
+      hash->addData(stream->footage()->filename().toUtf8());
+      hash->addData(stream->footage()->timestamp().toString().toUtf8());
+      hash->addData(QString::number(stream->index()).toUtf8());
+
+      if (stream->type() == Stream::kImage || stream->type() == Stream::kVideo) {
+        ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(stream);
+
+        hash->addData(image_stream->footage()->project()->ocio_config().toUtf8());
+        hash->addData(image_stream->colorspace().toUtf8());
+        hash->addData(QString::number(image_stream->premultiplied_alpha()).toUtf8());
+      }
+    }
+  } else if (!value.isNull()) {
+    QByteArray bytes;
+    QDataStream ds(&bytes, QIODevice::WriteOnly);
+    ds << value;
+
+    hash->addData(bytes);
+  }
+}
+
+void VideoRenderBackend::SaveFrameCacheMap()
+{
+  if (!source_viewer_node() || !(operating_mode_ & VideoRenderWorker::kHashOnly)) {
+    return;
+  }
+
+  // Frames that are still waiting for or being rendered don't have a valid hash yet, and approximations aren't what
+  // their time should look like
+  TimeRangeList invalid_ranges = invalidated_;
+
+  foreach (const TimeRange& range, approximated_) {
+    invalid_ranges.InsertTimeRange(range);
+  }
+
+  foreach (const TimeRange& job, render_job_info_.keys()) {
+    invalid_ranges.InsertTimeRange(TimeRange(job.in(), job.in() + params_.time_base()));
+  }
+
+  frame_cache_.SaveMap(GenerateGraphHash(), invalid_ranges);
+}
+
+void VideoRenderBackend::ApplyRestoredFrameCacheMap()
+{
+  if (restored_map_.isEmpty() || !source_viewer_node() || validating_) {
+    // If a map is still being validated, this one is picked up once it's done
+    return;
+  }
+
+  QMap<rational, QByteArray> restored_map = restored_map_;
+  restored_map_.clear();
+
+  if (restored_graph_hash_ != GenerateGraphHash()) {
+    // Something changed since this map was saved, the workers will have to hash everything again
+    return;
+  }
+
+  // Frames may have been deleted since the map was saved. Statting every file could take a while, so it's done once
+  // here in the background rather than on each frame request.
+  validating_map_ = restored_map;
+  validating_graph_hash_ = restored_graph_hash_;
+  validating_paths_.clear();
+  validating_missing_.clear();
+
+  foreach (const QByteArray& hash, restored_map) {
+    if (!validating_paths_.contains(hash)) {
+      validating_paths_.insert(hash, frame_cache_.CachePathName(hash, params_.format()));
+    }
+  }
+
+  validating_ = true;
+  validating_batch_++;
+
+  hash_pool_.start(new RestoredMapValidateTask(this, validating_batch_));
+}
+
+void VideoRenderBackend::RestoredMapValidated(int batch)
+{
+  validating_ = false;
+
+  QMap<rational, QByteArray> restored_map = validating_map_;
+  QSet<QByteArray> missing = validating_missing_;
+
+  validating_map_.clear();
+  validating_paths_.clear();
+  validating_missing_.clear();
+
+  if (batch != validating_batch_ || !source_viewer_node() || validating_graph_hash_ != GenerateGraphHash()) {
+    // The cache ID or graph changed while we were validating, so this map no longer applies. A map restored in the
+    // meantime will still be applied on the next requeue.
+    if (!restored_map_.isEmpty()) {
+      Requeue();
+    }
+
+    return;
+  }
+
+  qint64 job_time = QDateTime::currentMSecsSinceEpoch();
+  rational length = source_viewer_node()->Length();
+
+  for (QMap<rational, QByteArray>::const_iterator i=restored_map.begin();i!=restored_map.end();i++) {
+    if (i.key() >= length
+        || missing.contains(i.value())
+        || !frame_cache_.TimeToHash(i.key()).isEmpty()) {
+      continue;
+    }
+
+    frame_cache_.SetHash(i.key(), i.value());
+
+    invalidated_.RemoveTimeRange(TimeRange(i.key(), i.key() + params_.time_base()));
+
+    emit CachedTimeReady(i.key(), job_time);
+  }
+}
+
+bool VideoRenderBackend::BackgroundRenderIsActive() const
+{
+  return background_range_.length() > 0 && background_idle_ && !background_paused_;
+}
+
+void VideoRenderBackend::UpdateBackgroundRenderProgress()
+{
+  if (background_range_.length() <= 0) {
+    if (background_progress_ != -1) {
+      background_progress_ = -1;
+      emit BackgroundRenderProgress(TimeRange(), 0, false);
+    }
+
+    return;
+  }
+
+  // Anything still invalidated or currently being rendered hasn't been cached yet
+  rational remaining;
+
+  foreach (const TimeRange& range, invalidated_.Intersects(background_range_)) {
+    remaining += range.length();
+  }
+
+  for (QHash<TimeRange, qint64>::const_iterator i=render_job_info_.constBegin();i!=render_job_info_.constEnd();i++) {
+    if (background_range_.Contains(i.key(), true, false)) {
+      remaining += params_.time_base();
+    }
+  }
+
+  int percent = qBound(0, qFloor(100.0 * (1.0 - remaining.toDouble() / background_range_.length().toDouble())), 100);
+
+  if (percent != background_progress_ || background_paused_ != background_progress_paused_) {
+    background_progress_ = percent;
+    background_progress_paused_ = background_paused_;
+    emit BackgroundRenderProgress(background_range_, percent, background_paused_);
+  }
+}
+
+VideoRenderBackend::RestoredMapValidateTask::RestoredMapValidateTask(VideoRenderBackend *backend, int batch) :
+  backend_(backend),
+  batch_(batch)
+{
+}
+
+void VideoRenderBackend::RestoredMapValidateTask::run()
+{
+  for (QHash<QByteArray, QString>::const_iterator i=backend_->validating_paths_.constBegin();
+       i!=backend_->validating_paths_.constEnd();
+       i++) {
+    if (!QFileInfo::exists(i.value())) {
+      backend_->validating_missing_.insert(i.key());
+    }
+  }
+
+  QMetaObject::invokeMethod(backend_, "RestoredMapValidated", Qt::QueuedConnection, Q_ARG(int, batch_));
 }
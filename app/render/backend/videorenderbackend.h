@@ -22,6 +22,10 @@
 #define VIDEORENDERERBACKEND_H
 
 #include <QLinkedList>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
 
 #include "colorprocessorcache.h"
 #include "node/output/viewer/viewer.h"
@@ -46,6 +50,8 @@ public:
    */
   VideoRenderBackend(QObject* parent = nullptr);
 
+  virtual ~VideoRenderBackend() override;
+
   /**
    * @brief Set parameters of the Renderer
    *
@@ -56,6 +62,15 @@ public:
 
   void SetOperatingMode(const VideoRenderWorker::OperatingMode& mode);
 
+  /**
+   * @brief Convert generated frames to an encoder's planar Y'CbCr layout on the GPU before they're downloaded
+   *
+   * Only affects frames signalled through GeneratedFrame(), not ones downloaded to the disk cache. `color_processor` is
+   * the output color transform to apply before converting, or nullptr to leave colors as they are. Pass an invalid
+   * YUVParams to go back to generating RGBA frames.
+   */
+  void SetOutputConversion(ColorProcessorPtr color_processor, const YUVParams& yuv_params);
+
   void SetOnlySignalLastFrameRequested(bool enabled);
 
   bool IsRendered(const rational& time) const;
@@ -64,6 +79,51 @@ public:
 
   QString GetCachedFrame(const rational& time);
 
+  /**
+   * @brief Return whether the frame at this time is ready to be shown
+   *
+   * Unlike GetCachedFrame(), this doesn't count as a request, so it doesn't move the caching window or queue anything.
+   */
+  bool IsFrameCached(const rational& time);
+
+  /**
+   * @brief Generate the hash of every frame in `ranges` without going through the render workers
+   *
+   * Frames are hashed in contiguous batches on a CPU thread pool, so there's no per-frame round trip through the
+   * render threads and consecutive frames share their block lookups and footage details. The hashes are set in
+   * frame_cache() and HashesGenerated() is emitted once all of them are done. Rendering is held off until then.
+   *
+   * Returns false if hashing couldn't be started (e.g. the graph couldn't be compiled), in which case
+   * HashesGenerated() won't be emitted.
+   */
+  bool GenerateHashes(const TimeRangeList& ranges);
+
+  /**
+   * @brief Progressively render a range in the background while the user isn't interacting with this backend
+   *
+   * Frames outside the DiskCacheBehind/DiskCacheAhead window around the playhead are only queued once no frame has
+   * been requested for "BackgroundRenderIdleDelay" milliseconds, and are dropped from the queue again as soon as one
+   * is. If "BackgroundRenderPauseOnBattery" is set, background rendering is also paused while the machine is running
+   * off a battery. Set an empty range to disable.
+   */
+  void SetBackgroundRenderRange(const TimeRange& range);
+
+  /**
+   * @brief Set the speed the viewer is playing at (negative for reverse, 0 when paused)
+   *
+   * While playing, the caching window extends in the playback direction only, scaled by the speed and by how fast the
+   * workers have been rendering frames, and queued frames are prioritized by when the playhead will reach them.
+   */
+  void SetPlaybackSpeed(int speed);
+
+  /**
+   * @brief Don't start rendering any frame after `time` until the limit is raised again
+   *
+   * Lets a consumer that holds onto rendered frames (e.g. the exporter's reorder buffer) stop new ones from piling up
+   * while it catches up. Set RATIONAL_MAX to lift the limit.
+   */
+  void SetRenderLimit(const rational& time);
+
   VideoRenderFrameCache* frame_cache();
 
   const VideoRenderingParams& params() const;
@@ -84,6 +144,8 @@ protected:
 
   virtual TimeRange PopNextFrameFromQueue() override;
 
+  virtual bool NextFrameIsHeld() override;
+
   /**
    * @brief Internal function for generating the cache ID
    */
@@ -97,6 +159,12 @@ protected:
 
   virtual void ParamsChangedEvent(){}
 
+  virtual void OutputConversionChangedEvent(){}
+
+  ColorProcessorPtr output_color_processor() const;
+
+  const YUVParams& output_yuv_params() const;
+
   VideoRenderWorker::OperatingMode operating_mode_;
 
 signals:
@@ -106,6 +174,15 @@ signals:
 
   void GeneratedFrame(const rational &time, FramePtr frame);
 
+  /**
+   * @brief Emitted when the progress of rendering the background range has changed
+   *
+   * An empty range means background rendering has been disabled.
+   */
+  void BackgroundRenderProgress(const TimeRange& range, int percent, bool paused);
+
+  void HashesGenerated();
+
 private:
   bool TimeIsQueued(const TimeRange &time) const;
 
@@ -115,28 +192,175 @@ private:
 
   void Requeue();
 
+  /**
+   * @brief Hash everything about the video graph that could affect a frame's hash
+   *
+   * Used to check whether a frame cache map saved in a previous session still applies. This covers node IDs, input
+   * values, keyframes, connections and footage, but unlike the per-frame hash it doesn't need any time-dependent
+   * evaluation so it's cheap enough to run on the main thread.
+   */
+  QByteArray GenerateGraphHash();
+
+  static void HashGraphInput(QCryptographicHash* hash, NodeInput* input, const QList<Node*>& nodes);
+
+  static void HashGraphValue(QCryptographicHash* hash, const QVariant& value);
+
+  void SaveFrameCacheMap();
+
+  /**
+   * @brief Merge a frame cache map restored from disk if the graph still matches the one it was saved with
+   *
+   * Entries whose files have gone from the disk are dropped first. That check is done by a RestoredMapValidateTask on
+   * hash_pool_, and the map is merged in RestoredMapValidated().
+   */
+  void ApplyRestoredFrameCacheMap();
+
+  /**
+   * @brief Checks which files of a restored frame cache map still exist, off the main thread
+   */
+  class RestoredMapValidateTask : public QRunnable
+  {
+  public:
+    RestoredMapValidateTask(VideoRenderBackend* backend, int batch);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    VideoRenderBackend* backend_;
+
+    int batch_;
+
+  };
+
+  /**
+   * @brief Stop any GenerateHashes() batch and wait for its threads, must be done before the graph is destroyed
+   */
+  void CancelHashing();
+
+  bool BackgroundRenderIsActive() const;
+
+  void UpdateBackgroundRenderProgress();
+
+  /**
+   * @brief Determine how far behind and ahead of the playhead (in the playback direction) frames should be cached
+   */
+  void GetCacheWindow(rational* behind, rational* ahead) const;
+
+  /**
+   * @brief Estimated seconds of media the workers can render per second, or 0 if there's no estimate yet
+   */
+  double GetRenderThroughput() const;
+
+  rational FrameContaining(const rational& time) const;
+
   VideoRenderingParams params_;
 
+  ColorProcessorPtr output_color_processor_;
+
+  YUVParams output_yuv_params_;
+
   VideoRenderFrameCache frame_cache_;
 
   TimeRangeList invalidated_;
 
+  /**
+   * @brief Frames currently cached as approximations, see VideoRenderWorker::CompletedApproximateDownload()
+   */
+  TimeRangeList approximated_;
+
   rational last_time_requested_;
 
+  rational render_limit_;
+
   bool only_signal_last_frame_requested_;
 
   bool limit_caching_;
 
+  QMap<rational, QByteArray> restored_map_;
+
+  QByteArray restored_graph_hash_;
+
+  /**
+   * @brief Restored map waiting on a RestoredMapValidateTask
+   */
+  QMap<rational, QByteArray> validating_map_;
+
+  QByteArray validating_graph_hash_;
+
+  /**
+   * @brief Files to check and the hashes of those that are missing, only touched by the task while it's running
+   */
+  QHash<QByteArray, QString> validating_paths_;
+
+  QSet<QByteArray> validating_missing_;
+
+  bool validating_;
+
+  int validating_batch_;
+
+  QThreadPool hash_pool_;
+
+  QVector<rational> hash_times_;
+
+  QVector<QByteArray> hash_results_;
+
+  int hash_tasks_remaining_;
+
+  int hash_batch_;
+
+  QAtomicInt hash_cancelled_;
+
+  int playback_speed_;
+
+  /// Moving average of how long a frame takes to render in milliseconds
+  double render_cost_;
+
+  static const double kRenderCostWeight;
+
+  /// Limit on how much the look-ahead is extended while shuttling
+  static const double kMaximumLookAheadScale;
+
+  /// Added to the distance of frames the playhead will reach before they can be rendered
+  static const double kLateFrameScore;
+
+  TimeRange background_range_;
+
+  bool background_idle_;
+
+  bool background_paused_;
+
+  int background_progress_;
+
+  bool background_progress_paused_;
+
+  QTimer background_idle_timer_;
+
+  QTimer power_check_timer_;
+
+  static const int kPowerCheckInterval = 30000;
+
 private slots:
   void ThreadCompletedDownload(NodeDependency dep, qint64 job_time, QByteArray hash, bool texture_existed);
+  void ThreadCompletedApproximateDownload(NodeDependency dep, qint64 job_time, QByteArray hash, bool texture_existed);
   void ThreadSkippedFrame(NodeDependency dep, qint64 job_time, QByteArray hash);
   void ThreadHashAlreadyExists(NodeDependency dep, qint64 job_time, QByteArray hash);
+  void ThreadValuesChangedDuringRender(NodeDependency dep, qint64 job_time);
+  void ThreadRenderTimeMeasured(double msecs);
   void ThreadGeneratedFrame();
 
   void TruncateFrameCacheLength(const rational& length);
 
   void FrameRemovedFromDiskCache(const QByteArray& hash);
 
+  void BackgroundIdleTimeout();
+
+  void CheckPowerSource();
+
+  void HashTaskFinished(int batch);
+
+  void RestoredMapValidated(int batch);
+
 };
 
 #endif // VIDEORENDERERBACKEND_H
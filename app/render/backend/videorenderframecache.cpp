@@ -1,7 +1,10 @@
 #include "videorenderframecache.h"
 
+#include <QDataStream>
+#include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QSaveFile>
 
 #include "common/filefunctions.h"
 
@@ -122,6 +125,103 @@ const QMap<rational, QByteArray> &VideoRenderFrameCache::time_hash_map() const
   return time_hash_map_;
 }
 
+void VideoRenderFrameCache::SaveMap(const QByteArray &graph_hash, const TimeRangeList &invalid_ranges) const
+{
+  if (cache_id_.isEmpty()) {
+    return;
+  }
+
+  QMap<rational, QByteArray> valid_map;
+
+  for (QMap<rational, QByteArray>::const_iterator i=time_hash_map_.begin();i!=time_hash_map_.end();i++) {
+    if (!invalid_ranges.ContainsTimeRange(TimeRange(i.key(), i.key()), true, false)) {
+      valid_map.insert(i.key(), i.value());
+    }
+  }
+
+  if (valid_map.isEmpty()) {
+    // Nothing worth restoring, don't leave an outdated map behind either
+    QFile::remove(MapFilename());
+    return;
+  }
+
+  // Write to a temporary file first so a crash mid-write can't leave a truncated map
+  QSaveFile file(MapFilename());
+
+  if (!file.open(QFile::WriteOnly)) {
+    qWarning() << "Failed to save frame cache map" << file.fileName();
+    return;
+  }
+
+  QDataStream ds(&file);
+
+  ds << kMapFileMagic << kMapFileVersion << graph_hash << valid_map.size();
+
+  for (QMap<rational, QByteArray>::const_iterator i=valid_map.begin();i!=valid_map.end();i++) {
+    ds << static_cast<qint64>(i.key().numerator())
+       << static_cast<qint64>(i.key().denominator())
+       << i.value();
+  }
+
+  if (!file.commit()) {
+    qWarning() << "Failed to save frame cache map" << file.fileName();
+  }
+}
+
+QByteArray VideoRenderFrameCache::LoadMap(QMap<rational, QByteArray> *map) const
+{
+  map->clear();
+
+  if (cache_id_.isEmpty()) {
+    return QByteArray();
+  }
+
+  QFile file(MapFilename());
+
+  if (!file.open(QFile::ReadOnly)) {
+    return QByteArray();
+  }
+
+  QDataStream ds(&file);
+
+  quint32 magic, version;
+  QByteArray graph_hash;
+  int count;
+
+  ds >> magic >> version;
+
+  if (magic != kMapFileMagic || version != kMapFileVersion) {
+    return QByteArray();
+  }
+
+  ds >> graph_hash >> count;
+
+  for (int i=0;i<count && ds.status() == QDataStream::Ok;i++) {
+    qint64 num, den;
+    QByteArray hash;
+
+    ds >> num >> den >> hash;
+
+    map->insert(rational(num, den), hash);
+  }
+
+  if (ds.status() != QDataStream::Ok) {
+    qWarning() << "Frame cache map" << file.fileName() << "is corrupt, ignoring it";
+    map->clear();
+    return QByteArray();
+  }
+
+  return graph_hash;
+}
+
+QString VideoRenderFrameCache::MapFilename() const
+{
+  QDir map_dir(QDir(GetMediaCacheLocation()).filePath(QStringLiteral("maps")));
+  map_dir.mkpath(".");
+
+  return map_dir.filePath(cache_id_);
+}
+
 QString VideoRenderFrameCache::CachePathName(const QByteArray& hash, const PixelFormat::Format& pix_fmt) const
 {
   QString ext;
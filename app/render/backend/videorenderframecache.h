@@ -4,6 +4,7 @@
 #include <QMutex>
 
 #include "common/rational.h"
+#include "common/timerange.h"
 #include "render/pixelformat.h"
 
 class VideoRenderFrameCache
@@ -55,9 +56,30 @@ public:
 
   const QMap<rational, QByteArray>& time_hash_map() const;
 
+  /**
+   * @brief Write the time to hash map to disk so it can be restored in a later session
+   *
+   * The map is stored next to the cache under the current cache ID along with `graph_hash`, which LoadMap() returns so
+   * the caller can check whether the map still applies. Frames within `invalid_ranges` are omitted.
+   */
+  void SaveMap(const QByteArray& graph_hash, const TimeRangeList& invalid_ranges) const;
+
+  /**
+   * @brief Read the map written by SaveMap() for the current cache ID
+   *
+   * @return The graph hash the map was saved with, or an empty array if there was no readable map.
+   */
+  QByteArray LoadMap(QMap<rational, QByteArray>* map) const;
+
 private:
+  QString MapFilename() const;
+
   QMap<rational, QByteArray> time_hash_map_;
 
+  static const quint32 kMapFileMagic = 0x4F4C564D; // "OLVM"
+
+  static const quint32 kMapFileVersion = 1;
+
   QMutex currently_caching_lock_;
   QVector<QByteArray> currently_caching_list_;
 
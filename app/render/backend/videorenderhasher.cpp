@@ -0,0 +1,233 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "videorenderhasher.h"
+
+#include "node/block/transition/transition.h"
+#include "project/item/footage/footage.h"
+#include "project/item/footage/imagestream.h"
+#include "project/project.h"
+
+VideoRenderHasher::VideoRenderHasher(const VideoRenderingParams &params, DecoderCache *decoder_cache) :
+  params_(params),
+  decoder_cache_(decoder_cache)
+{
+}
+
+QByteArray VideoRenderHasher::Hash(const Node *node, const rational &time)
+{
+  // We use SHA-1 for speed (benchmarks show it's the fastest hash available to us)
+  QCryptographicHash hasher(QCryptographicHash::Sha1);
+
+  // Embed video parameters into this hash
+  int vwidth = params_.effective_width();
+  int vheight = params_.effective_height();
+  PixelFormat::Format vfmt = params_.format();
+  RenderMode::Mode vmode = params_.mode();
+
+  hasher.addData(reinterpret_cast<const char*>(&vwidth), sizeof(int));
+  hasher.addData(reinterpret_cast<const char*>(&vheight), sizeof(int));
+  hasher.addData(reinterpret_cast<const char*>(&vfmt), sizeof(PixelFormat::Format));
+  hasher.addData(reinterpret_cast<const char*>(&vmode), sizeof(RenderMode::Mode));
+
+  HashNodeRecursively(&hasher, node, time);
+
+  return hasher.result();
+}
+
+QByteArray VideoRenderHasher::ApproximationHash(const QByteArray &exact_hash)
+{
+  QCryptographicHash hasher(QCryptographicHash::Sha1);
+
+  hasher.addData(exact_hash);
+  hasher.addData(QByteArrayLiteral("keyframes-only"));
+
+  return hasher.result();
+}
+
+void VideoRenderHasher::HashNodeRecursively(QCryptographicHash *hash, const Node* n, const rational& time)
+{
+  // Resolve BlockList
+  if (n->IsTrack()) {
+    n = BlockAtTime(static_cast<const TrackOutput*>(n), time);
+
+    if (!n) {
+      return;
+    }
+  }
+
+  // Add this Node's ID
+  hash->addData(n->id().toUtf8());
+
+  if (n->IsBlock() && static_cast<const Block*>(n)->type() == Block::kTransition) {
+    const TransitionBlock* transition = static_cast<const TransitionBlock*>(n);
+
+    double all_prog = transition->GetTotalProgress(time);
+    double in_prog = transition->GetInProgress(time);
+    double out_prog = transition->GetOutProgress(time);
+
+    hash->addData(reinterpret_cast<const char*>(&all_prog), sizeof(double));
+    hash->addData(reinterpret_cast<const char*>(&in_prog), sizeof(double));
+    hash->addData(reinterpret_cast<const char*>(&out_prog), sizeof(double));
+  }
+
+  foreach (NodeParam* param, n->parameters()) {
+    // For each input, try to hash its value
+    if (param->type() == NodeParam::kInput) {
+      NodeInput* input = static_cast<NodeInput*>(param);
+
+      if (n->IsBlock()) {
+        const Block* b = static_cast<const Block*>(n);
+
+        // Ignore some Block attributes when hashing
+        if (input == b->media_in_input()
+            || input == b->speed_input()
+            || input == b->length_input()) {
+          continue;
+        }
+      }
+
+      // Get time adjustment
+      // For a single frame, we only care about one of the times
+      rational input_time = n->InputTimeAdjustment(input, TimeRange(time, time)).in();
+
+      if (input->IsConnected()) {
+        // Traverse down this edge
+        HashNodeRecursively(hash, input->get_connected_node(), input_time);
+      } else {
+        // Grab the value at this time
+        QVariant value = input->get_value_at_time(input_time);
+        hash->addData(NodeParam::ValueToBytes(input->data_type(), value));
+      }
+
+      // We have one exception for FOOTAGE types, since we resolve the footage into a frame in the renderer
+      if (input->data_type() == NodeParam::kFootage) {
+        StreamPtr stream = input->get_value_at_time(0).value<StreamPtr>();
+
+        if (stream) {
+          QByteArray details = FootageDetails(stream);
+
+          if (!details.isEmpty()) {
+            hash->addData(details);
+
+            // Footage timestamp
+            if (stream->type() == Stream::kVideo) {
+              hash->addData(QStringLiteral("%1/%2").arg(QString::number(input_time.numerator()),
+                                                        QString::number(input_time.denominator())).toUtf8());
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+const Block *VideoRenderHasher::BlockAtTime(const TrackOutput *track, const rational &time)
+{
+  if (track->IsMuted()) {
+    return nullptr;
+  }
+
+  // Consecutive frames usually land in the same block so check that before searching the whole track
+  const Block* last = last_blocks_.value(track);
+
+  if (last && last->in() <= time && last->out() > time) {
+    return last;
+  }
+
+  const Block* block = track->BlockAtTime(time);
+
+  last_blocks_.insert(track, block);
+
+  return block;
+}
+
+QByteArray VideoRenderHasher::FootageDetails(StreamPtr stream)
+{
+  QHash<Stream*, QByteArray>::const_iterator existing = footage_details_.constFind(stream.get());
+
+  if (existing != footage_details_.constEnd()) {
+    return existing.value();
+  }
+
+  QByteArray details;
+
+  // Footage that can't be decoded won't be rendered either, so it doesn't contribute to the hash
+  if (decoder_cache_->GetOrOpen(stream)) {
+    // Footage filename
+    details.append(stream->footage()->filename().toUtf8());
+
+    // Footage last modified date
+    details.append(stream->footage()->timestamp().toString().toUtf8());
+
+    // Footage stream
+    details.append(QString::number(stream->index()).toUtf8());
+
+    if (stream->type() == Stream::kImage || stream->type() == Stream::kVideo) {
+      ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(stream);
+
+      // Current color config and space
+      details.append(image_stream->footage()->project()->ocio_config().toUtf8());
+      details.append(image_stream->colorspace().toUtf8());
+
+      // Alpha associated setting
+      details.append(QString::number(image_stream->premultiplied_alpha()).toUtf8());
+    }
+  }
+
+  footage_details_.insert(stream.get(), details);
+
+  return details;
+}
+
+VideoRenderHashTask::VideoRenderHashTask(QObject *receiver,
+                                         int batch,
+                                         const Node *node,
+                                         const VideoRenderingParams &params,
+                                         DecoderCache *decoder_cache,
+                                         const QVector<rational> *times,
+                                         QByteArray *hashes,
+                                         int start,
+                                         int end,
+                                         const QAtomicInt *cancelled) :
+  receiver_(receiver),
+  batch_(batch),
+  node_(node),
+  hasher_(params, decoder_cache),
+  times_(times),
+  hashes_(hashes),
+  start_(start),
+  end_(end),
+  cancelled_(cancelled)
+{
+}
+
+void VideoRenderHashTask::run()
+{
+  for (int i=start_;i<end_;i++) {
+    if (*cancelled_) {
+      break;
+    }
+
+    hashes_[i] = hasher_.Hash(node_, times_->at(i));
+  }
+
+  QMetaObject::invokeMethod(receiver_, "HashTaskFinished", Qt::QueuedConnection, Q_ARG(int, batch_));
+}
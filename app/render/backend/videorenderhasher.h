@@ -0,0 +1,114 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef VIDEORENDERHASHER_H
+#define VIDEORENDERHASHER_H
+
+#include <QCryptographicHash>
+#include <QRunnable>
+
+#include "decodercache.h"
+#include "node/block/block.h"
+#include "node/output/track/track.h"
+#include "render/videoparams.h"
+
+/**
+ * @brief Generates the hashes VideoRenderWorker uses to identify identical frames
+ *
+ * Hashing only reads the node graph, so this has no need for a render context and can run on any thread as long as
+ * the graph isn't modified in the meantime. An instance remembers the block it last found on each track and the
+ * details of each footage stream it has seen, so hashing consecutive frames with the same instance shares that work.
+ * Create a new instance whenever the graph may have changed.
+ */
+class VideoRenderHasher
+{
+public:
+  VideoRenderHasher(const VideoRenderingParams& params, DecoderCache* decoder_cache);
+
+  QByteArray Hash(const Node* node, const rational& time);
+
+  /**
+   * @brief Derive the hash to store an approximation of a frame under (see Decoder::IsReturningKeyframesOnly())
+   *
+   * Keeps approximations from ever being mistaken for the exact frame that `exact_hash` describes.
+   */
+  static QByteArray ApproximationHash(const QByteArray& exact_hash);
+
+private:
+  void HashNodeRecursively(QCryptographicHash* hash, const Node* n, const rational& time);
+
+  const Block* BlockAtTime(const TrackOutput* track, const rational& time);
+
+  QByteArray FootageDetails(StreamPtr stream);
+
+  VideoRenderingParams params_;
+
+  DecoderCache* decoder_cache_;
+
+  QHash<const TrackOutput*, const Block*> last_blocks_;
+
+  QHash<Stream*, QByteArray> footage_details_;
+
+};
+
+/**
+ * @brief Hashes a slice of frames on a thread pool thread (see VideoRenderBackend::GenerateHashes())
+ *
+ * Each task writes into its own slice of `hashes`, so tasks sharing the same array don't need to lock. When done,
+ * `receiver`'s HashTaskFinished(int) slot is invoked through a queued connection with `batch`.
+ */
+class VideoRenderHashTask : public QRunnable
+{
+public:
+  VideoRenderHashTask(QObject* receiver,
+                      int batch,
+                      const Node* node,
+                      const VideoRenderingParams& params,
+                      DecoderCache* decoder_cache,
+                      const QVector<rational>* times,
+                      QByteArray* hashes,
+                      int start,
+                      int end,
+                      const QAtomicInt* cancelled);
+
+  virtual void run() override;
+
+private:
+  QObject* receiver_;
+
+  int batch_;
+
+  const Node* node_;
+
+  VideoRenderHasher hasher_;
+
+  const QVector<rational>* times_;
+
+  QByteArray* hashes_;
+
+  int start_;
+
+  int end_;
+
+  const QAtomicInt* cancelled_;
+
+};
+
+#endif // VIDEORENDERHASHER_H
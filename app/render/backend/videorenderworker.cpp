@@ -1,5 +1,7 @@
 #include "videorenderworker.h"
 
+#include <algorithm>
+#include <QElapsedTimer>
 #include <OpenEXR/ImfFloatAttribute.h>
 #include <OpenEXR/ImfInputFile.h>
 #include <OpenEXR/ImfOutputFile.h>
@@ -7,10 +9,9 @@
 
 #include "common/define.h"
 #include "common/functiontimer.h"
-#include "node/block/transition/transition.h"
 #include "node/node.h"
-#include "project/project.h"
 #include "render/pixelformat.h"
+#include "videorenderhasher.h"
 
 VideoRenderWorker::VideoRenderWorker(VideoRenderFrameCache *frame_cache, DecoderCache* decoder_cache, QObject *parent) :
   RenderWorker(decoder_cache, parent),
@@ -26,25 +27,13 @@ const VideoRenderingParams &VideoRenderWorker::video_params()
 
 NodeValueTable VideoRenderWorker::RenderInternal(const NodeDependency& path, const qint64 &job_time)
 {
+  // The hash and the frame we store under it must come from the same values
+  int generation = GraphGeneration();
+
   // Get hash of node graph
-  // We use SHA-1 for speed (benchmarks show it's the fastest hash available to us)
   QByteArray hash;
   if (operating_mode_ & kHashOnly) {
-    QCryptographicHash hasher(QCryptographicHash::Sha1);
-
-    // Embed video parameters into this hash
-    int vwidth = video_params_.effective_width();
-    int vheight = video_params_.effective_height();
-    PixelFormat::Format vfmt = video_params_.format();
-    RenderMode::Mode vmode = video_params_.mode();
-
-    hasher.addData(reinterpret_cast<const char*>(&vwidth), sizeof(int));
-    hasher.addData(reinterpret_cast<const char*>(&vheight), sizeof(int));
-    hasher.addData(reinterpret_cast<const char*>(&vfmt), sizeof(PixelFormat::Format));
-    hasher.addData(reinterpret_cast<const char*>(&vmode), sizeof(RenderMode::Mode));
-
-    HashNodeRecursively(&hasher, path.node(), path.in());
-    hash = hasher.result();
+    hash = VideoRenderHasher(video_params_, decoder_cache()).Hash(path.node(), path.in());
   }
 
   NodeValueTable value;
@@ -61,22 +50,55 @@ NodeValueTable VideoRenderWorker::RenderInternal(const NodeDependency& path, con
 
   } else if (!(operating_mode_ & kHashOnly) || frame_cache_->TryCache(hash)) {
 
+    QElapsedTimer render_timer;
+    render_timer.start();
+
     // This hash is available for us to cache, start traversing graph
     value = ProcessNode(path);
 
+    if ((operating_mode_ & kHashOnly) && GraphChangedSince(generation)) {
+      // Values changed while we were working, so this frame may not be what the hash describes. It must never end up
+      // in the cache under this hash, the backend will render this time again.
+      frame_cache_->RemoveHashFromCurrentlyCaching(hash);
+
+      emit ValuesChangedDuringRender(path, job_time);
+
+      return NodeValueTable();
+    }
+
+    bool approximated = ((operating_mode_ & kHashOnly) && FootageWasApproximated());
+
+    if (approximated) {
+      // A decoder gave us a nearby keyframe rather than the frame this hash describes, so the result goes under a hash
+      // of its own where it can never be served in place of the exact frame
+      frame_cache_->RemoveHashFromCurrentlyCaching(hash);
+
+      hash = VideoRenderHasher::ApproximationHash(hash);
+    }
+
     // Find texture in hash
     QVariant texture = value.Get(NodeParam::kTexture);
 
     // If we actually have a texture, download it into the disk cache
     if (!texture.isNull()) {
       Download(path.in(), texture, frame_cache_->CachePathName(hash, video_params_.format()));
+    } else if (!(operating_mode_ & kDownloadOnly)) {
+      EmitBlankFrame(path.in());
+    }
+
+    if (!approximated) {
+      frame_cache_->RemoveHashFromCurrentlyCaching(hash);
     }
 
-    frame_cache_->RemoveHashFromCurrentlyCaching(hash);
+    emit RenderTimeMeasured(render_timer.nsecsElapsed() * 0.000001);
 
     // Signal that this job is complete
     if (operating_mode_ & kDownloadOnly) {
-      emit CompletedDownload(path, job_time, hash, !texture.isNull());
+      if (approximated) {
+        emit CompletedApproximateDownload(path, job_time, hash, !texture.isNull());
+      } else {
+        emit CompletedDownload(path, job_time, hash, !texture.isNull());
+      }
     }
 
   } else {
@@ -89,115 +111,6 @@ NodeValueTable VideoRenderWorker::RenderInternal(const NodeDependency& path, con
   return value;
 }
 
-void VideoRenderWorker::HashNodeRecursively(QCryptographicHash *hash, const Node* n, const rational& time)
-{
-  // Resolve BlockList
-  if (n->IsTrack()) {
-    n = static_cast<const TrackOutput*>(n)->BlockAtTime(time);
-
-    if (!n) {
-      return;
-    }
-  }
-
-  // Add this Node's ID
-  hash->addData(n->id().toUtf8());
-
-  if (n->IsBlock() && static_cast<const Block*>(n)->type() == Block::kTransition) {
-    const TransitionBlock* transition = static_cast<const TransitionBlock*>(n);
-
-    double all_prog = transition->GetTotalProgress(time);
-    double in_prog = transition->GetInProgress(time);
-    double out_prog = transition->GetOutProgress(time);
-
-    hash->addData(reinterpret_cast<const char*>(&all_prog), sizeof(double));
-    hash->addData(reinterpret_cast<const char*>(&in_prog), sizeof(double));
-    hash->addData(reinterpret_cast<const char*>(&out_prog), sizeof(double));
-  }
-
-  foreach (NodeParam* param, n->parameters()) {
-    // For each input, try to hash its value
-    if (param->type() == NodeParam::kInput) {
-      NodeInput* input = static_cast<NodeInput*>(param);
-
-      if (n->IsBlock()) {
-        const Block* b = static_cast<const Block*>(n);
-
-        // Ignore some Block attributes when hashing
-        if (input == b->media_in_input()
-            || input == b->speed_input()
-            || input == b->length_input()) {
-          continue;
-        }
-      }
-
-      // Get time adjustment
-      // For a single frame, we only care about one of the times
-      rational input_time = n->InputTimeAdjustment(input, TimeRange(time, time)).in();
-
-      if (input->IsConnected()) {
-        // Traverse down this edge
-        HashNodeRecursively(hash, input->get_connected_node(), input_time);
-      } else {
-        // Grab the value at this time
-        QVariant value = input->get_value_at_time(input_time);
-        hash->addData(NodeParam::ValueToBytes(input->data_type(), value));
-      }
-
-      // We have one exception for FOOTAGE types, since we resolve the footage into a frame in the renderer
-      if (input->data_type() == NodeParam::kFootage) {
-        StreamPtr stream = ResolveStreamFromInput(input);
-
-        if (stream) {
-          DecoderPtr decoder = ResolveDecoderFromInput(stream);
-
-          if (decoder) {
-
-            // Add footage details to hash
-
-            // Footage filename
-            hash->addData(stream->footage()->filename().toUtf8());
-
-            // Footage last modified date
-            hash->addData(stream->footage()->timestamp().toString().toUtf8());
-
-            // Footage stream
-            hash->addData(QString::number(stream->index()).toUtf8());
-
-            if (stream->type() == Stream::kImage || stream->type() == Stream::kVideo) {
-              ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(stream);
-
-              // Current color config and space
-              hash->addData(image_stream->footage()->project()->ocio_config().toUtf8());
-              hash->addData(image_stream->colorspace().toUtf8());
-
-              // Alpha associated setting
-              hash->addData(QString::number(image_stream->premultiplied_alpha()).toUtf8());
-            }
-
-            // Footage timestamp
-            if (stream->type() == Stream::kVideo) {
-              hash->addData(QStringLiteral("%1/%2").arg(QString::number(input_time.numerator()),
-                                                        QString::number(input_time.denominator())).toUtf8());
-              /*Decoder::RetrieveState state = decoder->GetRetrieveState(input_time);
-
-              if (state == Decoder::kReady) {
-                VideoStreamPtr video_stream = std::static_pointer_cast<VideoStream>(stream);
-
-                int64_t timestamp_here = video_stream->get_closest_timestamp_in_frame_index(input_time);
-
-                hash->addData(QString::number(timestamp_here).toUtf8());
-              } else {
-                ReportUnavailableFootage(stream, state, input_time);
-              }*/
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
 void VideoRenderWorker::SetParameters(const VideoRenderingParams &video_params)
 {
   video_params_ = video_params;
@@ -214,6 +127,11 @@ void VideoRenderWorker::SetOperatingMode(const VideoRenderWorker::OperatingMode
   operating_mode_ = mode;
 }
 
+void VideoRenderWorker::SetOutputYUVParams(const YUVParams &params)
+{
+  output_yuv_params_ = params;
+}
+
 bool VideoRenderWorker::InitInternal()
 {
   ResizeDownloadBuffer();
@@ -314,19 +232,62 @@ void VideoRenderWorker::Download(const rational& time, QVariant texture, QString
 
   } else {
 
-    FramePtr frame = Frame::Create();
-    frame->set_width(video_params().width());
-    frame->set_height(video_params().height());
-    frame->set_format(video_params().format());
-    frame->allocate();
+    FramePtr frame = CreateOutputFrame();
 
-    TextureToBuffer(texture, frame->data());
+    if (output_yuv_params_.is_valid()) {
+      TextureToPlanes(texture, frame->data());
+    } else {
+      TextureToBuffer(texture, frame->data());
+    }
 
     emit GeneratedFrame(time, frame);
 
   }
 }
 
+FramePtr VideoRenderWorker::CreateOutputFrame()
+{
+  FramePtr frame = Frame::Create();
+  frame->set_width(video_params().width());
+  frame->set_height(video_params().height());
+  frame->set_format(video_params().format());
+
+  if (output_yuv_params_.is_valid()) {
+    frame->set_yuv_params(output_yuv_params_);
+  }
+
+  frame->allocate();
+
+  return frame;
+}
+
+void VideoRenderWorker::EmitBlankFrame(const rational &time)
+{
+  FramePtr frame = CreateOutputFrame();
+
+  if (output_yuv_params_.is_valid()) {
+    // Video range black, matching the offsets TextureToPlanes() converts with
+    int shift = output_yuv_params_.bit_depth() - 8;
+
+    for (int i=0;i<YUVParams::kPlaneCount;i++) {
+      int value = ((i == 0) ? 16 : 128) << shift;
+      int sample_count = output_yuv_params_.plane_width(i, frame->width())
+          * output_yuv_params_.plane_height(i, frame->height());
+      char* plane = frame->data() + output_yuv_params_.plane_offset(i, frame->width(), frame->height());
+
+      if (output_yuv_params_.bytes_per_sample() == 1) {
+        memset(plane, value, static_cast<size_t>(sample_count));
+      } else {
+        std::fill_n(reinterpret_cast<quint16*>(plane), sample_count, static_cast<quint16>(value));
+      }
+    }
+  } else {
+    memset(frame->data(), 0, static_cast<size_t>(frame->allocated_size()));
+  }
+
+  emit GeneratedFrame(time, frame);
+}
+
 void VideoRenderWorker::ResizeDownloadBuffer()
 {
   download_buffer_.resize(PixelFormat::GetBufferSize(video_params_.format(), video_params_.effective_width(), video_params_.effective_height()));
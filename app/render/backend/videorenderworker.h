@@ -6,6 +6,7 @@
 #include "colorprocessorcache.h"
 #include "node/dependency.h"
 #include "render/videoparams.h"
+#include "render/yuvparams.h"
 #include "renderworker.h"
 #include "videorenderframecache.h"
 
@@ -47,13 +48,39 @@ public:
 
   void SetOperatingMode(const OperatingMode& mode);
 
+  /**
+   * @brief Generate planar Y'CbCr frames instead of RGBA ones when not downloading to the disk cache
+   *
+   * Set to an invalid YUVParams (the default) to generate RGBA frames.
+   */
+  void SetOutputYUVParams(const YUVParams& params);
+
 signals:
   void CompletedDownload(NodeDependency path, qint64 job_time, QByteArray hash, bool texture_existed);
 
+  /**
+   * @brief Same as CompletedDownload() for a frame rendered from keyframes only while shuttling
+   *
+   * `hash` is the VideoRenderHasher::ApproximationHash() the frame was stored under.
+   */
+  void CompletedApproximateDownload(NodeDependency path, qint64 job_time, QByteArray hash, bool texture_existed);
+
   void HashAlreadyBeingCached(NodeDependency path, qint64 job_time, QByteArray hash);
 
   void HashAlreadyExists(NodeDependency path, qint64 job_time, QByteArray hash);
 
+  /**
+   * @brief Emitted instead of storing a frame that was rendered while the backend updated the graph's values
+   */
+  void ValuesChangedDuringRender(NodeDependency path, qint64 job_time);
+
+  /**
+   * @brief Emitted before a job's completion signal with how long rendering (and downloading) its frame took
+   *
+   * Only jobs that actually rendered something emit this, and time spent queued or hashing isn't included.
+   */
+  void RenderTimeMeasured(double msecs);
+
   void GeneratedFrame(const rational &time, FramePtr frame);
 
   void Aborted();
@@ -69,6 +96,11 @@ protected:
 
   virtual void TextureToBuffer(const QVariant& texture, void *buffer) = 0;
 
+  /**
+   * @brief Convert a texture to planar Y'CbCr (see SetOutputYUVParams()) and download it into a buffer
+   */
+  virtual void TextureToPlanes(const QVariant& texture, void *buffer) = 0;
+
   virtual NodeValueTable RenderInternal(const NodeDependency& CurrentPath, const qint64& job_time) override;
 
   virtual NodeValueTable RenderBlock(const TrackOutput *track, const TimeRange& range) override;
@@ -78,10 +110,21 @@ protected:
   ColorProcessorCache* color_cache();
 
 private:
-  void HashNodeRecursively(QCryptographicHash* hash, const Node *n, const rational &time);
-
   void Download(const rational &time, QVariant texture, QString filename);
 
+  /**
+   * @brief Allocate a frame in the format GeneratedFrame() delivers (see SetOutputYUVParams())
+   */
+  FramePtr CreateOutputFrame();
+
+  /**
+   * @brief Emit GeneratedFrame() with a black frame for a time that has nothing to render (e.g. a gap)
+   *
+   * Without this, whoever requested the frame would wait for it forever and this worker would never be marked as
+   * available again.
+   */
+  void EmitBlankFrame(const rational& time);
+
   void ResizeDownloadBuffer();
 
   VideoRenderingParams video_params_;
@@ -94,6 +137,8 @@ private:
 
   OperatingMode operating_mode_;
 
+  YUVParams output_yuv_params_;
+
 private slots:
 
 };
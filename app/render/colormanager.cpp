@@ -1,6 +1,7 @@
 #include "colormanager.h"
 
 #include <QFloat16>
+#include <QThreadPool>
 
 #include "common/define.h"
 #include "config/config.h"
@@ -29,6 +30,11 @@ void ColorManager::SetConfig(OCIO::ConstConfigRcPtr config)
   emit ConfigChanged();
 }
 
+void ColorManager::PreloadDefaultConfig()
+{
+  QThreadPool::globalInstance()->start(new DefaultConfigTask());
+}
+
 void ColorManager::DisassociateAlpha(FramePtr f)
 {
   AssociateAlphaPixFmtFilter(kDisassociate, f);
@@ -173,3 +179,9 @@ void ColorManager::AssociateAlphaInternal(ColorManager::AlphaAction action, T *d
     }
   }
 }
+
+void ColorManager::DefaultConfigTask::run()
+{
+  // GetCurrentConfig() is thread-safe and keeps the config it loads, we only need to trigger it
+  OCIO::GetCurrentConfig();
+}
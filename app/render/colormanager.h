@@ -2,6 +2,7 @@
 #define COLORSERVICE_H
 
 #include <memory>
+#include <QRunnable>
 
 #include "codec/frame.h"
 #include "colorprocessor.h"
@@ -18,6 +19,14 @@ public:
 
   void SetConfig(OCIO::ConstConfigRcPtr config);
 
+  /**
+   * @brief Start loading OCIO's default config on the global thread pool
+   *
+   * The default config comes from $OCIO and can take a while to parse. OCIO caches it, so doing this early at startup
+   * means the first project's ColorManager doesn't have to wait for it.
+   */
+  static void PreloadDefaultConfig();
+
   static void DisassociateAlpha(FramePtr f);
 
   static void AssociateAlpha(FramePtr f);
@@ -51,6 +60,12 @@ signals:
   void ConfigChanged();
 
 private:
+  class DefaultConfigTask : public QRunnable
+  {
+  protected:
+    virtual void run() override;
+  };
+
   OCIO::ConstConfigRcPtr config_;
 
   enum AlphaAction {
@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QStandardPaths>
+#include <QThreadPool>
 
 #include "common/filefunctions.h"
 #include "config/config.h"
@@ -29,16 +30,21 @@ DiskManager::DiskManager() :
       ds >> h.access_time;
       ds >> h.file_size;
 
-      if (QFileInfo::exists(h.file_name)) {
-        consumption_ += h.file_size;
-        disk_data_.append(h);
-      }
+      consumption_ += h.file_size;
+      disk_data_.append(h);
     }
   }
+
+  // Checking every file can take a while on a large cache, so we trust the index for now and prune it in the
+  // background
+  QThreadPool::globalInstance()->start(new ValidateIndexTask(this));
 }
 
 DiskManager::~DiskManager()
 {
+  // Make sure validation isn't still using us
+  validated_.acquire();
+
   if (Config::Current()["ClearDiskCacheOnClose"].toBool()) {
     // Clear all cache data
     ClearDiskCache(true);
@@ -175,6 +181,41 @@ bool DiskManager::ClearDiskCache(bool quick_delete)
   return deleted_files;
 }
 
+void DiskManager::ValidateIndex()
+{
+  lock_.lock();
+  QList<HashTime> entries = disk_data_;
+  lock_.unlock();
+
+  QList<HashTime> missing_entries;
+
+  foreach (const HashTime& h, entries) {
+    if (!QFileInfo::exists(h.file_name)) {
+      missing_entries.append(h);
+    }
+  }
+
+  if (missing_entries.isEmpty()) {
+    return;
+  }
+
+  lock_.lock();
+
+  // The index may have changed while we were checking, so only remove what's still there. A file that was deleted and
+  // created again in the meantime has a new entry with a different access time, which is kept.
+  for (int i=0;i<disk_data_.size();i++) {
+    const HashTime& h = disk_data_.at(i);
+
+    if (missing_entries.contains(h)) {
+      consumption_ -= h.file_size;
+      disk_data_.removeAt(i);
+      i--;
+    }
+  }
+
+  lock_.unlock();
+}
+
 QByteArray DiskManager::DeleteLeastRecent()
 {
   HashTime h = disk_data_.takeFirst();
@@ -200,3 +241,22 @@ QString DiskManager::GetCacheIndexFilename()
   d.mkpath(".");
   return d.filePath("diskindex");
 }
+
+DiskManager::ValidateIndexTask::ValidateIndexTask(DiskManager *manager) :
+  manager_(manager)
+{
+}
+
+void DiskManager::ValidateIndexTask::run()
+{
+  manager_->ValidateIndex();
+
+  manager_->validated_.release();
+}
+
+bool DiskManager::HashTime::operator==(const DiskManager::HashTime &rhs) const
+{
+  return rhs.file_name == file_name
+      && rhs.hash == hash
+      && rhs.access_time == access_time;
+}
@@ -3,6 +3,8 @@
 
 #include <QMutex>
 #include <QObject>
+#include <QRunnable>
+#include <QSemaphore>
 
 class DiskManager : public QObject
 {
@@ -32,6 +34,27 @@ private:
 
   static DiskManager* instance_;
 
+  /**
+   * @brief Checks that the files in a freshly loaded index still exist, off the main thread
+   */
+  class ValidateIndexTask : public QRunnable
+  {
+  public:
+    ValidateIndexTask(DiskManager* manager);
+
+  protected:
+    virtual void run() override;
+
+  private:
+    DiskManager* manager_;
+
+  };
+
+  /**
+   * @brief Remove any index entries whose files no longer exist (see ValidateIndexTask)
+   */
+  void ValidateIndex();
+
   QByteArray DeleteLeastRecent();
 
   qint64 DiskLimit();
@@ -43,6 +66,8 @@ private:
     QByteArray hash;
     qint64 access_time;
     qint64 file_size;
+
+    bool operator==(const HashTime& rhs) const;
   };
 
   QList<HashTime> disk_data_;
@@ -51,6 +76,8 @@ private:
 
   QMutex lock_;
 
+  QSemaphore validated_;
+
 };
 
 #endif // DISKMANAGER_H
@@ -0,0 +1,194 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "filmstripcache.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtMath>
+
+#include "codec/decoder.h"
+#include "common/filefunctions.h"
+
+FilmstripCache* FilmstripCache::instance_ = nullptr;
+const int FilmstripCache::kFrameHeight = 64;
+const int FilmstripCache::kTicksPerSecond = 16;
+const int FilmstripCache::kMaximumLevel = 20;
+const int FilmstripCache::kMemoryCacheSize = 65536;
+const int FilmstripCache::kMaximumQueueSize = 256;
+const int FilmstripCache::kMaximumBatchSize = 32;
+const int FilmstripCache::kMaximumFallbackLevels = 4;
+
+FilmstripCache::FilmstripCache() :
+  AsyncImageCache(kMemoryCacheSize, kMaximumQueueSize, kMaximumBatchSize),
+  ready_signal_queued_(false)
+{
+}
+
+FilmstripCache::~FilmstripCache()
+{
+  Stop();
+}
+
+void FilmstripCache::CreateInstance()
+{
+  instance_ = new FilmstripCache();
+}
+
+void FilmstripCache::DestroyInstance()
+{
+  delete instance_;
+  instance_ = nullptr;
+}
+
+FilmstripCache *FilmstripCache::instance()
+{
+  return instance_;
+}
+
+QPixmap FilmstripCache::Get(ImageStreamPtr stream, qint64 tick, int level)
+{
+  QString key = GetKey(stream.get(), tick);
+
+  QPixmap* cached = Cached(key);
+
+  if (cached) {
+    return *cached;
+  }
+
+  Queue({key, stream->footage()->filename(), stream->footage()->decoder(), stream, tick});
+
+  // Show the frame from a coarser level in the meantime
+  for (int i=level+1;i<=qMin(kMaximumLevel, level+kMaximumFallbackLevels);i++) {
+    qint64 step = Q_INT64_C(1) << i;
+
+    cached = Cached(GetKey(stream.get(), tick - tick % step));
+
+    if (cached) {
+      return *cached;
+    }
+  }
+
+  return QPixmap();
+}
+
+int FilmstripCache::LevelForInterval(double seconds)
+{
+  double ticks = seconds * kTicksPerSecond;
+
+  if (ticks < 2.0) {
+    return 0;
+  }
+
+  return qMin(kMaximumLevel, qFloor(std::log2(ticks)));
+}
+
+qint64 FilmstripCache::TickAt(double seconds, int level)
+{
+  qint64 step = Q_INT64_C(1) << level;
+  qint64 tick = qMax(Q_INT64_C(0), static_cast<qint64>(qFloor(seconds * kTicksPerSecond)));
+
+  return tick - tick % step;
+}
+
+QString FilmstripCache::GetKey(Stream *stream, qint64 tick)
+{
+  // Include the modified time so frames of a changed file aren't mistaken for the old ones, like the disk tier does
+  return QStringLiteral("%1:%2:%3:%4").arg(stream->footage()->filename(),
+                                           QString::number(stream->footage()->timestamp().toMSecsSinceEpoch()),
+                                           QString::number(stream->index()),
+                                           QString::number(tick));
+}
+
+void FilmstripCache::ProcessBatch(const QList<Request> &batch)
+{
+  const Request& first = batch.first();
+
+  // Identifies the file by its path and modified time
+  QString file_id = GetUniqueFileIdentifier(first.filename);
+
+  QDir filmstrip_dir = GetDiskCacheDirectory(QStringLiteral("filmstrip"));
+
+  ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(first.stream);
+
+  DecoderPtr decoder;
+
+  foreach (const Request& r, batch) {
+    QImage image;
+
+    if (!file_id.isEmpty()) {
+      QString cache_filename = filmstrip_dir.filePath(QStringLiteral("%1-%2-%3.jpg").arg(file_id,
+                                                                                        QString::number(r.stream->index()),
+                                                                                        QString::number(r.position)));
+
+      if (!QFile::exists(cache_filename) || !image.load(cache_filename)) {
+        // Only open the decoder once we know we need it
+        if (!decoder) {
+          decoder = Decoder::CreateFromID(r.decoder);
+
+          if (decoder) {
+            decoder->set_stream(r.stream);
+
+            if (!decoder->Open()) {
+              decoder = nullptr;
+            }
+          }
+        }
+
+        if (decoder) {
+          int divider = qMax(1, image_stream->height() / kFrameHeight);
+
+          FramePtr frame = decoder->RetrieveVideo(rational(r.position, kTicksPerSecond), divider);
+
+          if (frame) {
+            image = FrameToImage(frame).scaledToHeight(kFrameHeight, Qt::SmoothTransformation);
+
+            if (!image.isNull() && !image.save(cache_filename, "JPG")) {
+              qWarning() << "Failed to save filmstrip frame to" << cache_filename;
+            }
+          }
+        }
+      }
+    }
+
+    ImageGenerated(r.key, image);
+  }
+
+  if (decoder) {
+    decoder->Close();
+  }
+}
+
+void FilmstripCache::ImageReady(const QString &key)
+{
+  Q_UNUSED(key)
+
+  if (!ready_signal_queued_) {
+    ready_signal_queued_ = true;
+    QMetaObject::invokeMethod(this, "EmitFramesReady", Qt::QueuedConnection);
+  }
+}
+
+void FilmstripCache::EmitFramesReady()
+{
+  ready_signal_queued_ = false;
+
+  emit FramesReady();
+}
@@ -0,0 +1,112 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef FILMSTRIPCACHE_H
+#define FILMSTRIPCACHE_H
+
+#include "project/item/footage/imagestream.h"
+#include "render/asyncimagecache.h"
+
+/**
+ * @brief Background generator and cache of the frames shown in filmstrips on timeline clips
+ *
+ * Frames are addressed by source time in "ticks" of 1/kTicksPerSecond seconds. A filmstrip at a given timeline scale
+ * uses a "level" where one frame is shown every 2^level ticks (see LevelForInterval()). Because every level's ticks
+ * are also ticks of all finer levels, frames are cached by tick rather than by level. Zooming in or out reuses any
+ * frame that has already been decoded, and Get() falls back to the nearest coarser level's frame while the exact one
+ * is being generated.
+ *
+ * Get() never blocks. Missing frames are queued and generated in the background, checking a disk tier before
+ * decoding. FramesReady() is emitted on the main thread when new frames can be retrieved.
+ */
+class FilmstripCache : public AsyncImageCache
+{
+  Q_OBJECT
+public:
+  static void CreateInstance();
+
+  static void DestroyInstance();
+
+  static FilmstripCache* instance();
+
+  /**
+   * @brief Retrieve the frame at `tick`, or the closest available one at a coarser level
+   *
+   * Returns a null QPixmap if nothing suitable is cached yet. Must only be called from the main thread.
+   */
+  QPixmap Get(ImageStreamPtr stream, qint64 tick, int level);
+
+  /**
+   * @brief Returns the finest level whose frames are at least `seconds` of source media apart
+   */
+  static int LevelForInterval(double seconds);
+
+  /**
+   * @brief Returns the tick of the frame at `level` that `seconds` falls into
+   */
+  static qint64 TickAt(double seconds, int level);
+
+  /**
+   * @brief Height frames are stored at, they're scaled to the track height when drawn
+   */
+  static const int kFrameHeight;
+
+  static const int kTicksPerSecond;
+
+  static const int kMaximumLevel;
+
+signals:
+  /**
+   * @brief Emitted when frames requested through Get() are available, at most once per event loop iteration
+   */
+  void FramesReady();
+
+protected:
+  virtual void ProcessBatch(const QList<Request>& batch) override;
+
+  virtual void ImageReady(const QString& key) override;
+
+private:
+  FilmstripCache();
+
+  virtual ~FilmstripCache() override;
+
+  static FilmstripCache* instance_;
+
+  static QString GetKey(Stream* stream, qint64 tick);
+
+  bool ready_signal_queued_;
+
+  /// Memory cache size in kilobytes
+  static const int kMemoryCacheSize;
+
+  static const int kMaximumQueueSize;
+
+  static const int kMaximumBatchSize;
+
+  /// How many coarser levels Get() checks when a frame is missing
+  static const int kMaximumFallbackLevels;
+
+private slots:
+  void EmitFramesReady();
+
+};
+
+#endif // FILMSTRIPCACHE_H
@@ -0,0 +1,285 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "memorymanager.h"
+
+#include <algorithm>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+#include <QFile>
+#elif defined(Q_OS_WINDOWS)
+#include <Windows.h>
+#endif
+
+#include "config/config.h"
+
+MemoryManager* MemoryManager::instance_ = nullptr;
+QMutex MemoryManager::lock_;
+QMutex MemoryManager::reclaim_lock_;
+QMap<int, MemoryManager::Consumer> MemoryManager::consumers_;
+int MemoryManager::next_id_ = 0;
+qint64 MemoryManager::usage_ = 0;
+qint64 MemoryManager::budget_ = 0;
+bool MemoryManager::reclaim_queued_ = false;
+const double MemoryManager::kReclaimTarget = 0.8;
+const double MemoryManager::kLowSystemMemory = 0.05;
+const int MemoryManager::kPressureInterval = 2000;
+
+MemoryManager::MemoryManager()
+{
+  UpdateBudget();
+
+  pressure_timer_.setInterval(kPressureInterval);
+  connect(&pressure_timer_, &QTimer::timeout, this, &MemoryManager::CheckSystemMemory);
+  pressure_timer_.start();
+}
+
+void MemoryManager::CreateInstance()
+{
+  instance_ = new MemoryManager();
+}
+
+void MemoryManager::DestroyInstance()
+{
+  delete instance_;
+  instance_ = nullptr;
+}
+
+MemoryManager *MemoryManager::instance()
+{
+  return instance_;
+}
+
+int MemoryManager::AddConsumer(const QString &name, MemoryManager::Priority priority, const ReclaimFunction &reclaim)
+{
+  QMutexLocker locker(&lock_);
+
+  int id = next_id_;
+  next_id_++;
+
+  consumers_.insert(id, {name, priority, reclaim, 0});
+
+  return id;
+}
+
+void MemoryManager::RemoveConsumer(int id)
+{
+  // Wait for a running reclaim to finish in case it's calling this consumer
+  QMutexLocker reclaim_locker(&reclaim_lock_);
+  QMutexLocker locker(&lock_);
+
+  usage_ -= consumers_.take(id).usage;
+}
+
+void MemoryManager::Allocated(int id, qint64 bytes)
+{
+  lock_.lock();
+
+  usage_ += bytes;
+
+  QMap<int, Consumer>::iterator consumer = consumers_.find(id);
+  if (consumer != consumers_.end()) {
+    consumer->usage += bytes;
+  }
+
+  bool queue_reclaim = (budget_ > 0 && usage_ > budget_ && !reclaim_queued_ && instance_);
+
+  if (queue_reclaim) {
+    reclaim_queued_ = true;
+  }
+
+  lock_.unlock();
+
+  if (queue_reclaim) {
+    QMetaObject::invokeMethod(instance_, "Reclaim", Qt::QueuedConnection);
+  }
+}
+
+void MemoryManager::Freed(int id, qint64 bytes)
+{
+  QMutexLocker locker(&lock_);
+
+  usage_ -= bytes;
+
+  QMap<int, Consumer>::iterator consumer = consumers_.find(id);
+  if (consumer != consumers_.end()) {
+    consumer->usage -= bytes;
+  }
+}
+
+qint64 MemoryManager::Usage()
+{
+  QMutexLocker locker(&lock_);
+
+  return usage_;
+}
+
+qint64 MemoryManager::Budget()
+{
+  QMutexLocker locker(&lock_);
+
+  return budget_;
+}
+
+bool MemoryManager::IsOverBudget()
+{
+  QMutexLocker locker(&lock_);
+
+  return budget_ > 0 && usage_ > budget_;
+}
+
+void MemoryManager::UpdateBudget()
+{
+  qint64 budget = qRound64(Config::Current()["MemoryBudget"].toDouble() * 1073741824.0);
+
+  if (budget <= 0) {
+    qint64 total, available;
+
+    if (GetSystemMemory(&total, &available)) {
+      budget = total / 2;
+    } else {
+      // Unlimited, we can still react to memory pressure
+      budget = 0;
+    }
+  }
+
+  QMutexLocker locker(&lock_);
+
+  budget_ = budget;
+}
+
+bool MemoryManager::GetSystemMemory(qint64 *total, qint64 *available)
+{
+#if defined(Q_OS_LINUX)
+  QFile meminfo(QStringLiteral("/proc/meminfo"));
+
+  if (!meminfo.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  *total = -1;
+  *available = -1;
+
+  // Lines are formatted like "MemTotal:       32778048 kB"
+  foreach (const QByteArray& line, meminfo.readAll().split('\n')) {
+    QList<QByteArray> fields = line.simplified().split(' ');
+
+    if (fields.size() < 2) {
+      continue;
+    }
+
+    if (fields.at(0) == "MemTotal:") {
+      *total = fields.at(1).toLongLong() * 1024;
+    } else if (fields.at(0) == "MemAvailable:") {
+      *available = fields.at(1).toLongLong() * 1024;
+    }
+  }
+
+  return (*total > 0 && *available >= 0);
+#elif defined(Q_OS_WINDOWS)
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+
+  if (!GlobalMemoryStatusEx(&status)) {
+    return false;
+  }
+
+  *total = static_cast<qint64>(status.ullTotalPhys);
+  *available = static_cast<qint64>(status.ullAvailPhys);
+
+  return true;
+#else
+  Q_UNUSED(total)
+  Q_UNUSED(available)
+
+  return false;
+#endif
+}
+
+void MemoryManager::ReclaimBytes(qint64 bytes)
+{
+  if (bytes <= 0) {
+    return;
+  }
+
+  QMutexLocker reclaim_locker(&reclaim_lock_);
+
+  lock_.lock();
+
+  QList<int> order = consumers_.keys();
+
+  // Lowest priority first, and within the same priority the consumers holding the most
+  std::sort(order.begin(), order.end(), [](int a, int b) {
+    const Consumer& ca = consumers_[a];
+    const Consumer& cb = consumers_[b];
+
+    if (ca.priority != cb.priority) {
+      return ca.priority < cb.priority;
+    }
+
+    return ca.usage > cb.usage;
+  });
+
+  lock_.unlock();
+
+  foreach (int id, order) {
+    lock_.lock();
+    ReclaimFunction reclaim = consumers_.value(id).reclaim;
+    lock_.unlock();
+
+    // Consumers that don't account for their memory (e.g. because it's counted by a pool they return it to) are
+    // asked as well
+    if (reclaim) {
+      bytes -= reclaim(bytes);
+    }
+
+    if (bytes <= 0) {
+      break;
+    }
+  }
+}
+
+void MemoryManager::Reclaim()
+{
+  lock_.lock();
+  reclaim_queued_ = false;
+  qint64 excess = usage_ - qRound64(budget_ * kReclaimTarget);
+  lock_.unlock();
+
+  ReclaimBytes(excess);
+}
+
+void MemoryManager::CheckSystemMemory()
+{
+  UpdateBudget();
+
+  qint64 total, available;
+
+  if (GetSystemMemory(&total, &available) && available < total * kLowSystemMemory) {
+    lock_.lock();
+    qint64 usage = usage_;
+    lock_.unlock();
+
+    qWarning() << "System memory is low, freeing" << usage / 4 << "bytes of cached data";
+
+    // Free enough to make a difference even though we don't know who's using the rest of the system's memory
+    ReclaimBytes(usage / 4);
+  }
+}
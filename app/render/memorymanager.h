@@ -0,0 +1,151 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#ifndef MEMORYMANAGER_H
+#define MEMORYMANAGER_H
+
+#include <functional>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+
+/**
+ * @brief Keeps the memory held by caches and pools across the application within one budget
+ *
+ * Anything that holds onto memory it could give back (frame pools, texture caches, decoder caches, export buffers)
+ * registers itself as a consumer and reports what it allocates and frees. When the total goes over the budget set in
+ * the Config ("MemoryBudget", in GB, 0 for half of the system's memory), or the system itself is running out of
+ * memory, consumers are asked to free memory through their reclaim function, lowest priority first.
+ *
+ * Accounting functions can be called from any thread. Reclaim functions are always called on the main thread and
+ * must be thread-safe with respect to their consumer.
+ */
+class MemoryManager : public QObject
+{
+  Q_OBJECT
+public:
+  enum Priority {
+    /// Memory only kept for reuse, e.g. free frames or textures, asked first
+    kPriorityPool,
+
+    /// Caches that save work but can be rebuilt
+    kPriorityCache,
+
+    /// Data that's expensive to recreate, only asked once nothing else could free enough
+    kPriorityWorking
+  };
+
+  /**
+   * @brief Asks a consumer to free roughly `bytes`, returning how much it actually freed (or will free shortly)
+   */
+  using ReclaimFunction = std::function<qint64(qint64 bytes)>;
+
+  static void CreateInstance();
+
+  static void DestroyInstance();
+
+  static MemoryManager* instance();
+
+  /**
+   * @brief Register a consumer, the returned ID is used for all other calls
+   */
+  static int AddConsumer(const QString& name, Priority priority, const ReclaimFunction& reclaim);
+
+  /**
+   * @brief Unregister a consumer, waiting for its reclaim function to return if it's currently being called
+   */
+  static void RemoveConsumer(int id);
+
+  static void Allocated(int id, qint64 bytes);
+
+  static void Freed(int id, qint64 bytes);
+
+  static qint64 Usage();
+
+  static qint64 Budget();
+
+  /**
+   * @brief Returns whether consumers should avoid holding onto anything they don't need right now
+   */
+  static bool IsOverBudget();
+
+private:
+  MemoryManager();
+
+  struct Consumer {
+    QString name;
+    Priority priority;
+    ReclaimFunction reclaim;
+    qint64 usage;
+  };
+
+  /**
+   * @brief Read the budget from the Config, falling back to half of the system's memory
+   */
+  static void UpdateBudget();
+
+  /**
+   * @brief Ask consumers to free `bytes` in total, in order of priority
+   */
+  static void ReclaimBytes(qint64 bytes);
+
+  /**
+   * @brief Returns the physical memory of the system and how much of it is available, or false if unknown
+   */
+  static bool GetSystemMemory(qint64* total, qint64* available);
+
+  static MemoryManager* instance_;
+
+  static QMutex lock_;
+
+  static QMutex reclaim_lock_;
+
+  static QMap<int, Consumer> consumers_;
+
+  static int next_id_;
+
+  static qint64 usage_;
+
+  static qint64 budget_;
+
+  static bool reclaim_queued_;
+
+  /**
+   * @brief Reclaiming brings usage down to this fraction of the budget so it isn't triggered again immediately
+   */
+  static const double kReclaimTarget;
+
+  /**
+   * @brief System memory is considered low below this fraction of the total
+   */
+  static const double kLowSystemMemory;
+
+  static const int kPressureInterval;
+
+  QTimer pressure_timer_;
+
+private slots:
+  void Reclaim();
+
+  void CheckSystemMemory();
+
+};
+
+#endif // MEMORYMANAGER_H
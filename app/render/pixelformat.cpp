@@ -243,13 +243,21 @@ FramePtr PixelFormat::ConvertPixelFormat(FramePtr frame, const PixelFormat::Form
   converted->set_format(dest_format);
   converted->allocate();
 
-  OIIO::ImageBuf src(OIIO::ImageSpec(frame->width(), frame->height(), ChannelCount(frame->format()), GetOIIOTypeDesc(frame->format())), frame->data());
-  OIIO::ImageBuf dst(OIIO::ImageSpec(converted->width(), converted->height(), ChannelCount(converted->format()), GetOIIOTypeDesc(converted->format())), converted->data());
-
-  if (dst.copy_pixels(src)) {
+  if (ConvertPixels(frame->const_data(), frame->format(), converted->data(), dest_format, frame->width(), frame->height())) {
     return converted;
   } else {
     return nullptr;
   }
 }
 
+bool PixelFormat::ConvertPixels(const char *src, const PixelFormat::Format &src_format,
+                                char *dst, const PixelFormat::Format &dst_format,
+                                int width, int height)
+{
+  // OIIO won't write to the source buffer, it just doesn't take a const pointer
+  OIIO::ImageBuf src_buf(OIIO::ImageSpec(width, height, ChannelCount(src_format), GetOIIOTypeDesc(src_format)), const_cast<char*>(src));
+  OIIO::ImageBuf dst_buf(OIIO::ImageSpec(width, height, ChannelCount(dst_format), GetOIIOTypeDesc(dst_format)), dst);
+
+  return dst_buf.copy_pixels(src_buf);
+}
+
@@ -109,6 +109,15 @@ public:
    */
   static FramePtr ConvertPixelFormat(FramePtr frame, const Format &dest_format);
 
+  /**
+   * @brief Convert tightly packed rows of pixels from one pixel format to another into an existing buffer
+   *
+   * Unlike ConvertPixelFormat(), this allocates nothing, so it can be used to convert a frame in parts.
+   */
+  static bool ConvertPixels(const char* src, const Format& src_format,
+                            char* dst, const Format& dst_format,
+                            int width, int height);
+
   /**
    * @brief Simple convenience function returning whether a pixel format has an alpha channel or not
    */
@@ -0,0 +1,350 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "pixelpipeline.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QFloat16>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "common/define.h"
+
+const int PixelPipeline::kStripBytes = 131072;
+
+class PixelPipeline::Job
+{
+public:
+  const char* src;
+  PixelFormat::Format src_format;
+
+  char* dst;
+  PixelFormat::Format dst_format;
+
+  int width;
+  int height;
+
+  int rows_per_strip;
+  int strip_count;
+
+  AlphaOperation before_transform;
+  OCIO::ConstProcessorRcPtr processor;
+  AlphaOperation after_transform;
+
+  QAtomicInt next_strip;
+  QSemaphore strips_done;
+};
+
+class PixelPipeline::StripTask : public QRunnable
+{
+public:
+  StripTask(std::shared_ptr<Job> job) :
+    job_(job)
+  {
+  }
+
+  virtual void run() override
+  {
+    // If the caller got through every strip before we started, this returns straight away
+    PixelPipeline::ProcessStrips(job_.get());
+  }
+
+private:
+  std::shared_ptr<Job> job_;
+
+};
+
+namespace {
+
+// These loops are kept simple (contiguous, no branches in the body) so the compiler can vectorize them
+
+template<typename T>
+void UnpackStrip(const T* src, int channels, float scale, float* dst, int pixel_count)
+{
+  if (channels == kRGBAChannels) {
+    int value_count = pixel_count * kRGBAChannels;
+
+    for (int i=0;i<value_count;i++) {
+      dst[i] = static_cast<float>(src[i]) * scale;
+    }
+  } else {
+    for (int i=0;i<pixel_count;i++) {
+      dst[i*kRGBAChannels + 0] = static_cast<float>(src[i*kRGBChannels + 0]) * scale;
+      dst[i*kRGBAChannels + 1] = static_cast<float>(src[i*kRGBChannels + 1]) * scale;
+      dst[i*kRGBAChannels + 2] = static_cast<float>(src[i*kRGBChannels + 2]) * scale;
+      dst[i*kRGBAChannels + 3] = 1.0f;
+    }
+  }
+}
+
+template<typename T>
+T PackComponent(float value, float scale)
+{
+  Q_UNUSED(scale)
+  return static_cast<T>(value);
+}
+
+template<>
+uint8_t PackComponent<uint8_t>(float value, float scale)
+{
+  return static_cast<uint8_t>(qBound(0.0f, value * scale + 0.5f, scale));
+}
+
+template<>
+uint16_t PackComponent<uint16_t>(float value, float scale)
+{
+  return static_cast<uint16_t>(qBound(0.0f, value * scale + 0.5f, scale));
+}
+
+template<typename T>
+void PackStrip(const float* src, T* dst, int channels, float scale, int pixel_count)
+{
+  if (channels == kRGBAChannels) {
+    int value_count = pixel_count * kRGBAChannels;
+
+    for (int i=0;i<value_count;i++) {
+      dst[i] = PackComponent<T>(src[i], scale);
+    }
+  } else {
+    for (int i=0;i<pixel_count;i++) {
+      dst[i*kRGBChannels + 0] = PackComponent<T>(src[i*kRGBAChannels + 0], scale);
+      dst[i*kRGBChannels + 1] = PackComponent<T>(src[i*kRGBAChannels + 1], scale);
+      dst[i*kRGBChannels + 2] = PackComponent<T>(src[i*kRGBAChannels + 2], scale);
+    }
+  }
+}
+
+void Unpack(const char* src, PixelFormat::Format format, float* dst, int pixel_count)
+{
+  int channels = PixelFormat::ChannelCount(format);
+
+  switch (format) {
+  case PixelFormat::PIX_FMT_RGB8:
+  case PixelFormat::PIX_FMT_RGBA8:
+    UnpackStrip(reinterpret_cast<const uint8_t*>(src), channels, 1.0f / 255.0f, dst, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB16U:
+  case PixelFormat::PIX_FMT_RGBA16U:
+    UnpackStrip(reinterpret_cast<const uint16_t*>(src), channels, 1.0f / 65535.0f, dst, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB16F:
+  case PixelFormat::PIX_FMT_RGBA16F:
+    UnpackStrip(reinterpret_cast<const qfloat16*>(src), channels, 1.0f, dst, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB32F:
+  case PixelFormat::PIX_FMT_RGBA32F:
+    UnpackStrip(reinterpret_cast<const float*>(src), channels, 1.0f, dst, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_INVALID:
+  case PixelFormat::PIX_FMT_COUNT:
+    break;
+  }
+}
+
+void Pack(const float* src, char* dst, PixelFormat::Format format, int pixel_count)
+{
+  int channels = PixelFormat::ChannelCount(format);
+
+  switch (format) {
+  case PixelFormat::PIX_FMT_RGB8:
+  case PixelFormat::PIX_FMT_RGBA8:
+    PackStrip(src, reinterpret_cast<uint8_t*>(dst), channels, 255.0f, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB16U:
+  case PixelFormat::PIX_FMT_RGBA16U:
+    PackStrip(src, reinterpret_cast<uint16_t*>(dst), channels, 65535.0f, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB16F:
+  case PixelFormat::PIX_FMT_RGBA16F:
+    PackStrip(src, reinterpret_cast<qfloat16*>(dst), channels, 1.0f, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_RGB32F:
+  case PixelFormat::PIX_FMT_RGBA32F:
+    PackStrip(src, reinterpret_cast<float*>(dst), channels, 1.0f, pixel_count);
+    break;
+  case PixelFormat::PIX_FMT_INVALID:
+  case PixelFormat::PIX_FMT_COUNT:
+    break;
+  }
+}
+
+void ApplyAlpha(PixelPipeline::AlphaOperation operation, float* data, int pixel_count)
+{
+  switch (operation) {
+  case PixelPipeline::kAlphaNone:
+    break;
+  case PixelPipeline::kAlphaAssociate:
+    for (int i=0;i<pixel_count;i++) {
+      float* pixel = data + i*kRGBAChannels;
+      float multiplier = pixel[kRGBChannels];
+
+      pixel[0] *= multiplier;
+      pixel[1] *= multiplier;
+      pixel[2] *= multiplier;
+    }
+    break;
+  case PixelPipeline::kAlphaDisassociate:
+    for (int i=0;i<pixel_count;i++) {
+      float* pixel = data + i*kRGBAChannels;
+      float alpha = pixel[kRGBChannels];
+      float multiplier = (alpha > 0.0f) ? 1.0f / alpha : 1.0f;
+
+      pixel[0] *= multiplier;
+      pixel[1] *= multiplier;
+      pixel[2] *= multiplier;
+    }
+    break;
+  case PixelPipeline::kAlphaReassociate:
+    for (int i=0;i<pixel_count;i++) {
+      float* pixel = data + i*kRGBAChannels;
+      float alpha = pixel[kRGBChannels];
+      float multiplier = (alpha > 0.0f) ? alpha : 1.0f;
+
+      pixel[0] *= multiplier;
+      pixel[1] *= multiplier;
+      pixel[2] *= multiplier;
+    }
+    break;
+  }
+}
+
+}
+
+FramePtr PixelPipeline::Process(FramePtr frame,
+                                PixelFormat::Format dest_format,
+                                AlphaOperation before_transform,
+                                ColorProcessor *processor,
+                                AlphaOperation after_transform)
+{
+  if (frame->format() == PixelFormat::PIX_FMT_INVALID || dest_format == PixelFormat::PIX_FMT_INVALID) {
+    qWarning() << "Pixel pipeline received an invalid pixel format";
+    return nullptr;
+  }
+
+  FramePtr dest;
+
+  if (frame->format() == dest_format) {
+    if (before_transform == kAlphaNone && !processor && after_transform == kAlphaNone) {
+      // Nothing to do
+      return frame;
+    }
+
+    dest = frame;
+  } else {
+    dest = Frame::Create();
+    dest->set_width(frame->width());
+    dest->set_height(frame->height());
+    dest->set_timestamp(frame->timestamp());
+    dest->set_sample_aspect_ratio(frame->sample_aspect_ratio());
+    dest->set_format(dest_format);
+    dest->allocate();
+  }
+
+  if (frame->width() <= 0 || frame->height() <= 0) {
+    return dest;
+  }
+
+  std::shared_ptr<Job> job = std::make_shared<Job>();
+
+  job->src = frame->const_data();
+  job->src_format = static_cast<PixelFormat::Format>(frame->format());
+  job->dst = dest->data();
+  job->dst_format = dest_format;
+  job->width = frame->width();
+  job->height = frame->height();
+  job->rows_per_strip = qMax(1, kStripBytes / (job->width * kRGBAChannels * static_cast<int>(sizeof(float))));
+  job->strip_count = (job->height + job->rows_per_strip - 1) / job->rows_per_strip;
+  job->before_transform = before_transform;
+  job->processor = processor ? processor->GetProcessor() : nullptr;
+  job->after_transform = after_transform;
+
+  // The calling thread works too, so one less helper than there are strips
+  int helper_count = qMin(job->strip_count - 1, QThreadPool::globalInstance()->maxThreadCount());
+
+  for (int i=0;i<helper_count;i++) {
+    QThreadPool::globalInstance()->start(new StripTask(job));
+  }
+
+  ProcessStrips(job.get());
+
+  // Helpers that never got to start hold their own reference to the job, so we only need to wait for the strips
+  job->strips_done.acquire(job->strip_count);
+
+  return dest;
+}
+
+void PixelPipeline::ProcessStrips(Job *job)
+{
+  float* scratch = nullptr;
+
+  forever {
+    int strip = job->next_strip.fetchAndAddOrdered(1);
+
+    if (strip >= job->strip_count) {
+      break;
+    }
+
+    // RGBA32F destinations are worked on in place, anything else goes through a strip-sized buffer
+    if (!scratch && job->dst_format != PixelFormat::PIX_FMT_RGBA32F) {
+      scratch = new float[job->width * job->rows_per_strip * kRGBAChannels];
+    }
+
+    ProcessStrip(job, strip, scratch);
+  }
+
+  delete [] scratch;
+}
+
+void PixelPipeline::ProcessStrip(Job *job, int strip, float *scratch)
+{
+  int first_row = strip * job->rows_per_strip;
+  int row_count = qMin(job->rows_per_strip, job->height - first_row);
+  int pixel_count = job->width * row_count;
+
+  int src_stride = job->width * PixelFormat::ChannelCount(job->src_format) * PixelFormat::BytesPerChannel(job->src_format);
+  int dst_stride = job->width * PixelFormat::ChannelCount(job->dst_format) * PixelFormat::BytesPerChannel(job->dst_format);
+
+  const char* src = job->src + first_row * src_stride;
+  char* dst = job->dst + first_row * dst_stride;
+
+  float* work = scratch ? scratch : reinterpret_cast<float*>(dst);
+
+  // When working in place on an RGBA32F frame the data is already unpacked
+  if (reinterpret_cast<const char*>(work) != src) {
+    Unpack(src, job->src_format, work, pixel_count);
+  }
+
+  ApplyAlpha(job->before_transform, work, pixel_count);
+
+  if (job->processor) {
+    OCIO::PackedImageDesc img(work, job->width, row_count, kRGBAChannels);
+
+    job->processor->apply(img);
+  }
+
+  ApplyAlpha(job->after_transform, work, pixel_count);
+
+  if (scratch) {
+    Pack(work, dst, job->dst_format, pixel_count);
+  }
+
+  job->strips_done.release();
+}
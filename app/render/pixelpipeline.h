@@ -0,0 +1,84 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PIXELPIPELINE_H
+#define PIXELPIPELINE_H
+
+#include "codec/frame.h"
+#include "render/colorprocessor.h"
+#include "render/pixelformat.h"
+
+/**
+ * @brief Fused CPU path for pixel format conversion, alpha (dis)association and OCIO color transforms
+ *
+ * Doing each of these as its own full-frame pass (ConvertPixelFormat(), ColorManager::DisassociateAlpha(),
+ * ColorProcessor::ConvertFrame(), etc.) streams the whole frame through memory several times and allocates for each
+ * step. Instead, Process() splits the frame into strips of rows small enough to stay in cache and runs every stage on
+ * a strip before moving on to the next. Strips are spread over the global thread pool, with the calling thread working
+ * on them too.
+ *
+ * Internally each strip is unpacked to RGBA float, so alpha operations on formats without an alpha channel are no-ops
+ * and an RGB destination simply drops the alpha channel again when packing.
+ */
+class PixelPipeline
+{
+public:
+  enum AlphaOperation {
+    kAlphaNone,
+
+    /// Multiply color by alpha
+    kAlphaAssociate,
+
+    /// Divide color by alpha, skipping fully transparent pixels
+    kAlphaDisassociate,
+
+    /// Multiply color by alpha, skipping fully transparent pixels (i.e. undo kAlphaDisassociate)
+    kAlphaReassociate
+  };
+
+  /**
+   * @brief Convert `frame` to `dest_format`, applying alpha operations before and after the color transform
+   *
+   * `processor` may be nullptr to skip the color transform. If `frame` is already in `dest_format` it's processed
+   * in place and returned, otherwise a new frame is returned.
+   */
+  static FramePtr Process(FramePtr frame,
+                          PixelFormat::Format dest_format,
+                          AlphaOperation before_transform,
+                          ColorProcessor* processor,
+                          AlphaOperation after_transform);
+
+private:
+  class Job;
+
+  class StripTask;
+
+  static void ProcessStrips(Job* job);
+
+  static void ProcessStrip(Job* job, int strip, float* scratch);
+
+  /**
+   * @brief Size of a strip in bytes while it's being worked on, roughly half of a typical L2 cache
+   */
+  static const int kStripBytes;
+
+};
+
+#endif // PIXELPIPELINE_H
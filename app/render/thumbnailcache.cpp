@@ -0,0 +1,186 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "thumbnailcache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+
+#include "codec/decoder.h"
+#include "common/filefunctions.h"
+#include "common/timecodefunctions.h"
+
+ThumbnailCache* ThumbnailCache::instance_ = nullptr;
+const int ThumbnailCache::kThumbnailSize = 128;
+const int ThumbnailCache::kMemoryCacheSize = 32768;
+const int ThumbnailCache::kMaximumQueueSize = 64;
+
+ThumbnailCache::ThumbnailCache() :
+  AsyncImageCache(kMemoryCacheSize, kMaximumQueueSize, 1)
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+  Stop();
+}
+
+void ThumbnailCache::CreateInstance()
+{
+  instance_ = new ThumbnailCache();
+}
+
+void ThumbnailCache::DestroyInstance()
+{
+  delete instance_;
+  instance_ = nullptr;
+}
+
+ThumbnailCache *ThumbnailCache::instance()
+{
+  return instance_;
+}
+
+QPixmap ThumbnailCache::Get(Footage *footage)
+{
+  QString key = GetKey(footage);
+
+  if (key.isEmpty()) {
+    return QPixmap();
+  }
+
+  QPixmap* cached = Cached(key);
+
+  if (cached) {
+    return *cached;
+  }
+
+  foreach (StreamPtr s, footage->streams()) {
+    if (s->type() == Stream::kVideo || s->type() == Stream::kImage) {
+      Queue({key, footage->filename(), footage->decoder(), s, 0});
+      break;
+    }
+  }
+
+  return QPixmap();
+}
+
+QString ThumbnailCache::GetKey(Footage *footage)
+{
+  if (footage->status() == Footage::kUnprobed || footage->status() == Footage::kInvalid) {
+    return QString();
+  }
+
+  foreach (StreamPtr s, footage->streams()) {
+    if (s->type() == Stream::kVideo || s->type() == Stream::kImage) {
+      // Avoid touching the file system here since this is called while painting, the disk cache checks the file's
+      // actual modified time
+      QCryptographicHash hash(QCryptographicHash::Sha1);
+
+      hash.addData(footage->filename().toUtf8());
+      hash.addData(QByteArray::number(footage->timestamp().toMSecsSinceEpoch()));
+      hash.addData(QByteArray::number(s->index()));
+
+      return QString(hash.result().toHex());
+    }
+  }
+
+  return QString();
+}
+
+QString ThumbnailCache::GetDiskCacheFilename(const ThumbnailCache::Request &request)
+{
+  // Identifies the file by its path and modified time
+  QString file_id = GetUniqueFileIdentifier(request.filename);
+
+  if (file_id.isEmpty()) {
+    return QString();
+  }
+
+  return GetDiskCacheDirectory(QStringLiteral("thumbnails")).filePath(QStringLiteral("%1-%2.jpg").arg(file_id, QString::number(request.stream->index())));
+}
+
+QImage ThumbnailCache::LoadOrGenerate(const ThumbnailCache::Request &request)
+{
+  QString cache_filename = GetDiskCacheFilename(request);
+
+  if (cache_filename.isEmpty()) {
+    return QImage();
+  }
+
+  QImage image;
+
+  if (QFile::exists(cache_filename) && image.load(cache_filename)) {
+    return image;
+  }
+
+  DecoderPtr decoder = Decoder::CreateFromID(request.decoder);
+
+  if (!decoder) {
+    return QImage();
+  }
+
+  decoder->set_stream(request.stream);
+
+  if (!decoder->Open()) {
+    return QImage();
+  }
+
+  ImageStreamPtr image_stream = std::static_pointer_cast<ImageStream>(request.stream);
+
+  // Let the decoder scale down for us so we don't have to convert a full resolution frame
+  int divider = qMax(1, qMax(image_stream->width(), image_stream->height()) / kThumbnailSize);
+
+  rational poster_time;
+
+  if (request.stream->type() == Stream::kVideo) {
+    // A little way into the footage is more representative than the first frame, which is often black
+    poster_time = Timecode::timestamp_to_time(request.stream->duration() / 10, request.stream->timebase());
+  }
+
+  FramePtr frame = decoder->RetrieveKeyframe(poster_time, divider);
+
+  decoder->Close();
+
+  if (!frame) {
+    return QImage();
+  }
+
+  image = FrameToImage(frame).scaled(kThumbnailSize, kThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+  if (!image.isNull() && !image.save(cache_filename, "JPG")) {
+    qWarning() << "Failed to save thumbnail to" << cache_filename;
+  }
+
+  return image;
+}
+
+void ThumbnailCache::ProcessBatch(const QList<Request> &batch)
+{
+  foreach (const Request& r, batch) {
+    ImageGenerated(r.key, LoadOrGenerate(r));
+  }
+}
+
+void ThumbnailCache::ImageReady(const QString &key)
+{
+  emit ThumbnailReady(key);
+}
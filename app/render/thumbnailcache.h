@@ -0,0 +1,104 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include "project/item/footage/footage.h"
+#include "render/asyncimagecache.h"
+
+/**
+ * @brief Background generator and cache of poster frames for Footage
+ *
+ * Get() never blocks. If a thumbnail isn't in memory, it returns a null QPixmap and queues a request. Each request
+ * first checks the disk cache and otherwise decodes a low resolution keyframe (see Decoder::RetrieveKeyframe()) near
+ * the start of the footage. ThumbnailReady() is emitted on the main thread once the thumbnail can be retrieved with
+ * Get().
+ *
+ * Thumbnails are stored on disk keyed by the footage's filename, last modified time and stream index, so a changed
+ * file gets a new thumbnail.
+ */
+class ThumbnailCache : public AsyncImageCache
+{
+  Q_OBJECT
+public:
+  static void CreateInstance();
+
+  static void DestroyInstance();
+
+  static ThumbnailCache* instance();
+
+  /**
+   * @brief Retrieve a thumbnail for this footage, or a null QPixmap if it isn't available (yet)
+   *
+   * Must only be called from the main thread.
+   */
+  QPixmap Get(Footage* footage);
+
+  /**
+   * @brief Retrieve the key Get() uses for this footage, or an empty string if it has nothing to show a thumbnail of
+   */
+  static QString GetKey(Footage* footage);
+
+  /**
+   * @brief Maximum width and height of a thumbnail
+   */
+  static const int kThumbnailSize;
+
+signals:
+  /**
+   * @brief Emitted when a thumbnail that was requested through Get() is available
+   */
+  void ThumbnailReady(const QString& key);
+
+protected:
+  virtual void ProcessBatch(const QList<Request>& batch) override;
+
+  virtual void ImageReady(const QString& key) override;
+
+private:
+  ThumbnailCache();
+
+  virtual ~ThumbnailCache() override;
+
+  static ThumbnailCache* instance_;
+
+  /**
+   * @brief Load the thumbnail from disk or generate (and store) it
+   *
+   * Called from the worker pool.
+   */
+  static QImage LoadOrGenerate(const Request& request);
+
+  /**
+   * @brief Retrieve the disk cache filename for a request, or an empty string if the file doesn't exist
+   *
+   * Unlike GetKey(), this checks the file's actual modified time, so it's only called from the worker pool.
+   */
+  static QString GetDiskCacheFilename(const Request& request);
+
+  /// Memory cache size in kilobytes
+  static const int kMemoryCacheSize;
+
+  static const int kMaximumQueueSize;
+
+};
+
+#endif // THUMBNAILCACHE_H
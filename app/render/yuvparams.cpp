@@ -0,0 +1,115 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "yuvparams.h"
+
+const int YUVParams::kPlaneCount = 3;
+
+YUVParams::YUVParams() :
+  subsampling_(kChroma420),
+  bit_depth_(0)
+{
+}
+
+YUVParams::YUVParams(const YUVParams::ChromaSubsampling &subsampling, const int &bit_depth) :
+  subsampling_(subsampling),
+  bit_depth_(bit_depth)
+{
+}
+
+const YUVParams::ChromaSubsampling &YUVParams::subsampling() const
+{
+  return subsampling_;
+}
+
+const int &YUVParams::bit_depth() const
+{
+  return bit_depth_;
+}
+
+bool YUVParams::is_valid() const
+{
+  return bit_depth_ >= 8 && bit_depth_ <= 16;
+}
+
+int YUVParams::horizontal_subsampling() const
+{
+  return (subsampling_ == kChroma444) ? 1 : 2;
+}
+
+int YUVParams::vertical_subsampling() const
+{
+  return (subsampling_ == kChroma420) ? 2 : 1;
+}
+
+int YUVParams::bytes_per_sample() const
+{
+  return (bit_depth_ > 8) ? 2 : 1;
+}
+
+int YUVParams::plane_width(int plane, int width) const
+{
+  if (plane == 0) {
+    return width;
+  }
+
+  // Round up so odd sizes still have a chroma sample covering the last column
+  return (width + horizontal_subsampling() - 1) / horizontal_subsampling();
+}
+
+int YUVParams::plane_height(int plane, int height) const
+{
+  if (plane == 0) {
+    return height;
+  }
+
+  return (height + vertical_subsampling() - 1) / vertical_subsampling();
+}
+
+int YUVParams::plane_linesize(int plane, int width) const
+{
+  return plane_width(plane, width) * bytes_per_sample();
+}
+
+int YUVParams::plane_offset(int plane, int width, int height) const
+{
+  int offset = 0;
+
+  for (int i=0;i<plane;i++) {
+    offset += plane_linesize(i, width) * plane_height(i, height);
+  }
+
+  return offset;
+}
+
+int YUVParams::GetBufferSize(int width, int height) const
+{
+  return plane_offset(kPlaneCount, width, height);
+}
+
+bool YUVParams::operator==(const YUVParams &other) const
+{
+  return subsampling_ == other.subsampling_ && bit_depth_ == other.bit_depth_;
+}
+
+bool YUVParams::operator!=(const YUVParams &other) const
+{
+  return !(*this == other);
+}
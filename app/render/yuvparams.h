@@ -0,0 +1,85 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2019 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef YUVPARAMS_H
+#define YUVPARAMS_H
+
+#include <QMetaType>
+
+/**
+ * @brief Describes a planar Y'CbCr buffer that frames can be converted to before they're handed to an encoder
+ *
+ * Planes are stored contiguously in Y, Cb, Cr order and tightly packed (each line is exactly as long as the plane is
+ * wide). Samples deeper than 8 bits are stored as native-endian 16-bit integers, right-aligned (e.g. 10-bit values range
+ * from 0 to 1023), which matches FFmpeg's *P10LE formats on little-endian hosts.
+ */
+class YUVParams {
+public:
+  enum ChromaSubsampling {
+    kChroma420,
+    kChroma422,
+    kChroma444
+  };
+
+  YUVParams();
+  YUVParams(const ChromaSubsampling& subsampling, const int& bit_depth);
+
+  const ChromaSubsampling& subsampling() const;
+  const int& bit_depth() const;
+
+  bool is_valid() const;
+
+  /**
+   * @brief How many luma pixels are averaged into one chroma sample horizontally
+   */
+  int horizontal_subsampling() const;
+
+  /**
+   * @brief How many luma pixels are averaged into one chroma sample vertically
+   */
+  int vertical_subsampling() const;
+
+  int bytes_per_sample() const;
+
+  int plane_width(int plane, int width) const;
+  int plane_height(int plane, int height) const;
+  int plane_linesize(int plane, int width) const;
+  int plane_offset(int plane, int width, int height) const;
+
+  /**
+   * @brief Size in bytes of all three planes of a frame at this resolution
+   */
+  int GetBufferSize(int width, int height) const;
+
+  bool operator==(const YUVParams& other) const;
+  bool operator!=(const YUVParams& other) const;
+
+  static const int kPlaneCount;
+
+private:
+  ChromaSubsampling subsampling_;
+
+  int bit_depth_;
+
+};
+
+Q_DECLARE_METATYPE(YUVParams)
+
+#endif // YUVPARAMS_H
@@ -1,6 +1,7 @@
 #include "undocommand.h"
 
 #include "core.h"
+#include "node/output/track/track.h"
 
 UndoCommand::UndoCommand(QUndoCommand *parent) :
   QUndoCommand(parent)
@@ -9,15 +10,26 @@ UndoCommand::UndoCommand(QUndoCommand *parent) :
 
 void UndoCommand::redo()
 {
-  redo_internal();
-
+  // Stored before redoing so that a command with UndoCommand children restores the state from before any of them ran
   modified_ = Core::instance()->IsProjectModified();
+
+  {
+    // Child commands open their own transactions, only the outermost one notifies anything
+    TrackOutput::EditTransaction transaction;
+
+    redo_internal();
+  }
+
   Core::instance()->SetProjectModified(true);
 }
 
 void UndoCommand::undo()
 {
-  undo_internal();
+  {
+    TrackOutput::EditTransaction transaction;
+
+    undo_internal();
+  }
 
   Core::instance()->SetProjectModified(modified_);
 }
@@ -21,11 +21,17 @@
 #include "nodeview.h"
 
 #include <QMouseEvent>
+#include <QSet>
 
+#include "common/clamp.h"
+#include "config/config.h"
 #include "core.h"
 #include "nodeviewundo.h"
 #include "node/factory.h"
 
+const double NodeView::kMinimumScale = 0.1;
+const double NodeView::kMaximumScale = 4.0;
+
 NodeView::NodeView(QWidget *parent) :
   QGraphicsView(parent),
   graph_(nullptr),
@@ -35,8 +41,8 @@ NodeView::NodeView(QWidget *parent) :
   setScene(&scene_);
   setDragMode(RubberBandDrag);
   setContextMenuPolicy(Qt::CustomContextMenu);
+  setTransformationAnchor(AnchorUnderMouse);
 
-  connect(&scene_, &QGraphicsScene::changed, this, &NodeView::ItemsChanged);
   connect(&scene_, &QGraphicsScene::selectionChanged, this, &NodeView::SceneSelectionChangedSlot);
   connect(this, &NodeView::customContextMenuRequested, this, &NodeView::ShowContextMenu);
 
@@ -128,6 +134,9 @@ void NodeView::DeselectAll()
 
 void NodeView::Select(const QList<Node *> &nodes)
 {
+  // Signal the new selection once rather than once for every item that changes
+  scene_.blockSignals(true);
+
   DeselectAll();
 
   foreach (Node* n, nodes) {
@@ -138,25 +147,35 @@ void NodeView::Select(const QList<Node *> &nodes)
 
     item->setSelected(true);
   }
+
+  scene_.blockSignals(false);
+
+  SceneSelectionChangedSlot();
 }
 
 void NodeView::SelectWithDependencies(QList<Node *> nodes)
 {
-  int original_length = nodes.size();
-  for (int i=0;i<original_length;i++) {
-    nodes.append(nodes.at(i)->GetDependencies());
-  }
+  QSet<Node*> found_nodes;
+  QList<Node*> select_nodes;
 
-  Select(nodes);
-}
+  foreach (Node* n, nodes) {
+    if (found_nodes.contains(n)) {
+      // Already found as a dependency of another node, which means its dependencies have been found too
+      continue;
+    }
 
-void NodeView::ItemsChanged()
-{
-  QHash<NodeEdge *, NodeViewEdge *>::const_iterator i;
+    found_nodes.insert(n);
+    select_nodes.append(n);
 
-  for (i=scene_.edge_map().begin();i!=scene_.edge_map().end();i++) {
-    i.value()->Adjust();
+    foreach (Node* dep, n->GetDependencies()) {
+      if (!found_nodes.contains(dep)) {
+        found_nodes.insert(dep);
+        select_nodes.append(dep);
+      }
+    }
   }
+
+  Select(select_nodes);
 }
 
 void NodeView::keyPressEvent(QKeyEvent *event)
@@ -261,6 +280,23 @@ void NodeView::mouseMoveEvent(QMouseEvent *event)
   }
 }
 
+void NodeView::wheelEvent(QWheelEvent *event)
+{
+  // Same as the timeline, CTRL zooms unless the user has swapped that behavior
+  if (static_cast<bool>(event->modifiers() & Qt::ControlModifier) == !Config::Current()["ScrollZooms"].toBool()) {
+    if (event->delta() != 0) {
+      double current_scale = transform().m11();
+      double new_scale = clamp(current_scale * (event->delta() > 0 ? 1.25 : 0.8), kMinimumScale, kMaximumScale);
+
+      scale(new_scale / current_scale, new_scale / current_scale);
+    }
+
+    return;
+  }
+
+  QGraphicsView::wheelEvent(event);
+}
+
 void NodeView::SceneSelectionChangedSlot()
 {
   // Get the scene's selected items and convert it into a list of selected nodes
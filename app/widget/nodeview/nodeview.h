@@ -70,6 +70,8 @@ protected:
 
   virtual void mouseMoveEvent(QMouseEvent *event) override;
 
+  virtual void wheelEvent(QWheelEvent* event) override;
+
 private:
   void PlaceNode(NodeViewItem* n, const QPointF& pos);
 
@@ -86,14 +88,10 @@ private:
 
   NodeViewScene scene_;
 
-private slots:
-  /**
-   * @brief Internal function triggered when any change is signalled from the QGraphicsScene
-   *
-   * Current primary function is to inform all NodeViewEdges to re-adjust in case any Nodes have moved
-   */
-  void ItemsChanged();
+  static const double kMinimumScale;
+  static const double kMaximumScale;
 
+private slots:
   /**
    * @brief Receiver for when the scene's selected items change
    */
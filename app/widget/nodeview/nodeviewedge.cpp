@@ -23,6 +23,8 @@
 #include <QApplication>
 #include <QDebug>
 #include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 #include "common/clamp.h"
 #include "common/lerp.h"
@@ -126,6 +128,14 @@ void NodeViewEdge::SetHighlighted(bool e)
 
 void NodeViewEdge::SetPoints(const QPointF &start, const QPointF &end)
 {
+  if (start == start_ && end == end_ && !path().isEmpty()) {
+    return;
+  }
+
+  start_ = start;
+  end_ = end;
+  shape_ = QPainterPath();
+
   QPainterPath path;
   double half_x = lerp(start.x(), end.x(), 0.5);
   path.moveTo(start);
@@ -133,9 +143,33 @@ void NodeViewEdge::SetPoints(const QPointF &start, const QPointF &end)
   setPath(path);
 }
 
+QPainterPath NodeViewEdge::shape() const
+{
+  if (shape_.isEmpty() && !path().isEmpty()) {
+    shape_ = QGraphicsPathItem::shape();
+  }
+
+  return shape_;
+}
+
+void NodeViewEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+  if (option->levelOfDetailFromTransform(painter->worldTransform()) < NodeViewItem::kLowDetailScale) {
+    // Zoomed out too far for the curve to be made out, a thin straight line is much cheaper to draw
+    QPen thin_pen = pen();
+    thin_pen.setWidth(0);
+
+    painter->setPen(thin_pen);
+    painter->drawLine(start_, end_);
+  } else {
+    QGraphicsPathItem::paint(painter, option, widget);
+  }
+}
+
 void NodeViewEdge::UpdatePen()
 {
   setPen(QPen(qApp->palette().color(color_group_, color_role_), edge_width_));
+  shape_ = QPainterPath();
 
   //update();
 }
@@ -52,8 +52,8 @@ public:
    * that this edge connects. It uses their positions to determine where the line should visually connect and sets
    * it accordingly.
    *
-   * This should be set any time the NodeEdge changes (see SetEdge()), and any time the nodes move in the NodeGraph
-   * (see NodeView::ItemsChanged()). This will keep the nodes visually connected at all times.
+   * This should be set any time the NodeEdge changes (see SetEdge()), and any time either node moves or changes size
+   * (see NodeViewScene::AdjustNodeEdges()). This will keep the nodes visually connected at all times.
    */
   void Adjust();
 
@@ -81,6 +81,11 @@ public:
    */
   void SetPoints(const QPointF& start, const QPointF& end);
 
+  virtual QPainterPath shape() const override;
+
+protected:
+  virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
 private:
   void UpdatePen();
 
@@ -92,6 +97,19 @@ private:
 
   QPalette::ColorRole color_role_;
 
+  /// Points the current path was created from, the path is only rebuilt if these change
+  QPointF start_;
+  QPointF end_;
+
+  /**
+   * @brief Cached hit test shape
+   *
+   * QGraphicsPathItem strokes its path every time shape() is called, which gets expensive with many edges, so we only
+   * do it when the path or pen changes.
+   */
+  mutable QPainterPath shape_;
+
+
 };
 
 #endif // NODEEDGEITEM_H
@@ -34,6 +34,8 @@
 #include "ui/icons/icons.h"
 #include "window/mainwindow/mainwindow.h"
 
+const double NodeViewItem::kLowDetailScale = 0.5;
+
 NodeViewItem::NodeViewItem(QGraphicsItem *parent) :
   QGraphicsRectItem(parent),
   node_(nullptr),
@@ -124,6 +126,11 @@ void NodeViewItem::SetExpanded(bool e)
   update();
 
   setRect(new_rect);
+
+  // Connectors have moved
+  if (scene()) {
+    static_cast<NodeViewScene*>(scene())->AdjustNodeEdges(node_);
+  }
 }
 
 void NodeViewItem::ToggleExpanded()
@@ -199,6 +206,19 @@ void NodeViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 
   painter->setPen(border_pen);
 
+  if (option->levelOfDetailFromTransform(painter->worldTransform()) < kLowDetailScale) {
+    // Too small to read, just draw a box
+    painter->setBrush(css_proxy_.TitleBarColor());
+
+    if (option->state & QStyle::State_Selected) {
+      border_pen.setColor(app_pal.color(QPalette::Highlight));
+      painter->setPen(border_pen);
+    }
+
+    painter->drawRect(rect());
+    return;
+  }
+
   if (expanded_ && node_ != nullptr) {
 
     // Use main widget color for node contents
@@ -505,6 +525,11 @@ QVariant NodeViewItem::itemChange(QGraphicsItem::GraphicsItemChange change, cons
 {
   if (change == ItemPositionHasChanged && node_) {
     node_->SetPosition(value.toPointF());
+
+    // Only this node's edges need to follow it
+    if (scene()) {
+      static_cast<NodeViewScene*>(scene())->AdjustNodeEdges(node_);
+    }
   }
 
   return QGraphicsItem::itemChange(change, value);
@@ -77,6 +77,14 @@ public:
   QRectF GetParameterConnectorRect(int index);
   QRectF GetParameterConnectorRect(NodeParam* index);
 
+  /**
+   * @brief View scale below which nodes and edges are drawn without detail
+   *
+   * Nodes are drawn as plain boxes with no text or parameters and edges as thin straight lines. At this point text
+   * isn't legible anyway and it keeps panning large graphs fast when zoomed out.
+   */
+  static const double kLowDetailScale;
+
 protected:
   virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
 
@@ -25,6 +25,8 @@ void NodeViewScene::clear()
     }
     edge_map_.clear();
   }
+
+  node_edge_map_.clear();
 }
 
 NodeViewItem *NodeViewScene::NodeToUIObject(Node *n)
@@ -52,6 +54,13 @@ const QHash<NodeEdge *, NodeViewEdge *> &NodeViewScene::edge_map() const
   return edge_map_;
 }
 
+void NodeViewScene::AdjustNodeEdges(Node *n)
+{
+  foreach (NodeViewEdge* edge, node_edge_map_.value(n)) {
+    edge->Adjust();
+  }
+}
+
 void NodeViewScene::AddNode(Node* node)
 {
   NodeViewItem* item = new NodeViewItem();
@@ -75,12 +84,17 @@ void NodeViewScene::AddNode(Node* node)
     }
   }
 
+  // Edges from nodes that were added before this one couldn't be positioned until now
+  AdjustNodeEdges(node);
+
   QueueReorganize();
 }
 
 void NodeViewScene::RemoveNode(Node *node)
 {
   delete item_map_.take(node);
+
+  node_edge_map_.remove(node);
 }
 
 void NodeViewScene::AddEdge(NodeEdgePtr edge)
@@ -92,12 +106,37 @@ void NodeViewScene::AddEdge(NodeEdgePtr edge)
   addItem(edge_ui);
   edge_map_.insert(edge.get(), edge_ui);
 
+  node_edge_map_[edge->output()->parentNode()].append(edge_ui);
+  node_edge_map_[edge->input()->parentNode()].append(edge_ui);
+
+  // SetEdge() couldn't position the edge before it was in the scene
+  edge_ui->Adjust();
+
   QueueReorganize();
 }
 
 void NodeViewScene::RemoveEdge(NodeEdgePtr edge)
 {
-  delete edge_map_.take(edge.get());
+  NodeViewEdge* edge_ui = edge_map_.take(edge.get());
+
+  if (!edge_ui) {
+    return;
+  }
+
+  // Either node may have already been removed from the scene
+  QHash<Node*, QVector<NodeViewEdge*> >::iterator i = node_edge_map_.find(edge->output()->parentNode());
+
+  if (i != node_edge_map_.end()) {
+    i.value().removeOne(edge_ui);
+  }
+
+  i = node_edge_map_.find(edge->input()->parentNode());
+
+  if (i != node_edge_map_.end()) {
+    i.value().removeOne(edge_ui);
+  }
+
+  delete edge_ui;
 }
 
 void NodeViewScene::QueueReorganize()
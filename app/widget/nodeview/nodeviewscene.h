@@ -41,6 +41,11 @@ public:
   const QHash<Node*, NodeViewItem*>& item_map() const;
   const QHash<NodeEdge*, NodeViewEdge*>& edge_map() const;
 
+  /**
+   * @brief Re-adjust the edges connected to a node, used when the node's item has moved or changed size
+   */
+  void AdjustNodeEdges(Node* n);
+
 public slots:
   /**
    * @brief Slot when a Node is added to a graph (SetGraph() connects this)
@@ -87,6 +92,11 @@ private:
 
   QHash<NodeEdge*, NodeViewEdge*> edge_map_;
 
+  /**
+   * @brief Edge items connected to each node so moving a node doesn't require adjusting every edge in the graph
+   */
+  QHash<Node*, QVector<NodeViewEdge*> > node_edge_map_;
+
   QTimer reorganize_timer_;
 
   NodeGraph* graph_;
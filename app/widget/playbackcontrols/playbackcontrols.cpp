@@ -52,6 +52,13 @@ PlaybackControls::PlaybackControls(QWidget *parent) :
   cur_tc_lbl_ = new TimeSlider();
   connect(cur_tc_lbl_, &TimeSlider::ValueChanged, this, &PlaybackControls::TimeChanged);
   lower_left_layout->addWidget(cur_tc_lbl_);
+
+  // Frames dropped or late since playback last started, kept after pausing so they can still be read
+  frame_stats_lbl_ = new QLabel();
+  frame_stats_lbl_->setVisible(false);
+  frame_stats_lbl_->setContentsMargins(fontMetrics().height(), 0, 0, 0);
+  lower_left_layout->addWidget(frame_stats_lbl_);
+
   lower_left_layout->addStretch();
 
   // In the lower-middle, we create playback control buttons
@@ -136,6 +143,12 @@ void PlaybackControls::SetTimebase(const rational &r)
   cur_tc_lbl_->setEnabled(!r.isNull());
 }
 
+void PlaybackControls::SetFrameStatistics(int dropped, int late)
+{
+  frame_stats_lbl_->setVisible(dropped > 0 || late > 0);
+  frame_stats_lbl_->setText(tr("%1 dropped, %2 late").arg(QString::number(dropped), QString::number(late)));
+}
+
 void PlaybackControls::SetTime(const int64_t &r)
 {
   cur_tc_lbl_->SetValue(r);
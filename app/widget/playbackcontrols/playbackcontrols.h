@@ -47,6 +47,11 @@ public:
 
   void SetTimebase(const rational& r);
 
+  /**
+   * @brief Show how many frames were dropped or late during playback, hidden while both are zero
+   */
+  void SetFrameStatistics(int dropped, int late);
+
 public slots:
   void SetTime(const int64_t &r);
 
@@ -99,6 +104,7 @@ private:
   QWidget* lower_right_container_;
 
   TimeSlider* cur_tc_lbl_;
+  QLabel* frame_stats_lbl_;
   QLabel* end_tc_lbl_;
 
   rational time_base_;
@@ -1,5 +1,6 @@
 #include "timelinewidget.h"
 
+#include <QSet>
 #include <QSplitter>
 #include <QVBoxLayout>
 #include <QtMath>
@@ -16,7 +17,8 @@
 TimelineWidget::TimelineWidget(QWidget *parent) :
   TimeBasedWidget(true, true, parent),
   rubberband_(QRubberBand::Rectangle, this),
-  active_tool_(nullptr)
+  active_tool_(nullptr),
+  visible_items_update_queued_(false)
 {
   QVBoxLayout* vert_layout = new QVBoxLayout(this);
   vert_layout->setSpacing(0);
@@ -100,6 +102,12 @@ TimelineWidget::TimelineWidget(QWidget *parent) :
     connect(view, &TimelineView::DragDropped, this, &TimelineWidget::ViewDragDropped);
     connect(view, &TimelineView::SelectionChanged, this, &TimelineWidget::ViewSelectionChanged);
 
+    // Scrolling or resizing changes which blocks need items
+    connect(view->horizontalScrollBar(), &QScrollBar::valueChanged, this, &TimelineWidget::QueueVisibleItemsUpdate);
+    connect(view->horizontalScrollBar(), &QScrollBar::rangeChanged, this, &TimelineWidget::QueueVisibleItemsUpdate);
+    connect(view->verticalScrollBar(), &QScrollBar::valueChanged, this, &TimelineWidget::QueueVisibleItemsUpdate);
+    connect(view->verticalScrollBar(), &QScrollBar::rangeChanged, this, &TimelineWidget::QueueVisibleItemsUpdate);
+
     connect(tview->splitter(), &QSplitter::splitterMoved, this, &TimelineWidget::UpdateHorizontalSplitters);
 
     // Connect each view's scroll to each other
@@ -196,6 +204,8 @@ void TimelineWidget::ScaleChangedEvent(const double &scale)
   foreach (TimelineAndTrackView* view, views_) {
     view->view()->SetScale(scale);
   }
+
+  QueueVisibleItemsUpdate();
 }
 
 void TimelineWidget::ConnectNodeInternal(ViewerOutput *n)
@@ -240,6 +250,12 @@ void TimelineWidget::DisconnectNodeInternal(ViewerOutput *n)
 
   SetTimebase(0);
 
+  for (int i=0;i<views_.size();i++) {
+    foreach (TrackOutput* track, n->track_list(static_cast<Timeline::TrackType>(i))->Tracks()) {
+      disconnect(track, &TrackOutput::BlocksMoved, this, &TimelineWidget::TrackBlocksMoved);
+    }
+  }
+
   Clear();
 
   for (int i=0;i<views_.size();i++) {
@@ -250,9 +266,31 @@ void TimelineWidget::DisconnectNodeInternal(ViewerOutput *n)
 
 void TimelineWidget::SelectAll()
 {
+  if (!GetConnectedNode()) {
+    return;
+  }
+
+  // Selected blocks always have items so this creates one for every block, hold off the selection signal until
+  // they're all done rather than sending one per block
+  foreach (TimelineAndTrackView* view, views_) {
+    view->view()->scene()->blockSignals(true);
+  }
+
+  foreach (TrackOutput* track, GetConnectedNode()->Tracks()) {
+    foreach (Block* block, track->Blocks()) {
+      TimelineViewBlockItem* item = block ? GetOrCreateBlockItem(block) : nullptr;
+
+      if (item) {
+        item->setSelected(true);
+      }
+    }
+  }
+
   foreach (TimelineAndTrackView* view, views_) {
-    view->view()->SelectAll();
+    view->view()->scene()->blockSignals(false);
   }
+
+  ViewSelectionChanged();
 }
 
 void TimelineWidget::DeselectAll()
@@ -406,7 +444,7 @@ void TimelineWidget::DeleteSelected(bool ripple)
     return;
   }
 
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   // Replace blocks with gaps (effectively deleting them)
   DeleteSelectedInternal(blocks_to_delete, true, true, command);
@@ -512,7 +550,7 @@ void TimelineWidget::RippleEditTo(Timeline::MovementMode mode, bool insert_gaps)
     }
   }
 
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   if (closest_point_to_playhead == playhead_time) {
     // Remove one frame only
@@ -666,29 +704,21 @@ void TimelineWidget::ViewDragDropped(TimelineViewMouseEvent *event)
 
 void TimelineWidget::AddBlock(Block *block, TrackReference track)
 {
+  Q_UNUSED(track)
+
   switch (block->type()) {
   case Block::kClip:
   case Block::kTransition:
   case Block::kGap:
   {
-    // Set up clip with view parameters (clip item will automatically size its rect accordingly)
-    TimelineViewBlockItem* item = new TimelineViewBlockItem(block);
-
-    item->SetYCoords(GetTrackY(track), GetTrackHeight(track));
-    item->SetScale(GetScale());
-    item->SetTrack(track);
-
-    // Add to list of clip items that can be iterated through
-    block_items_.insert(block, item);
-
-    // Add item to graphics scene
-    views_.at(track.type())->view()->scene()->addItem(item);
-
+    // Items are created once the block is in view (see UpdateVisibleItems())
     connect(block, &Block::Refreshed, this, &TimelineWidget::BlockChanged);
 
     if (block->type() == Block::kClip) {
       connect(static_cast<ClipBlock*>(block), &ClipBlock::PreviewUpdated, this, &TimelineWidget::PreviewUpdated);
     }
+
+    QueueVisibleItemsUpdate();
     break;
   }
   }
@@ -696,13 +726,19 @@ void TimelineWidget::AddBlock(Block *block, TrackReference track)
 
 void TimelineWidget::RemoveBlock(Block *block)
 {
-  delete block_items_[block];
+  disconnect(block, &Block::Refreshed, this, &TimelineWidget::BlockChanged);
+
+  if (block->type() == Block::kClip) {
+    disconnect(static_cast<ClipBlock*>(block), &ClipBlock::PreviewUpdated, this, &TimelineWidget::PreviewUpdated);
+  }
 
-  block_items_.remove(block);
+  delete block_items_.take(block);
 }
 
 void TimelineWidget::AddTrack(TrackOutput *track, Timeline::TrackType type)
 {
+  connect(track, &TrackOutput::BlocksMoved, this, &TimelineWidget::TrackBlocksMoved);
+
   foreach (Block* b, track->Blocks()) {
     AddBlock(b, TrackReference(type, track->Index()));
   }
@@ -710,6 +746,8 @@ void TimelineWidget::AddTrack(TrackOutput *track, Timeline::TrackType type)
 
 void TimelineWidget::RemoveTrack(TrackOutput *track)
 {
+  disconnect(track, &TrackOutput::BlocksMoved, this, &TimelineWidget::TrackBlocksMoved);
+
   foreach (Block* b, track->Blocks()) {
     RemoveBlock(b);
   }
@@ -717,6 +755,9 @@ void TimelineWidget::RemoveTrack(TrackOutput *track)
 
 void TimelineWidget::ViewSelectionChanged()
 {
+  // Deselected items that are out of view can be deleted now
+  QueueVisibleItemsUpdate();
+
   if (rubberband_.isVisible()) {
     return;
   }
@@ -738,6 +779,19 @@ void TimelineWidget::BlockChanged()
   if (rect) {
     rect->UpdateRect();
   }
+
+  // The block may have moved into or out of view
+  QueueVisibleItemsUpdate();
+}
+
+void TimelineWidget::TrackBlocksMoved()
+{
+  // Only blocks near the view have items, so this stays cheap no matter how many blocks moved
+  foreach (TimelineViewBlockItem* item, block_items_) {
+    item->UpdateRect();
+  }
+
+  QueueVisibleItemsUpdate();
 }
 
 void TimelineWidget::PreviewUpdated()
@@ -787,6 +841,8 @@ void TimelineWidget::TrackHeightChanged(Timeline::TrackType type, int index, int
                              view->GetTrackHeight(block_item->Track().index()));
     }
   }
+
+  QueueVisibleItemsUpdate();
 }
 
 void TimelineWidget::ShowContextMenu()
@@ -828,6 +884,111 @@ void TimelineWidget::DeferredScrollAction()
   scrollbar()->setValue(deferred_scroll_value_);
 }
 
+void TimelineWidget::UpdateVisibleItems()
+{
+  visible_items_update_queued_ = false;
+
+  if (!GetConnectedNode()) {
+    return;
+  }
+
+  QSet<Block*> visible_blocks;
+
+  foreach (TimelineAndTrackView* tview, views_) {
+    TimelineView* view = tview->view();
+
+    QRectF visible_rect = view->mapToScene(view->viewport()->rect()).boundingRect();
+
+    // Keep items either side of the view so scrolling doesn't reveal empty space before this catches up
+    qreal margin = visible_rect.width() * 0.5;
+    visible_rect.adjust(-margin, 0, margin, 0);
+
+    foreach (Block* block, view->GetBlocksInSceneRect(visible_rect)) {
+      // Blocks too narrow for an item are drawn by the view itself
+      if (block->length().toDouble() * GetScale() >= TimelineViewBlockItem::kMinimumWidth
+          && GetOrCreateBlockItem(block)) {
+        visible_blocks.insert(block);
+      }
+    }
+
+    view->viewport()->update();
+  }
+
+  if (active_tool_ || rubberband_.isVisible()) {
+    // Tools may be holding onto items so we'll clean up once they're done
+    return;
+  }
+
+  QMap<Block*, TimelineViewBlockItem*>::iterator iterator = block_items_.begin();
+
+  while (iterator != block_items_.end()) {
+    TimelineViewBlockItem* item = iterator.value();
+
+    if (visible_blocks.contains(iterator.key()) || item->isSelected()) {
+      iterator++;
+    } else {
+      iterator = block_items_.erase(iterator);
+
+      delete item;
+    }
+  }
+}
+
+TimelineViewBlockItem *TimelineWidget::GetOrCreateBlockItem(Block *block)
+{
+  TimelineViewBlockItem* item = block_items_.value(block);
+
+  if (item) {
+    return item;
+  }
+
+  if (block->type() != Block::kClip
+      && block->type() != Block::kTransition
+      && block->type() != Block::kGap) {
+    return nullptr;
+  }
+
+  TrackOutput* track_output = TrackOutput::TrackFromBlock(block);
+
+  if (!track_output) {
+    return nullptr;
+  }
+
+  TrackReference track(track_output->track_type(), track_output->Index());
+
+  // Set up clip with view parameters (clip item will automatically size its rect accordingly)
+  item = new TimelineViewBlockItem(block);
+
+  item->SetYCoords(GetTrackY(track), GetTrackHeight(track));
+  item->SetScale(GetScale());
+  item->SetTrack(track);
+
+  block_items_.insert(block, item);
+
+  // Add item to graphics scene
+  views_.at(track.type())->view()->scene()->addItem(item);
+
+  return item;
+}
+
+bool TimelineWidget::IsBlockSelected(Block *block) const
+{
+  // Selected blocks always have items so there's no need to create one here
+  TimelineViewBlockItem* item = block_items_.value(block);
+
+  return item && item->isSelected();
+}
+
+void TimelineWidget::QueueVisibleItemsUpdate()
+{
+  if (!visible_items_update_queued_) {
+    // Many blocks tend to change at once (e.g. a ripple refreshes every block after it) so do one update afterwards
+    visible_items_update_queued_ = true;
+
+    QMetaObject::invokeMethod(this, "UpdateVisibleItems", Qt::QueuedConnection);
+  }
+}
+
 void TimelineWidget::AddGhost(TimelineViewGhostItem *ghost)
 {
   ghost->SetScale(GetScale());
@@ -840,7 +1001,10 @@ void TimelineWidget::SetBlockLinksSelected(Block* block, bool selected)
   TimelineViewBlockItem* link_item;
 
   foreach (Block* link, block->linked_clips()) {
-    if ((link_item = block_items_[link]) != nullptr) {
+    // Links may be out of view, in which case they only need an item if they're getting selected
+    link_item = selected ? GetOrCreateBlockItem(link) : block_items_.value(link);
+
+    if (link_item) {
       link_item->setSelected(selected);
     }
   }
@@ -873,10 +1037,20 @@ void TimelineWidget::MoveRubberBandSelect(bool enable_selecting, bool select_lin
     QRect mapped_rect(view->viewport()->mapFromGlobal(drag_origin_),
                       view->viewport()->mapFromGlobal(rubberband_now));
 
-    // Normalize and get items in rect
-    QList<QGraphicsItem*> rubberband_items = view->items(mapped_rect.normalized());
+    // Find blocks rather than items since blocks that are narrow or out of view may not have items yet
+    QRectF scene_rect = view->mapToScene(mapped_rect.normalized()).boundingRect();
+
+    foreach (Block* block, view->GetBlocksInSceneRect(scene_rect)) {
+      if (block->type() == Block::kGap) {
+        continue;
+      }
+
+      TimelineViewBlockItem* item = GetOrCreateBlockItem(block);
 
-    new_selected_list.append(rubberband_items);
+      if (item) {
+        new_selected_list.append(item);
+      }
+    }
   }
 
   foreach (QGraphicsItem* item, rubberband_now_selected_) {
@@ -904,7 +1078,7 @@ void TimelineWidget::MoveRubberBandSelect(bool enable_selecting, bool select_lin
       // Add its links to the list
       TimelineViewBlockItem* link_item;
       foreach (Block* link, b->linked_clips()) {
-        if ((link_item = block_items_[link]) != nullptr) {
+        if ((link_item = block_items_.value(link)) != nullptr) {
           if (!new_selected_list.contains(link_item)) {
             new_selected_list.append(link_item);
           }
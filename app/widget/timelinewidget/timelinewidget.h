@@ -375,8 +375,28 @@ private:
 
   QVector<TimelineViewGhostItem*> ghost_items_;
 
+  /**
+   * @brief Returns the item for a block, creating it if it doesn't exist yet
+   *
+   * Returns nullptr for blocks that don't get items (e.g. blocks that aren't in a track).
+   */
+  TimelineViewBlockItem* GetOrCreateBlockItem(Block* block);
+
+  bool IsBlockSelected(Block* block) const;
+
+  void QueueVisibleItemsUpdate();
+
+  /**
+   * @brief Items that currently exist, keyed by their block
+   *
+   * Items are only created for blocks around the visible area that are wide enough to be seen (see
+   * UpdateVisibleItems()), selected blocks always keep their items. Use GetOrCreateBlockItem() when an item is
+   * needed for a block that might be off-screen.
+   */
   QMap<Block*, TimelineViewBlockItem*> block_items_;
 
+  bool visible_items_update_queued_;
+
   void RippleEditTo(Timeline::MovementMode mode, bool insert_gaps);
 
   TrackOutput* GetTrackFromReference(const TrackReference& ref);
@@ -423,6 +443,11 @@ private slots:
    */
   void BlockChanged();
 
+  /**
+   * @brief Slot for when blocks on a track moved (see TrackOutput::BlocksMoved())
+   */
+  void TrackBlocksMoved();
+
   void PreviewUpdated();
 
   void UpdateHorizontalSplitters();
@@ -437,6 +462,14 @@ private slots:
 
   void DeferredScrollAction();
 
+  /**
+   * @brief Create items for blocks that have come into view and delete ones that have left it
+   *
+   * Keeps the number of QGraphicsItems proportional to what's on screen rather than the length of the sequence.
+   * Items aren't deleted while a tool is in use since tools may be holding onto them.
+   */
+  void UpdateVisibleItems();
+
 };
 
 #endif // TIMELINEWIDGET_H
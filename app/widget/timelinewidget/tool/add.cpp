@@ -47,7 +47,7 @@ void TimelineWidget::AddTool::MouseRelease(TimelineViewMouseEvent *event)
 
   if (ghost_) {
     if (!ghost_->AdjustedLength().isNull()) {
-      QUndoCommand* command = new QUndoCommand();
+      QUndoCommand* command = new UndoCommand();
 
       ClipBlock* clip = new ClipBlock();
       clip->set_length_and_media_out(ghost_->AdjustedLength());
@@ -266,7 +266,7 @@ void TimelineWidget::ImportTool::PrepGhosts(const rational& frame, const int& tr
 
 void TimelineWidget::ImportTool::DropGhosts(bool insert)
 {
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   NodeGraph* dst_graph = nullptr;
   ViewerOutput* viewer_node = nullptr;
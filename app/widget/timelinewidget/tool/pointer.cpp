@@ -180,7 +180,7 @@ void TimelineWidget::PointerTool::SetTrimmingAllowed(bool allowed)
 
 void TimelineWidget::PointerTool::MouseReleaseInternal(TimelineViewMouseEvent *event)
 {
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   QList<Block*> blocks_to_temp_remove;
   QList<TrackReference> tracks_affected;
@@ -495,7 +495,7 @@ void TimelineWidget::PointerTool::InitiateGhosts(TimelineViewBlockItem* clicked_
 
           // Create a rolling effect with the attached block
           if (transition->connected_in_block()) {
-            if (parent()->block_items_.value(transition->connected_in_block())->isSelected()) {
+            if (parent()->IsBlockSelected(transition->connected_in_block())) {
               // We'll be moving this item too, no need to create a ghost for it here
               transition_can_move_tracks = true;
             } else if (block_mode == Timeline::kTrimOut || block_mode == Timeline::kMove) {
@@ -504,7 +504,7 @@ void TimelineWidget::PointerTool::InitiateGhosts(TimelineViewBlockItem* clicked_
           }
 
           if (transition->connected_out_block()) {
-            if (parent()->block_items_.value(transition->connected_in_block())->isSelected()) {
+            if (parent()->IsBlockSelected(transition->connected_in_block())) {
                 // We'll be moving this item too, no need to create a ghost for it here
               transition_can_move_tracks = true;
             } else if (block_mode == Timeline::kTrimIn || block_mode == Timeline::kMove) {
@@ -36,7 +36,7 @@ void TimelineWidget::RippleTool::MouseReleaseInternal(TimelineViewMouseEvent *ev
   // For ripple operations, all ghosts will be moving the same way
   Timeline::MovementMode movement_mode = parent()->ghost_items_.first()->mode();
 
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   // Find earliest point to ripple around
   foreach (TimelineViewGhostItem* ghost, parent()->ghost_items_) {
@@ -33,7 +33,7 @@ void TimelineWidget::RollingTool::MouseReleaseInternal(TimelineViewMouseEvent *e
 {
   Q_UNUSED(event)
 
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   // Find earliest point to ripple around
   foreach (TimelineViewGhostItem* ghost, parent()->ghost_items_) {
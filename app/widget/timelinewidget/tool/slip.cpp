@@ -24,6 +24,7 @@
 
 #include "common/timecodefunctions.h"
 #include "config/config.h"
+#include "undo/undocommand.h"
 
 TimelineWidget::SlipTool::SlipTool(TimelineWidget *parent) :
   PointerTool(parent)
@@ -68,7 +69,7 @@ void TimelineWidget::SlipTool::MouseReleaseInternal(TimelineViewMouseEvent *even
 {
   Q_UNUSED(event)
 
-  QUndoCommand* command = new QUndoCommand();
+  QUndoCommand* command = new UndoCommand();
 
   // Find earliest point to ripple around
   foreach (TimelineViewGhostItem* ghost, parent()->ghost_items_) {
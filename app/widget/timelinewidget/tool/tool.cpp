@@ -56,19 +56,27 @@ Timeline::MovementMode TimelineWidget::Tool::FlipTrimMode(const Timeline::Moveme
 
 TimelineViewBlockItem *TimelineWidget::Tool::GetItemAtScenePos(const TimelineCoordinate& coord)
 {
-  QMapIterator<Block*, TimelineViewBlockItem*> iterator(parent()->block_items_);
+  TrackOutput* track = parent()->GetTrackFromReference(coord.GetTrack());
 
-  while (iterator.hasNext()) {
-    iterator.next();
+  if (!track) {
+    return nullptr;
+  }
+
+  const QVector<Block*>& blocks = track->Blocks();
+
+  for (int i=track->IndexOfFirstBlockEndingAfter(coord.GetFrame());i<blocks.size();i++) {
+    Block* b = blocks.at(i);
 
-    Block* b = iterator.key();
-    TimelineViewBlockItem* item = iterator.value();
+    if (!b) {
+      continue;
+    }
 
-    if (b->in() <= coord.GetFrame()
-        && b->out() > coord.GetFrame()
-        && item->Track() == coord.GetTrack()) {
-      return item;
+    if (b->in() <= coord.GetFrame()) {
+      // The block may be too narrow or too far out of view to have an item yet
+      return parent()->GetOrCreateBlockItem(b);
     }
+
+    break;
   }
 
   return nullptr;
@@ -173,6 +181,7 @@ bool TimelineWidget::Tool::SnapPoint(QList<rational> start_times, rational* move
   }
 
   if (snap_points & kSnapToClips) {
+    // Only blocks around the visible area have items, which are the only ones within snapping range anyway
     QMapIterator<Block*, TimelineViewBlockItem*> iterator(parent()->block_items_);
 
     while (iterator.hasNext()) {
@@ -91,7 +91,7 @@ void TimelineWidget::TransitionTool::MouseRelease(TimelineViewMouseEvent *event)
     if (!ghost_->AdjustedLength().isNull()) {
       TransitionBlock* transition = static_cast<TransitionBlock*>(NodeFactory::CreateFromID("org.olivevideoeditor.Olive.crossdissolve"));
 
-      QUndoCommand* command = new QUndoCommand();
+      QUndoCommand* command = new UndoCommand();
 
       // Place transition in place
       new NodeAddCommand(static_cast<NodeGraph*>(parent()->GetConnectedNode()->parent()),
@@ -32,6 +32,7 @@
 #include "common/timecodefunctions.h"
 #include "node/input/media/media.h"
 #include "project/item/footage/footage.h"
+#include "render/filmstripcache.h"
 
 TimelineView::TimelineView(Qt::Alignment vertical_alignment, QWidget *parent) :
   TimelineViewBase(parent),
@@ -47,6 +48,10 @@ TimelineView::TimelineView(Qt::Alignment vertical_alignment, QWidget *parent) :
   viewport()->setMouseTracking(true);
 
   connect(scene(), &QGraphicsScene::selectionChanged, this, &TimelineView::SelectionChanged);
+
+  if (FilmstripCache::instance()) {
+    connect(FilmstripCache::instance(), &FilmstripCache::FramesReady, viewport(), static_cast<void(QWidget::*)()>(&QWidget::update));
+  }
 }
 
 void TimelineView::SelectAll()
@@ -183,6 +188,62 @@ void TimelineView::drawBackground(QPainter *painter, const QRectF &rect)
     return;
   }
 
+  // Blocks too narrow to have their own items are drawn here, adjacent ones merged into a single rect
+  QVector<QRectF> narrow_rects;
+
+  rational start = SceneToTime(rect.left());
+  rational end = SceneToTime(rect.right());
+
+  for (int i=0;i<connected_track_list_->TrackCount();i++) {
+    TrackOutput* track = connected_track_list_->TrackAt(i);
+
+    if (!track) {
+      continue;
+    }
+
+    int track_top = GetTrackY(i);
+    int track_height = GetTrackHeight(i);
+
+    if (track_top + track_height < rect.top() || track_top > rect.bottom()) {
+      continue;
+    }
+
+    const QVector<Block*>& track_blocks = track->Blocks();
+    int first_rect = narrow_rects.size();
+
+    for (int j=track->IndexOfFirstBlockEndingAfter(start);j<track_blocks.size();j++) {
+      Block* b = track_blocks.at(j);
+
+      if (!b || (b->type() != Block::kClip && b->type() != Block::kTransition)) {
+        continue;
+      }
+
+      if (b->in() > end) {
+        break;
+      }
+
+      qreal left = TimeToScene(b->in());
+      qreal right = TimeToScene(b->out());
+
+      if (right - left >= TimelineViewBlockItem::kMinimumWidth) {
+        continue;
+      }
+
+      if (narrow_rects.size() > first_rect && narrow_rects.last().right() + 1.0 >= left) {
+        narrow_rects.last().setRight(right);
+      } else {
+        narrow_rects.append(QRectF(left, track_top, right - left, track_height));
+      }
+    }
+  }
+
+  if (!narrow_rects.isEmpty()) {
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(144, 144, 216));
+    painter->drawRects(narrow_rects);
+    painter->setBrush(Qt::NoBrush);
+  }
+
   painter->setPen(palette().base().color());
 
   int line_y = 0;
@@ -332,6 +393,51 @@ void TimelineView::ConnectTrackList(TrackList *list)
   }
 }
 
+QVector<Block *> TimelineView::GetBlocksInSceneRect(const QRectF &rect)
+{
+  QVector<Block*> blocks;
+
+  if (!connected_track_list_) {
+    return blocks;
+  }
+
+  rational start = SceneToTime(rect.left());
+  rational end = SceneToTime(rect.right());
+
+  for (int i=0;i<connected_track_list_->TrackCount();i++) {
+    int track_top = GetTrackY(i);
+    int track_bottom = track_top + GetTrackHeight(i);
+
+    if (track_bottom < rect.top() || track_top > rect.bottom()) {
+      continue;
+    }
+
+    TrackOutput* track = connected_track_list_->TrackAt(i);
+
+    if (!track) {
+      continue;
+    }
+
+    const QVector<Block*>& track_blocks = track->Blocks();
+
+    for (int j=track->IndexOfFirstBlockEndingAfter(start);j<track_blocks.size();j++) {
+      Block* b = track_blocks.at(j);
+
+      if (!b) {
+        continue;
+      }
+
+      if (b->in() > end) {
+        break;
+      }
+
+      blocks.append(b);
+    }
+  }
+
+  return blocks;
+}
+
 int TimelineView::SceneToTrack(double y)
 {
   int track = -1;
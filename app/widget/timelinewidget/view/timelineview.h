@@ -59,6 +59,14 @@ public:
 
   void ConnectTrackList(TrackList* list);
 
+  /**
+   * @brief Find the blocks that overlap a rect in scene coordinates
+   *
+   * Only tracks the rect covers are checked and each one's block list is binary searched, so this costs as much as
+   * the number of blocks inside the rect rather than the number of blocks in the sequence.
+   */
+  QVector<Block*> GetBlocksInSceneRect(const QRectF& rect);
+
 signals:
   void MousePressed(TimelineViewMouseEvent* event);
   void MouseMoved(TimelineViewMouseEvent* event);
@@ -34,6 +34,10 @@
 #include "common/qtutils.h"
 #include "config/config.h"
 #include "node/block/transition/transition.h"
+#include "node/input/media/video/video.h"
+#include "render/filmstripcache.h"
+
+const int TimelineViewBlockItem::kMinimumWidth = 4;
 
 TimelineViewBlockItem::TimelineViewBlockItem(Block *block, QGraphicsItem* parent) :
   TimelineViewRect(parent),
@@ -41,6 +45,7 @@ TimelineViewBlockItem::TimelineViewBlockItem(Block *block, QGraphicsItem* parent
 {
   setBrush(Qt::white);
   setCursor(Qt::DragMoveCursor);
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
   setFlag(QGraphicsItem::ItemIsSelectable,
           block_->type() == Block::kClip
           || block_->type() == Block::kGap
@@ -82,6 +87,8 @@ void TimelineViewBlockItem::paint(QPainter *painter, const QStyleOptionGraphicsI
     grad.setColorAt(1.0, QColor(128, 128, 192));
     painter->fillRect(rect(), grad);
 
+    PaintFilmstrip(painter, option->exposedRect);
+
     if (option->state & QStyle::State_Selected) {
       painter->fillRect(rect(), QColor(0, 0, 0, 64));
     }
@@ -218,3 +225,105 @@ void TimelineViewBlockItem::paint(QPainter *painter, const QStyleOptionGraphicsI
   }
   }
 }
+
+ImageStreamPtr TimelineViewBlockItem::GetVideoStream() const
+{
+  if (block_->type() != Block::kClip) {
+    return nullptr;
+  }
+
+  Node* connected = static_cast<ClipBlock*>(block_)->texture_input()->get_connected_node();
+
+  if (!connected) {
+    return nullptr;
+  }
+
+  QList<Node*> nodes = connected->GetDependencies();
+  nodes.prepend(connected);
+
+  foreach (Node* n, nodes) {
+    VideoInput* video_input = dynamic_cast<VideoInput*>(n);
+
+    if (video_input) {
+      StreamPtr stream = video_input->footage();
+
+      if (stream && (stream->type() == Stream::kVideo || stream->type() == Stream::kImage)) {
+        return std::static_pointer_cast<ImageStream>(stream);
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+void TimelineViewBlockItem::PaintFilmstrip(QPainter *painter, const QRectF &exposed)
+{
+  if (!FilmstripCache::instance()) {
+    return;
+  }
+
+  ImageStreamPtr stream = GetVideoStream();
+
+  if (!stream || stream->width() <= 0 || stream->height() <= 0) {
+    return;
+  }
+
+  double speed = block_->speed().toDouble();
+
+  if (speed <= 0) {
+    return;
+  }
+
+  double scale = GetScale();
+  double thumb_width = rect().height() * stream->width() / stream->height();
+  double media_in = block_->media_in().toDouble();
+
+  double left = qMax(rect().left(), exposed.left());
+  double right = qMin(rect().right(), exposed.right());
+
+  painter->save();
+  painter->setClipRect(QRectF(left, rect().top(), right - left, rect().height()), Qt::IntersectClip);
+
+  if (stream->type() == Stream::kImage) {
+
+    // Stills only need one frame, repeated across the clip
+    QPixmap frame = FilmstripCache::instance()->Get(stream, 0, 0);
+
+    if (!frame.isNull()) {
+      for (double x = qFloor(left / thumb_width) * thumb_width;x<right;x+=thumb_width) {
+        painter->drawPixmap(QRectF(x, rect().top(), thumb_width, rect().height()), frame, frame.rect());
+      }
+    }
+
+  } else {
+
+    // Pick the level where each frame covers at most a thumbnail's width, frames are cropped to fit their slot
+    int level = FilmstripCache::LevelForInterval(thumb_width / scale * speed);
+    qint64 step = Q_INT64_C(1) << level;
+
+    for (qint64 tick = FilmstripCache::TickAt(media_in + left / scale * speed, level);;tick += step) {
+      double slot_left = (static_cast<double>(tick) / FilmstripCache::kTicksPerSecond - media_in) / speed * scale;
+      double slot_right = (static_cast<double>(tick + step) / FilmstripCache::kTicksPerSecond - media_in) / speed * scale;
+
+      if (slot_left >= right) {
+        break;
+      }
+
+      QPixmap frame = FilmstripCache::instance()->Get(stream, tick, level);
+
+      if (!frame.isNull()) {
+        double draw_width = qMin(slot_right - slot_left, thumb_width);
+
+        // Crop the middle of the frame if the slot is narrower than it
+        double source_width = draw_width * frame.height() / rect().height();
+
+        painter->drawPixmap(QRectF(slot_left, rect().top(), draw_width, rect().height()),
+                            frame,
+                            QRectF((frame.width() - source_width) * 0.5, 0, source_width, frame.height()));
+      }
+    }
+
+  }
+
+  painter->restore();
+}
@@ -23,6 +23,7 @@
 
 #include "timelineviewrect.h"
 #include "node/block/clip/clip.h"
+#include "project/item/footage/imagestream.h"
 
 /**
  * @brief A graphical representation of a ClipBlock
@@ -36,10 +37,27 @@ public:
 
   virtual void UpdateRect() override;
 
+  /**
+   * @brief Blocks narrower than this (in pixels) don't get their own item unless they're selected
+   *
+   * TimelineView draws them in batches instead (see TimelineView::drawBackground()).
+   */
+  static const int kMinimumWidth;
+
 protected:
   virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
 
 private:
+  /**
+   * @brief Returns the video or image stream this clip shows, or nullptr if it isn't showing one
+   */
+  ImageStreamPtr GetVideoStream() const;
+
+  /**
+   * @brief Draws frames from FilmstripCache across the exposed part of this clip
+   */
+  void PaintFilmstrip(QPainter* painter, const QRectF& exposed);
+
   Block* block_;
 
 };
@@ -37,7 +37,9 @@ TimeRuler::TimeRuler(bool text_visible, bool cache_status_visible, QWidget* pare
   centered_text_(true),
   scale_(1.0),
   time_(0),
-  show_cache_status_(cache_status_visible)
+  show_cache_status_(cache_status_visible),
+  background_percent_(0),
+  background_paused_(false)
 {
   QFontMetrics fm = fontMetrics();
 
@@ -129,6 +131,17 @@ void TimeRuler::CacheTimeReady(const rational &time)
   }
 }
 
+void TimeRuler::SetBackgroundRenderProgress(const TimeRange &range, int percent, bool paused)
+{
+  if (show_cache_status_) {
+    background_range_ = range;
+    background_percent_ = percent;
+    background_paused_ = paused;
+
+    update();
+  }
+}
+
 void TimeRuler::paintEvent(QPaintEvent *)
 {
   // Nothing to paint if the timebase is invalid
@@ -305,6 +318,36 @@ void TimeRuler::paintEvent(QPaintEvent *)
         p.fillRect(adjusted_left, cache_y, qMin(width(), range_right) - adjusted_left, cache_status_height_, Qt::red);
       }
     }
+
+    // Outline the background render range and label it with its progress
+    if (background_range_.length() > 0) {
+      int range_left = TimeToScreen(background_range_.in());
+      int range_right = qMin(TimeToScreen(background_range_.out()), width());
+
+      if (range_left < width() && range_right >= 0) {
+        int adjusted_left = qMax(0, range_left);
+        int cache_y = height() - cache_status_height_;
+
+        p.setPen(palette().highlight().color());
+        p.setBrush(Qt::NoBrush);
+        p.drawRect(adjusted_left, cache_y, range_right - adjusted_left - 1, cache_status_height_ - 1);
+
+        QString label = background_paused_
+            ? tr("Background render paused (on battery)")
+            : tr("Background render %1%").arg(background_percent_);
+
+        QFontMetrics fm = p.fontMetrics();
+        int label_width = QFontMetricsWidth(fm, label) + fm.height() / 2;
+        QRect label_rect(qMax(adjusted_left, range_right - label_width),
+                         cache_y - fm.height(),
+                         label_width,
+                         fm.height());
+
+        p.fillRect(label_rect, palette().window());
+        p.setPen(palette().text().color());
+        p.drawText(label_rect, Qt::AlignCenter, label);
+      }
+    }
   }
 
   // Draw the playhead if it's on screen at the moment
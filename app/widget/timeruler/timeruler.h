@@ -54,6 +54,11 @@ public slots:
 
   void SetCacheStatusLength(const rational& length);
 
+  /**
+   * @brief Show the progress of a background render over the cache status (an empty range hides it)
+   */
+  void SetBackgroundRenderProgress(const TimeRange& range, int percent, bool paused);
+
 protected:
   virtual void paintEvent(QPaintEvent* e) override;
 
@@ -115,6 +120,12 @@ private:
 
   TimeRangeList dirty_cache_ranges_;
 
+  TimeRange background_range_;
+
+  int background_percent_;
+
+  bool background_paused_;
+
 };
 
 #endif // TIMERULER_H
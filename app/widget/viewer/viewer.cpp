@@ -20,9 +20,10 @@
 
 #include "viewer.h"
 
-#include <QDateTime>
+#include <QGuiApplication>
 #include <QLabel>
 #include <QResizeEvent>
+#include <QScreen>
 #include <QtMath>
 #include <QVBoxLayout>
 
@@ -34,14 +35,30 @@
 #include "render/pixelformat.h"
 #include "widget/menu/menu.h"
 
+const qint64 ViewerWidget::kMaximumHoldTime = 250000;
+const int ViewerWidget::kDegradeThreshold = 3;
+const int ViewerWidget::kMaximumPlaybackDividerScale = 8;
+
 ViewerWidget::ViewerWidget(QWidget *parent) :
   TimeBasedWidget(false, true, parent),
+  clock_offset_(0),
+  last_clock_(0),
+  audio_clock_enabled_(false),
+  refresh_interval_(16667),
+  last_presented_(-1),
+  last_late_(-1),
+  dropped_frames_(0),
+  late_frames_(0),
+  consecutive_late_frames_(0),
+  holding_frame_(false),
+  playback_divider_scale_(1),
   playback_speed_(0),
   frame_cache_job_time_(0),
   color_menu_enabled_(true),
   divider_(Config::Current()["DefaultViewerDivider"].toInt()),
   override_color_manager_(nullptr),
-  time_changed_from_timer_(false)
+  time_changed_from_timer_(false),
+  background_render_enabled_(false)
 {
   // Set up main layout
   QVBoxLayout* layout = new QVBoxLayout(this);
@@ -83,7 +100,9 @@ ViewerWidget::ViewerWidget(QWidget *parent) :
   connect(video_renderer_, &VideoRenderBackend::CachedTimeReady, this, &ViewerWidget::RendererCachedTime);
   connect(video_renderer_, &VideoRenderBackend::CachedTimeReady, ruler(), &TimeRuler::CacheTimeReady);
   connect(video_renderer_, &VideoRenderBackend::RangeInvalidated, ruler(), &TimeRuler::CacheInvalidatedRange);
+  connect(video_renderer_, &VideoRenderBackend::BackgroundRenderProgress, ruler(), &TimeRuler::SetBackgroundRenderProgress);
   audio_renderer_ = new AudioBackend(this);
+  connect(audio_renderer_, &AudioBackend::CachedRangeReady, this, &ViewerWidget::AudioRendererCachedRange);
 
   connect(PixelFormat::instance(), &PixelFormat::FormatChanged, this, &ViewerWidget::UpdateRendererParameters);
 
@@ -150,6 +169,8 @@ void ViewerWidget::DisconnectNodeInternal(ViewerOutput *n)
   // Effectively disables the viewer and clears the state
   SizeChangedSlot(0, 0);
 
+  video_renderer_->SetBackgroundRenderRange(TimeRange());
+
   gl_widget_->DisconnectColorManager();
 }
 
@@ -215,6 +236,13 @@ VideoRenderBackend *ViewerWidget::video_renderer() const
   return video_renderer_;
 }
 
+void ViewerWidget::SetBackgroundRenderEnabled(bool enabled)
+{
+  background_render_enabled_ = enabled;
+
+  UpdateBackgroundRenderRange();
+}
+
 void ViewerWidget::UpdateTextureFromNode(const rational& time)
 {
   if (!GetConnectedNode() || time >= GetConnectedNode()->Length()) {
@@ -224,8 +252,113 @@ void ViewerWidget::UpdateTextureFromNode(const rational& time)
 
     if (!frame_fn.isEmpty()) {
       gl_widget_->SetImage(frame_fn);
+
+      int64_t timestamp = Timecode::time_to_timestamp(time, timebase());
+
+      if (IsPlaying() && last_presented_ != -1) {
+        // Any frame between this one and the last one we showed was skipped
+        int64_t steps = qAbs(timestamp - last_presented_) / qAbs(playback_speed_);
+
+        if (steps > 1) {
+          dropped_frames_ += static_cast<int>(steps - 1);
+          controls_->SetFrameStatistics(dropped_frames_, late_frames_);
+        }
+      }
+
+      last_presented_ = timestamp;
+    }
+  }
+}
+
+int ViewerWidget::dropped_frame_count() const
+{
+  return dropped_frames_;
+}
+
+int ViewerWidget::late_frame_count() const
+{
+  return late_frames_;
+}
+
+qint64 ViewerWidget::GetPlaybackClock()
+{
+  qint64 monotonic_clock = playback_timer_.nsecsElapsed() / 1000;
+  qint64 clock = monotonic_clock + clock_offset_;
+
+  if (audio_clock_enabled_) {
+    qint64 audio_clock = AudioManager::instance()->GetOutputPlayedUSecs();
+
+    if (audio_clock >= 0) {
+      // The audio device consumes samples at its own rate, which drifts from the system clock over long playback, so
+      // it's the master while it's running. Keep the offset in step so falling back to the monotonic clock (e.g. when
+      // the device underruns) doesn't jump.
+      clock = audio_clock;
+      clock_offset_ = audio_clock - monotonic_clock;
+    }
+  }
+
+  // Never run backwards, the audio clock can move back slightly when the device's buffer estimate is corrected
+  last_clock_ = qMax(last_clock_, clock);
+
+  return last_clock_;
+}
+
+int64_t ViewerWidget::ApplyLateFramePolicy(int64_t target)
+{
+  if (target == GetTimestamp()
+      || video_renderer_->IsFrameCached(Timecode::timestamp_to_time(target, timebase()))) {
+    consecutive_late_frames_ = 0;
+    holding_frame_ = false;
+    return target;
+  }
+
+  if (target != last_late_) {
+    late_frames_++;
+    consecutive_late_frames_++;
+    last_late_ = target;
+
+    controls_->SetFrameStatistics(dropped_frames_, late_frames_);
+  }
+
+  switch (static_cast<LateFramePolicy>(Config::Current()["PlaybackLateFramePolicy"].toInt())) {
+  case kLateFrameHold:
+  {
+    if (last_presented_ == -1) {
+      break;
+    }
+
+    if (!holding_frame_) {
+      holding_frame_ = true;
+      hold_timer_.start();
+    }
+
+    if (hold_timer_.nsecsElapsed() / 1000 < kMaximumHoldTime) {
+      // Wait on the frame after the one that's showing rather than skipping past it
+      int64_t next_frame = last_presented_ + playback_speed_;
+
+      return (playback_speed_ > 0) ? qMin(next_frame, target) : qMax(next_frame, target);
+    }
+
+    // Held too long, give up and catch up with the clock
+    holding_frame_ = false;
+    break;
+  }
+  case kLateFrameDegrade:
+    if (consecutive_late_frames_ >= kDegradeThreshold
+        && playback_divider_scale_ < kMaximumPlaybackDividerScale) {
+      playback_divider_scale_ *= 2;
+      consecutive_late_frames_ = 0;
+
+      qInfo() << "Frames arriving late, lowering playback resolution by" << playback_divider_scale_;
+
+      UpdateRendererParameters();
     }
+    break;
+  case kLateFrameDrop:
+    break;
   }
+
+  return target;
 }
 
 void ViewerWidget::PlayInternal(int speed)
@@ -239,16 +372,39 @@ void ViewerWidget::PlayInternal(int speed)
 
   playback_speed_ = speed;
 
+  video_renderer_->SetPlaybackSpeed(playback_speed_);
+
+  audio_clock_enabled_ = false;
+
   QIODevice* audio_src = audio_renderer_->GetAudioPullDevice();
   if (audio_src != nullptr && audio_src->open(QIODevice::ReadOnly)) {
     audio_src->seek(audio_renderer_->params().time_to_bytes(GetTime()));
     AudioManager::instance()->SetOutputParams(audio_renderer_->params());
     AudioManager::instance()->StartOutput(audio_src, playback_speed_);
+
+    audio_clock_enabled_ = true;
   }
 
-  start_msec_ = QDateTime::currentMSecsSinceEpoch();
   start_timestamp_ = ruler()->GetTime();
 
+  playback_timer_.start();
+  clock_offset_ = 0;
+  last_clock_ = 0;
+
+  // Seed the refresh interval with what the screen reports, it's refined from the actual buffer swaps as we play
+  if (QGuiApplication::primaryScreen() && QGuiApplication::primaryScreen()->refreshRate() > 0) {
+    refresh_interval_ = qRound64(1000000.0 / QGuiApplication::primaryScreen()->refreshRate());
+  }
+  swap_timer_.invalidate();
+
+  last_presented_ = start_timestamp_;
+  last_late_ = -1;
+  dropped_frames_ = 0;
+  late_frames_ = 0;
+  consecutive_late_frames_ = 0;
+  holding_frame_ = false;
+  controls_->SetFrameStatistics(0, 0);
+
   controls_->ShowPauseButton();
 
   connect(gl_widget_, &ViewerGLWidget::frameSwapped, this, &ViewerWidget::PlaybackTimerUpdate);
@@ -256,22 +412,13 @@ void ViewerWidget::PlayInternal(int speed)
 
 void ViewerWidget::PushScrubbedAudio()
 {
-  if (!IsPlaying() && Config::Current()["AudioScrubbing"].toBool()) {
-    // Get audio src device from renderer
-    QIODevice* audio_src = audio_renderer_->GetAudioPullDevice();
+  if (!IsPlaying()
+      && Config::Current()["AudioScrubbing"].toBool()
+      && audio_renderer_->params().is_valid()) {
+    // Render any audio that's missing around the playhead first so there's something to hear
+    audio_renderer_->SetPriorityTime(GetTime());
 
-    if (audio_src && audio_src->open(QFile::ReadOnly)) {
-      // Try to get one "frame" of audio
-      int size_of_sample = audio_renderer_->params().time_to_bytes(timebase());
-
-      // Push audio
-      audio_src->seek(audio_renderer_->params().time_to_bytes(GetTime()));
-      QByteArray frame_audio = audio_src->read(size_of_sample);
-      AudioManager::instance()->SetOutputParams(audio_renderer_->params());
-      AudioManager::instance()->PushToOutput(frame_audio);
-
-      audio_src->close();
-    }
+    AudioManager::instance()->ScrubTo(audio_renderer_->CachePathName(), audio_renderer_->params(), GetTime());
   }
 }
 
@@ -287,6 +434,16 @@ int ViewerWidget::CalculateDivider()
   return divider_;
 }
 
+void ViewerWidget::UpdateBackgroundRenderRange()
+{
+  // There are no in/out points yet, so the whole sequence is rendered
+  if (background_render_enabled_ && GetConnectedNode()) {
+    video_renderer_->SetBackgroundRenderRange(TimeRange(0, GetConnectedNode()->Length()));
+  } else {
+    video_renderer_->SetBackgroundRenderRange(TimeRange());
+  }
+}
+
 void ViewerWidget::UpdateRendererParameters()
 {
   if (!GetConnectedNode()) {
@@ -298,7 +455,7 @@ void ViewerWidget::UpdateRendererParameters()
   VideoRenderingParams vparam(GetConnectedNode()->video_params(),
                               PixelFormat::instance()->GetConfiguredFormatForMode(render_mode),
                               render_mode,
-                              divider_);
+                              divider_ * playback_divider_scale_);
 
   if (video_renderer_->params() != vparam) {
     video_renderer_->SetParameters(vparam);
@@ -385,9 +542,15 @@ void ViewerWidget::Pause()
   if (IsPlaying()) {
     AudioManager::instance()->StopOutput();
     playback_speed_ = 0;
+    video_renderer_->SetPlaybackSpeed(0);
     controls_->ShowPlayButton();
 
     disconnect(gl_widget_, &ViewerGLWidget::frameSwapped, this, &ViewerWidget::PlaybackTimerUpdate);
+
+    if (playback_divider_scale_ != 1) {
+      playback_divider_scale_ = 1;
+      UpdateRendererParameters();
+    }
   }
 }
 
@@ -462,19 +625,37 @@ void ViewerWidget::TimebaseChangedEvent(const rational &timebase)
 
 void ViewerWidget::PlaybackTimerUpdate()
 {
-  int64_t real_time = QDateTime::currentMSecsSinceEpoch() - start_msec_;
+  // Refine the refresh interval from the time between buffer swaps
+  if (swap_timer_.isValid()) {
+    qint64 swap_interval = swap_timer_.nsecsElapsed() / 1000;
+
+    // Ignore stalls (e.g. the window being hidden) which would skew the estimate
+    if (swap_interval > 0 && swap_interval < 4 * refresh_interval_) {
+      refresh_interval_ = (refresh_interval_ * 7 + swap_interval) / 8;
+    }
+  }
+  swap_timer_.start();
+
+  // Pick the frame that will be current when this swap actually reaches the screen, not the one that's current now
+  qint64 presentation_time = GetPlaybackClock() + refresh_interval_;
 
-  int64_t frames_since_start = qRound(static_cast<double>(real_time) / (timebase_dbl() * 1000));
+  int64_t frames_since_start = qFloor(static_cast<double>(presentation_time) / (timebase_dbl() * 1000000));
 
   int64_t current_time = start_timestamp_ + frames_since_start * playback_speed_;
 
   if (current_time < 0) {
     SetTimeAndSignal(0);
-  } else {
-    time_changed_from_timer_ = true;
-    SetTimeAndSignal(current_time);
-    time_changed_from_timer_ = false;
+    return;
   }
+
+  current_time = ApplyLateFramePolicy(current_time);
+
+  time_changed_from_timer_ = true;
+  SetTimeAndSignal(current_time);
+  time_changed_from_timer_ = false;
+
+  // We're driven by frameSwapped, so make sure there's always another swap coming even if the image didn't change
+  gl_widget_->update();
 }
 
 void ViewerWidget::RendererCachedTime(const rational &time, qint64 job_time)
@@ -486,6 +667,11 @@ void ViewerWidget::RendererCachedTime(const rational &time, qint64 job_time)
   }
 }
 
+void ViewerWidget::AudioRendererCachedRange(const TimeRange &range)
+{
+  AudioManager::instance()->ScrubSourceUpdated(audio_renderer_->CachePathName(), range);
+}
+
 void ViewerWidget::SizeChangedSlot(int width, int height)
 {
   sizer_->SetChildSize(width, height);
@@ -495,6 +681,8 @@ void ViewerWidget::LengthChangedSlot(const rational &length)
 {
   controls_->SetEndTime(Timecode::time_to_timestamp(length, timebase()));
   ruler()->SetCacheStatusLength(length);
+
+  UpdateBackgroundRenderRange();
 }
 
 void ViewerWidget::ColorDisplayChanged(QAction* action)
@@ -21,6 +21,7 @@
 #ifndef VIEWER_WIDGET_H
 #define VIEWER_WIDGET_H
 
+#include <QElapsedTimer>
 #include <QFile>
 #include <QLabel>
 #include <QPushButton>
@@ -45,6 +46,20 @@ class ViewerWidget : public TimeBasedWidget
 {
   Q_OBJECT
 public:
+  /**
+   * @brief What playback does when a frame isn't ready by the time it should be shown
+   */
+  enum LateFramePolicy {
+    /// Keep showing the last frame and skip ahead to whatever the clock says once frames are ready again
+    kLateFrameDrop,
+
+    /// Wait (up to kMaximumHoldTime) for the late frame and show it rather than skipping it
+    kLateFrameHold,
+
+    /// Drop, and lower the playback resolution if frames keep arriving late
+    kLateFrameDegrade
+  };
+
   ViewerWidget(QWidget* parent = nullptr);
 
   void SetPlaybackControlsEnabled(bool enabled);
@@ -71,6 +86,21 @@ public:
 
   VideoRenderBackend* video_renderer() const;
 
+  /**
+   * @brief Set whether the whole connected sequence should be rendered in the background while the user is idle
+   */
+  void SetBackgroundRenderEnabled(bool enabled);
+
+  /**
+   * @brief Number of frames that were never shown because playback skipped past them since playback last started
+   */
+  int dropped_frame_count() const;
+
+  /**
+   * @brief Number of frames that weren't ready when they were due since playback last started
+   */
+  int late_frame_count() const;
+
 public slots:
   void Play();
 
@@ -125,19 +155,72 @@ private:
 
   void UpdateTextureFromNode(const rational &time);
 
+  /**
+   * @brief Microseconds since playback started
+   *
+   * Slaved to the audio output's played position while audio is playing, otherwise a monotonic clock that's kept in
+   * step with it so switching between the two doesn't jump.
+   */
+  qint64 GetPlaybackClock();
+
+  /**
+   * @brief Apply the configured LateFramePolicy to the frame the playback clock wants to show
+   *
+   * Returns the timestamp that should actually be shown, which may be an earlier one if the policy is to hold.
+   */
+  int64_t ApplyLateFramePolicy(int64_t target);
+
   void PlayInternal(int speed);
 
   void PushScrubbedAudio();
 
   int CalculateDivider();
 
+  void UpdateBackgroundRenderRange();
+
   ViewerSizer* sizer_;
 
   PlaybackControls* controls_;
 
-  qint64 start_msec_;
   int64_t start_timestamp_;
 
+  QElapsedTimer playback_timer_;
+
+  qint64 clock_offset_;
+
+  qint64 last_clock_;
+
+  bool audio_clock_enabled_;
+
+  /// Measures the time between buffer swaps to predict when the next frame will be displayed
+  QElapsedTimer swap_timer_;
+
+  /// Estimated display refresh interval in microseconds
+  qint64 refresh_interval_;
+
+  int64_t last_presented_;
+
+  int64_t last_late_;
+
+  int dropped_frames_;
+
+  int late_frames_;
+
+  int consecutive_late_frames_;
+
+  bool holding_frame_;
+
+  QElapsedTimer hold_timer_;
+
+  /// Divider multiplier applied during playback by kLateFrameDegrade
+  int playback_divider_scale_;
+
+  static const qint64 kMaximumHoldTime;
+
+  static const int kDegradeThreshold;
+
+  static const int kMaximumPlaybackDividerScale;
+
   int playback_speed_;
 
   qint64 frame_cache_job_time_;
@@ -152,11 +235,15 @@ private:
 
   bool time_changed_from_timer_;
 
+  bool background_render_enabled_;
+
 private slots:
   void PlaybackTimerUpdate();
 
   void RendererCachedTime(const rational& time, qint64 job_time);
 
+  void AudioRendererCachedRange(const TimeRange& range);
+
   void SizeChangedSlot(int width, int height);
 
   void LengthChangedSlot(const rational& length);
@@ -23,6 +23,7 @@
 #include <QEvent>
 
 #include "common/timecodefunctions.h"
+#include "config/config.h"
 #include "core.h"
 #include "dialog/actionsearch/actionsearch.h"
 #include "panel/panelmanager.h"
@@ -200,6 +201,9 @@ MainMenu::MainMenu(QMainWindow *parent) :
 
   playback_loop_item_ = playback_menu_->AddItem("loop", nullptr, nullptr);
   //Menu::SetBooleanAction(playback_loop_item_, &olive::config.loop);
+  playback_background_render_item_ = playback_menu_->AddItem("backgroundrender", this, SLOT(BackgroundRenderTriggered()));
+  playback_background_render_item_->setCheckable(true);
+  playback_background_render_item_->setChecked(Config::Current()["BackgroundRender"].toBool());
 
   //
   // WINDOW MENU
@@ -507,6 +511,17 @@ void MainMenu::GoToNextCutTriggered()
   PanelManager::instance()->CurrentlyFocused()->GoToNextCut();
 }
 
+void MainMenu::BackgroundRenderTriggered()
+{
+  bool enabled = playback_background_render_item_->isChecked();
+
+  Config::Current()["BackgroundRender"] = enabled;
+
+  foreach (ViewerPanel* viewer, PanelManager::instance()->GetPanelsOfType<ViewerPanel>()) {
+    viewer->SetBackgroundRenderEnabled(enabled);
+  }
+}
+
 void MainMenu::Retranslate()
 {
   // MenuShared is not a QWidget and therefore does not receive a LanguageEvent, we use MainMenu's to update it
@@ -583,6 +598,7 @@ void MainMenu::Retranslate()
   playback_shuttlestop_item_->setText(tr("Shuttle Stop"));
   playback_shuttleright_item_->setText(tr("Shuttle Right"));
   playback_loop_item_->setText(tr("Loop"));
+  playback_background_render_item_->setText(tr("Render in Background"));
 
   // Window menu
   window_menu_->setTitle("&Window");
@@ -140,6 +140,8 @@ private slots:
   void GoToPrevCutTriggered();
   void GoToNextCutTriggered();
 
+  void BackgroundRenderTriggered();
+
 private:
   /**
    * @brief Set strings based on the current application language.
@@ -210,6 +212,7 @@ private:
   QAction* playback_shuttlestop_item_;
   QAction* playback_shuttleright_item_;
   QAction* playback_loop_item_;
+  QAction* playback_background_render_item_;
 
   Menu* window_menu_;
   QAction* window_menu_separator_;
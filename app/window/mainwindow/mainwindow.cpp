@@ -100,6 +100,7 @@ MainWindow::MainWindow(QWidget *parent) :
   connect(curve_panel_, &CurvePanel::TimeChanged, param_panel_, &ParamPanel::SetTime);
   connect(viewer_panel_->video_renderer(), &VideoRenderBackend::CachedTimeReady, timeline_panel_->ruler(), &TimeRuler::CacheTimeReady);
   connect(viewer_panel_->video_renderer(), &VideoRenderBackend::RangeInvalidated, timeline_panel_->ruler(), &TimeRuler::CacheInvalidatedRange);
+  connect(viewer_panel_->video_renderer(), &VideoRenderBackend::BackgroundRenderProgress, timeline_panel_->ruler(), &TimeRuler::SetBackgroundRenderProgress);
 
   viewer_panel_->ConnectTimeBasedPanel(timeline_panel_);
   viewer_panel_->ConnectTimeBasedPanel(param_panel_);